@@ -25,6 +25,16 @@
 #define CORE_MQTT_AGENT_TASKS_H
 
 #include "FreeRTOS.h"
+#include "sdkconfig.h"
+
+/**
+ * @brief Largest payload accepted by mqttAgentPublish.
+ *
+ * Set with CONFIG_MQTT_AGENT_PAYLOAD_BUF_SIZE or a compile definition.
+ */
+#ifndef MQTT_AGENT_PAYLOAD_BUF_SIZE
+    #define MQTT_AGENT_PAYLOAD_BUF_SIZE    CONFIG_MQTT_AGENT_PAYLOAD_BUF_SIZE
+#endif
 
 /**
  * @brief structure of mqtt subscribe information.
@@ -82,7 +92,7 @@ extern BaseType_t mqttAgentSubscribe( MQTTQoS_t qos,
  * @param[in] pTopic char pointer to mqtt topic name that publishing to.
  * @param[in] topicLength length of topic name.
  * @param[in] pMsg pointer to message to be published.
- * @param[in] msgLength length of message
+ * @param[in] msgLength length of message, at most MQTT_AGENT_PAYLOAD_BUF_SIZE.
  *
  * @return pdTRUE for successful publish, otherwise return pdFALSE.
  */
@@ -64,7 +64,7 @@
 #define mqttexampleSTRING_BUFFER_LENGTH                   ( 100 )
 
 #define mqttexampleSTRING_TOPIC_BUFFER_LENGTH             ( 100 )
-#define mqttexampleSTRING_PAYLOAD_BUFFER_LENGTH           ( 2048 )
+#define mqttexampleSTRING_PAYLOAD_BUFFER_LENGTH           MQTT_AGENT_PAYLOAD_BUF_SIZE
 
 /**
  * @brief Number of publishes done by each task in this demo.
@@ -372,6 +372,13 @@ BaseType_t mqttAgentPublish( MQTTQoS_t qos,
     MQTTStatus_t xCommandAdded;
     MQTTAgentCommandInfo_t xCommandParams = { 0UL };
 
+    if( ( topicLength >= mqttexampleSTRING_TOPIC_BUFFER_LENGTH ) ||
+        ( msgLength > mqttexampleSTRING_PAYLOAD_BUFFER_LENGTH ) )
+    {
+        LogError(( "Publish of %u bytes does not fit the payload buffer.", ( unsigned int ) msgLength ));
+        return pdFALSE;
+    }
+
     /* Configure the publish operation. */
     memset( ( void * ) &xPublishInfo, 0x00, sizeof( xPublishInfo ) );
     memset( ( void * ) topicBuf, 0x00, mqttexampleSTRING_TOPIC_BUFFER_LENGTH);
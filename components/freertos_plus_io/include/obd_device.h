@@ -33,4 +33,8 @@
 /* NTP for cms data. */
 #define ioctlOBD_NTP             0x30000000
 
+/* Exclusive access to the link for one command/response transaction. */
+#define ioctlOBD_LOCK            0x40000000
+#define ioctlOBD_UNLOCK          0x40000001
+
 #endif /* OBD_DEVICE_H */
@@ -24,6 +24,7 @@
 #include <string.h>
 
 #include "FreeRTOS_DriverInterface.h"
+#include "freertos/semphr.h"
 #include "driver/uart.h"
 #include "driver/gpio.h"
 #include "esp_sntp.h"
@@ -45,6 +46,7 @@
 typedef struct ObdDeviceContext
 {
     uint32_t readTimeoutMs;
+    SemaphoreHandle_t linkMutex; /* Serializes transactions from the telemetry and GPS tasks. */
 } ObdDeviceContext_t;
 
 /*-----------------------------------------------------------*/
@@ -66,7 +68,8 @@ static BaseType_t Obd_Ioctl( Peripheral_Descriptor_t const xPeripheral,
 
 static ObdDeviceContext_t obdDeviceContext =
 {
-    DEFAULT_READ_TIMEOUT_MS
+    DEFAULT_READ_TIMEOUT_MS,
+    NULL
 };
 
 Peripheral_device_t gObdDevice =
@@ -199,6 +202,12 @@ Peripheral_Descriptor_t Obd_Open( const int8_t * pcPath,
     /* Set UART pins. */
     uart_set_pin( LINK_UART_NUM, PIN_LINK_UART_TX, PIN_LINK_UART_RX, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE );
 
+    /* Create the link mutex once. It's kept across reopen. */
+    if( obdDeviceContext.linkMutex == NULL )
+    {
+        obdDeviceContext.linkMutex = xSemaphoreCreateMutex();
+    }
+
     /* Install UART driver. */
     if( uart_driver_install( LINK_UART_NUM, LINK_UART_BUF_SIZE, 0, 0, NULL, 0 ) == ESP_OK )
     {
@@ -341,6 +350,22 @@ BaseType_t Obd_Ioctl( Peripheral_Descriptor_t const pxPeripheral,
                 }
                 break;
 
+            case ioctlOBD_LOCK:
+                if( ( pObdContext->linkMutex == NULL ) ||
+                    ( xSemaphoreTake( pObdContext->linkMutex, portMAX_DELAY ) != pdTRUE ) )
+                {
+                    printf( "ioctlOBD_LOCK failed" );
+                    retValue = pdFAIL;
+                }
+                break;
+
+            case ioctlOBD_UNLOCK:
+                if( pObdContext->linkMutex != NULL )
+                {
+                    xSemaphoreGive( pObdContext->linkMutex );
+                }
+                break;
+
             default:
                 printf( "unsupported ioctl request fail 0x%08x", ulRequest );
                 retValue = pdFAIL;
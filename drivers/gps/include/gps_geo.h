@@ -0,0 +1,92 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file gps_geo.h
+ * @brief Fixed-point geodetic helpers on int32 microdegree coordinates.
+ */
+
+#ifndef GPS_GEO_H
+#define GPS_GEO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* "-180.000000" and the terminator. */
+#define GPS_GEO_STRING_MAX          ( 16 )
+
+#define GPS_GEO_MICRODEGREE         ( 1000000L )
+
+/**
+ * @brief Cosine of an angle in Q15.
+ *
+ * @param[in] angleE6 angle in microdegree.
+ *
+ * @return cosine scaled by 32768, 0 to 32768.
+ */
+uint32_t GPSGeo_CosQ15( int32_t angleE6 );
+
+/**
+ * @brief Distance between two coordinates.
+ *
+ * Equirectangular approximation, good for the short segments between fixes
+ * and trip ends. The error grows past a few hundred kilometres, except along
+ * the equator and the meridians. Distances saturate at UINT32_MAX, about
+ * 4295 km.
+ *
+ * @param[in] lat1E6 latitude of the first point in microdegree.
+ * @param[in] lng1E6 longitude of the first point in microdegree.
+ * @param[in] lat2E6 latitude of the second point in microdegree.
+ * @param[in] lng2E6 longitude of the second point in microdegree.
+ *
+ * @return distance in millimetre, at most UINT32_MAX.
+ */
+uint32_t GPSGeo_DistanceMm( int32_t lat1E6,
+                            int32_t lng1E6,
+                            int32_t lat2E6,
+                            int32_t lng2E6 );
+
+/**
+ * @brief Initial bearing from the first coordinate to the second.
+ *
+ * @param[in] lat1E6 latitude of the first point in microdegree.
+ * @param[in] lng1E6 longitude of the first point in microdegree.
+ * @param[in] lat2E6 latitude of the second point in microdegree.
+ * @param[in] lng2E6 longitude of the second point in microdegree.
+ *
+ * @return bearing in 0.01 degree, 0 is north, 0 to 35999.
+ */
+uint16_t GPSGeo_BearingCentiDegrees( int32_t lat1E6,
+                                     int32_t lng1E6,
+                                     int32_t lat2E6,
+                                     int32_t lng2E6 );
+
+/**
+ * @brief Format a microdegree value as a decimal degree string.
+ *
+ * @param[in] pBuffer buffer to receive the string.
+ * @param[in] bufferSize size of the buffer, GPS_GEO_STRING_MAX is enough.
+ * @param[in] valueE6 value in microdegree.
+ *
+ * @return the length of the string as snprintf.
+ */
+int GPSGeo_FormatMicrodegrees( char * pBuffer,
+                               size_t bufferSize,
+                               int32_t valueE6 );
+
+#endif /* GPS_GEO_H */
@@ -30,17 +30,21 @@ typedef struct ObdGpsData
     uint32_t ts;
     uint32_t date;
     uint32_t time;
-    double lat;
-    double lng;
+    int32_t lat;       /* microdegree */
+    int32_t lng;       /* microdegree */
     double alt;        /* meter */
     double speed;      /* knot */
     uint16_t heading; /* degree */
-    uint8_t hdop;
+    uint8_t hdop;      /* 0.1 unit for NMEA data. */
     uint8_t sat;
+    uint8_t fixQuality; /* GGA fix quality, 0 is no fix. */
+    uint8_t fixMode;    /* GSA fix mode, 1 no fix, 2 2D, 3 3D. */
     uint16_t sentences;
     uint16_t errors;
 } ObdGpsData_t;
 
+struct GpsNmeaParser;
+
 /**
  * @brief Get GPS NMEA data.
  *
@@ -74,6 +78,22 @@ bool GPSLib_Begin( Peripheral_Descriptor_t obdDevice );
 bool GPSLib_GetData( Peripheral_Descriptor_t obdDevice,
                      ObdGpsData_t * gpsData );
 
+/**
+ * @brief Get GPS data by parsing the raw NMEA stream of the obd device.
+ *
+ * The parser keeps sentences that span two reads, so the same parser must be
+ * passed on every call.
+ *
+ * @param[in] obdDevice obd device descriptor.
+ * @param[in] pParser pointer to NMEA parser state.
+ * @param[in] gpsData pointer to read back gps data.
+ *
+ * @return true if a valid position is decoded from this read or false.
+ */
+bool GPSLib_GetDataNMEA( Peripheral_Descriptor_t obdDevice,
+                         struct GpsNmeaParser * pParser,
+                         ObdGpsData_t * gpsData );
+
 /**
  * @brief Stop obd device GPS.
  *
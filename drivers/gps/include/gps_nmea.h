@@ -0,0 +1,91 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file gps_nmea.h
+ * @brief Incremental NMEA 0183 sentence parser.
+ */
+
+#ifndef GPS_NMEA_H
+#define GPS_NMEA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS_IO.h"
+#include "gps_library.h"
+
+/* NMEA limits a sentence to 82 characters including "$" and "\r\n". */
+#define GPS_NMEA_SENTENCE_MAX       ( 84 )
+#define GPS_NMEA_FIELD_MAX          ( 20 )
+
+typedef enum GpsNmeaSentence
+{
+    GPS_NMEA_SENTENCE_NONE = 0,     /* Sentence not complete yet. */
+    GPS_NMEA_SENTENCE_RMC,
+    GPS_NMEA_SENTENCE_GGA,
+    GPS_NMEA_SENTENCE_GSA,
+    GPS_NMEA_SENTENCE_VTG,
+    GPS_NMEA_SENTENCE_OTHER,        /* Valid sentence that is not decoded. */
+    GPS_NMEA_SENTENCE_INVALID       /* Checksum error or malformed sentence. */
+} GpsNmeaSentence_t;
+
+/**
+ * @brief Parser state. No heap is used, one instance per byte stream.
+ */
+typedef struct GpsNmeaParser
+{
+    char sentence[ GPS_NMEA_SENTENCE_MAX ];
+    uint8_t length;
+    uint8_t state;
+    uint8_t checksum;
+    uint8_t receivedChecksum;
+    bool positionValid;
+    ObdGpsData_t fix;
+} GpsNmeaParser_t;
+
+/**
+ * @brief Reset the parser.
+ *
+ * @param[in] pParser pointer to parser state.
+ */
+void GPSNmea_Init( GpsNmeaParser_t * pParser );
+
+/**
+ * @brief Feed one byte of a NMEA stream.
+ *
+ * @param[in] pParser pointer to parser state.
+ * @param[in] c the received byte.
+ *
+ * @return the sentence type when a sentence is complete, otherwise GPS_NMEA_SENTENCE_NONE.
+ */
+GpsNmeaSentence_t GPSNmea_ParseByte( GpsNmeaParser_t * pParser,
+                                     char c );
+
+/**
+ * @brief Get the fix accumulated from RMC, GGA, GSA and VTG sentences.
+ *
+ * @param[in] pParser pointer to parser state.
+ * @param[out] pGpsData pointer to receive the fix.
+ *
+ * @return true if the last position report was valid or false.
+ */
+bool GPSNmea_GetFix( const GpsNmeaParser_t * pParser,
+                     ObdGpsData_t * pGpsData );
+
+#endif /* GPS_NMEA_H */
@@ -0,0 +1,256 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file gps_geo.c
+ * @brief Implementation of fixed-point geodetic helpers.
+ *
+ * Everything is integer arithmetic, the ESP32 has no double precision FPU.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "gps_geo.h"
+
+/*-----------------------------------------------------------*/
+
+/* Largest offset that is squared, the sum of two squares stays below 2^63. */
+#define GEO_MAX_SQUARED_MM          ( ( int64_t ) 1 << 31 )
+
+/* 111319.49 metre per degree on the WGS84 equator, in 1e-5 millimetre per microdegree. */
+#define GEO_MM_PER_MICRODEGREE_E5   ( 11131949LL )
+
+#define GEO_Q15_ONE                 ( 32768L )
+
+/* atan(x) ~= 45x + x(1 - x)(14.02 + 3.80x) degree on 0 <= x <= 1, in 0.01 degree. */
+#define GEO_ATAN_C1                 ( 4500L )
+#define GEO_ATAN_C2                 ( 1402L )
+#define GEO_ATAN_C3                 ( 380L )
+
+/*-----------------------------------------------------------*/
+
+/* cos( n degree ) in Q15, n = 0 to 90. */
+static const uint16_t cosTableQ15[ 91 ] =
+{
+    32768, 32763, 32748, 32723, 32688, 32643, 32588, 32524, 32449, 32365,
+    32270, 32166, 32052, 31928, 31795, 31651, 31499, 31336, 31164, 30983,
+    30792, 30592, 30382, 30163, 29935, 29698, 29452, 29197, 28932, 28660,
+    28378, 28088, 27789, 27482, 27166, 26842, 26510, 26170, 25822, 25466,
+    25102, 24730, 24351, 23965, 23571, 23170, 22763, 22348, 21926, 21498,
+    21063, 20622, 20174, 19720, 19261, 18795, 18324, 17847, 17364, 16877,
+    16384, 15886, 15384, 14876, 14365, 13848, 13328, 12803, 12275, 11743,
+    11207, 10668, 10126,  9580,  9032,  8481,  7927,  7371,  6813,  6252,
+     5690,  5126,  4560,  3993,  3425,  2856,  2286,  1715,  1144,   572,
+        0
+};
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvSqrt64( uint64_t value )
+{
+    uint64_t result = 0;
+    uint64_t bit = ( uint64_t ) 1 << 62;
+
+    while( bit > value )
+    {
+        bit >>= 2;
+    }
+
+    while( bit != 0 )
+    {
+        if( value >= ( result + bit ) )
+        {
+            value -= result + bit;
+            result = ( result >> 1 ) + bit;
+        }
+        else
+        {
+            result >>= 1;
+        }
+
+        bit >>= 2;
+    }
+
+    return ( uint32_t ) result;
+}
+
+/*-----------------------------------------------------------*/
+
+static int32_t prvLongitudeDelta( int32_t lng1E6,
+                                  int32_t lng2E6 )
+{
+    int64_t delta = ( int64_t ) lng2E6 - lng1E6;
+
+    /* Take the short way across the antimeridian. */
+    if( delta > ( 180 * GPS_GEO_MICRODEGREE ) )
+    {
+        delta -= 360 * GPS_GEO_MICRODEGREE;
+    }
+    else if( delta < ( -180 * GPS_GEO_MICRODEGREE ) )
+    {
+        delta += 360 * GPS_GEO_MICRODEGREE;
+    }
+    else
+    {
+        /* Empty Else MISRA 15.7 */
+    }
+
+    return ( int32_t ) delta;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvLocalOffsetMm( int32_t lat1E6,
+                              int32_t lng1E6,
+                              int32_t lat2E6,
+                              int32_t lng2E6,
+                              int64_t * pEastMm,
+                              int64_t * pNorthMm )
+{
+    int32_t meanLatE6 = ( int32_t ) ( ( ( int64_t ) lat1E6 + lat2E6 ) / 2 );
+    int64_t eastE5 = ( int64_t ) prvLongitudeDelta( lng1E6, lng2E6 ) * GEO_MM_PER_MICRODEGREE_E5;
+
+    *pNorthMm = ( ( int64_t ) lat2E6 - lat1E6 ) * GEO_MM_PER_MICRODEGREE_E5 / 100000;
+    *pEastMm = ( eastE5 / 100000 ) * ( int64_t ) GPSGeo_CosQ15( meanLatE6 ) / GEO_Q15_ONE;
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t GPSGeo_CosQ15( int32_t angleE6 )
+{
+    uint32_t angle = ( angleE6 < 0 ) ? ( uint32_t ) ( -( int64_t ) angleE6 ) : ( uint32_t ) angleE6;
+    uint32_t index = 0;
+    int32_t fraction = 0;
+    int32_t step = 0;
+
+    if( angle >= ( 90U * GPS_GEO_MICRODEGREE ) )
+    {
+        return 0;
+    }
+
+    index = angle / GPS_GEO_MICRODEGREE;
+    fraction = ( int32_t ) ( angle % GPS_GEO_MICRODEGREE );
+    step = ( int32_t ) cosTableQ15[ index + 1 ] - ( int32_t ) cosTableQ15[ index ];
+
+    return ( uint32_t ) ( ( int32_t ) cosTableQ15[ index ] +
+                          ( int32_t ) ( ( ( int64_t ) step * fraction ) / GPS_GEO_MICRODEGREE ) );
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t GPSGeo_DistanceMm( int32_t lat1E6,
+                            int32_t lng1E6,
+                            int32_t lat2E6,
+                            int32_t lng2E6 )
+{
+    int64_t eastMm = 0;
+    int64_t northMm = 0;
+    uint32_t shift = 0;
+    uint64_t distanceMm = 0;
+
+    prvLocalOffsetMm( lat1E6, lng1E6, lat2E6, lng2E6, &eastMm, &northMm );
+    eastMm = ( eastMm < 0 ) ? -eastMm : eastMm;
+    northMm = ( northMm < 0 ) ? -northMm : northMm;
+
+    /* The offsets reach 2^35 mm, whose squares do not fit in 64 bits. Past
+     * about 2147 km they are scaled down, which costs less than 1 mm in 2^31. */
+    while( ( eastMm >= GEO_MAX_SQUARED_MM ) || ( northMm >= GEO_MAX_SQUARED_MM ) )
+    {
+        eastMm >>= 1;
+        northMm >>= 1;
+        shift++;
+    }
+
+    distanceMm = ( uint64_t ) prvSqrt64( ( uint64_t ) ( eastMm * eastMm ) + ( uint64_t ) ( northMm * northMm ) ) << shift;
+
+    return ( distanceMm > UINT32_MAX ) ? UINT32_MAX : ( uint32_t ) distanceMm;
+}
+
+/*-----------------------------------------------------------*/
+
+uint16_t GPSGeo_BearingCentiDegrees( int32_t lat1E6,
+                                     int32_t lng1E6,
+                                     int32_t lat2E6,
+                                     int32_t lng2E6 )
+{
+    int64_t eastMm = 0;
+    int64_t northMm = 0;
+    uint64_t absEast = 0;
+    uint64_t absNorth = 0;
+    uint64_t ratioQ15 = 0;
+    int32_t angle = 0;
+
+    prvLocalOffsetMm( lat1E6, lng1E6, lat2E6, lng2E6, &eastMm, &northMm );
+    absEast = ( uint64_t ) ( ( eastMm < 0 ) ? -eastMm : eastMm );
+    absNorth = ( uint64_t ) ( ( northMm < 0 ) ? -northMm : northMm );
+
+    if( ( absEast == 0 ) && ( absNorth == 0 ) )
+    {
+        return 0;
+    }
+
+    /* Angle from the major axis, 0 to 45 degree. */
+    if( absEast <= absNorth )
+    {
+        ratioQ15 = ( absEast << 15 ) / absNorth;
+    }
+    else
+    {
+        ratioQ15 = ( absNorth << 15 ) / absEast;
+    }
+
+    angle = ( int32_t ) ( ( GEO_ATAN_C1 * ( int64_t ) ratioQ15 ) / GEO_Q15_ONE );
+    angle += ( int32_t ) ( ( ( ( ( int64_t ) ratioQ15 * ( int64_t ) ( GEO_Q15_ONE - ( int64_t ) ratioQ15 ) ) / GEO_Q15_ONE ) *
+                             ( GEO_ATAN_C2 + ( ( GEO_ATAN_C3 * ( int64_t ) ratioQ15 ) / GEO_Q15_ONE ) ) ) / GEO_Q15_ONE );
+
+    /* Unfold to the bearing octant, measured clockwise from north. */
+    if( absEast > absNorth )
+    {
+        angle = 9000 - angle;
+    }
+
+    if( northMm < 0 )
+    {
+        angle = 18000 - angle;
+    }
+
+    if( eastMm < 0 )
+    {
+        angle = 36000 - angle;
+    }
+
+    return ( uint16_t ) ( angle % 36000 );
+}
+
+/*-----------------------------------------------------------*/
+
+int GPSGeo_FormatMicrodegrees( char * pBuffer,
+                               size_t bufferSize,
+                               int32_t valueE6 )
+{
+    uint32_t absValue = ( valueE6 < 0 ) ? ( uint32_t ) ( -( int64_t ) valueE6 ) : ( uint32_t ) valueE6;
+
+    return snprintf( pBuffer, bufferSize, "%s%u.%06u",
+                     ( valueE6 < 0 ) ? "-" : "",
+                     ( unsigned int ) ( absValue / GPS_GEO_MICRODEGREE ),
+                     ( unsigned int ) ( absValue % GPS_GEO_MICRODEGREE ) );
+}
+
+/*-----------------------------------------------------------*/
@@ -32,6 +32,7 @@
 
 #include "obd_library.h"
 #include "gps_library.h"
+#include "gps_nmea.h"
 
 /*-----------------------------------------------------------*/
 
@@ -40,6 +41,7 @@
 #define GPS_DEVICE_READY_TIME_MS       ( 1000 )
 #define GPS_COMMAND_TIMEOUT_MS         ( 100 )
 #define GPS_NMEA_COMMAND_TIMEOUT_MS    ( 200 )
+#define GPS_NMEA_BUFFER_SIZE           ( 512 )
 
 #define abs( x )    ( x > 0.0 ? ( x ) : ( x * -1.0 ) )
 
@@ -188,8 +190,8 @@ bool GPSLib_GetData( Peripheral_Descriptor_t obdDevice,
     }
 
     s += 7;
-    double lat = 0;
-    double lng = 0;
+    int32_t lat = 0;
+    int32_t lng = 0;
     double alt = 0;
     bool good = false;
 
@@ -216,14 +218,14 @@ bool GPSLib_GetData( Peripheral_Descriptor_t obdDevice,
 
         gpsData->date = date;
         gpsData->time = time;
-        lat = ( double ) prvGpsAtoi( ++s ) / 1000000;
+        lat = prvGpsAtoi( ++s );
 
         if( !( s = strchr( s, ',' ) ) )
         {
             break;
         }
 
-        lng = ( double ) prvGpsAtoi( ++s ) / 1000000;
+        lng = prvGpsAtoi( ++s );
 
         if( !( s = strchr( s, ',' ) ) )
         {
@@ -265,7 +267,7 @@ bool GPSLib_GetData( Peripheral_Descriptor_t obdDevice,
     if( good && ( gpsData->lat || gpsData->lng || gpsData->alt ) )
     {
         /* filter out invalid coordinates */
-        good = ( abs( lat * 1000000 - gpsData->lat * 1000000 ) < 100000 && abs( lng * 1000000 - gpsData->lng * 1000000 ) < 100000 );
+        good = ( abs( lat - gpsData->lat ) < 100000 && abs( lng - gpsData->lng ) < 100000 );
     }
 
     if( !good )
@@ -276,13 +278,55 @@ bool GPSLib_GetData( Peripheral_Descriptor_t obdDevice,
     gpsData->lat = lat;
     gpsData->lng = lng;
     gpsData->alt = alt;
-    printf( "[GPSLib] %lf %lf SATS %d Course: %d\r\n",
-                gpsData->lat, gpsData->lng, gpsData->sat, gpsData->heading );
+    /* $GNIFO is only reported with a fix. */
+    gpsData->fixQuality = 1;
+    printf( "[GPSLib] %d %d SATS %d Course: %d\r\n",
+                ( int ) gpsData->lat, ( int ) gpsData->lng, gpsData->sat, gpsData->heading );
     return true;
 }
 
 /*-----------------------------------------------------------*/
 
+bool GPSLib_GetDataNMEA( Peripheral_Descriptor_t obdDevice,
+                         struct GpsNmeaParser * pParser,
+                         ObdGpsData_t * gpsData )
+{
+    char buf[ GPS_NMEA_BUFFER_SIZE ];
+    int length = 0;
+    int i = 0;
+    bool good = false;
+    GpsNmeaSentence_t sentence = GPS_NMEA_SENTENCE_NONE;
+
+    if( ( pParser == NULL ) || ( gpsData == NULL ) )
+    {
+        return false;
+    }
+
+    length = GPSLib_GetNMEA( obdDevice, buf, sizeof( buf ) );
+
+    for( i = 0; i < length; i++ )
+    {
+        sentence = GPSNmea_ParseByte( pParser, buf[ i ] );
+
+        /* Keep the last valid position of this read. */
+        if( ( ( sentence == GPS_NMEA_SENTENCE_RMC ) || ( sentence == GPS_NMEA_SENTENCE_GGA ) ) &&
+            ( GPSNmea_GetFix( pParser, gpsData ) == true ) )
+        {
+            good = true;
+        }
+    }
+
+    if( good == true )
+    {
+        /* Fix quality, mode and hdop may come after the position sentence. */
+        GPSNmea_GetFix( pParser, gpsData );
+    }
+
+    return good;
+}
+
+/*-----------------------------------------------------------*/
+
 bool GPSLib_End( Peripheral_Descriptor_t obdDevice )
 {
     char buf[ 16 ] = { 0 };
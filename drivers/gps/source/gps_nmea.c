@@ -0,0 +1,541 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file gps_nmea.c
+ * @brief Implementation of incremental NMEA 0183 sentence parser.
+ *
+ * Bytes are fed one at a time. A sentence is buffered until its checksum is
+ * received, then split in place and decoded with integer arithmetic.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS_IO.h"
+#include "gps_library.h"
+#include "gps_nmea.h"
+
+/*-----------------------------------------------------------*/
+
+#define NMEA_STATE_IDLE             ( 0U )
+#define NMEA_STATE_BODY             ( 1U )
+#define NMEA_STATE_CHECKSUM_HIGH    ( 2U )
+#define NMEA_STATE_CHECKSUM_LOW     ( 3U )
+
+/* "GPRMC" talker and sentence id. */
+#define NMEA_ADDRESS_LENGTH         ( 5U )
+
+/*-----------------------------------------------------------*/
+
+static int8_t prvHexValue( char c )
+{
+    int8_t retValue = -1;
+
+    if( ( c >= '0' ) && ( c <= '9' ) )
+    {
+        retValue = ( int8_t ) ( c - '0' );
+    }
+    else if( ( c >= 'A' ) && ( c <= 'F' ) )
+    {
+        retValue = ( int8_t ) ( c - 'A' + 10 );
+    }
+    else if( ( c >= 'a' ) && ( c <= 'f' ) )
+    {
+        retValue = ( int8_t ) ( c - 'a' + 10 );
+    }
+    else
+    {
+        /* Empty Else MISRA 15.7 */
+    }
+
+    return retValue;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Parse a decimal field into an integer scaled by 10^decimals. Extra digits are truncated. */
+static bool prvParseFixed( const char * pField,
+                           uint8_t decimals,
+                           int32_t * pResult )
+{
+    int32_t result = 0;
+    int32_t sign = 1;
+    uint8_t fraction = 0;
+    bool inFraction = false;
+    bool hasDigit = false;
+
+    if( *pField == '-' )
+    {
+        sign = -1;
+        pField++;
+    }
+
+    for( ; *pField != '\0'; pField++ )
+    {
+        if( ( *pField >= '0' ) && ( *pField <= '9' ) )
+        {
+            if( ( inFraction == false ) || ( fraction < decimals ) )
+            {
+                if( result > ( ( INT32_MAX - 9 ) / 10 ) )
+                {
+                    return false;
+                }
+
+                result = ( result * 10 ) + ( *pField - '0' );
+                fraction = ( inFraction == true ) ? ( fraction + 1U ) : 0U;
+            }
+            else
+            {
+                /* Truncate extra fraction digits. */
+            }
+
+            hasDigit = true;
+        }
+        else if( ( *pField == '.' ) && ( inFraction == false ) )
+        {
+            inFraction = true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    for( ; fraction < decimals; fraction++ )
+    {
+        if( result > ( INT32_MAX / 10 ) )
+        {
+            return false;
+        }
+
+        result = result * 10;
+    }
+
+    if( hasDigit == true )
+    {
+        *pResult = result * sign;
+    }
+
+    return hasDigit;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Convert "ddmm.mmmmm" or "dddmm.mmmmm" with its hemisphere into microdegrees. */
+static bool prvParseCoordinate( const char * pField,
+                                const char * pHemisphere,
+                                int32_t * pMicroDegrees )
+{
+    int32_t value = 0;
+    int32_t degrees = 0;
+    int32_t minutesE5 = 0;
+    bool retParse = false;
+
+    if( prvParseFixed( pField, 5, &value ) == true )
+    {
+        degrees = value / 10000000;
+        minutesE5 = value % 10000000;
+
+        /* minutes / 60 * 10^6 == minutesE5 / 6. */
+        value = ( degrees * 1000000 ) + ( ( minutesE5 + 3 ) / 6 );
+
+        if( ( *pHemisphere == 'S' ) || ( *pHemisphere == 'W' ) )
+        {
+            value = -value;
+        }
+
+        *pMicroDegrees = value;
+        retParse = true;
+    }
+
+    return retParse;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint8_t prvClampUint8( int32_t value )
+{
+    uint8_t retValue = 0;
+
+    if( value > UINT8_MAX )
+    {
+        retValue = UINT8_MAX;
+    }
+    else if( value > 0 )
+    {
+        retValue = ( uint8_t ) value;
+    }
+    else
+    {
+        /* Empty Else MISRA 15.7 */
+    }
+
+    return retValue;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvDecodeRMC( GpsNmeaParser_t * pParser,
+                          char * pFields[],
+                          uint8_t fieldCount )
+{
+    int32_t value = 0;
+    int32_t latitude = 0;
+    int32_t longitude = 0;
+
+    /* $xxRMC,time,status,lat,N/S,lon,E/W,speed knots,course,date,... */
+    if( fieldCount < 10 )
+    {
+        return;
+    }
+
+    if( prvParseFixed( pFields[ 1 ], 2, &value ) == true )
+    {
+        pParser->fix.time = ( uint32_t ) value;
+    }
+
+    if( prvParseFixed( pFields[ 9 ], 0, &value ) == true )
+    {
+        pParser->fix.date = ( uint32_t ) value;
+    }
+
+    if( pFields[ 2 ][ 0 ] != 'A' )
+    {
+        pParser->positionValid = false;
+        return;
+    }
+
+    if( ( prvParseCoordinate( pFields[ 3 ], pFields[ 4 ], &latitude ) == true ) &&
+        ( prvParseCoordinate( pFields[ 5 ], pFields[ 6 ], &longitude ) == true ) )
+    {
+        pParser->fix.lat = latitude;
+        pParser->fix.lng = longitude;
+        pParser->positionValid = true;
+    }
+
+    if( prvParseFixed( pFields[ 7 ], 2, &value ) == true )
+    {
+        pParser->fix.speed = ( double ) value / 100;
+    }
+
+    if( prvParseFixed( pFields[ 8 ], 0, &value ) == true )
+    {
+        pParser->fix.heading = ( uint16_t ) value;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvDecodeGGA( GpsNmeaParser_t * pParser,
+                          char * pFields[],
+                          uint8_t fieldCount )
+{
+    int32_t value = 0;
+    int32_t latitude = 0;
+    int32_t longitude = 0;
+
+    /* $xxGGA,time,lat,N/S,lon,E/W,quality,satellites,hdop,altitude,M,... */
+    if( fieldCount < 10 )
+    {
+        return;
+    }
+
+    if( prvParseFixed( pFields[ 6 ], 0, &value ) == true )
+    {
+        pParser->fix.fixQuality = prvClampUint8( value );
+    }
+
+    if( prvParseFixed( pFields[ 7 ], 0, &value ) == true )
+    {
+        pParser->fix.sat = prvClampUint8( value );
+    }
+
+    if( prvParseFixed( pFields[ 8 ], 1, &value ) == true )
+    {
+        pParser->fix.hdop = prvClampUint8( value );
+    }
+
+    if( pParser->fix.fixQuality == 0 )
+    {
+        pParser->positionValid = false;
+        return;
+    }
+
+    if( prvParseFixed( pFields[ 1 ], 2, &value ) == true )
+    {
+        pParser->fix.time = ( uint32_t ) value;
+    }
+
+    if( ( prvParseCoordinate( pFields[ 2 ], pFields[ 3 ], &latitude ) == true ) &&
+        ( prvParseCoordinate( pFields[ 4 ], pFields[ 5 ], &longitude ) == true ) )
+    {
+        pParser->fix.lat = latitude;
+        pParser->fix.lng = longitude;
+        pParser->positionValid = true;
+    }
+
+    if( prvParseFixed( pFields[ 9 ], 2, &value ) == true )
+    {
+        pParser->fix.alt = ( double ) value / 100;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvDecodeGSA( GpsNmeaParser_t * pParser,
+                          char * pFields[],
+                          uint8_t fieldCount )
+{
+    int32_t value = 0;
+
+    /* $xxGSA,mode,fix type,12 x satellite id,pdop,hdop,vdop */
+    if( fieldCount < 3 )
+    {
+        return;
+    }
+
+    if( prvParseFixed( pFields[ 2 ], 0, &value ) == true )
+    {
+        pParser->fix.fixMode = prvClampUint8( value );
+    }
+
+    if( ( fieldCount > 16 ) && ( prvParseFixed( pFields[ 16 ], 1, &value ) == true ) )
+    {
+        pParser->fix.hdop = prvClampUint8( value );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvDecodeVTG( GpsNmeaParser_t * pParser,
+                          char * pFields[],
+                          uint8_t fieldCount )
+{
+    int32_t value = 0;
+
+    /* $xxVTG,course true,T,course magnetic,M,speed knots,N,speed kmh,K,mode */
+    if( fieldCount < 6 )
+    {
+        return;
+    }
+
+    if( prvParseFixed( pFields[ 1 ], 0, &value ) == true )
+    {
+        pParser->fix.heading = ( uint16_t ) value;
+    }
+
+    if( prvParseFixed( pFields[ 5 ], 2, &value ) == true )
+    {
+        pParser->fix.speed = ( double ) value / 100;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static GpsNmeaSentence_t prvDecodeSentence( GpsNmeaParser_t * pParser )
+{
+    char * pFields[ GPS_NMEA_FIELD_MAX ];
+    uint8_t fieldCount = 0;
+    char * p = pParser->sentence;
+    const char * pType = NULL;
+    GpsNmeaSentence_t retSentence = GPS_NMEA_SENTENCE_OTHER;
+
+    /* Split the fields in place. */
+    pFields[ fieldCount++ ] = p;
+
+    for( ; *p != '\0'; p++ )
+    {
+        if( *p == ',' )
+        {
+            *p = '\0';
+
+            if( fieldCount < GPS_NMEA_FIELD_MAX )
+            {
+                pFields[ fieldCount++ ] = p + 1;
+            }
+        }
+    }
+
+    if( strlen( pFields[ 0 ] ) != NMEA_ADDRESS_LENGTH )
+    {
+        return GPS_NMEA_SENTENCE_INVALID;
+    }
+
+    /* Any talker, GP GN GL GA BD. */
+    pType = &pFields[ 0 ][ 2 ];
+
+    if( strcmp( pType, "RMC" ) == 0 )
+    {
+        prvDecodeRMC( pParser, pFields, fieldCount );
+        retSentence = GPS_NMEA_SENTENCE_RMC;
+    }
+    else if( strcmp( pType, "GGA" ) == 0 )
+    {
+        prvDecodeGGA( pParser, pFields, fieldCount );
+        retSentence = GPS_NMEA_SENTENCE_GGA;
+    }
+    else if( strcmp( pType, "GSA" ) == 0 )
+    {
+        prvDecodeGSA( pParser, pFields, fieldCount );
+        retSentence = GPS_NMEA_SENTENCE_GSA;
+    }
+    else if( strcmp( pType, "VTG" ) == 0 )
+    {
+        prvDecodeVTG( pParser, pFields, fieldCount );
+        retSentence = GPS_NMEA_SENTENCE_VTG;
+    }
+    else
+    {
+        /* Empty Else MISRA 15.7 */
+    }
+
+    return retSentence;
+}
+
+/*-----------------------------------------------------------*/
+
+void GPSNmea_Init( GpsNmeaParser_t * pParser )
+{
+    if( pParser != NULL )
+    {
+        memset( pParser, 0, sizeof( GpsNmeaParser_t ) );
+        pParser->state = NMEA_STATE_IDLE;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+GpsNmeaSentence_t GPSNmea_ParseByte( GpsNmeaParser_t * pParser,
+                                     char c )
+{
+    GpsNmeaSentence_t retSentence = GPS_NMEA_SENTENCE_NONE;
+    int8_t hexValue = 0;
+
+    if( pParser == NULL )
+    {
+        return GPS_NMEA_SENTENCE_NONE;
+    }
+
+    /* A start delimiter always restarts the sentence. */
+    if( c == '$' )
+    {
+        if( pParser->state != NMEA_STATE_IDLE )
+        {
+            pParser->fix.errors++;
+        }
+
+        pParser->length = 0;
+        pParser->checksum = 0;
+        pParser->state = NMEA_STATE_BODY;
+        return GPS_NMEA_SENTENCE_NONE;
+    }
+
+    switch( pParser->state )
+    {
+        case NMEA_STATE_BODY:
+
+            if( c == '*' )
+            {
+                pParser->sentence[ pParser->length ] = '\0';
+                pParser->state = NMEA_STATE_CHECKSUM_HIGH;
+            }
+            else if( ( c == '\r' ) || ( c == '\n' ) || ( pParser->length >= ( GPS_NMEA_SENTENCE_MAX - 1 ) ) )
+            {
+                /* No checksum or too long. */
+                retSentence = GPS_NMEA_SENTENCE_INVALID;
+            }
+            else
+            {
+                pParser->sentence[ pParser->length++ ] = c;
+                pParser->checksum ^= ( uint8_t ) c;
+            }
+
+            break;
+
+        case NMEA_STATE_CHECKSUM_HIGH:
+            hexValue = prvHexValue( c );
+
+            if( hexValue < 0 )
+            {
+                retSentence = GPS_NMEA_SENTENCE_INVALID;
+            }
+            else
+            {
+                pParser->receivedChecksum = ( uint8_t ) ( hexValue << 4 );
+                pParser->state = NMEA_STATE_CHECKSUM_LOW;
+            }
+
+            break;
+
+        case NMEA_STATE_CHECKSUM_LOW:
+            hexValue = prvHexValue( c );
+
+            if( ( hexValue < 0 ) ||
+                ( ( pParser->receivedChecksum | ( uint8_t ) hexValue ) != pParser->checksum ) )
+            {
+                retSentence = GPS_NMEA_SENTENCE_INVALID;
+            }
+            else
+            {
+                pParser->state = NMEA_STATE_IDLE;
+                retSentence = prvDecodeSentence( pParser );
+            }
+
+            break;
+
+        default:
+            /* Wait for the start delimiter. */
+            break;
+    }
+
+    if( retSentence == GPS_NMEA_SENTENCE_INVALID )
+    {
+        pParser->state = NMEA_STATE_IDLE;
+        pParser->fix.errors++;
+    }
+    else if( retSentence != GPS_NMEA_SENTENCE_NONE )
+    {
+        pParser->fix.sentences++;
+    }
+    else
+    {
+        /* Empty Else MISRA 15.7 */
+    }
+
+    return retSentence;
+}
+
+/*-----------------------------------------------------------*/
+
+bool GPSNmea_GetFix( const GpsNmeaParser_t * pParser,
+                     ObdGpsData_t * pGpsData )
+{
+    bool retGetFix = false;
+
+    if( ( pParser != NULL ) && ( pGpsData != NULL ) )
+    {
+        memcpy( pGpsData, &pParser->fix, sizeof( ObdGpsData_t ) );
+        retGetFix = pParser->positionValid;
+    }
+
+    return retGetFix;
+}
+
+/*-----------------------------------------------------------*/
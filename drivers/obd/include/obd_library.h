@@ -64,6 +64,21 @@ bool OBDLib_ReadPID( Peripheral_Descriptor_t obdDevice,
                      uint8_t pid,
                      int * pResult );
 
+/**
+ * @brief Read the battery voltage measured by the obd dongle.
+ *
+ * The dongle answers ATRV from its own ADC, the vehicle bus is not used and
+ * it works with the ECU asleep.
+ *
+ * @param[in] obdDevice obd device peripheral descriptor.
+ * @param[in] pVoltage pointer to receive the voltage in volt.
+ *
+ * @return true for successful read.
+ * Otherwise return false.
+ */
+bool OBDLib_ReadBatteryVoltage( Peripheral_Descriptor_t obdDevice,
+                                float * pVoltage );
+
 /**
  * @brief Read DTC(Diagnostic Trouble Code) from obd device.
  *
@@ -23,6 +23,7 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
 
 /* Kernel includes. */
@@ -298,6 +299,7 @@ size_t OBDLib_SendCommand( Peripheral_Descriptor_t obdDevice,
 #ifdef OBD_DEBUG
         printf("OBD send cmd %s\r\n", pCmd );
 #endif
+        FreeRTOS_ioctl( obdDevice, ioctlOBD_LOCK, NULL );
         retSendCommand = FreeRTOS_write( obdDevice, pCmd, strlen( pCmd ) );
 
         /* Set the read timeout. */
@@ -320,6 +322,7 @@ size_t OBDLib_SendCommand( Peripheral_Descriptor_t obdDevice,
             }
 #endif
         }
+        FreeRTOS_ioctl( obdDevice, ioctlOBD_UNLOCK, NULL );
     }
 
     return retSendCommand;
@@ -472,6 +475,7 @@ bool OBDLib_ReadPID( Peripheral_Descriptor_t obdDevice,
     size_t retSendCommand = 0;
 
     sprintf( buffer, "%02X%02X\r", dataMode, pid );
+    FreeRTOS_ioctl( obdDevice, ioctlOBD_LOCK, NULL );
     FreeRTOS_write( obdDevice, buffer, strlen( buffer ) ); /* link->send(buffer); */
 #ifdef OBD_DEBUG
         printf("OBD ReadPID send cmd %s\r\n", buffer );
@@ -481,6 +485,7 @@ bool OBDLib_ReadPID( Peripheral_Descriptor_t obdDevice,
     vTaskDelay( pdMS_TO_TICKS(OBD_READ_PID_DELAY_MS) );                      /* idleTasks(); */
 
     retSendCommand = FreeRTOS_read( obdDevice, buffer, 64 );
+    FreeRTOS_ioctl( obdDevice, ioctlOBD_UNLOCK, NULL );
 #ifdef OBD_DEBUG
     printf("OBD ReadPID result %s\r\n", buffer );
 #endif
@@ -532,6 +537,43 @@ bool OBDLib_ReadPID( Peripheral_Descriptor_t obdDevice,
 
 /*-----------------------------------------------------------*/
 
+bool OBDLib_ReadBatteryVoltage( Peripheral_Descriptor_t obdDevice,
+                                float * pVoltage )
+{
+    /*
+     * Response example:
+     * 12.6V
+     */
+    char buffer[ 32 ] = { 0 };
+    char * p = NULL;
+    char * end = NULL;
+    float voltage = 0.0f;
+
+    if( ( OBDLib_SendCommand( obdDevice, "ATRV\r", buffer, sizeof( buffer ) - 1, OBD_TIMEOUT_SHORT_MS ) == 0 ) ||
+        checkErrorMessage( buffer ) )
+    {
+        return false;
+    }
+
+    for( p = buffer; *p && ( ( *p < '0' ) || ( *p > '9' ) ); p++ )
+    {
+    }
+
+    voltage = strtof( p, &end );
+
+    if( ( end == p ) || ( *end != 'V' ) )
+    {
+        printf("OBD ReadBatteryVoltage result failed %s\r\n", buffer );
+        return false;
+    }
+
+    *pVoltage = voltage;
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
+
 bool OBDLib_ReadUTCTime( Peripheral_Descriptor_t obdDevice,
                         char *pUTCStr, uint32_t bufferSize )
 {
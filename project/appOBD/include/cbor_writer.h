@@ -0,0 +1,179 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file cbor_writer.h
+ * @brief Bounded streaming CBOR (RFC 8949) writer with integer map keys.
+ */
+
+#ifndef CBOR_WRITER_H
+#define CBOR_WRITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define CBOR_WRITER_DEPTH_MAX       ( 8 )
+
+/* Key for the root item and array elements. */
+#define CBOR_WRITER_NO_KEY          ( 0U )
+
+typedef struct CborWriter
+{
+    uint8_t * pBuffer;
+    size_t bufferSize;
+    size_t length;
+    uint8_t depth;
+    bool hasMember[ CBOR_WRITER_DEPTH_MAX ];
+    size_t openLength[ CBOR_WRITER_DEPTH_MAX ];     /* Length before the key that opened the level. */
+    bool openHadMember[ CBOR_WRITER_DEPTH_MAX ];    /* Parent member flag before the level was opened. */
+    size_t stringOpenLength;
+    size_t stringDataLength;
+    bool overflow;
+} CborWriter_t;
+
+/*
+ * Maps and arrays are written with indefinite length. Map members with an
+ * empty string or no value and containers that close empty are left out,
+ * array elements keep their place.
+ */
+
+/**
+ * @brief Start writing a document.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] pBuffer buffer to receive the document.
+ * @param[in] bufferSize size of the buffer.
+ * @param[in] version format version byte written in front of the CBOR item.
+ */
+void CborWriter_Init( CborWriter_t * pWriter,
+                      uint8_t * pBuffer,
+                      size_t bufferSize,
+                      uint8_t version );
+
+void CborWriter_BeginMap( CborWriter_t * pWriter,
+                          uint16_t key );
+
+void CborWriter_EndMap( CborWriter_t * pWriter );
+
+void CborWriter_BeginArray( CborWriter_t * pWriter,
+                            uint16_t key );
+
+void CborWriter_EndArray( CborWriter_t * pWriter );
+
+/**
+ * @brief Add a text string.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] key map key, CBOR_WRITER_NO_KEY in an array.
+ * @param[in] pValue null terminated UTF-8 string.
+ */
+void CborWriter_AddText( CborWriter_t * pWriter,
+                         uint16_t key,
+                         const char * pValue );
+
+/**
+ * @brief Add a byte string.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] key map key, CBOR_WRITER_NO_KEY in an array.
+ * @param[in] pData the data.
+ * @param[in] length length of the data.
+ */
+void CborWriter_AddBytes( CborWriter_t * pWriter,
+                          uint16_t key,
+                          const uint8_t * pData,
+                          size_t length );
+
+/**
+ * @brief Open a text string to be written in place, up to 65535 bytes.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] key map key, CBOR_WRITER_NO_KEY in an array.
+ * @param[out] pAvailable space to write including a null terminator.
+ *
+ * @return the write position or NULL if the buffer is full.
+ */
+char * CborWriter_BeginText( CborWriter_t * pWriter,
+                             uint16_t key,
+                             size_t * pAvailable );
+
+/**
+ * @brief Close a text string opened with CborWriter_BeginText.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] length number of bytes written in place.
+ */
+void CborWriter_EndText( CborWriter_t * pWriter,
+                         size_t length );
+
+void CborWriter_AddInt( CborWriter_t * pWriter,
+                        uint16_t key,
+                        int64_t value );
+
+/**
+ * @brief Add a decimal fraction, value times 10^-decimals (tag 4).
+ *
+ * Written as a plain integer when there is no fraction left.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] key map key, CBOR_WRITER_NO_KEY in an array.
+ * @param[in] value the mantissa.
+ * @param[in] decimals number of fraction digits.
+ */
+void CborWriter_AddDecimal( CborWriter_t * pWriter,
+                            uint16_t key,
+                            int64_t value,
+                            uint8_t decimals );
+
+/**
+ * @brief Add a number in the smallest exact form.
+ *
+ * The value is rounded to the given fraction digits, then written as an
+ * integer, a float16 or a float32 if that keeps it within half of the last
+ * digit, or else as a float64. NaN is added as null.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] key map key, CBOR_WRITER_NO_KEY in an array.
+ * @param[in] value the value.
+ * @param[in] decimals number of fraction digits, up to 9.
+ */
+void CborWriter_AddNumber( CborWriter_t * pWriter,
+                           uint16_t key,
+                           double value,
+                           uint8_t decimals );
+
+/**
+ * @brief Add a null, only written as an array element.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] key map key, CBOR_WRITER_NO_KEY in an array.
+ */
+void CborWriter_AddNull( CborWriter_t * pWriter,
+                         uint16_t key );
+
+/**
+ * @brief Finish the document.
+ *
+ * @param[in] pWriter pointer to writer state.
+ *
+ * @return the length of the document or -1 if it did not fit or is not closed.
+ */
+int32_t CborWriter_Finish( const CborWriter_t * pWriter );
+
+#endif /* CBOR_WRITER_H */
@@ -0,0 +1,116 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file clock_service.h
+ * @brief 64-bit UTC clock in epoch milliseconds disciplined from GPS and NTP.
+ *
+ * The clock runs on the tick count with an offset to UTC. GPS is preferred to
+ * NTP, a source is used until a better one syncs or it was not synced for
+ * CLOCK_SERVICE_SOURCE_HOLD_MS. Small errors are slewed out and large ones step
+ * the clock. Without any source the clock counts from 1970 at boot. A trip
+ * replay runs the clock on the time of the replay, see trip_replay.h.
+ *
+ * The clock is used from the telemetry task only.
+ */
+
+#ifndef CLOCK_SERVICE_H
+#define CLOCK_SERVICE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "FreeRTOS_IO.h"
+#include "gps_library.h"
+
+/* Ordered by preference. */
+typedef enum ClockSource
+{
+    CLOCK_SOURCE_UPTIME = 0,
+    CLOCK_SOURCE_NTP,
+    CLOCK_SOURCE_GPS
+} ClockSource_t;
+
+/* YYYY-MM-DDTHH:MM:SS.ssssZ */
+#define CLOCK_SERVICE_ISO_TIME_LENGTH    ( 25U )
+
+/**
+ * @brief Reset the clock to the uptime.
+ */
+void ClockService_Init( void );
+
+/**
+ * @brief Sync the clock to the time of a GPS fix.
+ *
+ * @param[in] pGpsData the fix, date and time in NMEA format.
+ * @param[in] fixAgeMs age of the fix in milisecond.
+ *
+ * @return true if the fix time was used.
+ */
+bool ClockService_SyncGps( const ObdGpsData_t * pGpsData,
+                           uint32_t fixAgeMs );
+
+/**
+ * @brief Sync the clock to the system time kept by SNTP.
+ *
+ * @return true if the system time is set and was used.
+ */
+bool ClockService_SyncNtp( void );
+
+/**
+ * @brief Get the current time.
+ *
+ * @return milliseconds since 1970-01-01 UTC.
+ */
+uint64_t ClockService_NowMs( void );
+
+/**
+ * @brief Convert a tick count time taken in the last 49 days.
+ *
+ * @param[in] ticksMs tick count in milliseconds, the time of the replay
+ * with TRIP_REPLAY_ENABLE.
+ *
+ * @return milliseconds since 1970-01-01 UTC.
+ */
+uint64_t ClockService_TicksToEpochMs( uint32_t ticksMs );
+
+/**
+ * @brief Get the source of the last sync.
+ *
+ * @return the clock source.
+ */
+ClockSource_t ClockService_GetSource( void );
+
+/**
+ * @brief Format a time as ISO 8601 UTC.
+ *
+ * The date and hour are cached, times in the same hour as the previous call
+ * only format the minutes and seconds.
+ *
+ * @param[in] epochMs milliseconds since 1970-01-01 UTC.
+ * @param[out] pBuffer buffer to receive the string.
+ * @param[in] bufferLength at least CLOCK_SERVICE_ISO_TIME_LENGTH + 1.
+ *
+ * @return the string length or 0 if the buffer is too small.
+ */
+size_t ClockService_Format( uint64_t epochMs,
+                            char * pBuffer,
+                            size_t bufferLength );
+
+#endif /* CLOCK_SERVICE_H */
@@ -0,0 +1,127 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file event_engine.h
+ * @brief Table driven detection of driving events on the signal values.
+ *
+ * A rule raises its event when a signal stays beyond a threshold for a
+ * minimum duration. It is armed again once the signal comes back past the
+ * threshold by the hysteresis, so a value hovering at the threshold raises
+ * one event only. Each value costs one pass over the rule table.
+ */
+
+#ifndef EVENT_ENGINE_H
+#define EVENT_ENGINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define EVENT_ENGINE_MAX_RULES      ( 8U )
+
+typedef enum EventRuleCompare
+{
+    EVENT_RULE_ABOVE = 0,
+    EVENT_RULE_BELOW
+} EventRuleCompare_t;
+
+typedef struct EventRule
+{
+    const char * pName;             /* Event type in the message. */
+    uint32_t signal;                /* Signal index the rule watches. */
+    EventRuleCompare_t compare;
+    double threshold;
+    double hysteresis;              /* Distance back past the threshold to arm again. */
+    uint32_t minDurationMs;         /* Time beyond the threshold to raise the event. */
+} EventRule_t;
+
+typedef struct EventRuleState
+{
+    uint64_t startMs;               /* First value beyond the threshold. */
+    double peak;                    /* Furthest value beyond the threshold. */
+    bool beyond;
+    bool raised;
+} EventRuleState_t;
+
+typedef struct EventEngine
+{
+    const EventRule_t * pRules;
+    uint32_t ruleCount;
+    EventRuleState_t states[ EVENT_ENGINE_MAX_RULES ];
+} EventEngine_t;
+
+typedef struct Event
+{
+    uint32_t rule;                  /* Index in the rule table. */
+    uint64_t startMs;               /* Uptime. */
+    uint32_t durationMs;            /* Time beyond the threshold so far. */
+    double peak;
+} Event_t;
+
+/**
+ * @brief Start the engine with a rule table.
+ *
+ * @param[in] pEngine pointer to engine state.
+ * @param[in] pRules the rules, kept by pointer.
+ * @param[in] ruleCount number of rules, up to EVENT_ENGINE_MAX_RULES.
+ */
+void EventEngine_Init( EventEngine_t * pEngine,
+                       const EventRule_t * pRules,
+                       uint32_t ruleCount );
+
+/**
+ * @brief Clear the state of all rules, the table is kept.
+ *
+ * @param[in] pEngine pointer to engine state.
+ */
+void EventEngine_Reset( EventEngine_t * pEngine );
+
+/**
+ * @brief Check the rules of a signal against a new value.
+ *
+ * @param[in] pEngine pointer to engine state.
+ * @param[in] signal signal index.
+ * @param[in] value the value.
+ * @param[in] timeMs uptime of the value in milliseconds.
+ * @param[out] pEvents buffer to receive the raised events, may be NULL when
+ * maxEvents is 0.
+ * @param[in] maxEvents size of the event buffer. A rule due with no room
+ * left raises its event on a later value beyond the threshold.
+ *
+ * @return the number of events raised by this value.
+ */
+uint32_t EventEngine_Update( EventEngine_t * pEngine,
+                             uint32_t signal,
+                             double value,
+                             uint64_t timeMs,
+                             Event_t * pEvents,
+                             uint32_t maxEvents );
+
+/**
+ * @brief Get the rules with a signal beyond their threshold.
+ *
+ * A rule is active from its first value beyond the threshold, before its
+ * event is raised, until the signal comes back past the hysteresis.
+ *
+ * @param[in] pEngine pointer to engine state.
+ *
+ * @return bit i set when rule i is active.
+ */
+uint32_t EventEngine_GetActive( const EventEngine_t * pEngine );
+
+#endif /* EVENT_ENGINE_H */
@@ -0,0 +1,125 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file gorilla_codec.h
+ * @brief Time series compression of timestamps and float values.
+ *
+ * Encoding of the Gorilla paper (Pelkonen et al., VLDB 2015) with 32 bit
+ * millisecond timestamps and float values, and delta of delta ranges that
+ * fit two's complement. The stream starts with the
+ * sample count in 16 bits, the first timestamp and value in 32 bits each.
+ * Then per sample, MSB first:
+ *
+ * Timestamp, delta of delta D:
+ *   '0' D is 0, '10' + 7 bits, '110' + 9 bits, '1110' + 12 bits,
+ *   '1111' + 32 bits, two's complement.
+ *
+ * Value, XOR X with the previous value:
+ *   '0' X is 0,
+ *   '10' the meaningful bits of X fit in the previous leading and trailing
+ *        zeros, followed by those bits,
+ *   '11' + 5 bits leading zeros + 5 bits length minus 1 + the bits.
+ */
+
+#ifndef GORILLA_CODEC_H
+#define GORILLA_CODEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Buffer size that holds any stream of n samples. */
+#define GORILLA_MAX_BYTES( n )    ( 10U + ( ( size_t ) ( n ) * 10U ) )
+
+typedef struct GorillaState
+{
+    uint8_t * pBuffer;
+    size_t bufferSize;
+    size_t bitPosition;
+    uint16_t count;
+    uint32_t timestampMs;
+    int32_t delta;
+    uint32_t valueBits;
+    uint8_t leading;
+    uint8_t trailing;
+} GorillaState_t;
+
+typedef GorillaState_t GorillaEncoder_t;
+typedef GorillaState_t GorillaDecoder_t;
+
+/**
+ * @brief Start an encoded stream.
+ *
+ * @param[in] pEncoder pointer to encoder state.
+ * @param[in] pBuffer buffer to receive the stream.
+ * @param[in] bufferSize size of the buffer, GORILLA_MAX_BYTES() never fills up.
+ */
+void GorillaEncoder_Init( GorillaEncoder_t * pEncoder,
+                          uint8_t * pBuffer,
+                          size_t bufferSize );
+
+/**
+ * @brief Append a sample.
+ *
+ * @param[in] pEncoder pointer to encoder state.
+ * @param[in] timestampMs sample time, wraps around modulo 2^32.
+ * @param[in] value the value.
+ *
+ * @return false if the buffer is full, the stream is left as it was.
+ */
+bool GorillaEncoder_Append( GorillaEncoder_t * pEncoder,
+                            uint32_t timestampMs,
+                            float value );
+
+/**
+ * @brief Finish the stream.
+ *
+ * @param[in] pEncoder pointer to encoder state.
+ *
+ * @return the length of the stream in bytes, 0 if the buffer cannot hold the header.
+ */
+size_t GorillaEncoder_Finish( GorillaEncoder_t * pEncoder );
+
+/**
+ * @brief Start to decode a stream.
+ *
+ * @param[in] pDecoder pointer to decoder state.
+ * @param[in] pBuffer the stream.
+ * @param[in] length length of the stream.
+ *
+ * @return the number of samples in the stream.
+ */
+uint16_t GorillaDecoder_Init( GorillaDecoder_t * pDecoder,
+                              const uint8_t * pBuffer,
+                              size_t length );
+
+/**
+ * @brief Decode the next sample.
+ *
+ * @param[in] pDecoder pointer to decoder state.
+ * @param[out] pTimestampMs sample time.
+ * @param[out] pValue the value.
+ *
+ * @return false at the end of the stream or if it is truncated or malformed.
+ */
+bool GorillaDecoder_Next( GorillaDecoder_t * pDecoder,
+                          uint32_t * pTimestampMs,
+                          float * pValue );
+
+#endif /* GORILLA_CODEC_H */
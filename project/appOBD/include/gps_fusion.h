@@ -0,0 +1,134 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file gps_fusion.h
+ * @brief GPS and OBD speed fusion with dead reckoning.
+ */
+
+#ifndef GPS_FUSION_H
+#define GPS_FUSION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief One axis of the constant-velocity Kalman filter.
+ *
+ * Position in metres from the local origin, velocity in m/s and the
+ * symmetric 2x2 covariance.
+ */
+typedef struct GpsFusionAxis
+{
+    float position;
+    float velocity;
+    float p00;
+    float p01;
+    float p11;
+} GpsFusionAxis_t;
+
+typedef struct GpsFusion
+{
+    int32_t originLatitude;     /* Microdegree. */
+    int32_t originLongitude;    /* Microdegree. */
+    float metresPerMicrodegreeLongitude;
+    GpsFusionAxis_t east;
+    GpsFusionAxis_t north;
+    float heading;              /* Degree, 0 is north. */
+    bool headingValid;          /* False until the vehicle first moved. */
+    uint32_t lastPredictMs;
+    uint32_t lastFixMs;
+    bool initialized;
+} GpsFusion_t;
+
+/**
+ * @brief Reset the filter. Position is unknown until the first fix.
+ *
+ * @param[in] pFusion pointer to filter state.
+ */
+void GPSFusion_Init( GpsFusion_t * pFusion );
+
+/**
+ * @brief Propagate the state to the given time.
+ *
+ * @param[in] pFusion pointer to filter state.
+ * @param[in] nowMs current uptime in milisecond.
+ */
+void GPSFusion_Predict( GpsFusion_t * pFusion,
+                        uint32_t nowMs );
+
+/**
+ * @brief Correct the state with a GPS fix.
+ *
+ * A fix older than the last GPSFusion_Predict is applied at its own time, the
+ * state is not moved back.
+ *
+ * @param[in] pFusion pointer to filter state.
+ * @param[in] latitude fix latitude in microdegree.
+ * @param[in] longitude fix longitude in microdegree.
+ * @param[in] hdop fix hdop in 0.1 unit, 0 if unknown.
+ * @param[in] fixMs uptime of the fix in milisecond.
+ */
+void GPSFusion_UpdateFix( GpsFusion_t * pFusion,
+                          int32_t latitude,
+                          int32_t longitude,
+                          uint8_t hdop,
+                          uint32_t fixMs );
+
+/**
+ * @brief Correct the velocity with the OBD vehicle speed.
+ *
+ * The speed has no direction, it is applied along the current heading. A
+ * speed before the first heading is not applied.
+ *
+ * @param[in] pFusion pointer to filter state.
+ * @param[in] speedKph vehicle speed in km/h.
+ */
+void GPSFusion_UpdateSpeed( GpsFusion_t * pFusion,
+                            float speedKph );
+
+/**
+ * @brief Correct the velocity and heading with the course of the receiver.
+ *
+ * Call after GPSFusion_UpdateFix with the course of the same fix. It is not
+ * used below 1 m/s, where the course of a receiver is noise.
+ *
+ * @param[in] pFusion pointer to filter state.
+ * @param[in] courseDeg course over ground in degree, 0 is north.
+ * @param[in] speedKph speed over ground in km/h.
+ */
+void GPSFusion_UpdateCourse( GpsFusion_t * pFusion,
+                             float courseDeg,
+                             float speedKph );
+
+/**
+ * @brief Get the fused position and heading.
+ *
+ * @param[in] pFusion pointer to filter state.
+ * @param[out] pLatitude fused latitude in microdegree.
+ * @param[out] pLongitude fused longitude in microdegree.
+ * @param[out] pHeading fused heading in degree.
+ *
+ * @return true if the filter has been initialized by a fix or false.
+ */
+bool GPSFusion_GetState( const GpsFusion_t * pFusion,
+                         int32_t * pLatitude,
+                         int32_t * pLongitude,
+                         float * pHeading );
+
+#endif /* GPS_FUSION_H */
@@ -0,0 +1,78 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file gps_service.h
+ * @brief Background GPS acquisition and latest-fix publication.
+ */
+
+#ifndef GPS_SERVICE_H
+#define GPS_SERVICE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS_IO.h"
+#include "gps_library.h"
+
+/**
+ * @brief Start the GPS service task.
+ *
+ * The task turns on the dongle GPS and polls it at GPS_SERVICE_POLL_INTERVAL_MS.
+ * Each good fix is published as the latest snapshot. A trip replay starts no
+ * task, see GPSService_Poll.
+ *
+ * @param[in] obdDevice obd device descriptor.
+ *
+ * @return true if the task is created or false.
+ */
+bool GPSService_Start( Peripheral_Descriptor_t obdDevice );
+
+/**
+ * @brief Pause or resume the polling of the GPS.
+ *
+ * The GPS keeps tracking while paused, only the UART reads stop. The latest
+ * fix then ages out like a lost fix. A resumed GPS is polled at once.
+ *
+ * @param[in] active false pauses the polling.
+ */
+void GPSService_SetActive( bool active );
+
+/**
+ * @brief Get the latest GPS fix.
+ *
+ * Safe to call from any task. It never blocks and never touches the UART.
+ *
+ * @param[out] pGpsData pointer to receive the latest fix.
+ * @param[out] pAgeMs age of the fix in milisecond. Can be NULL.
+ *
+ * @return true if a fix is available or false.
+ */
+bool GPSService_GetLatestFix( ObdGpsData_t * pGpsData,
+                              uint32_t * pAgeMs );
+
+/**
+ * @brief Poll the GPS of a trip replay from the telemetry task.
+ *
+ * Only built with TRIP_REPLAY_ENABLE. The GPS is read when
+ * GPS_SERVICE_POLL_INTERVAL_MS of replay time have passed since the last
+ * read, so every recorded fix is parsed whatever the replay speed.
+ */
+void GPSService_Poll( void );
+
+#endif /* GPS_SERVICE_H */
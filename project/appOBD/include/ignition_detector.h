@@ -0,0 +1,66 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file ignition_detector.h
+ * @brief Engine start detection from the battery voltage.
+ *
+ * With the engine off the battery rests around 12.6 V. Cranking pulls it
+ * down and the alternator then charges it above 13 V. Either change from the
+ * rest voltage makes the engine a candidate, the caller confirms it with the
+ * engine RPM. The rest voltage follows the slow drift of a parked battery.
+ */
+
+#ifndef IGNITION_DETECTOR_H
+#define IGNITION_DETECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct IgnitionDetector
+{
+    float restVoltage;          /* 0 until the first reading below the charging voltage. */
+    uint64_t lastCheckMs;       /* Last time the caller was asked to check the RPM. */
+    bool candidate;
+} IgnitionDetector_t;
+
+/**
+ * @brief Forget the rest voltage.
+ *
+ * @param[in] pDetector pointer to detector state.
+ */
+void IgnitionDetector_Init( IgnitionDetector_t * pDetector );
+
+/**
+ * @brief Add a battery voltage reading.
+ *
+ * While the voltage looks like an engine start, it asks for an RPM check
+ * at once and then every IGNITION_RPM_CHECK_INTERVAL_MS. A reading below
+ * IGNITION_MIN_VOLTAGE is taken as a failed read and changes nothing.
+ *
+ * @param[in] pDetector pointer to detector state.
+ * @param[in] voltage battery voltage in volt.
+ * @param[in] nowMs uptime in milliseconds.
+ *
+ * @return true if the caller should check the engine RPM now.
+ */
+bool IgnitionDetector_Update( IgnitionDetector_t * pDetector,
+                              float voltage,
+                              uint64_t nowMs );
+
+#endif /* IGNITION_DETECTOR_H */
@@ -0,0 +1,217 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file json_writer.h
+ * @brief Bounded streaming JSON writer.
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define JSON_WRITER_DEPTH_MAX       ( 8 )
+
+/* Writer options. */
+#define JSON_WRITER_PRETTY          ( 0x01U )     /* Indent with line breaks. */
+#define JSON_WRITER_OMIT_EMPTY      ( 0x02U )     /* Skip empty members, array elements keep their place. */
+#define JSON_WRITER_TRIM_ZEROS      ( 0x04U )     /* Drop trailing zeros of fraction digits. */
+
+typedef struct JsonWriter
+{
+    char * pBuffer;
+    size_t bufferSize;
+    size_t length;
+    uint8_t depth;
+    bool needComma[ JSON_WRITER_DEPTH_MAX ];
+    size_t openLength[ JSON_WRITER_DEPTH_MAX ];     /* Length before the member that opened the level. */
+    bool openComma[ JSON_WRITER_DEPTH_MAX ];        /* Comma state of the parent before the level. */
+    size_t stringOpenLength;                        /* Same for a string written in place. */
+    bool stringOpenComma;
+    uint8_t options;
+    bool overflow;
+} JsonWriter_t;
+
+/**
+ * @brief Start writing a JSON document.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] pBuffer buffer to receive the document.
+ * @param[in] bufferSize size of the buffer.
+ * @param[in] options JSON_WRITER_PRETTY, JSON_WRITER_OMIT_EMPTY and
+ * JSON_WRITER_TRIM_ZEROS or 0 for plain compact output.
+ */
+void JsonWriter_Init( JsonWriter_t * pWriter,
+                      char * pBuffer,
+                      size_t bufferSize,
+                      uint8_t options );
+
+/**
+ * @brief Open an object.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] pKey member name, NULL for the root or an array element.
+ */
+void JsonWriter_BeginObject( JsonWriter_t * pWriter,
+                             const char * pKey );
+
+/**
+ * @brief Close the current object.
+ *
+ * @param[in] pWriter pointer to writer state.
+ */
+void JsonWriter_EndObject( JsonWriter_t * pWriter );
+
+/**
+ * @brief Open an array.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] pKey member name, NULL for an array element.
+ */
+void JsonWriter_BeginArray( JsonWriter_t * pWriter,
+                            const char * pKey );
+
+/**
+ * @brief Close the current array.
+ *
+ * @param[in] pWriter pointer to writer state.
+ */
+void JsonWriter_EndArray( JsonWriter_t * pWriter );
+
+/**
+ * @brief Add an escaped string.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] pKey member name, NULL in an array.
+ * @param[in] pValue null terminated string.
+ */
+void JsonWriter_AddString( JsonWriter_t * pWriter,
+                           const char * pKey,
+                           const char * pValue );
+
+/**
+ * @brief Add binary data as a base64 string.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] pKey member name, NULL in an array.
+ * @param[in] pData the data.
+ * @param[in] length length of the data.
+ */
+void JsonWriter_AddBase64( JsonWriter_t * pWriter,
+                           const char * pKey,
+                           const uint8_t * pData,
+                           size_t length );
+
+/**
+ * @brief Open a string value to be written in place.
+ *
+ * The caller writes at most the returned space, already escaped, and closes
+ * it with JsonWriter_EndString.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] pKey member name, NULL in an array.
+ * @param[out] pAvailable space to write including a null terminator.
+ *
+ * @return the write position or NULL if the buffer is full.
+ */
+char * JsonWriter_BeginString( JsonWriter_t * pWriter,
+                               const char * pKey,
+                               size_t * pAvailable );
+
+/**
+ * @brief Close a string value opened with JsonWriter_BeginString.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] length number of characters written in place.
+ */
+void JsonWriter_EndString( JsonWriter_t * pWriter,
+                           size_t length );
+
+/**
+ * @brief Add a signed integer.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] pKey member name, NULL in an array.
+ * @param[in] value the value.
+ */
+void JsonWriter_AddInt( JsonWriter_t * pWriter,
+                        const char * pKey,
+                        int64_t value );
+
+/**
+ * @brief Add a fixed-point number.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] pKey member name, NULL in an array.
+ * @param[in] value the value scaled by 10^decimals.
+ * @param[in] decimals number of fraction digits, up to 9.
+ */
+void JsonWriter_AddFixed( JsonWriter_t * pWriter,
+                          const char * pKey,
+                          int64_t value,
+                          uint8_t decimals );
+
+/**
+ * @brief Add a number rounded to a fixed number of fraction digits.
+ *
+ * Faster than printf and without its stack use. NaN, infinity and values
+ * beyond the 64 bit range are written as null.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] pKey member name, NULL in an array.
+ * @param[in] value the value.
+ * @param[in] decimals number of fraction digits, up to 9.
+ */
+void JsonWriter_AddDouble( JsonWriter_t * pWriter,
+                           const char * pKey,
+                           double value,
+                           uint8_t decimals );
+
+/**
+ * @brief Add a boolean.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] pKey member name, NULL in an array.
+ * @param[in] value the value.
+ */
+void JsonWriter_AddBool( JsonWriter_t * pWriter,
+                         const char * pKey,
+                         bool value );
+
+/**
+ * @brief Add a null.
+ *
+ * @param[in] pWriter pointer to writer state.
+ * @param[in] pKey member name, NULL in an array.
+ */
+void JsonWriter_AddNull( JsonWriter_t * pWriter,
+                         const char * pKey );
+
+/**
+ * @brief Finish the document.
+ *
+ * @param[in] pWriter pointer to writer state.
+ *
+ * @return the length of the document or -1 if it did not fit or is not closed.
+ */
+int32_t JsonWriter_Finish( const JsonWriter_t * pWriter );
+
+#endif /* JSON_WRITER_H */
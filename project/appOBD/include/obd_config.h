@@ -36,21 +36,150 @@
 #define CAR_HIGH_OIL_TEMP_RPM_DURATION_MS      ( 10000 )
 #define CAR_HIGH_OIL_TEMP                      ( 300 )
 
+/* Driving event rules, see event_engine.h. Acceleration is KM/hr per second. */
+#define OBD_EVENT_HARSH_ACCELERATION           ( 10.0 )
+#define OBD_EVENT_HARSH_BRAKING                ( -12.0 )
+#define OBD_EVENT_ACCELERATION_HYSTERESIS      ( 3.0 )
+#define OBD_EVENT_OVER_SPEED_MS                ( 5000 )      /* Above CAR_HIGH_SPEED_THRESHOLD. */
+#define OBD_EVENT_OVER_SPEED_HYSTERESIS        ( 5.0 )       /* KM/hr. */
+#define OBD_EVENT_OVER_REV_RPM                 ( 5000.0 )
+#define OBD_EVENT_OVER_REV_MS                  ( 3000 )
+#define OBD_EVENT_OVER_REV_HYSTERESIS          ( 300.0 )
+#define OBD_EVENT_LONG_IDLE_MS                 ( 20000 )     /* At CAR_IDLE_SPEED_THRESHOLD, below CAR_IGINITION_IDLE_OFF_MS. */
+
 /* The OBD data collect interval time. */
 #define OBD_DATA_COLLECT_INTERVAL_MS           ( 2000 )
 
-#define OBD_AGGREGATED_DATA_INTERVAL_MS        ( 20000 )
+#define OBD_AGGREGATED_DATA_INTERVAL_MS        ( 20000 )     /* Tumbling window, also the sliding window step. */
+#define OBD_AGGREGATED_SLIDING_WINDOWS         ( 3U )        /* Intervals covered by the sliding window. */
 #define OBD_TELEMETRY_DATA_INTERVAL_MS         ( 2000 )
+#define OBD_SIGNAL_SLOW_INTERVAL_MS            ( 10000 )     /* Read interval of the slow changing PIDs. */
+
+/* Telemetry samples are sent together, whichever limit is reached first. */
+#define OBD_TELEMETRY_BATCH_MAX_SAMPLES        ( 10 )
+#define OBD_TELEMETRY_BATCH_MAX_MS             ( 20000 )
+#define OBD_TELEMETRY_BATCH_GORILLA            ( 0 )         /* 1 sends the measured values as Gorilla streams, see gorilla_codec.h. */
+
+/* Message buffer, also the MQTT agent payload buffer. Fits a pretty printed
+ * batch of 10 samples. */
+#define OBD_MESSAGE_BUF_SIZE                   ( 4096 )
+
+/* A sample field is reported when it moved beyond its deadband or was silent for its heartbeat. */
+#define OBD_TELEMETRY_DEADBAND                 ( 1 )         /* 0 reports every field of every sample. */
+#define OBD_TELEMETRY_HEARTBEAT_MS             ( 60000 )
+#define OBD_TELEMETRY_SLOW_HEARTBEAT_MS        ( 300000 )    /* Odometer, fuel and oil temperature. */
+#define OBD_DEADBAND_POSITION                  ( 50 )        /* Microdegree, about 5 m. */
+#define OBD_DEADBAND_HEADING                   ( 5.0 )       /* Degree. */
+#define OBD_DEADBAND_SPEED                     ( 2.0 )       /* KM/hr. */
+#define OBD_DEADBAND_DISTANCE                  ( 0.1 )       /* KM. */
+#define OBD_DEADBAND_FUEL                      ( 0.2 )       /* L. */
+#define OBD_DEADBAND_TEMPERATURE               ( 2.0 )
+
+/* The clock service. */
+#define CLOCK_SERVICE_STEP_MS                  ( 1000 )      /* Larger errors step the clock, smaller ones are slewed. */
+#define CLOCK_SERVICE_SLEW_DIVISOR             ( 4 )
+#define CLOCK_SERVICE_SOURCE_HOLD_MS           ( 600000 )    /* A source not synced this long gives way to any other. */
+#define CLOCK_SERVICE_MIN_EPOCH_S              ( 1577836800 ) /* 2020-01-01, an older system time is not set by SNTP. */
+
+/* The GPS service task. */
+#define GPS_SERVICE_POLL_INTERVAL_MS           ( 1000 )
+#define GPS_SERVICE_TASK_STACK_SIZE            ( 1024 * 3 )
+#define GPS_SERVICE_TASK_PRIORITY              ( tskIDLE_PRIORITY + 1 )
+#define GPS_FIX_MAX_AGE_MS                     ( 5000 )      /* Older fix is treated as GPS lost. */
+#define GPS_SERVICE_USE_NMEA                   ( 1 )         /* 1 parses raw NMEA (ATGRR), 0 uses the $GNIFO summary (ATGPS). */
+#define GPS_FUSION_MAX_DEAD_RECKONING_MS       ( 60000 )     /* Fused position is held after this long without fix. */
+
+#define TRIP_ODOMETER_MAX_HDOP                 ( 50 )        /* 0.1 unit, worse fixes are not used for distance. */
+#define TRIP_ODOMETER_SPEED_TOLERANCE_PERCENT  ( 50 )        /* Allowed GPS and OBD speed distance mismatch. */
+#define TRIP_ODOMETER_SPEED_MARGIN_MM          ( 20000 )
+
+#define TRIP_PATH_MAX_POINTS                   ( 128 )       /* Kept points, tolerance doubles when full. */
+#define TRIP_PATH_WINDOW_MAX                   ( 32 )
+#define TRIP_PATH_TOLERANCE_M                  ( 10.0f )
+
+/* Pretty is the indented JSON. Compact strips whitespace, leaves out empty
+ * and not measured fields and rounds numbers to the field precision. CBOR is
+ * the compact payload in binary with the integer keys of obd_payload.h. */
+#define OBD_PAYLOAD_ENCODING_PRETTY            ( 0 )
+#define OBD_PAYLOAD_ENCODING_COMPACT           ( 1 )
+#define OBD_PAYLOAD_ENCODING_CBOR              ( 2 )
+#define OBD_PAYLOAD_ENCODING                   OBD_PAYLOAD_ENCODING_PRETTY
+#define OBD_PAYLOAD_CLOSING_SPACE              ( 32 )        /* Space kept to close the payload objects. */
+
+/* LZSS compression of the payload, see payload_compress.h for the format.
+ * Only sent compressed when it saves more than the given percentage. */
+#define OBD_PAYLOAD_COMPRESSION                ( 0 )
+#define OBD_PAYLOAD_COMPRESSION_MIN_SIZE       ( 256 )
+#define OBD_PAYLOAD_COMPRESSION_MIN_SAVING     ( 10 )        /* Percent. */
+
+/* Messages not acknowledged are kept on the SD card, see store_forward.h.
+ * The oldest segment is dropped when all segments are full. */
+#define STORE_FORWARD_ENABLE                   ( 1 )
+#define STORE_FORWARD_SEGMENT_COUNT            ( 8U )
+#define STORE_FORWARD_SEGMENT_SIZE             ( 64U * 1024U )
+#define STORE_FORWARD_ALIGN                    ( 512U )      /* FAT sector size. */
+#define STORE_FORWARD_REPLAY_PER_LOOP          ( 2U )        /* Stored messages sent per publisher wake up. */
+#define STORE_FORWARD_CURSOR_SAVE_EVERY        ( 16U )       /* Acknowledged messages per cursor write. */
+#define STORE_FORWARD_BATCH_GORILLA            ( 1 )         /* 1 sends batches as Gorilla streams while they are being stored. */
+
+/* The publisher task, see publish_service.h. Each ring record holds one
+ * message of OBD_MESSAGE_BUF_SIZE. */
+#define PUBLISH_SERVICE_RING_SIZE              ( 4U )
+#define PUBLISH_SERVICE_IDLE_MS                ( 1000 )      /* Wake up to replay stored messages. */
+#define PUBLISH_SERVICE_TASK_STACK_SIZE        ( 1024 * 4 )
+#define PUBLISH_SERVICE_TASK_PRIORITY          ( tskIDLE_PRIORITY + 1 )
+
+/* Ignition detection, see ignition_detector.h. */
+#define IGNITION_POLL_INTERVAL_MS              ( 500 )       /* Battery voltage reads while parked. */
+#define IGNITION_CHARGING_VOLTAGE              ( 13.2f )     /* Volt, the alternator is charging. */
+#define IGNITION_CHARGING_RISE                 ( 0.5f )      /* Volt above the rest voltage. */
+#define IGNITION_CRANKING_DIP                  ( 1.0f )      /* Volt below the rest voltage. */
+#define IGNITION_MIN_VOLTAGE                   ( 6.0f )      /* Volt, a lower reading is a failed read. */
+#define IGNITION_REST_FILTER                   ( 16.0f )     /* Readings to follow a change of the rest voltage. */
+#define IGNITION_RPM_CHECK_INTERVAL_MS         ( 2000 )      /* While the voltage is high and the RPM is 0. */
+#define IGNITION_RPM_MAX_AGE_MS                ( 5000 )      /* Without a newer RPM the engine is off. */
+
+/* Vehicle states, see vehicle_state.h. The intervals of a state are a
+ * percentage of the configured ones, the city state uses them as is. */
+#define VEHICLE_STATE_HIGHWAY_SPEED            ( 80.0 )      /* KM/hr. */
+#define VEHICLE_STATE_SPEED_HYSTERESIS         ( 10.0 )      /* KM/hr. */
+#define VEHICLE_STATE_DWELL_MS                 ( 5000 )      /* A slower state must hold this long. */
+#define VEHICLE_STATE_MIN_INTERVAL_MS          ( 250 )
+#define VEHICLE_STATE_OFF_PERCENT              ( 500U )
+#define VEHICLE_STATE_IDLE_PERCENT             ( 250U )
+#define VEHICLE_STATE_HIGHWAY_PERCENT          ( 50U )
+#define VEHICLE_STATE_EVENT_PERCENT            ( 25U )
+#define VEHICLE_STATE_GPS_RESUME_MS            ( 3000 )      /* Wait for a fix at ignition before using simulated GPS. */
+
+/* Trip checkpoints in NVS, see trip_checkpoint.h. Each save writes about
+ * 2 KB of flash, the interval bounds the wear. */
+#define TRIP_CHECKPOINT_INTERVAL_MS            ( 60000 )
+#define TRIP_CHECKPOINT_MAX_GAP_MS             ( 300000 )    /* Longer stops start a new trip. */
+
+/* Replay of a recorded trip log in place of the vehicle, see trip_replay.h.
+ * Trip checkpoints are not written while replaying. May be set by the build. */
+#ifndef TRIP_REPLAY_ENABLE
+    #define TRIP_REPLAY_ENABLE                 ( 0 )
+#endif
+#define TRIP_REPLAY_SPEED                      ( 0U )        /* Times real time, 0 runs as fast as possible. */
+#define TRIP_REPLAY_FAST_WAIT_MS               ( 10U )       /* Real wait of a loop step at speed 0. */
+#define TRIP_REPLAY_MAX_COMMANDS               ( 24U )       /* Distinct commands in a log. */
+
+/* Settings changed over MQTT, see runtime_config.h. */
+#define RUNTIME_CONFIG_MIN_INTERVAL_MS         ( 500 )
+#define RUNTIME_CONFIG_MAX_INTERVAL_MS         ( 60000 )
+#define RUNTIME_CONFIG_MAX_BATCH_MS            ( 300000 )
+#define RUNTIME_CONFIG_MESSAGE_MAX             ( 512 )
 
 #define OBD_SIMULATED_TRIP_MS                  ( 120000 )
     /* Test code. <^ 25.03914, 121.563526 .*/
     /* Test code. >^ 25.03902, 121.568408 .*/
     /* Test code. >| 25.03290, 121.568386 .*/
     /* Test code. <| 25.03291, 121.563558 .*/
-#define OBD_SIMULATED_TRIP_X1                   ( 25.03914 )
-#define OBD_SIMULATED_TRIP_Y1                   ( 121.563526 )
-#define OBD_SIMULATED_TRIP_X2                   ( 25.03290 )
-#define OBD_SIMULATED_TRIP_Y2                   ( 121.568386 )
+#define OBD_SIMULATED_TRIP_X1                   ( 25039140 )      /* Microdegree. */
+#define OBD_SIMULATED_TRIP_Y1                   ( 121563526 )
+#define OBD_SIMULATED_TRIP_X2                   ( 25032900 )
+#define OBD_SIMULATED_TRIP_Y2                   ( 121568386 )
 
 #define OBD_SIMULATED_VEHICLE_SPEED             ( 100.0 )
 
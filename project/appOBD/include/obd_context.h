@@ -24,6 +24,19 @@
 #ifndef OBD_CONTEXT_H
 #define OBD_CONTEXT_H
 
+#include "gps_fusion.h"
+#include "trip_odometer.h"
+#include "trip_path.h"
+#include "telemetry_batch.h"
+#include "clock_service.h"
+#include "signal_registry.h"
+#include "stream_stats.h"
+#include "window_aggregate.h"
+#include "event_engine.h"
+#include "runtime_config.h"
+#include "vehicle_state.h"
+#include "ignition_detector.h"
+
 #define OBD_ISO_TIME_MAX                       ( 64 )
 #define OBD_VIN_MAX                            ( 32 )
 #define OBD_IGNITION_MAX                       ( 8 )
@@ -33,25 +46,77 @@
 #define OBD_THINGNAME_MAX                      ( 32 )
 #define OBD_MESSAGE_ID_MAX                     ( 128 )
 
-#define OBD_MESSAGE_BUF_SIZE                   ( 2048 )
 #define OBD_TOPIC_BUF_SIZE                     ( 64 )
 
+/* Signals of the registry, in the order of obdSignals. The window aggregates
+ * take the first WINDOW_AGGREGATE_MAX_SIGNALS. */
+typedef enum ObdSignal
+{
+    OBD_SIGNAL_VEHICLE_SPEED = 0,
+    OBD_SIGNAL_ENGINE_SPEED,
+    OBD_SIGNAL_OIL_TEMP,
+    OBD_SIGNAL_ACCELERATOR_PEDAL,
+    OBD_SIGNAL_ACCELERATION,
+    OBD_SIGNAL_FUEL_LEVEL,
+    OBD_SIGNAL_GPS_SPEED,
+    OBD_SIGNAL_MAX
+} ObdSignal_t;
+
+/* What a trip needs to go on after a reset, see trip_checkpoint.h. */
+typedef struct ObdTripCheckpoint
+{
+    char tripId[ OBD_TRIP_ID_MAX ];
+    uint64_t startEpochMs;
+    uint64_t savedEpochMs;
+    uint64_t distanceMm;
+    uint64_t highSpeedDurationMs;
+    uint64_t idleSpeedDurationMs;
+    double startFuelLevel;
+    int32_t startLatitude;  /* Microdegree. */
+    int32_t startLongitude; /* Microdegree. */
+    uint8_t startDirection;
+    bool ended;             /* Saved at ignition off, not resumed. */
+    uint32_t highAccelerationEvents;
+    uint32_t highBrakingEvents;
+    StreamStats_t signalStats[ OBD_SIGNAL_MAX ];
+    TripPath_t tripPath;
+} ObdTripCheckpoint_t;
+
 typedef struct obdContext
 {
     ObdAggregatedData_t obdAggregatedData;
-    ObdTelemetryData_t obdTelemetryData;
+    RuntimeConfig_t config;
+    VehicleStateMachine_t vehicleState;
+    VehicleStateProfile_t rates;            /* Of the current vehicle state. */
+    IgnitionDetector_t ignitionDetector;
+    ObdTripCheckpoint_t checkpoint;         /* Last saved or loaded. */
+    uint64_t checkpointTicksMs;
+    SignalRegistry_t signals;
+    StreamStats_t signalStats[ OBD_SIGNAL_MAX ];
+    WindowAggregate_t window;
+    uint64_t windowStartTicksMs;
+    EventEngine_t eventEngine;
+    Event_t pendingEvents[ EVENT_ENGINE_MAX_RULES ];    /* Raised and not sent yet. */
+    uint32_t pendingEventCount;
     char thingName[ OBD_THINGNAME_MAX ];
     char tripId[ OBD_TRIP_ID_MAX ];
     char tripName[ OBD_TRIP_NAME_MAX ];
     char vin[ OBD_VIN_MAX ];
     char ignition_status[ OBD_IGNITION_MAX ];
     char transmission_gear_position[ OBD_TRANSMISSION_GEAR_POSITION_MAX ];
-    double latitude;
-    double longitude;
-    double startLatitude;
-    double startLongitude;
+    int32_t latitude;       /* Microdegree. */
+    int32_t longitude;      /* Microdegree. */
+    double heading; /* Degree, 0 is north. */
+    GpsFusion_t gpsFusion;
+    uint32_t lastFusedFixMs;
+    int32_t startLatitude;  /* Microdegree. */
+    int32_t startLongitude; /* Microdegree. */
     uint8_t startDirection;
-    double odometer;
+    double odometer; /* km */
+    TripOdometer_t tripOdometer;
+    TripPath_t tripPath;
+    TelemetryBatch_t telemetryBatch;
+    TelemetryDeadband_t telemetryDeadband;
     bool brake_pedal_status;
     double fuel_level; /* 0 to 100 in %. */
     double start_fuel_level;
@@ -62,16 +127,19 @@ typedef struct obdContext
     
     uint64_t higRpmDurationIntervalMs;
     
-    ObdTelemetryDataType_t telemetryIndex;
     char topicBuf[ OBD_TOPIC_BUF_SIZE ];
     char messageBuf[ OBD_MESSAGE_BUF_SIZE ];
     Peripheral_Descriptor_t obdDevice;
     Peripheral_Descriptor_t buzzDevice;
-    char isoTime[ OBD_ISO_TIME_MAX ];
-    uint8_t timeSelection;
+    char creationTime[ OBD_ISO_TIME_MAX ];  /* Of the message being built. */
+    char sendTime[ OBD_ISO_TIME_MAX ];
+    ClockSource_t clockSource;
     uint64_t startTicksMs;
     uint64_t lastUpdateTicksMs; /* Uptime ticks. */
     uint32_t updateCount;
+    uint8_t gpsSatellites;
+    uint8_t gpsFixQuality;
+    uint8_t gpsFixMode;
     bool gpsReceived;
     bool obdDeviceConnected;
 } obdContext_t;
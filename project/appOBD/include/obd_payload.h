@@ -0,0 +1,229 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file obd_payload.h
+ * @brief Message building interface over the JSON and CBOR payload writers.
+ */
+
+#ifndef OBD_PAYLOAD_H
+#define OBD_PAYLOAD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "obd_config.h"
+#include "json_writer.h"
+#include "cbor_writer.h"
+
+/*
+ * Payload field keys. The number is the CBOR map key and must never be
+ * reused for another field, the name is the JSON member name.
+ */
+#define OBD_PAYLOAD_KEYS( X )                                   \
+    X( OBD_KEY_MESSAGE_ID, 1, "MessageId" )                     \
+    X( OBD_KEY_SIMULATION_ID, 2, "SimulationId" )               \
+    X( OBD_KEY_CREATION_TIME_STAMP, 3, "CreationTimeStamp" )    \
+    X( OBD_KEY_SEND_TIME_STAMP, 4, "SendTimeStamp" )            \
+    X( OBD_KEY_VIN, 5, "VIN" )                                  \
+    X( OBD_KEY_TRIP_ID, 6, "TripId" )                           \
+    X( OBD_KEY_DRIVER_ID, 7, "DriverID" )                       \
+    X( OBD_KEY_GEO_LOCATION, 8, "GeoLocation" )                 \
+    X( OBD_KEY_LATITUDE, 9, "Latitude" )                        \
+    X( OBD_KEY_LONGITUDE, 10, "Longitude" )                     \
+    X( OBD_KEY_ALTITUDE, 11, "Altitude" )                       \
+    X( OBD_KEY_HEADING, 12, "Heading" )                         \
+    X( OBD_KEY_SPEED, 13, "Speed" )                             \
+    X( OBD_KEY_COMMUNICATIONS, 14, "Communications" )           \
+    X( OBD_KEY_GSM, 15, "GSM" )                                 \
+    X( OBD_KEY_SATELITES, 16, "Satelites" )                     \
+    X( OBD_KEY_FIX, 17, "Fix" )                                 \
+    X( OBD_KEY_NETWORK_TYPE, 18, "NetworkType" )                \
+    X( OBD_KEY_MNC, 19, "MNC" )                                 \
+    X( OBD_KEY_MCC, 20, "MCC" )                                 \
+    X( OBD_KEY_LAC, 21, "LAC" )                                 \
+    X( OBD_KEY_CID, 22, "CID" )                                 \
+    X( OBD_KEY_WIFI, 23, "WiFi" )                               \
+    X( OBD_KEY_NETWORK_ID, 24, "NetworkID" )                    \
+    X( OBD_KEY_WIRED, 25, "Wired" )                             \
+    X( OBD_KEY_ACCELERATION, 26, "Acceleration" )               \
+    X( OBD_KEY_MAX_LONGITUDINAL, 27, "MaxLongitudinal" )        \
+    X( OBD_KEY_AXIS, 28, "Axis" )                               \
+    X( OBD_KEY_VALUE, 29, "Value" )                             \
+    X( OBD_KEY_MAX_LATERAL, 30, "MaxLateral" )                  \
+    X( OBD_KEY_THROTTLE, 31, "Throttle" )                       \
+    X( OBD_KEY_MAX, 32, "Max" )                                 \
+    X( OBD_KEY_AVERAGE, 33, "Average" )                         \
+    X( OBD_KEY_ODOMETER, 34, "Odometer" )                       \
+    X( OBD_KEY_METRES, 35, "Metres" )                           \
+    X( OBD_KEY_TICKS_FL, 36, "TicksFL" )                        \
+    X( OBD_KEY_TICKS_FR, 37, "TicksFR" )                        \
+    X( OBD_KEY_TICKS_RL, 38, "TicksRL" )                        \
+    X( OBD_KEY_TICKS_RR, 39, "TicksRR" )                        \
+    X( OBD_KEY_FUEL, 40, "Fuel" )                               \
+    X( OBD_KEY_NAME, 41, "Name" )                               \
+    X( OBD_KEY_OIL_TEMP, 42, "OilTemp" )                        \
+    X( OBD_KEY_FUEL_INFO, 43, "FuelInfo" )                      \
+    X( OBD_KEY_CURRENT_TRIP_CONSUMPTION, 44, "CurrentTripConsumption" ) \
+    X( OBD_KEY_TANK_CAPACITY, 45, "TankCapacity" )              \
+    X( OBD_KEY_IGNITION_STATUS, 46, "IgnitionStatus" )          \
+    X( OBD_KEY_TRIP_SUMMARY, 47, "TripSummary" )                \
+    X( OBD_KEY_START_TIME, 48, "StartTime" )                    \
+    X( OBD_KEY_DISTANCE, 49, "Distance" )                       \
+    X( OBD_KEY_DURATION, 50, "Duration" )                       \
+    X( OBD_KEY_START_LOCATION, 51, "StartLocation" )            \
+    X( OBD_KEY_END_LOCATION, 52, "EndLocation" )                \
+    X( OBD_KEY_SPEED_PROFILE, 53, "SpeedProfile" )              \
+    X( OBD_KEY_PATH, 54, "Path" )                               \
+    X( OBD_KEY_DTC, 55, "DTC" )                                 \
+    X( OBD_KEY_CODE, 56, "Code" )                               \
+    X( OBD_KEY_CHANGED, 57, "Changed" )                         \
+    X( OBD_KEY_MAINTENANCE, 58, "Maintenance" )                 \
+    X( OBD_KEY_ID, 59, "Id" )                                   \
+    X( OBD_KEY_VAL, 60, "Val" )                                 \
+    X( OBD_KEY_SAMPLES, 61, "Samples" )                         \
+    X( OBD_KEY_OFFSET, 62, "Offset" )                           \
+    X( OBD_KEY_STATISTICS, 63, "Statistics" )                   \
+    X( OBD_KEY_ENGINE_SPEED, 64, "EngineSpeed" )                \
+    X( OBD_KEY_FUEL_LEVEL, 65, "FuelLevel" )                    \
+    X( OBD_KEY_SAMPLE_COUNT, 66, "Count" )                      \
+    X( OBD_KEY_MIN, 67, "Min" )                                 \
+    X( OBD_KEY_STD_DEV, 68, "StdDev" )                          \
+    X( OBD_KEY_P50, 69, "P50" )                                 \
+    X( OBD_KEY_P95, 70, "P95" )                                 \
+    X( OBD_KEY_TIME_AVERAGE, 71, "TimeAverage" )               \
+    X( OBD_KEY_TUMBLING, 72, "Tumbling" )                       \
+    X( OBD_KEY_SLIDING, 73, "Sliding" )                         \
+    X( OBD_KEY_EVENT, 74, "Event" )                             \
+    X( OBD_KEY_TYPE, 75, "Type" )                               \
+    X( OBD_KEY_GPS_SPEED, 76, "GpsSpeed" )
+
+#define OBD_PAYLOAD_KEY_ENUM( key, number, name )    key = number,
+
+typedef enum ObdPayloadKey
+{
+    OBD_KEY_NONE = 0,     /* Root object and array elements. */
+    OBD_PAYLOAD_KEYS( OBD_PAYLOAD_KEY_ENUM )
+    OBD_KEY_COUNT
+} ObdPayloadKey_t;
+
+/* Version byte in front of a CBOR payload, bump when a key changes meaning. */
+#define OBD_PAYLOAD_CBOR_VERSION    ( 0x01U )
+
+typedef struct ObdPayload
+{
+    #if ( OBD_PAYLOAD_ENCODING == OBD_PAYLOAD_ENCODING_CBOR )
+        CborWriter_t cbor;
+    #else
+        JsonWriter_t json;
+    #endif
+} ObdPayload_t;
+
+/**
+ * @brief Start a payload in the configured OBD_PAYLOAD_ENCODING.
+ *
+ * @param[in] pPayload pointer to payload state.
+ * @param[in] pBuffer buffer to receive the payload.
+ * @param[in] bufferSize size of the buffer.
+ */
+void ObdPayload_Init( ObdPayload_t * pPayload,
+                      char * pBuffer,
+                      size_t bufferSize );
+
+void ObdPayload_BeginObject( ObdPayload_t * pPayload,
+                             ObdPayloadKey_t key );
+
+void ObdPayload_EndObject( ObdPayload_t * pPayload );
+
+void ObdPayload_BeginArray( ObdPayload_t * pPayload,
+                            ObdPayloadKey_t key );
+
+void ObdPayload_EndArray( ObdPayload_t * pPayload );
+
+void ObdPayload_AddString( ObdPayload_t * pPayload,
+                           ObdPayloadKey_t key,
+                           const char * pValue );
+
+/**
+ * @brief Add binary data, base64 in JSON and a byte string in CBOR.
+ *
+ * @param[in] pPayload pointer to payload state.
+ * @param[in] key field key.
+ * @param[in] pData the data.
+ * @param[in] length length of the data.
+ */
+void ObdPayload_AddBytes( ObdPayload_t * pPayload,
+                          ObdPayloadKey_t key,
+                          const uint8_t * pData,
+                          size_t length );
+
+/**
+ * @brief Open a string to be written in place.
+ *
+ * @param[in] pPayload pointer to payload state.
+ * @param[in] key field key.
+ * @param[out] pAvailable space to write including a null terminator.
+ * @param[out] pEscape true if the string must be escaped for JSON.
+ *
+ * @return the write position or NULL if the buffer is full.
+ */
+char * ObdPayload_BeginString( ObdPayload_t * pPayload,
+                               ObdPayloadKey_t key,
+                               size_t * pAvailable,
+                               bool * pEscape );
+
+void ObdPayload_EndString( ObdPayload_t * pPayload,
+                           size_t length );
+
+void ObdPayload_AddInt( ObdPayload_t * pPayload,
+                        ObdPayloadKey_t key,
+                        int64_t value );
+
+void ObdPayload_AddFixed( ObdPayload_t * pPayload,
+                          ObdPayloadKey_t key,
+                          int64_t value,
+                          uint8_t decimals );
+
+void ObdPayload_AddDouble( ObdPayload_t * pPayload,
+                           ObdPayloadKey_t key,
+                           double value,
+                           uint8_t decimals );
+
+void ObdPayload_AddNull( ObdPayload_t * pPayload,
+                         ObdPayloadKey_t key );
+
+/**
+ * @brief Finish the payload.
+ *
+ * @param[in] pPayload pointer to payload state.
+ *
+ * @return the length of the payload or -1 if it did not fit or is not closed.
+ */
+int32_t ObdPayload_Finish( const ObdPayload_t * pPayload );
+
+/**
+ * @brief Get the JSON member name of a key.
+ *
+ * @param[in] key field key.
+ *
+ * @return the name or NULL for OBD_KEY_NONE and unknown keys.
+ */
+const char * ObdPayload_KeyName( ObdPayloadKey_t key );
+
+#endif /* OBD_PAYLOAD_H */
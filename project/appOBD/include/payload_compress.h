@@ -0,0 +1,73 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file payload_compress.h
+ * @brief LZSS compression of message payloads.
+ *
+ * A compressed payload starts with PAYLOAD_COMPRESS_HEADER_LZSS and the
+ * original length in two bytes, big endian. This byte can not start a JSON
+ * or CBOR payload of this application, so the receiver tells them apart.
+ *
+ * The stream is groups of a flag byte and up to 8 items, flag bit 0 first.
+ * A set bit is one literal byte, a clear bit is a two byte match: 12 bits
+ * of distance minus 1 and 4 bits of length minus 3.
+ */
+
+#ifndef PAYLOAD_COMPRESS_H
+#define PAYLOAD_COMPRESS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define PAYLOAD_COMPRESS_HEADER_LZSS    ( 0x81U )
+#define PAYLOAD_COMPRESS_HEADER_SIZE    ( 3U )
+#define PAYLOAD_COMPRESS_INPUT_MAX      ( 0xFFFFU )
+
+/**
+ * @brief Compress a payload.
+ *
+ * @param[in] pInput payload to compress.
+ * @param[in] inputLength length of the payload, up to PAYLOAD_COMPRESS_INPUT_MAX.
+ * @param[out] pOutput buffer to receive the compressed payload.
+ * @param[in] outputSize size of the buffer, compression stops when it is full.
+ *
+ * @return the compressed length or -1 if it does not fit in the buffer.
+ */
+int32_t PayloadCompress_Encode( const uint8_t * pInput,
+                                size_t inputLength,
+                                uint8_t * pOutput,
+                                size_t outputSize );
+
+/**
+ * @brief Decompress a payload made by PayloadCompress_Encode.
+ *
+ * @param[in] pInput compressed payload including the header.
+ * @param[in] inputLength length of the compressed payload.
+ * @param[out] pOutput buffer to receive the payload.
+ * @param[in] outputSize size of the buffer.
+ *
+ * @return the payload length or -1 if the input is not valid or does not fit.
+ */
+int32_t PayloadCompress_Decode( const uint8_t * pInput,
+                                size_t inputLength,
+                                uint8_t * pOutput,
+                                size_t outputSize );
+
+#endif /* PAYLOAD_COMPRESS_H */
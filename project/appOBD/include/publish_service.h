@@ -0,0 +1,104 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file publish_service.h
+ * @brief Background MQTT publisher fed by the telemetry task.
+ *
+ * The telemetry task hands finished messages to the publisher through a
+ * single producer single consumer ring and never waits on the network. The
+ * publisher task is the only one calling mqttAgentPublish and the store and
+ * forward queue.
+ */
+
+#ifndef PUBLISH_SERVICE_H
+#define PUBLISH_SERVICE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Counters of the publisher, all since start.
+ */
+typedef struct PublishServiceStats
+{
+    uint32_t queued;        /* Messages accepted by PublishService_Send. */
+    uint32_t dropped;       /* Messages lost because the ring was full. */
+    uint32_t published;     /* Messages acknowledged by the broker. */
+    uint32_t stored;        /* Messages saved on the SD card for later. */
+    uint32_t failed;        /* Messages neither published nor stored. */
+    uint32_t highWater;     /* Most messages waiting in the ring at once. */
+} PublishServiceStats_t;
+
+/**
+ * @brief Open the store and forward queue and start the publisher task.
+ *
+ * @return true if the task is created or false.
+ */
+bool PublishService_Start( void );
+
+/**
+ * @brief Queue a message to be published.
+ *
+ * Called from the telemetry task only. It copies the message and never
+ * blocks, a full ring drops the message.
+ *
+ * @param[in] pTopic null terminated topic.
+ * @param[in] pMessage the message.
+ * @param[in] messageLength length of the message.
+ *
+ * @return true if the message is queued or false.
+ */
+bool PublishService_Send( const char * pTopic,
+                          const char * pMessage,
+                          size_t messageLength );
+
+/**
+ * @brief Change how the next messages are published.
+ *
+ * Called from the telemetry task only. Both options take effect together.
+ *
+ * @param[in] qos MQTT QoS, 0 or 1.
+ * @param[in] compression true compresses the large messages, ignored when
+ * OBD_PAYLOAD_COMPRESSION is 0.
+ */
+void PublishService_SetOptions( uint8_t qos,
+                                bool compression );
+
+/**
+ * @brief Get the publisher counters.
+ *
+ * Safe to call from any task.
+ *
+ * @param[out] pStats pointer to receive the counters.
+ */
+void PublishService_GetStats( PublishServiceStats_t * pStats );
+
+/**
+ * @brief Tell if the next messages are likely to go to the SD card.
+ *
+ * True while the broker is not connected or older messages are still
+ * stored, as seen by the publisher at its last wake up. Safe to call from
+ * any task.
+ *
+ * @return true if messages are being stored or false.
+ */
+bool PublishService_IsStoring( void );
+
+#endif /* PUBLISH_SERVICE_H */
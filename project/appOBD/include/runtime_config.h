@@ -0,0 +1,92 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file runtime_config.h
+ * @brief Sampling and publishing settings changed at run time over MQTT.
+ *
+ * The settings start from obd_config.h, are overridden by the copy saved in
+ * NVS and then by the JSON documents received on the config topic, e.g.
+ *
+ *   { "CollectIntervalMs": 1000, "BatchMaxSamples": 5, "Qos": 0 }
+ *
+ * Fields left out keep their value. A document with any invalid field is
+ * rejected as a whole.
+ */
+
+#ifndef RUNTIME_CONFIG_H
+#define RUNTIME_CONFIG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RUNTIME_CONFIG_TOPIC_FORMAT        "cmd/cvra/%s/config"
+
+typedef struct RuntimeConfig
+{
+    uint32_t collectIntervalMs;     /* Main loop period. */
+    uint32_t telemetryIntervalMs;   /* Telemetry sample period, rounded down to collect intervals. */
+    uint32_t batchMaxSamples;       /* Up to OBD_TELEMETRY_BATCH_MAX_SAMPLES. */
+    uint32_t batchMaxMs;
+    uint32_t enabledSignals;        /* SIGNAL_BIT of the acquired signals. */
+    uint8_t qos;                    /* MQTT QoS of the data messages, 0 or 1. */
+    bool compression;               /* Rejected without OBD_PAYLOAD_COMPRESSION. */
+} RuntimeConfig_t;
+
+/**
+ * @brief Load the settings saved in NVS, or the defaults.
+ *
+ * Call once before RuntimeConfig_Subscribe.
+ *
+ * @param[out] pConfig pointer to receive the settings.
+ * @param[in] signalCount number of signals of the registry.
+ */
+void RuntimeConfig_Init( RuntimeConfig_t * pConfig,
+                         uint32_t signalCount );
+
+/**
+ * @brief Subscribe to the config topic of the thing.
+ *
+ * @param[in] pThingName null terminated thing name.
+ *
+ * @return true if subscribed or false.
+ */
+bool RuntimeConfig_Subscribe( const char * pThingName );
+
+/**
+ * @brief Get the settings received since the last call.
+ *
+ * Called from the telemetry task only. It never blocks, the settings of one
+ * document are always returned together.
+ *
+ * @param[out] pConfig pointer to receive the settings.
+ *
+ * @return true if new settings were received or false.
+ */
+bool RuntimeConfig_Fetch( RuntimeConfig_t * pConfig );
+
+/**
+ * @brief Save the settings to NVS, used from the next start.
+ *
+ * @param[in] pConfig the settings.
+ *
+ * @return true if saved or false.
+ */
+bool RuntimeConfig_Save( const RuntimeConfig_t * pConfig );
+
+#endif /* RUNTIME_CONFIG_H */
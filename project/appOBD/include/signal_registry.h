@@ -0,0 +1,188 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file signal_registry.h
+ * @brief Table driven acquisition of the vehicle signals.
+ *
+ * Each signal is described once: where it comes from, how the raw value is
+ * decoded, how often it is read, which aggregators take it and its output
+ * name. The values are kept as arrays indexed by signal, so a pass over the
+ * registry touches one contiguous block.
+ *
+ * PID signals are read through a callback when their interval is over. GPS
+ * signals are set by the GPS stage. Derived signals are computed from their
+ * input signal in the same pass, so they follow their input in the table.
+ */
+
+#ifndef SIGNAL_REGISTRY_H
+#define SIGNAL_REGISTRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "obd_payload.h"
+
+#define SIGNAL_REGISTRY_MAX_SIGNALS    ( 16U )
+
+#define SIGNAL_BIT( signal )           ( ( uint32_t ) 1U << ( signal ) )
+
+/* Aggregators taking the values of a signal. */
+#define SIGNAL_AGGREGATE_STATS         ( 1U << 0 )  /* Trip statistics. */
+#define SIGNAL_AGGREGATE_WINDOW        ( 1U << 1 )  /* Tumbling and sliding windows. */
+#define SIGNAL_AGGREGATE_EVENTS        ( 1U << 2 )  /* Driving event rules. */
+
+typedef enum SignalSource
+{
+    SIGNAL_SOURCE_PID = 0,
+    SIGNAL_SOURCE_GPS,
+    SIGNAL_SOURCE_DERIVED
+} SignalSource_t;
+
+struct SignalRegistry;
+struct SignalDescriptor;
+
+/**
+ * @brief Decode a raw PID value, or compute a derived value from the registry.
+ *
+ * @return false if there is no value.
+ */
+typedef bool ( * SignalDecoder_t )( const struct SignalRegistry * pRegistry,
+                                    const struct SignalDescriptor * pDescriptor,
+                                    int32_t raw,
+                                    double * pValue );
+
+/**
+ * @brief Read a PID from the vehicle.
+ *
+ * @return false if the PID could not be read.
+ */
+typedef bool ( * SignalReadPid_t )( void * pContext,
+                                    uint8_t pid,
+                                    int32_t * pRaw );
+
+typedef struct SignalDescriptor
+{
+    SignalSource_t source;
+    uint8_t pid;                /* SIGNAL_SOURCE_PID. */
+    uint8_t input;              /* SIGNAL_SOURCE_DERIVED, the signal it is computed from. */
+    SignalDecoder_t decode;     /* NULL takes the raw value. */
+    uint32_t intervalMs;        /* Read interval of a PID, 0 reads it in every pass. */
+    uint8_t aggregators;        /* SIGNAL_AGGREGATE_* bits. */
+    ObdPayloadKey_t key;        /* Output name. */
+    uint8_t decimals;
+} SignalDescriptor_t;
+
+typedef struct SignalRegistry
+{
+    const SignalDescriptor_t * pDescriptors;
+    uint32_t count;
+    uint32_t enabled;           /* SIGNAL_BIT of the signals acquired. */
+    uint32_t valid;             /* SIGNAL_BIT of the signals with a value. */
+    double value[ SIGNAL_REGISTRY_MAX_SIGNALS ];
+    double previous[ SIGNAL_REGISTRY_MAX_SIGNALS ];
+    uint64_t updatedMs[ SIGNAL_REGISTRY_MAX_SIGNALS ];     /* Uptime. */
+    uint64_t previousMs[ SIGNAL_REGISTRY_MAX_SIGNALS ];
+} SignalRegistry_t;
+
+/**
+ * @brief Set up a registry with all signals enabled.
+ *
+ * @param[in] pRegistry pointer to registry state.
+ * @param[in] pDescriptors the signal table, kept by reference.
+ * @param[in] count number of signals, at most SIGNAL_REGISTRY_MAX_SIGNALS.
+ */
+void SignalRegistry_Init( SignalRegistry_t * pRegistry,
+                          const SignalDescriptor_t * pDescriptors,
+                          uint32_t count );
+
+/**
+ * @brief Forget all values, the enabled signals are kept.
+ *
+ * @param[in] pRegistry pointer to registry state.
+ */
+void SignalRegistry_Reset( SignalRegistry_t * pRegistry );
+
+/**
+ * @brief Enable or disable a signal.
+ *
+ * @param[in] pRegistry pointer to registry state.
+ * @param[in] signal signal index.
+ * @param[in] enabled false stops acquiring and aggregating the signal.
+ */
+void SignalRegistry_SetEnabled( SignalRegistry_t * pRegistry,
+                                uint32_t signal,
+                                bool enabled );
+
+/**
+ * @brief Read the PID signals that are due and compute the derived ones.
+ *
+ * @param[in] pRegistry pointer to registry state.
+ * @param[in] nowMs uptime in milliseconds.
+ * @param[in] readPid reads a PID.
+ * @param[in] pContext passed to readPid.
+ *
+ * @return SIGNAL_BIT of the signals updated in this pass.
+ */
+uint32_t SignalRegistry_Acquire( SignalRegistry_t * pRegistry,
+                                 uint64_t nowMs,
+                                 SignalReadPid_t readPid,
+                                 void * pContext );
+
+/**
+ * @brief Set the value of a signal, used for the GPS signals.
+ *
+ * @param[in] pRegistry pointer to registry state.
+ * @param[in] signal signal index.
+ * @param[in] value the value.
+ * @param[in] nowMs uptime in milliseconds.
+ *
+ * @return false if the signal is disabled.
+ */
+bool SignalRegistry_Set( SignalRegistry_t * pRegistry,
+                         uint32_t signal,
+                         double value,
+                         uint64_t nowMs );
+
+/**
+ * @brief Get the last value of a signal.
+ *
+ * @param[in] pRegistry pointer to registry state.
+ * @param[in] signal signal index.
+ *
+ * @return the value, 0 if the signal has none.
+ */
+double SignalRegistry_Get( const SignalRegistry_t * pRegistry,
+                           uint32_t signal );
+
+/**
+ * @brief Check if a signal has a recent value.
+ *
+ * @param[in] pRegistry pointer to registry state.
+ * @param[in] signal signal index.
+ * @param[in] nowMs uptime in milliseconds.
+ * @param[in] maxAgeMs oldest value that counts as recent.
+ *
+ * @return true if the last value is at most maxAgeMs old.
+ */
+bool SignalRegistry_IsFresh( const SignalRegistry_t * pRegistry,
+                             uint32_t signal,
+                             uint64_t nowMs,
+                             uint32_t maxAgeMs );
+
+#endif /* SIGNAL_REGISTRY_H */
@@ -0,0 +1,107 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file store_forward.h
+ * @brief Persistent queue of unsent messages on the SD card.
+ *
+ * The queue is a ring of preallocated segment files. Every record holds the
+ * topic and the payload of one message with a sequence number and a CRC-32,
+ * and starts at a STORE_FORWARD_ALIGN boundary.
+ *
+ * The sequence of the next message to send is saved in a cursor file every
+ * STORE_FORWARD_CURSOR_SAVE_EVERY acknowledged messages, when the reader
+ * moves to another segment and when the queue is drained. After a restart
+ * the messages acknowledged since the last save are sent again. Without a
+ * valid cursor, missing or damaged, the whole queue is sent again from its
+ * oldest record, the records do not tell which ones were acknowledged.
+ * Messages are delivered at least once, the receiver drops duplicates by
+ * MessageId.
+ */
+
+#ifndef STORE_FORWARD_H
+#define STORE_FORWARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Open the queue on the mounted file system.
+ *
+ * Creates the segments on the first run and finds the write position after
+ * the newest valid record. A torn record of a power loss is overwritten.
+ *
+ * @return true if the queue is usable or false.
+ */
+bool StoreForward_Init( void );
+
+/**
+ * @brief Append a message.
+ *
+ * When the queue is full the oldest segment is dropped.
+ *
+ * @param[in] pTopic null terminated topic.
+ * @param[in] pPayload the payload.
+ * @param[in] payloadLength length of the payload.
+ *
+ * @return true if the message is stored or false.
+ */
+bool StoreForward_Push( const char * pTopic,
+                        const uint8_t * pPayload,
+                        size_t payloadLength );
+
+/**
+ * @brief Read the oldest message without removing it.
+ *
+ * @param[out] pTopic buffer to receive the null terminated topic.
+ * @param[in] topicSize size of the topic buffer.
+ * @param[out] pPayload buffer to receive the payload.
+ * @param[in] payloadSize size of the payload buffer.
+ * @param[out] pPayloadLength length of the payload.
+ *
+ * @return true if a message is read or false if the queue is empty.
+ */
+bool StoreForward_Peek( char * pTopic,
+                        size_t topicSize,
+                        uint8_t * pPayload,
+                        size_t payloadSize,
+                        size_t * pPayloadLength );
+
+/**
+ * @brief Remove the message returned by StoreForward_Peek.
+ *
+ * Saves the cursor when it is due, see the file description.
+ */
+void StoreForward_Pop( void );
+
+/**
+ * @brief Check if there are stored messages.
+ *
+ * @return true if the queue is empty or not open.
+ */
+bool StoreForward_IsEmpty( void );
+
+/**
+ * @brief Get the number of segments dropped because the queue was full.
+ *
+ * @return the number of dropped segments since start.
+ */
+uint32_t StoreForward_GetDroppedSegments( void );
+
+#endif /* STORE_FORWARD_H */
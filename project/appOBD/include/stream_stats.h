@@ -0,0 +1,133 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file stream_stats.h
+ * @brief Streaming statistics of one signal at O(1) cost per sample.
+ *
+ * Mean and variance use Welford's update, which stays accurate for long
+ * trips. The median and the 95th percentile are P-square estimates that
+ * keep five markers instead of the samples. The time weighted mean holds
+ * each value until the next sample, so irregular sampling does not bias it.
+ */
+
+#ifndef STREAM_STATS_H
+#define STREAM_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define STREAM_QUANTILE_MARKERS     ( 5 )
+
+typedef struct StreamQuantile
+{
+    double quantile;                                /* 0 to 1. */
+    double height[ STREAM_QUANTILE_MARKERS ];       /* Marker values. */
+    int32_t position[ STREAM_QUANTILE_MARKERS ];    /* Marker ranks. */
+    double desired[ STREAM_QUANTILE_MARKERS ];      /* Wanted marker ranks. */
+    uint32_t count;
+} StreamQuantile_t;
+
+typedef struct StreamStats
+{
+    uint32_t count;
+    double mean;
+    double m2;              /* Sum of squared differences from the mean. */
+    double min;
+    double max;
+    StreamQuantile_t p50;
+    StreamQuantile_t p95;
+    double lastValue;
+    uint64_t lastTimeMs;
+    double weightedSum;     /* Sum of value times held milliseconds. */
+    uint64_t weightedMs;
+} StreamStats_t;
+
+/**
+ * @brief Start a quantile estimate.
+ *
+ * @param[in] pQuantile pointer to quantile state.
+ * @param[in] quantile the quantile, 0.5 for the median.
+ */
+void StreamQuantile_Init( StreamQuantile_t * pQuantile,
+                          double quantile );
+
+/**
+ * @brief Add a value to the quantile estimate.
+ *
+ * @param[in] pQuantile pointer to quantile state.
+ * @param[in] value the value.
+ */
+void StreamQuantile_Add( StreamQuantile_t * pQuantile,
+                         double value );
+
+/**
+ * @brief Get the quantile estimate, exact for the first five values.
+ *
+ * @param[in] pQuantile pointer to quantile state.
+ *
+ * @return the estimate or 0 without values.
+ */
+double StreamQuantile_Get( const StreamQuantile_t * pQuantile );
+
+/**
+ * @brief Drop all values.
+ *
+ * @param[in] pStats pointer to stats state.
+ */
+void StreamStats_Init( StreamStats_t * pStats );
+
+/**
+ * @brief Add a sample.
+ *
+ * @param[in] pStats pointer to stats state.
+ * @param[in] value the sample value.
+ * @param[in] timeMs uptime of the sample in milliseconds.
+ */
+void StreamStats_Add( StreamStats_t * pStats,
+                      double value,
+                      uint64_t timeMs );
+
+/**
+ * @brief Get the sample variance.
+ *
+ * @param[in] pStats pointer to stats state.
+ *
+ * @return the variance or 0 with less than two samples.
+ */
+double StreamStats_GetVariance( const StreamStats_t * pStats );
+
+/**
+ * @brief Get the sample standard deviation.
+ *
+ * @param[in] pStats pointer to stats state.
+ *
+ * @return the standard deviation or 0 with less than two samples.
+ */
+double StreamStats_GetStdDev( const StreamStats_t * pStats );
+
+/**
+ * @brief Get the mean weighted by the time each value was held.
+ *
+ * @param[in] pStats pointer to stats state.
+ *
+ * @return the time weighted mean, the plain mean before any time passed.
+ */
+double StreamStats_GetTimeWeightedMean( const StreamStats_t * pStats );
+
+#endif /* STREAM_STATS_H */
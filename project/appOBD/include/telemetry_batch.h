@@ -0,0 +1,155 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file telemetry_batch.h
+ * @brief Collects telemetry samples to be sent together in one message.
+ */
+
+#ifndef TELEMETRY_BATCH_H
+#define TELEMETRY_BATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "obd_config.h"
+
+/* Sample fields, the latitude and longitude are reported together. */
+typedef enum ObdSampleField
+{
+    OBD_SAMPLE_FIELD_POSITION = 0,
+    OBD_SAMPLE_FIELD_HEADING,
+    OBD_SAMPLE_FIELD_SPEED,
+    OBD_SAMPLE_FIELD_ODOMETER,
+    OBD_SAMPLE_FIELD_FUEL,
+    OBD_SAMPLE_FIELD_OIL_TEMP,
+    OBD_SAMPLE_FIELD_MAX
+} ObdSampleField_t;
+
+#define OBD_SAMPLE_FIELD_BIT( field )    ( ( uint8_t ) ( 1U << ( field ) ) )
+#define OBD_SAMPLE_FIELDS_ALL            ( ( uint8_t ) ( ( 1U << OBD_SAMPLE_FIELD_MAX ) - 1U ) )
+
+typedef struct ObdSample
+{
+    uint64_t timestampMs;   /* Uptime. */
+    uint8_t reported;       /* OBD_SAMPLE_FIELD_BIT of the fields with a new value. */
+    int32_t latitude;       /* Microdegree. */
+    int32_t longitude;      /* Microdegree. */
+    double heading;         /* Degree, 0 is north. */
+    double speed;           /* km/h */
+    double odometer;        /* km */
+    double fuel;            /* L */
+    double oilTemp;         /* Celsius. */
+} ObdSample_t;
+
+typedef struct TelemetryBatch
+{
+    ObdSample_t samples[ OBD_TELEMETRY_BATCH_MAX_SAMPLES ];
+    uint16_t count;
+    uint16_t maxSamples;    /* 0 until set, then OBD_TELEMETRY_BATCH_MAX_SAMPLES. */
+    uint32_t maxMs;
+} TelemetryBatch_t;
+
+typedef struct TelemetryDeadband
+{
+    ObdSample_t last;                                   /* Last reported value of each field. */
+    uint64_t lastReportMs[ OBD_SAMPLE_FIELD_MAX ];
+    bool started;
+} TelemetryDeadband_t;
+
+/**
+ * @brief Drop all samples, the limits are kept.
+ *
+ * @param[in] pBatch pointer to batch state.
+ */
+void TelemetryBatch_Init( TelemetryBatch_t * pBatch );
+
+/**
+ * @brief Change the batch limits.
+ *
+ * A batch already holding more samples becomes due at once.
+ *
+ * @param[in] pBatch pointer to batch state.
+ * @param[in] maxSamples up to OBD_TELEMETRY_BATCH_MAX_SAMPLES, larger is cut.
+ * @param[in] maxMs age of the first sample that makes the batch due.
+ */
+void TelemetryBatch_SetLimits( TelemetryBatch_t * pBatch,
+                               uint32_t maxSamples,
+                               uint32_t maxMs );
+
+/**
+ * @brief Add a sample.
+ *
+ * @param[in] pBatch pointer to batch state.
+ * @param[in] pSample the sample to copy.
+ *
+ * @return false if the batch is full.
+ */
+bool TelemetryBatch_Add( TelemetryBatch_t * pBatch,
+                         const ObdSample_t * pSample );
+
+/**
+ * @brief Check if the batch should be sent.
+ *
+ * A batch is due when it holds its maximum samples or the first sample is
+ * its maximum milliseconds old.
+ *
+ * @param[in] pBatch pointer to batch state.
+ * @param[in] nowMs uptime in milliseconds.
+ *
+ * @return true if the batch should be sent.
+ */
+bool TelemetryBatch_IsDue( const TelemetryBatch_t * pBatch,
+                           uint64_t nowMs );
+
+/**
+ * @brief Get the time of a sample relative to the first sample.
+ *
+ * @param[in] pBatch pointer to batch state.
+ * @param[in] index sample index.
+ *
+ * @return offset in milliseconds.
+ */
+uint32_t TelemetryBatch_GetOffsetMs( const TelemetryBatch_t * pBatch,
+                                     uint16_t index );
+
+/**
+ * @brief Forget the reported values, the next sample reports all fields.
+ *
+ * @param[in] pDeadband pointer to deadband state.
+ */
+void TelemetryDeadband_Init( TelemetryDeadband_t * pDeadband );
+
+/**
+ * @brief Decide which fields of a sample are reported.
+ *
+ * A field is reported when it moved beyond its deadband from the last
+ * reported value or was not reported for its heartbeat interval. The
+ * fields not reported are set back to their last reported value, so the
+ * receiver rebuilds the series by holding each field until its next report.
+ *
+ * @param[in] pDeadband pointer to deadband state.
+ * @param[in,out] pSample the sample, reported is set.
+ *
+ * @return false if no field is reported and the sample can be dropped.
+ */
+bool TelemetryDeadband_Filter( TelemetryDeadband_t * pDeadband,
+                               ObdSample_t * pSample );
+
+#endif /* TELEMETRY_BATCH_H */
@@ -0,0 +1,87 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file trip_checkpoint.h
+ * @brief Trip state saved to NVS to resume the trip after a reset.
+ *
+ * The telemetry task saves a checkpoint every TRIP_CHECKPOINT_INTERVAL_MS
+ * and at ignition off. A power loss or reset then costs at most the data of
+ * one interval, and a trip started again within TRIP_CHECKPOINT_MAX_GAP_MS
+ * keeps its id, start, distance, statistics, event counts and path. The
+ * window aggregates and the event rules start again, an event in progress
+ * at the reset is raised again if it goes on.
+ *
+ * The gap is measured on the wall clock, without GPS or NTP time no trip is
+ * resumed.
+ */
+
+#ifndef TRIP_CHECKPOINT_H
+#define TRIP_CHECKPOINT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "obd_data.h"
+#include "obd_context.h"
+
+typedef enum TripResume
+{
+    TRIP_RESUME_NONE = 0,       /* Start a new trip. */
+    TRIP_RESUME_CHECKPOINT,     /* Continue the trip of the checkpoint. */
+    TRIP_RESUME_ODOMETER        /* Continue the trip of the RTC memory, started after the checkpoint ended. */
+} TripResume_t;
+
+/**
+ * @brief Save a checkpoint over the previous one.
+ *
+ * @param[in] pCheckpoint the checkpoint.
+ *
+ * @return true if saved or false.
+ */
+bool TripCheckpoint_Save( const ObdTripCheckpoint_t * pCheckpoint );
+
+/**
+ * @brief Load the last checkpoint.
+ *
+ * @param[out] pCheckpoint pointer to receive the checkpoint.
+ *
+ * @return false if there is none or it was saved by another firmware layout.
+ */
+bool TripCheckpoint_Load( ObdTripCheckpoint_t * pCheckpoint );
+
+/**
+ * @brief Decide which trip to continue at ignition.
+ *
+ * A trip is continued only within TRIP_CHECKPOINT_MAX_GAP_MS of the last
+ * checkpoint. The trip kept in the RTC memory over a soft reset is only
+ * continued after an ended checkpoint, it started later and is newer.
+ *
+ * @param[in] pCheckpoint the loaded checkpoint, NULL if there is none.
+ * @param[in] pOdometerTripId trip id of the RTC memory, NULL if there is none.
+ * @param[in] clockValid true if the clock is synced to GPS or NTP.
+ * @param[in] nowEpochMs current time in milliseconds since 1970.
+ *
+ * @return the trip to continue.
+ */
+TripResume_t TripCheckpoint_GetResume( const ObdTripCheckpoint_t * pCheckpoint,
+                                       const char * pOdometerTripId,
+                                       bool clockValid,
+                                       uint64_t nowEpochMs );
+
+#endif /* TRIP_CHECKPOINT_H */
@@ -0,0 +1,135 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file trip_odometer.h
+ * @brief Trip distance integrated from GPS fixes and OBD vehicle speed.
+ */
+
+#ifndef TRIP_ODOMETER_H
+#define TRIP_ODOMETER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct TripOdometer
+{
+    uint64_t distanceMm;        /* Committed distance up to the anchor fix. */
+    uint32_t pendingSpeedMm;    /* Speed integrated distance since the anchor fix. */
+    int32_t anchorLatitude;     /* Microdegree. */
+    int32_t anchorLongitude;    /* Microdegree. */
+    uint32_t lastSpeedMs;
+    float lastSpeedMps;
+    bool hasAnchor;
+    bool hasSpeed;
+    bool active;                /* A trip is started or resumed. */
+} TripOdometer_t;
+
+/**
+ * @brief Reset the odometer to zero.
+ *
+ * Fixes and speeds are ignored until a trip is started or resumed.
+ *
+ * @param[in] pOdometer pointer to odometer state.
+ */
+void TripOdometer_Init( TripOdometer_t * pOdometer );
+
+/**
+ * @brief Start a new trip from zero and persist it.
+ *
+ * @param[in] pOdometer pointer to odometer state.
+ * @param[in] pTripId trip id saved with the distance.
+ */
+void TripOdometer_Start( TripOdometer_t * pOdometer,
+                         const char * pTripId );
+
+/**
+ * @brief Continue a trip from a saved distance and persist it.
+ *
+ * @param[in] pOdometer pointer to odometer state.
+ * @param[in] pTripId trip id saved with the distance.
+ * @param[in] distanceMm distance already driven.
+ */
+void TripOdometer_Continue( TripOdometer_t * pOdometer,
+                            const char * pTripId,
+                            uint64_t distanceMm );
+
+/**
+ * @brief Resume the trip that was running before a reset.
+ *
+ * The distance is kept in memory which survives a software reset, panic or
+ * watchdog reset, but not a power loss.
+ *
+ * @param[in] pOdometer pointer to odometer state.
+ * @param[out] pTripId buffer to receive the resumed trip id.
+ * @param[in] tripIdSize size of the trip id buffer.
+ *
+ * @return true if a trip is resumed or false.
+ */
+bool TripOdometer_Resume( TripOdometer_t * pOdometer,
+                          char * pTripId,
+                          size_t tripIdSize );
+
+/**
+ * @brief End the trip, it will not be resumed after a reset.
+ *
+ * Fixes and speeds are ignored until the next trip is started.
+ *
+ * @param[in] pOdometer pointer to odometer state.
+ */
+void TripOdometer_Stop( TripOdometer_t * pOdometer );
+
+/**
+ * @brief Accumulate the segment to a new GPS fix.
+ *
+ * Fixes with poor HDOP are skipped, the speed integration covers the gap.
+ * Segments shorter than the fix noise are held back so a parked car does not
+ * collect distance from jitter.
+ *
+ * @param[in] pOdometer pointer to odometer state.
+ * @param[in] latitude fix latitude in microdegree.
+ * @param[in] longitude fix longitude in microdegree.
+ * @param[in] hdop fix hdop in 0.1 unit.
+ */
+void TripOdometer_AddFix( TripOdometer_t * pOdometer,
+                          int32_t latitude,
+                          int32_t longitude,
+                          uint8_t hdop );
+
+/**
+ * @brief Integrate the OBD vehicle speed.
+ *
+ * @param[in] pOdometer pointer to odometer state.
+ * @param[in] speedKph vehicle speed in km/h.
+ * @param[in] nowMs current uptime in milisecond.
+ */
+void TripOdometer_AddSpeed( TripOdometer_t * pOdometer,
+                            float speedKph,
+                            uint32_t nowMs );
+
+/**
+ * @brief Get the trip distance.
+ *
+ * @param[in] pOdometer pointer to odometer state.
+ *
+ * @return the distance in millimetre.
+ */
+uint64_t TripOdometer_GetDistanceMm( const TripOdometer_t * pOdometer );
+
+#endif /* TRIP_ODOMETER_H */
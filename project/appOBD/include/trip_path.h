@@ -0,0 +1,103 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file trip_path.h
+ * @brief Streaming trajectory simplification for the trip path upload.
+ */
+
+#ifndef TRIP_PATH_H
+#define TRIP_PATH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "obd_config.h"
+
+typedef struct TripPathPoint
+{
+    int32_t latitude;   /* Microdegree. */
+    int32_t longitude;  /* Microdegree. */
+} TripPathPoint_t;
+
+typedef struct TripPath
+{
+    TripPathPoint_t points[ TRIP_PATH_MAX_POINTS ];     /* Significant points. */
+    TripPathPoint_t window[ TRIP_PATH_WINDOW_MAX ];     /* Points after the last significant one. */
+    uint16_t count;
+    uint16_t windowCount;
+    float toleranceM;
+} TripPath_t;
+
+/**
+ * @brief Clear the path.
+ *
+ * @param[in] pPath pointer to path state.
+ */
+void TripPath_Init( TripPath_t * pPath );
+
+/**
+ * @brief Add a position to the path.
+ *
+ * A point is kept only when the straight line from the last kept point can
+ * no longer represent the positions in between within the tolerance.
+ *
+ * @param[in] pPath pointer to path state.
+ * @param[in] latitude latitude in microdegree.
+ * @param[in] longitude longitude in microdegree.
+ */
+void TripPath_AddPoint( TripPath_t * pPath,
+                        int32_t latitude,
+                        int32_t longitude );
+
+/**
+ * @brief Keep the last added position as the end of the path.
+ *
+ * @param[in] pPath pointer to path state.
+ */
+void TripPath_Finish( TripPath_t * pPath );
+
+/**
+ * @brief Drop points by doubling the tolerance.
+ *
+ * @param[in] pPath pointer to path state.
+ *
+ * @return true if any point is dropped or false.
+ */
+bool TripPath_Compact( TripPath_t * pPath );
+
+/**
+ * @brief Encode the kept points with the encoded polyline algorithm.
+ *
+ * Coordinates are rounded to 1e-5 degree and delta encoded. The output is
+ * null terminated.
+ *
+ * @param[in] pPath pointer to path state.
+ * @param[in] pBuffer buffer to receive the encoded path.
+ * @param[in] bufferSize size of the buffer.
+ * @param[in] jsonEscape escape the output to be placed in a JSON string.
+ *
+ * @return the length of the encoded path or -1 if the buffer is too small.
+ */
+int32_t TripPath_Encode( const TripPath_t * pPath,
+                         char * pBuffer,
+                         size_t bufferSize,
+                         bool jsonEscape );
+
+#endif /* TRIP_PATH_H */
@@ -0,0 +1,110 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file trip_replay.h
+ * @brief Replay of a recorded trip in place of the vehicle.
+ *
+ * The replay is an OBD link device answering the commands of the OBD and
+ * GPS libraries from a log, so the responses go through the real parsing,
+ * aggregation, encoding and publishing. Every line of the log holds one
+ * response of the adapter:
+ *
+ *   <milliseconds> <command> <response>
+ *
+ * for example "1200 010D 41 0D 3C" or "1500 ATGRR $GNRMC,...\r\n$GNGGA,...".
+ * The response is the rest of the line without the "\r>" prompt, with \r,
+ * \n and \\ escaped. Lines starting with # are comments. A command is
+ * answered with its latest response at the time of the log, and with OK or
+ * NO DATA before it has one.
+ *
+ * The telemetry task and the clock service run on the clock of the replay, so
+ * the message times follow the log. At TRIP_REPLAY_SPEED 1 it is the uptime,
+ * at a higher speed the waits of the task are shortened and the clock skips
+ * the rest.
+ */
+
+#ifndef TRIP_REPLAY_H
+#define TRIP_REPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS_IO.h"
+
+/* Timed parts of the telemetry task. */
+typedef enum TripReplayStage
+{
+    TRIP_REPLAY_STAGE_ACQUIRE = 0,  /* OBD requests, parsing and decoding. */
+    TRIP_REPLAY_STAGE_GPS,          /* Fix, fusion and odometer. */
+    TRIP_REPLAY_STAGE_AGGREGATE,    /* Statistics, windows, events and samples. */
+    TRIP_REPLAY_STAGE_ENCODE,       /* Payloads built and queued to the publisher. */
+    TRIP_REPLAY_STAGE_STEP,         /* A whole step of the loop. */
+    TRIP_REPLAY_STAGE_MAX
+} TripReplayStage_t;
+
+/**
+ * @brief Open the log and start the clock of the replay.
+ *
+ * The log is read from the SD card, or from the host through semihosting
+ * when there is no file system.
+ *
+ * @param[in] speed times real time, 0 runs as fast as possible.
+ *
+ * @return the device to use as OBD device, NULL if the log cannot be read.
+ */
+Peripheral_Descriptor_t TripReplay_Open( uint32_t speed );
+
+/**
+ * @brief Get the time of the replay.
+ *
+ * @return the uptime plus the time skipped by TripReplay_WaitMs.
+ */
+uint32_t TripReplay_NowMs( void );
+
+/**
+ * @brief Wait for a time of the replay.
+ *
+ * @param[in] waitMs time to wait, shortened by the speed.
+ */
+void TripReplay_WaitMs( uint32_t waitMs );
+
+/**
+ * @brief Get a time stamp for TripReplay_AddStageTime.
+ *
+ * @return microseconds since boot.
+ */
+uint64_t TripReplay_GetTimeUs( void );
+
+/**
+ * @brief Account the run of a stage.
+ *
+ * Called from the telemetry task only.
+ *
+ * @param[in] stage the stage.
+ * @param[in] startUs time stamp taken before the stage.
+ */
+void TripReplay_AddStageTime( TripReplayStage_t stage,
+                              uint64_t startUs );
+
+/**
+ * @brief Log the throughput and the stage timings since the open.
+ */
+void TripReplay_Report( void );
+
+#endif /* TRIP_REPLAY_H */
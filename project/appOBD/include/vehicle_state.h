@@ -0,0 +1,109 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file vehicle_state.h
+ * @brief Driving state of the vehicle and the sampling rates of each state.
+ *
+ * The state comes from the ignition, the speed and the driving events in
+ * progress. A faster state is entered at once, a slower one only after it
+ * held for VEHICLE_STATE_DWELL_MS, so a short stop or a single event does
+ * not make the rates flap.
+ */
+
+#ifndef VEHICLE_STATE_H
+#define VEHICLE_STATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* In order of sampling rate. */
+typedef enum VehicleState
+{
+    VEHICLE_STATE_OFF = 0,      /* Parked, waiting for ignition. */
+    VEHICLE_STATE_IDLE,
+    VEHICLE_STATE_CITY,
+    VEHICLE_STATE_HIGHWAY,
+    VEHICLE_STATE_EVENT,        /* A driving event is in progress. */
+    VEHICLE_STATE_MAX
+} VehicleState_t;
+
+typedef struct VehicleStateProfile
+{
+    uint32_t collectIntervalMs;
+    uint32_t telemetryIntervalMs;
+    bool gpsActive;
+} VehicleStateProfile_t;
+
+typedef struct VehicleStateMachine
+{
+    VehicleState_t state;
+    VehicleState_t candidate;   /* Slower state waiting for its dwell time. */
+    uint64_t candidateSinceMs;
+} VehicleStateMachine_t;
+
+/**
+ * @brief Start in the off state.
+ *
+ * @param[in] pMachine pointer to state machine.
+ */
+void VehicleState_Init( VehicleStateMachine_t * pMachine );
+
+/**
+ * @brief Update the state.
+ *
+ * @param[in] pMachine pointer to state machine.
+ * @param[in] running true while the ignition is on.
+ * @param[in] speed vehicle speed in KM/hr.
+ * @param[in] eventActive true while a driving event is in progress.
+ * @param[in] nowMs uptime in milliseconds.
+ *
+ * @return true if the state changed.
+ */
+bool VehicleState_Update( VehicleStateMachine_t * pMachine,
+                          bool running,
+                          double speed,
+                          bool eventActive,
+                          uint64_t nowMs );
+
+/**
+ * @brief Get the rates of a state.
+ *
+ * The intervals scale the configured ones by the percentage of the state,
+ * the city state uses them as is.
+ *
+ * @param[in] state the state.
+ * @param[in] collectIntervalMs configured collect interval.
+ * @param[in] telemetryIntervalMs configured telemetry interval.
+ * @param[out] pProfile pointer to receive the rates.
+ */
+void VehicleState_GetProfile( VehicleState_t state,
+                              uint32_t collectIntervalMs,
+                              uint32_t telemetryIntervalMs,
+                              VehicleStateProfile_t * pProfile );
+
+/**
+ * @brief Get the name of a state.
+ *
+ * @param[in] state the state.
+ *
+ * @return null terminated name.
+ */
+const char * VehicleState_GetName( VehicleState_t state );
+
+#endif /* VEHICLE_STATE_H */
@@ -0,0 +1,127 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file window_aggregate.h
+ * @brief Tumbling and sliding window aggregates of the telemetry signals.
+ *
+ * Values are summed into the open bucket of a small ring. Closing the bucket
+ * gives the tumbling window, and merging the last closed buckets gives the
+ * sliding window, which moves by one bucket each time. Nothing is kept per
+ * sample.
+ */
+
+#ifndef WINDOW_AGGREGATE_H
+#define WINDOW_AGGREGATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "obd_config.h"
+
+#define WINDOW_AGGREGATE_MAX_SIGNALS    ( 8U )
+
+typedef struct WindowSummary
+{
+    uint32_t count;
+    double sum;
+    double min;
+    double max;
+} WindowSummary_t;
+
+typedef struct WindowBucket
+{
+    uint64_t startMs;   /* Uptime. */
+    uint64_t endMs;
+    WindowSummary_t signals[ WINDOW_AGGREGATE_MAX_SIGNALS ];
+} WindowBucket_t;
+
+typedef struct WindowAggregate
+{
+    WindowBucket_t buckets[ OBD_AGGREGATED_SLIDING_WINDOWS + 1U ];  /* Closed ones and the open one. */
+    uint32_t open;      /* Index of the open bucket. */
+    uint32_t closed;    /* Number of closed buckets, up to OBD_AGGREGATED_SLIDING_WINDOWS. */
+} WindowAggregate_t;
+
+/**
+ * @brief Drop all buckets and open the first one.
+ *
+ * @param[in] pWindow pointer to window state.
+ * @param[in] nowMs uptime in milliseconds.
+ */
+void WindowAggregate_Init( WindowAggregate_t * pWindow,
+                           uint64_t nowMs );
+
+/**
+ * @brief Add a value to the open bucket.
+ *
+ * @param[in] pWindow pointer to window state.
+ * @param[in] signal signal index below WINDOW_AGGREGATE_MAX_SIGNALS.
+ * @param[in] value the value.
+ */
+void WindowAggregate_Add( WindowAggregate_t * pWindow,
+                          uint32_t signal,
+                          double value );
+
+/**
+ * @brief Check if the open bucket covers OBD_AGGREGATED_DATA_INTERVAL_MS.
+ *
+ * @param[in] pWindow pointer to window state.
+ * @param[in] nowMs uptime in milliseconds.
+ *
+ * @return true if the bucket should be closed.
+ */
+bool WindowAggregate_IsDue( const WindowAggregate_t * pWindow,
+                            uint64_t nowMs );
+
+/**
+ * @brief Close the open bucket and open the next one.
+ *
+ * @param[in] pWindow pointer to window state.
+ * @param[in] nowMs uptime in milliseconds.
+ */
+void WindowAggregate_Close( WindowAggregate_t * pWindow,
+                            uint64_t nowMs );
+
+/**
+ * @brief Get the last closed bucket of a signal.
+ *
+ * @param[in] pWindow pointer to window state.
+ * @param[in] signal signal index.
+ * @param[out] pSummary the summary, count 0 when empty.
+ *
+ * @return the duration of the window in milliseconds.
+ */
+uint64_t WindowAggregate_GetTumbling( const WindowAggregate_t * pWindow,
+                                      uint32_t signal,
+                                      WindowSummary_t * pSummary );
+
+/**
+ * @brief Get the closed buckets of a signal merged together.
+ *
+ * @param[in] pWindow pointer to window state.
+ * @param[in] signal signal index.
+ * @param[out] pSummary the summary, count 0 when empty.
+ *
+ * @return the duration of the window in milliseconds.
+ */
+uint64_t WindowAggregate_GetSliding( const WindowAggregate_t * pWindow,
+                                     uint32_t signal,
+                                     WindowSummary_t * pSummary );
+
+#endif /* WINDOW_AGGREGATE_H */
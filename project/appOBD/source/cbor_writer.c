@@ -0,0 +1,555 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file cbor_writer.c
+ * @brief Implementation of the bounded streaming CBOR writer.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "../include/cbor_writer.h"
+
+/*-----------------------------------------------------------*/
+
+#define CBOR_MAJOR_UNSIGNED         ( 0x00U )
+#define CBOR_MAJOR_NEGATIVE         ( 0x20U )
+#define CBOR_MAJOR_BYTES            ( 0x40U )
+#define CBOR_MAJOR_TEXT             ( 0x60U )
+#define CBOR_MAJOR_ARRAY            ( 0x80U )
+#define CBOR_MAJOR_MAP              ( 0xA0U )
+#define CBOR_MAJOR_TAG              ( 0xC0U )
+
+#define CBOR_INDEFINITE             ( 0x1FU )
+#define CBOR_BREAK                  ( 0xFFU )
+#define CBOR_NULL                   ( 0xF6U )
+#define CBOR_FLOAT16                ( 0xF9U )
+#define CBOR_FLOAT32                ( 0xFAU )
+#define CBOR_FLOAT64                ( 0xFBU )
+#define CBOR_TAG_DECIMAL_FRACTION   ( 4U )
+
+/* Header of a text string written in place, always with a 16 bit length. */
+#define CBOR_TEXT16_HEADER_SIZE     ( 3U )
+
+#define CBOR_DECIMALS_MAX           ( 9U )
+
+/* Integers beyond 2^53 are not exact in a double. */
+#define CBOR_EXACT_INTEGER_LIMIT    ( 9007199254740992.0 )
+
+static const uint32_t powersOfTen[ CBOR_DECIMALS_MAX + 1U ] =
+{
+    1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
+
+/*-----------------------------------------------------------*/
+
+static void prvPutData( CborWriter_t * pWriter,
+                        const uint8_t * pData,
+                        size_t length )
+{
+    if( ( pWriter->length + length ) <= pWriter->bufferSize )
+    {
+        memcpy( &pWriter->pBuffer[ pWriter->length ], pData, length );
+        pWriter->length = pWriter->length + length;
+    }
+    else
+    {
+        pWriter->overflow = true;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPutByte( CborWriter_t * pWriter,
+                        uint8_t value )
+{
+    prvPutData( pWriter, &value, 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Major type with the shortest argument encoding. */
+static void prvPutHead( CborWriter_t * pWriter,
+                        uint8_t major,
+                        uint64_t argument )
+{
+    uint8_t head[ 9 ];
+    size_t size = 0;
+    size_t i = 0;
+
+    if( argument < 24U )
+    {
+        head[ 0 ] = ( uint8_t ) ( major | ( uint8_t ) argument );
+        size = 1;
+    }
+    else if( argument <= 0xFFU )
+    {
+        head[ 0 ] = ( uint8_t ) ( major | 24U );
+        size = 2;
+    }
+    else if( argument <= 0xFFFFU )
+    {
+        head[ 0 ] = ( uint8_t ) ( major | 25U );
+        size = 3;
+    }
+    else if( argument <= 0xFFFFFFFFUL )
+    {
+        head[ 0 ] = ( uint8_t ) ( major | 26U );
+        size = 5;
+    }
+    else
+    {
+        head[ 0 ] = ( uint8_t ) ( major | 27U );
+        size = 9;
+    }
+
+    /* Big endian argument. */
+    for( i = size - 1U; i > 0U; i-- )
+    {
+        head[ i ] = ( uint8_t ) ( argument & 0xFFU );
+        argument >>= 8;
+    }
+
+    prvPutData( pWriter, head, size );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPutInt( CborWriter_t * pWriter,
+                       int64_t value )
+{
+    if( value < 0 )
+    {
+        /* -1 - n, also right for INT64_MIN. */
+        prvPutHead( pWriter, CBOR_MAJOR_NEGATIVE, ( uint64_t ) ( -( value + 1 ) ) );
+    }
+    else
+    {
+        prvPutHead( pWriter, CBOR_MAJOR_UNSIGNED, ( uint64_t ) value );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPutKey( CborWriter_t * pWriter,
+                       uint16_t key )
+{
+    pWriter->hasMember[ pWriter->depth ] = true;
+
+    if( key != CBOR_WRITER_NO_KEY )
+    {
+        prvPutHead( pWriter, CBOR_MAJOR_UNSIGNED, key );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvOpen( CborWriter_t * pWriter,
+                     uint16_t key,
+                     uint8_t major )
+{
+    size_t openLength = pWriter->length;
+    bool hadMember = pWriter->hasMember[ pWriter->depth ];
+
+    prvPutKey( pWriter, key );
+    prvPutByte( pWriter, ( uint8_t ) ( major | CBOR_INDEFINITE ) );
+
+    if( pWriter->depth < ( CBOR_WRITER_DEPTH_MAX - 1U ) )
+    {
+        pWriter->depth = pWriter->depth + 1U;
+        pWriter->hasMember[ pWriter->depth ] = false;
+        pWriter->openLength[ pWriter->depth ] = openLength;
+        pWriter->openHadMember[ pWriter->depth ] = hadMember;
+    }
+    else
+    {
+        pWriter->overflow = true;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvClose( CborWriter_t * pWriter )
+{
+    uint8_t depth = pWriter->depth;
+
+    if( depth == 0U )
+    {
+        pWriter->overflow = true;
+        return;
+    }
+
+    pWriter->depth = depth - 1U;
+
+    if( ( pWriter->hasMember[ depth ] == false ) && ( depth > 1U ) )
+    {
+        /* Take back the key and the opening byte. */
+        pWriter->length = pWriter->openLength[ depth ];
+        pWriter->hasMember[ depth - 1U ] = pWriter->openHadMember[ depth ];
+    }
+    else
+    {
+        prvPutByte( pWriter, CBOR_BREAK );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static uint16_t prvFloatToHalf( float value )
+{
+    uint32_t bits = 0;
+    uint32_t sign = 0;
+    uint32_t mantissa = 0;
+    int32_t exponent = 0;
+    uint32_t shift = 0;
+    uint32_t half = 0;
+
+    memcpy( &bits, &value, sizeof( bits ) );
+    sign = ( bits >> 16 ) & 0x8000U;
+    exponent = ( int32_t ) ( ( bits >> 23 ) & 0xFFU ) - 127 + 15;
+    mantissa = bits & 0x7FFFFFU;
+
+    if( exponent >= 31 )
+    {
+        /* Too large, infinity fails the precision check. */
+        half = sign | 0x7C00U;
+    }
+    else if( exponent <= 0 )
+    {
+        if( exponent < -10 )
+        {
+            half = sign;
+        }
+        else
+        {
+            /* Subnormal, round to nearest. */
+            mantissa = mantissa | 0x800000U;
+            shift = ( uint32_t ) ( 14 - exponent );
+            half = sign | ( mantissa >> shift );
+            half = half + ( ( mantissa >> ( shift - 1U ) ) & 1U );
+        }
+    }
+    else
+    {
+        /* A carry out of the mantissa correctly bumps the exponent. */
+        half = sign | ( ( uint32_t ) exponent << 10 ) | ( mantissa >> 13 );
+        half = half + ( ( mantissa >> 12 ) & 1U );
+    }
+
+    return ( uint16_t ) half;
+}
+
+/*-----------------------------------------------------------*/
+
+static float prvHalfToFloat( uint16_t half )
+{
+    int32_t exponent = ( int32_t ) ( ( half >> 10 ) & 0x1FU );
+    int32_t mantissa = ( int32_t ) ( half & 0x3FFU );
+    float value = 0.0f;
+
+    if( exponent == 0 )
+    {
+        value = ldexpf( ( float ) mantissa, -24 );
+    }
+    else if( exponent == 31 )
+    {
+        value = INFINITY;
+    }
+    else
+    {
+        value = ldexpf( ( float ) ( mantissa | 0x400 ), exponent - 25 );
+    }
+
+    return ( ( half & 0x8000U ) != 0U ) ? -value : value;
+}
+
+/*-----------------------------------------------------------*/
+
+void CborWriter_Init( CborWriter_t * pWriter,
+                      uint8_t * pBuffer,
+                      size_t bufferSize,
+                      uint8_t version )
+{
+    memset( pWriter, 0, sizeof( CborWriter_t ) );
+    pWriter->pBuffer = pBuffer;
+    pWriter->bufferSize = bufferSize;
+    prvPutByte( pWriter, version );
+}
+
+/*-----------------------------------------------------------*/
+
+void CborWriter_BeginMap( CborWriter_t * pWriter,
+                          uint16_t key )
+{
+    prvOpen( pWriter, key, CBOR_MAJOR_MAP );
+}
+
+/*-----------------------------------------------------------*/
+
+void CborWriter_EndMap( CborWriter_t * pWriter )
+{
+    prvClose( pWriter );
+}
+
+/*-----------------------------------------------------------*/
+
+void CborWriter_BeginArray( CborWriter_t * pWriter,
+                            uint16_t key )
+{
+    prvOpen( pWriter, key, CBOR_MAJOR_ARRAY );
+}
+
+/*-----------------------------------------------------------*/
+
+void CborWriter_EndArray( CborWriter_t * pWriter )
+{
+    prvClose( pWriter );
+}
+
+/*-----------------------------------------------------------*/
+
+void CborWriter_AddText( CborWriter_t * pWriter,
+                         uint16_t key,
+                         const char * pValue )
+{
+    size_t length = strlen( pValue );
+
+    if( ( length > 0U ) || ( key == CBOR_WRITER_NO_KEY ) )
+    {
+        prvPutKey( pWriter, key );
+        prvPutHead( pWriter, CBOR_MAJOR_TEXT, length );
+        prvPutData( pWriter, ( const uint8_t * ) pValue, length );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void CborWriter_AddBytes( CborWriter_t * pWriter,
+                          uint16_t key,
+                          const uint8_t * pData,
+                          size_t length )
+{
+    if( ( length > 0U ) || ( key == CBOR_WRITER_NO_KEY ) )
+    {
+        prvPutKey( pWriter, key );
+        prvPutHead( pWriter, CBOR_MAJOR_BYTES, length );
+        prvPutData( pWriter, pData, length );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+char * CborWriter_BeginText( CborWriter_t * pWriter,
+                             uint16_t key,
+                             size_t * pAvailable )
+{
+    char * pPosition = NULL;
+
+    pWriter->stringOpenLength = pWriter->length;
+    *pAvailable = 0;
+
+    if( key != CBOR_WRITER_NO_KEY )
+    {
+        prvPutHead( pWriter, CBOR_MAJOR_UNSIGNED, key );
+    }
+
+    pWriter->stringDataLength = pWriter->length + CBOR_TEXT16_HEADER_SIZE;
+
+    if( ( pWriter->overflow == false ) && ( pWriter->stringDataLength < pWriter->bufferSize ) )
+    {
+        pPosition = ( char * ) &pWriter->pBuffer[ pWriter->stringDataLength ];
+        *pAvailable = pWriter->bufferSize - pWriter->stringDataLength;
+
+        if( *pAvailable > 0xFFFFU )
+        {
+            *pAvailable = 0xFFFFU;
+        }
+    }
+
+    return pPosition;
+}
+
+/*-----------------------------------------------------------*/
+
+void CborWriter_EndText( CborWriter_t * pWriter,
+                         size_t length )
+{
+    if( length == 0U )
+    {
+        pWriter->length = pWriter->stringOpenLength;
+    }
+    else if( ( pWriter->stringDataLength + length ) <= pWriter->bufferSize )
+    {
+        /* Not the shortest head, but valid CBOR. */
+        pWriter->pBuffer[ pWriter->stringDataLength - 3U ] = ( uint8_t ) ( CBOR_MAJOR_TEXT | 25U );
+        pWriter->pBuffer[ pWriter->stringDataLength - 2U ] = ( uint8_t ) ( length >> 8 );
+        pWriter->pBuffer[ pWriter->stringDataLength - 1U ] = ( uint8_t ) ( length & 0xFFU );
+        pWriter->length = pWriter->stringDataLength + length;
+        pWriter->hasMember[ pWriter->depth ] = true;
+    }
+    else
+    {
+        pWriter->length = pWriter->stringOpenLength;
+        pWriter->overflow = true;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void CborWriter_AddInt( CborWriter_t * pWriter,
+                        uint16_t key,
+                        int64_t value )
+{
+    prvPutKey( pWriter, key );
+    prvPutInt( pWriter, value );
+}
+
+/*-----------------------------------------------------------*/
+
+void CborWriter_AddDecimal( CborWriter_t * pWriter,
+                            uint16_t key,
+                            int64_t value,
+                            uint8_t decimals )
+{
+    while( ( decimals > 0U ) && ( ( value % 10 ) == 0 ) )
+    {
+        value = value / 10;
+        decimals = decimals - 1U;
+    }
+
+    prvPutKey( pWriter, key );
+
+    if( decimals == 0U )
+    {
+        prvPutInt( pWriter, value );
+    }
+    else
+    {
+        /* 4([-decimals, value]) */
+        prvPutHead( pWriter, CBOR_MAJOR_TAG, CBOR_TAG_DECIMAL_FRACTION );
+        prvPutHead( pWriter, CBOR_MAJOR_ARRAY, 2 );
+        prvPutInt( pWriter, -( int64_t ) decimals );
+        prvPutInt( pWriter, value );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void CborWriter_AddNumber( CborWriter_t * pWriter,
+                           uint16_t key,
+                           double value,
+                           uint8_t decimals )
+{
+    uint8_t data[ 9 ];
+    double scale = 0.0;
+    double rounded = 0.0;
+    float tolerance = 0.0f;
+    float single = 0.0f;
+    uint16_t half = 0;
+    uint32_t bits32 = 0;
+    uint64_t bits64 = 0;
+    size_t i = 0;
+
+    if( isnan( value ) )
+    {
+        CborWriter_AddNull( pWriter, key );
+        return;
+    }
+
+    if( decimals > CBOR_DECIMALS_MAX )
+    {
+        decimals = CBOR_DECIMALS_MAX;
+    }
+
+    scale = ( double ) powersOfTen[ decimals ];
+    rounded = round( value * scale ) / scale;
+    tolerance = 0.5f / ( float ) scale;
+    single = ( float ) rounded;
+    prvPutKey( pWriter, key );
+
+    if( ( rounded == floor( rounded ) ) && ( fabs( rounded ) < CBOR_EXACT_INTEGER_LIMIT ) )
+    {
+        prvPutInt( pWriter, ( int64_t ) rounded );
+        return;
+    }
+
+    half = prvFloatToHalf( single );
+
+    if( fabsf( prvHalfToFloat( half ) - single ) <= tolerance )
+    {
+        data[ 0 ] = CBOR_FLOAT16;
+        data[ 1 ] = ( uint8_t ) ( half >> 8 );
+        data[ 2 ] = ( uint8_t ) ( half & 0xFFU );
+        prvPutData( pWriter, data, 3 );
+    }
+    else if( fabs( ( double ) single - rounded ) <= ( double ) tolerance )
+    {
+        memcpy( &bits32, &single, sizeof( bits32 ) );
+        data[ 0 ] = CBOR_FLOAT32;
+
+        for( i = 0; i < 4U; i++ )
+        {
+            data[ 4U - i ] = ( uint8_t ) ( bits32 >> ( 8U * i ) );
+        }
+
+        prvPutData( pWriter, data, 5 );
+    }
+    else
+    {
+        memcpy( &bits64, &rounded, sizeof( bits64 ) );
+        data[ 0 ] = CBOR_FLOAT64;
+
+        for( i = 0; i < 8U; i++ )
+        {
+            data[ 8U - i ] = ( uint8_t ) ( bits64 >> ( 8U * i ) );
+        }
+
+        prvPutData( pWriter, data, 9 );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void CborWriter_AddNull( CborWriter_t * pWriter,
+                         uint16_t key )
+{
+    if( key == CBOR_WRITER_NO_KEY )
+    {
+        prvPutKey( pWriter, key );
+        prvPutByte( pWriter, CBOR_NULL );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t CborWriter_Finish( const CborWriter_t * pWriter )
+{
+    int32_t length = -1;
+
+    if( ( pWriter->overflow == false ) && ( pWriter->depth == 0U ) )
+    {
+        length = ( int32_t ) pWriter->length;
+    }
+
+    return length;
+}
+
+/*-----------------------------------------------------------*/
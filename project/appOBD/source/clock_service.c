@@ -0,0 +1,296 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file clock_service.c
+ * @brief Implementation of the UTC clock.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "../include/clock_service.h"
+#include "../include/obd_config.h"
+
+#if ( TRIP_REPLAY_ENABLE == 1 )
+    #include "../include/trip_replay.h"
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* The ticks of the telemetry task, a replay passes its own clock to
+ * ClockService_TicksToEpochMs. */
+#if ( TRIP_REPLAY_ENABLE == 1 )
+    #define xTaskGetTickCountMs()       TripReplay_NowMs()
+#else
+    #define xTaskGetTickCountMs()       ( uint32_t ) ( xTaskGetTickCount() * portTICK_PERIOD_MS )
+#endif
+
+#define CLOCK_MS_PER_DAY                ( 86400000ULL )
+#define CLOCK_MS_PER_HOUR               ( 3600000ULL )
+
+/* Length of the cached "YYYY-MM-DDTHH:" prefix. */
+#define CLOCK_PREFIX_LENGTH             ( 14U )
+
+typedef struct ClockState
+{
+    uint64_t uptimeMs;          /* Tick count extended to 64 bits. */
+    uint32_t lastTicksMs;
+    int64_t offsetMs;           /* UTC minus uptime. */
+    ClockSource_t source;
+    uint64_t lastSyncMs;        /* Uptime. */
+    uint64_t cachedHour;        /* Hours since 1970 of the cached prefix. */
+    char cachedPrefix[ CLOCK_PREFIX_LENGTH + 1U ];
+} ClockState_t;
+
+/*-----------------------------------------------------------*/
+
+static ClockState_t clockState;
+
+/*-----------------------------------------------------------*/
+
+static uint64_t updateUptime( void )
+{
+    uint32_t ticksMs = xTaskGetTickCountMs();
+
+    /* Unsigned difference is right across the 32-bit wrap. */
+    clockState.uptimeMs = clockState.uptimeMs + ( uint32_t ) ( ticksMs - clockState.lastTicksMs );
+    clockState.lastTicksMs = ticksMs;
+
+    return clockState.uptimeMs;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Days since 1970-01-01 of a civil date, valid from year 2000. */
+static uint32_t daysFromCivil( uint32_t year,
+                               uint32_t month,
+                               uint32_t day )
+{
+    uint32_t era = 0;
+    uint32_t yearOfEra = 0;
+    uint32_t dayOfYear = 0;
+
+    year = ( month <= 2U ) ? ( year - 1U ) : year;
+    era = year / 400U;
+    yearOfEra = year - ( era * 400U );
+    dayOfYear = ( ( 153U * ( ( month > 2U ) ? ( month - 3U ) : ( month + 9U ) ) ) + 2U ) / 5U + day - 1U;
+
+    return ( era * 146097U ) + ( yearOfEra * 365U ) + ( yearOfEra / 4U ) - ( yearOfEra / 100U ) + dayOfYear - 719468U;
+}
+
+/*-----------------------------------------------------------*/
+
+static void civilFromDays( uint32_t days,
+                           uint32_t * pYear,
+                           uint32_t * pMonth,
+                           uint32_t * pDay )
+{
+    uint32_t shifted = days + 719468U;
+    uint32_t era = shifted / 146097U;
+    uint32_t dayOfEra = shifted - ( era * 146097U );
+    uint32_t yearOfEra = ( dayOfEra - ( dayOfEra / 1460U ) + ( dayOfEra / 36524U ) - ( dayOfEra / 146096U ) ) / 365U;
+    uint32_t dayOfYear = dayOfEra - ( ( 365U * yearOfEra ) + ( yearOfEra / 4U ) - ( yearOfEra / 100U ) );
+    uint32_t monthIndex = ( ( 5U * dayOfYear ) + 2U ) / 153U;
+
+    *pDay = dayOfYear - ( ( ( 153U * monthIndex ) + 2U ) / 5U ) + 1U;
+    *pMonth = ( monthIndex < 10U ) ? ( monthIndex + 3U ) : ( monthIndex - 9U );
+    *pYear = yearOfEra + ( era * 400U ) + ( ( *pMonth <= 2U ) ? 1U : 0U );
+}
+
+/*-----------------------------------------------------------*/
+
+static void formatDigits( char * pBuffer,
+                          uint32_t value,
+                          uint32_t digits )
+{
+    while( digits > 0U )
+    {
+        digits = digits - 1U;
+        pBuffer[ digits ] = ( char ) ( '0' + ( value % 10U ) );
+        value = value / 10U;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Step to a better or stale source or on a large error, else slew a part of the error. */
+static bool syncClock( ClockSource_t source,
+                       uint64_t epochMs,
+                       uint64_t atUptimeMs )
+{
+    uint64_t uptimeMs = updateUptime();
+    int64_t errorMs = ( int64_t ) epochMs - ( ( int64_t ) atUptimeMs + clockState.offsetMs );
+    bool stale = ( uptimeMs - clockState.lastSyncMs ) > CLOCK_SERVICE_SOURCE_HOLD_MS;
+    bool synced = true;
+
+    if( ( source > clockState.source ) || ( stale == true ) ||
+        ( ( source == clockState.source ) &&
+          ( ( errorMs > CLOCK_SERVICE_STEP_MS ) || ( errorMs < -CLOCK_SERVICE_STEP_MS ) ) ) )
+    {
+        clockState.offsetMs = ( int64_t ) epochMs - ( int64_t ) atUptimeMs;
+        clockState.source = source;
+    }
+    else if( source == clockState.source )
+    {
+        clockState.offsetMs = clockState.offsetMs + ( errorMs / CLOCK_SERVICE_SLEW_DIVISOR );
+    }
+    else
+    {
+        synced = false;
+    }
+
+    if( synced == true )
+    {
+        clockState.lastSyncMs = uptimeMs;
+    }
+
+    return synced;
+}
+
+/*-----------------------------------------------------------*/
+
+void ClockService_Init( void )
+{
+    memset( &clockState, 0, sizeof( ClockState_t ) );
+    clockState.lastTicksMs = xTaskGetTickCountMs();
+    clockState.uptimeMs = clockState.lastTicksMs;
+    clockState.source = CLOCK_SOURCE_UPTIME;
+    clockState.cachedHour = UINT64_MAX;
+}
+
+/*-----------------------------------------------------------*/
+
+bool ClockService_SyncGps( const ObdGpsData_t * pGpsData,
+                           uint32_t fixAgeMs )
+{
+    uint32_t day = pGpsData->date / 10000U;
+    uint32_t month = ( pGpsData->date / 100U ) % 100U;
+    uint32_t year = ( pGpsData->date % 100U ) + 2000U;
+    uint32_t hours = pGpsData->time / 1000000U;
+    uint32_t minutes = ( pGpsData->time % 1000000U ) / 10000U;
+    uint32_t seconds = ( pGpsData->time % 10000U ) / 100U;
+    uint32_t centiseconds = pGpsData->time % 100U;
+    uint64_t epochMs = 0;
+    bool synced = false;
+
+    /* The receiver sends an empty date until it has the almanac time. */
+    if( ( day >= 1U ) && ( day <= 31U ) && ( month >= 1U ) && ( month <= 12U ) &&
+        ( hours < 24U ) && ( minutes < 60U ) && ( seconds < 60U ) )
+    {
+        epochMs = ( ( uint64_t ) daysFromCivil( year, month, day ) * CLOCK_MS_PER_DAY ) +
+                  ( ( uint64_t ) ( ( hours * 3600U ) + ( minutes * 60U ) + seconds ) * 1000U ) +
+                  ( ( uint64_t ) centiseconds * 10U );
+        synced = syncClock( CLOCK_SOURCE_GPS, epochMs, updateUptime() - fixAgeMs );
+    }
+
+    return synced;
+}
+
+/*-----------------------------------------------------------*/
+
+bool ClockService_SyncNtp( void )
+{
+    struct timeval now = { 0 };
+    bool synced = false;
+
+    /* Read the system time without the calendar conversion of localtime. */
+    if( ( gettimeofday( &now, NULL ) == 0 ) && ( now.tv_sec >= CLOCK_SERVICE_MIN_EPOCH_S ) )
+    {
+        synced = syncClock( CLOCK_SOURCE_NTP,
+                            ( ( uint64_t ) now.tv_sec * 1000U ) + ( ( uint64_t ) now.tv_usec / 1000U ),
+                            updateUptime() );
+    }
+
+    return synced;
+}
+
+/*-----------------------------------------------------------*/
+
+uint64_t ClockService_NowMs( void )
+{
+    return ( uint64_t ) ( ( int64_t ) updateUptime() + clockState.offsetMs );
+}
+
+/*-----------------------------------------------------------*/
+
+uint64_t ClockService_TicksToEpochMs( uint32_t ticksMs )
+{
+    uint64_t nowMs = ClockService_NowMs();
+
+    return nowMs - ( uint32_t ) ( clockState.lastTicksMs - ticksMs );
+}
+
+/*-----------------------------------------------------------*/
+
+ClockSource_t ClockService_GetSource( void )
+{
+    return clockState.source;
+}
+
+/*-----------------------------------------------------------*/
+
+size_t ClockService_Format( uint64_t epochMs,
+                            char * pBuffer,
+                            size_t bufferLength )
+{
+    uint64_t hour = epochMs / CLOCK_MS_PER_HOUR;
+    uint32_t msOfHour = ( uint32_t ) ( epochMs % CLOCK_MS_PER_HOUR );
+    uint32_t year = 0;
+    uint32_t month = 0;
+    uint32_t day = 0;
+
+    if( bufferLength <= CLOCK_SERVICE_ISO_TIME_LENGTH )
+    {
+        return 0;
+    }
+
+    if( hour != clockState.cachedHour )
+    {
+        civilFromDays( ( uint32_t ) ( hour / 24U ), &year, &month, &day );
+        formatDigits( &clockState.cachedPrefix[ 0 ], year, 4U );
+        clockState.cachedPrefix[ 4 ] = '-';
+        formatDigits( &clockState.cachedPrefix[ 5 ], month, 2U );
+        clockState.cachedPrefix[ 7 ] = '-';
+        formatDigits( &clockState.cachedPrefix[ 8 ], day, 2U );
+        clockState.cachedPrefix[ 10 ] = 'T';
+        formatDigits( &clockState.cachedPrefix[ 11 ], ( uint32_t ) ( hour % 24U ), 2U );
+        clockState.cachedPrefix[ 13 ] = ':';
+        clockState.cachedPrefix[ CLOCK_PREFIX_LENGTH ] = '\0';
+        clockState.cachedHour = hour;
+    }
+
+    /* MM:SS.ssssZ, the fraction keeps the four digits sent so far. */
+    memcpy( pBuffer, clockState.cachedPrefix, CLOCK_PREFIX_LENGTH );
+    formatDigits( &pBuffer[ 14 ], msOfHour / 60000U, 2U );
+    pBuffer[ 16 ] = ':';
+    formatDigits( &pBuffer[ 17 ], ( msOfHour / 1000U ) % 60U, 2U );
+    pBuffer[ 19 ] = '.';
+    formatDigits( &pBuffer[ 20 ], ( msOfHour % 1000U ) * 10U, 4U );
+    pBuffer[ 24 ] = 'Z';
+    pBuffer[ CLOCK_SERVICE_ISO_TIME_LENGTH ] = '\0';
+
+    return CLOCK_SERVICE_ISO_TIME_LENGTH;
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,146 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file event_engine.c
+ * @brief Implementation of the driving event rules.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../include/event_engine.h"
+
+/*-----------------------------------------------------------*/
+
+/* How far the value is beyond the threshold, negative when within. */
+static double getExcess( const EventRule_t * pRule,
+                         double value )
+{
+    return ( pRule->compare == EVENT_RULE_ABOVE ) ? ( value - pRule->threshold ) : ( pRule->threshold - value );
+}
+
+/*-----------------------------------------------------------*/
+
+void EventEngine_Init( EventEngine_t * pEngine,
+                       const EventRule_t * pRules,
+                       uint32_t ruleCount )
+{
+    pEngine->pRules = pRules;
+    pEngine->ruleCount = ( ruleCount > EVENT_ENGINE_MAX_RULES ) ? EVENT_ENGINE_MAX_RULES : ruleCount;
+    EventEngine_Reset( pEngine );
+}
+
+/*-----------------------------------------------------------*/
+
+void EventEngine_Reset( EventEngine_t * pEngine )
+{
+    memset( pEngine->states, 0, sizeof( pEngine->states ) );
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t EventEngine_Update( EventEngine_t * pEngine,
+                             uint32_t signal,
+                             double value,
+                             uint64_t timeMs,
+                             Event_t * pEvents,
+                             uint32_t maxEvents )
+{
+    const EventRule_t * pRule = NULL;
+    EventRuleState_t * pState = NULL;
+    uint32_t eventCount = 0;
+    uint32_t i = 0;
+    double excess = 0.0;
+
+    for( i = 0; i < pEngine->ruleCount; i++ )
+    {
+        pRule = &pEngine->pRules[ i ];
+        pState = &pEngine->states[ i ];
+
+        if( pRule->signal != signal )
+        {
+            continue;
+        }
+
+        excess = getExcess( pRule, value );
+
+        if( excess >= 0.0 )
+        {
+            if( pState->beyond == false )
+            {
+                pState->beyond = true;
+                pState->startMs = timeMs;
+                pState->peak = value;
+            }
+            else if( getExcess( pRule, pState->peak ) < excess )
+            {
+                pState->peak = value;
+            }
+            else
+            {
+                /* Empty Else MISRA 15.7 */
+            }
+
+            if( ( pState->raised == false ) &&
+                ( ( timeMs - pState->startMs ) >= pRule->minDurationMs ) &&
+                ( eventCount < maxEvents ) )
+            {
+                pState->raised = true;
+                pEvents[ eventCount ].rule = i;
+                pEvents[ eventCount ].startMs = pState->startMs;
+                pEvents[ eventCount ].durationMs = ( uint32_t ) ( timeMs - pState->startMs );
+                pEvents[ eventCount ].peak = pState->peak;
+                eventCount++;
+            }
+        }
+        else if( excess < -pRule->hysteresis )
+        {
+            /* Back past the hysteresis, armed for the next event. */
+            pState->beyond = false;
+            pState->raised = false;
+        }
+        else
+        {
+            /* Within the hysteresis band the episode goes on. */
+        }
+    }
+
+    return eventCount;
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t EventEngine_GetActive( const EventEngine_t * pEngine )
+{
+    uint32_t active = 0;
+    uint32_t i = 0;
+
+    for( i = 0; i < pEngine->ruleCount; i++ )
+    {
+        if( pEngine->states[ i ].beyond == true )
+        {
+            active = active | ( 1UL << i );
+        }
+    }
+
+    return active;
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,400 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file gorilla_codec.c
+ * @brief Implementation of the Gorilla time series codec.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../include/gorilla_codec.h"
+
+/*-----------------------------------------------------------*/
+
+#define GORILLA_HEADER_BITS     ( 80U )
+#define GORILLA_COUNT_BITS      ( 16U )
+
+/*-----------------------------------------------------------*/
+
+static void prvPutBits( GorillaState_t * pState,
+                        uint32_t value,
+                        uint8_t bitCount )
+{
+    uint8_t bit = 0;
+    size_t index = 0;
+    uint8_t mask = 0;
+
+    /* The caller checked the space. */
+    for( bit = bitCount; bit > 0U; bit-- )
+    {
+        index = pState->bitPosition >> 3;
+        mask = ( uint8_t ) ( 0x80U >> ( pState->bitPosition & 7U ) );
+
+        if( ( ( value >> ( bit - 1U ) ) & 1U ) != 0U )
+        {
+            pState->pBuffer[ index ] |= mask;
+        }
+        else
+        {
+            pState->pBuffer[ index ] &= ( uint8_t ) ~mask;
+        }
+
+        pState->bitPosition++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static bool prvGetBits( GorillaState_t * pState,
+                        uint8_t bitCount,
+                        uint32_t * pValue )
+{
+    uint32_t value = 0;
+    uint8_t bit = 0;
+
+    if( ( pState->bitPosition + bitCount ) > ( pState->bufferSize * 8U ) )
+    {
+        return false;
+    }
+
+    for( bit = 0; bit < bitCount; bit++ )
+    {
+        value = ( value << 1 ) | ( ( pState->pBuffer[ pState->bitPosition >> 3 ] >> ( 7U - ( pState->bitPosition & 7U ) ) ) & 1U );
+        pState->bitPosition++;
+    }
+
+    *pValue = value;
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint8_t prvLeadingZeros( uint32_t value )
+{
+    uint8_t count = 0;
+
+    while( ( count < 32U ) && ( ( value & ( 0x80000000UL >> count ) ) == 0U ) )
+    {
+        count++;
+    }
+
+    return count;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint8_t prvTrailingZeros( uint32_t value )
+{
+    uint8_t count = 0;
+
+    while( ( count < 32U ) && ( ( value & ( 1UL << count ) ) == 0U ) )
+    {
+        count++;
+    }
+
+    return count;
+}
+
+/*-----------------------------------------------------------*/
+
+void GorillaEncoder_Init( GorillaEncoder_t * pEncoder,
+                          uint8_t * pBuffer,
+                          size_t bufferSize )
+{
+    memset( pEncoder, 0, sizeof( GorillaEncoder_t ) );
+    pEncoder->pBuffer = pBuffer;
+    pEncoder->bufferSize = bufferSize;
+    pEncoder->bitPosition = GORILLA_COUNT_BITS;
+}
+
+/*-----------------------------------------------------------*/
+
+bool GorillaEncoder_Append( GorillaEncoder_t * pEncoder,
+                            uint32_t timestampMs,
+                            float value )
+{
+    uint32_t valueBits = 0;
+    uint32_t xorBits = 0;
+    int32_t delta = 0;
+    int32_t deltaOfDelta = 0;
+    uint8_t leading = 0;
+    uint8_t trailing = 0;
+
+    memcpy( &valueBits, &value, sizeof( valueBits ) );
+
+    if( pEncoder->count == 0U )
+    {
+        if( pEncoder->bufferSize < ( GORILLA_HEADER_BITS / 8U ) )
+        {
+            return false;
+        }
+
+        prvPutBits( pEncoder, timestampMs, 32 );
+        prvPutBits( pEncoder, valueBits, 32 );
+    }
+    else if( pEncoder->count == UINT16_MAX )
+    {
+        return false;
+    }
+    else
+    {
+        /* Worst case of 36 timestamp and 44 value bits. */
+        if( ( pEncoder->bitPosition + 80U ) > ( pEncoder->bufferSize * 8U ) )
+        {
+            return false;
+        }
+
+        delta = ( int32_t ) ( timestampMs - pEncoder->timestampMs );
+        deltaOfDelta = ( int32_t ) ( ( uint32_t ) delta - ( uint32_t ) pEncoder->delta );
+
+        if( deltaOfDelta == 0 )
+        {
+            prvPutBits( pEncoder, 0x0U, 1 );
+        }
+        else if( ( deltaOfDelta >= -64 ) && ( deltaOfDelta <= 63 ) )
+        {
+            prvPutBits( pEncoder, 0x2U, 2 );
+            prvPutBits( pEncoder, ( uint32_t ) deltaOfDelta & 0x7FU, 7 );
+        }
+        else if( ( deltaOfDelta >= -256 ) && ( deltaOfDelta <= 255 ) )
+        {
+            prvPutBits( pEncoder, 0x6U, 3 );
+            prvPutBits( pEncoder, ( uint32_t ) deltaOfDelta & 0x1FFU, 9 );
+        }
+        else if( ( deltaOfDelta >= -2048 ) && ( deltaOfDelta <= 2047 ) )
+        {
+            prvPutBits( pEncoder, 0xEU, 4 );
+            prvPutBits( pEncoder, ( uint32_t ) deltaOfDelta & 0xFFFU, 12 );
+        }
+        else
+        {
+            prvPutBits( pEncoder, 0xFU, 4 );
+            prvPutBits( pEncoder, ( uint32_t ) deltaOfDelta, 32 );
+        }
+
+        xorBits = valueBits ^ pEncoder->valueBits;
+
+        if( xorBits == 0U )
+        {
+            prvPutBits( pEncoder, 0x0U, 1 );
+        }
+        else
+        {
+            leading = prvLeadingZeros( xorBits );
+            trailing = prvTrailingZeros( xorBits );
+
+            /* A non zero XOR has less than 32 leading zeros. */
+            if( ( pEncoder->count > 1U ) && ( leading >= pEncoder->leading ) && ( trailing >= pEncoder->trailing ) )
+            {
+                prvPutBits( pEncoder, 0x2U, 2 );
+                prvPutBits( pEncoder, xorBits >> pEncoder->trailing, ( uint8_t ) ( 32U - pEncoder->leading - pEncoder->trailing ) );
+            }
+            else
+            {
+                prvPutBits( pEncoder, 0x3U, 2 );
+                prvPutBits( pEncoder, leading, 5 );
+                prvPutBits( pEncoder, ( uint32_t ) ( 32U - leading - trailing - 1U ), 5 );
+                prvPutBits( pEncoder, xorBits >> trailing, ( uint8_t ) ( 32U - leading - trailing ) );
+                pEncoder->leading = leading;
+                pEncoder->trailing = trailing;
+            }
+        }
+
+        pEncoder->delta = delta;
+    }
+
+    pEncoder->timestampMs = timestampMs;
+    pEncoder->valueBits = valueBits;
+    pEncoder->count++;
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
+
+size_t GorillaEncoder_Finish( GorillaEncoder_t * pEncoder )
+{
+    size_t length = 0;
+
+    if( pEncoder->bufferSize >= ( GORILLA_HEADER_BITS / 8U ) )
+    {
+        pEncoder->pBuffer[ 0 ] = ( uint8_t ) ( pEncoder->count >> 8 );
+        pEncoder->pBuffer[ 1 ] = ( uint8_t ) ( pEncoder->count & 0xFFU );
+        length = ( pEncoder->count == 0U ) ? 2U : ( ( pEncoder->bitPosition + 7U ) / 8U );
+
+        /* Clear the unused bits of the last byte. */
+        if( ( pEncoder->bitPosition & 7U ) != 0U )
+        {
+            pEncoder->pBuffer[ length - 1U ] &= ( uint8_t ) ( 0xFFU << ( 8U - ( pEncoder->bitPosition & 7U ) ) );
+        }
+    }
+
+    return length;
+}
+
+/*-----------------------------------------------------------*/
+
+uint16_t GorillaDecoder_Init( GorillaDecoder_t * pDecoder,
+                              const uint8_t * pBuffer,
+                              size_t length )
+{
+    memset( pDecoder, 0, sizeof( GorillaDecoder_t ) );
+
+    /* The buffer is only read. */
+    pDecoder->pBuffer = ( uint8_t * ) pBuffer;
+    pDecoder->bufferSize = length;
+
+    if( length >= 2U )
+    {
+        pDecoder->count = ( uint16_t ) ( ( ( uint16_t ) pBuffer[ 0 ] << 8 ) | pBuffer[ 1 ] );
+        pDecoder->bitPosition = GORILLA_COUNT_BITS;
+    }
+
+    return pDecoder->count;
+}
+
+/*-----------------------------------------------------------*/
+
+bool GorillaDecoder_Next( GorillaDecoder_t * pDecoder,
+                          uint32_t * pTimestampMs,
+                          float * pValue )
+{
+    uint32_t bits = 0;
+    uint32_t prefix = 0;
+    uint32_t length = 0;
+    uint32_t deltaOfDelta = 0;
+    uint8_t prefixBits = 0;
+    bool first = ( pDecoder->bitPosition == GORILLA_COUNT_BITS );
+
+    if( pDecoder->count == 0U )
+    {
+        return false;
+    }
+
+    if( first == true )
+    {
+        if( ( prvGetBits( pDecoder, 32, &pDecoder->timestampMs ) == false ) ||
+            ( prvGetBits( pDecoder, 32, &pDecoder->valueBits ) == false ) )
+        {
+            return false;
+        }
+    }
+    else
+    {
+        /* Timestamp prefix of up to four 1 bits. */
+        do
+        {
+            if( prvGetBits( pDecoder, 1, &bits ) == false )
+            {
+                return false;
+            }
+
+            prefix = ( prefix << 1 ) | bits;
+            prefixBits++;
+        } while( ( bits == 1U ) && ( prefixBits < 4U ) );
+
+        switch( prefix )
+        {
+            case 0x0U:
+                length = 0;
+                break;
+
+            case 0x2U:
+                length = 7;
+                break;
+
+            case 0x6U:
+                length = 9;
+                break;
+
+            case 0xEU:
+                length = 12;
+                break;
+
+            default:
+                length = 32;
+                break;
+        }
+
+        if( ( length > 0U ) && ( prvGetBits( pDecoder, ( uint8_t ) length, &deltaOfDelta ) == false ) )
+        {
+            return false;
+        }
+
+        /* Sign extend. */
+        if( ( length < 32U ) && ( length > 0U ) && ( ( deltaOfDelta >> ( length - 1U ) ) != 0U ) )
+        {
+            deltaOfDelta = deltaOfDelta | ( 0xFFFFFFFFUL << length );
+        }
+
+        pDecoder->delta = ( int32_t ) ( ( uint32_t ) pDecoder->delta + deltaOfDelta );
+        pDecoder->timestampMs = pDecoder->timestampMs + ( uint32_t ) pDecoder->delta;
+
+        if( prvGetBits( pDecoder, 1, &bits ) == false )
+        {
+            return false;
+        }
+
+        if( bits == 1U )
+        {
+            if( prvGetBits( pDecoder, 1, &bits ) == false )
+            {
+                return false;
+            }
+
+            if( bits == 1U )
+            {
+                if( ( prvGetBits( pDecoder, 5, &prefix ) == false ) ||
+                    ( prvGetBits( pDecoder, 5, &length ) == false ) )
+                {
+                    return false;
+                }
+
+                /* The encoder never writes a window past bit 0. */
+                if( ( prefix + length + 1U ) > 32U )
+                {
+                    return false;
+                }
+
+                pDecoder->leading = ( uint8_t ) prefix;
+                pDecoder->trailing = ( uint8_t ) ( 32U - prefix - ( length + 1U ) );
+            }
+
+            length = 32U - pDecoder->leading - pDecoder->trailing;
+
+            if( prvGetBits( pDecoder, ( uint8_t ) length, &bits ) == false )
+            {
+                return false;
+            }
+
+            pDecoder->valueBits = pDecoder->valueBits ^ ( bits << pDecoder->trailing );
+        }
+    }
+
+    pDecoder->count--;
+    *pTimestampMs = pDecoder->timestampMs;
+    memcpy( pValue, &pDecoder->valueBits, sizeof( float ) );
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,365 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file gps_fusion.c
+ * @brief Implementation of GPS and OBD speed fusion.
+ *
+ * Each of the east and north axes runs an independent constant-velocity
+ * Kalman filter in a local tangent plane anchored at an origin fix. GPS
+ * fixes correct the position, the course and speed of the receiver and the
+ * OBD speed correct the velocity along the current heading. Without fixes the filter keeps integrating the velocity,
+ * which dead-reckons through tunnels and garages.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "gps_geo.h"
+
+#include "../include/gps_fusion.h"
+
+/*-----------------------------------------------------------*/
+
+#define FUSION_METRES_PER_MICRODEGREE   ( 0.11131949f )
+#define FUSION_DEG_TO_RAD               ( 0.017453292f )
+#define FUSION_RAD_TO_DEG               ( 57.29578f )
+
+#define FUSION_ACCEL_NOISE              ( 4.0f )     /* (m/s^2)^2 white acceleration noise. */
+#define FUSION_GPS_UERE_M               ( 5.0f )     /* Position error at HDOP 1. */
+#define FUSION_GPS_DEFAULT_HDOP         ( 20U )      /* 0.1 unit, used if the fix has none. */
+#define FUSION_SPEED_NOISE              ( 1.0f )     /* (m/s)^2 OBD speed along heading. */
+#define FUSION_COURSE_NOISE             ( 0.25f )    /* (m/s)^2 receiver speed along its course. */
+#define FUSION_STOP_NOISE               ( 0.05f )    /* (m/s)^2 zero velocity when stopped. */
+#define FUSION_STOP_SPEED_MPS           ( 0.5f )
+#define FUSION_HEADING_MIN_SPEED_MPS    ( 1.0f )     /* Below this the heading is held. */
+#define FUSION_INITIAL_VELOCITY_VAR     ( 100.0f )
+#define FUSION_RESET_DISTANCE_M         ( 500.0f )   /* Fix further than this resets the position. */
+#define FUSION_RECENTER_DISTANCE_M      ( 5000.0f )  /* Keep float positions small. */
+#define FUSION_MAX_PREDICT_MS           ( 10000U )
+
+/*-----------------------------------------------------------*/
+
+static void prvPredictAxis( GpsFusionAxis_t * pAxis,
+                            float dt )
+{
+    float dt2 = dt * dt;
+
+    pAxis->position = pAxis->position + ( pAxis->velocity * dt );
+    pAxis->p00 = pAxis->p00 + ( dt * ( ( 2.0f * pAxis->p01 ) + ( dt * pAxis->p11 ) ) ) +
+                 ( FUSION_ACCEL_NOISE * dt2 * dt / 3.0f );
+    pAxis->p01 = pAxis->p01 + ( dt * pAxis->p11 ) + ( FUSION_ACCEL_NOISE * dt2 / 2.0f );
+    pAxis->p11 = pAxis->p11 + ( FUSION_ACCEL_NOISE * dt );
+}
+
+/*-----------------------------------------------------------*/
+
+/* A position measured age seconds ago, z = position - age * velocity. The
+ * process noise over the age is neglected. */
+static void prvUpdateAxisPosition( GpsFusionAxis_t * pAxis,
+                                   float z,
+                                   float r,
+                                   float age )
+{
+    float h0 = pAxis->p00 - ( age * pAxis->p01 );
+    float h1 = pAxis->p01 - ( age * pAxis->p11 );
+    float s = h0 - ( age * h1 ) + r;
+    float k0 = h0 / s;
+    float k1 = h1 / s;
+    float y = z - ( pAxis->position - ( age * pAxis->velocity ) );
+
+    pAxis->position = pAxis->position + ( k0 * y );
+    pAxis->velocity = pAxis->velocity + ( k1 * y );
+    pAxis->p11 = pAxis->p11 - ( k1 * h1 );
+    pAxis->p01 = pAxis->p01 - ( k0 * h1 );
+    pAxis->p00 = pAxis->p00 - ( k0 * h0 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvUpdateAxisVelocity( GpsFusionAxis_t * pAxis,
+                                   float z,
+                                   float r )
+{
+    float s = pAxis->p11 + r;
+    float k0 = pAxis->p01 / s;
+    float k1 = pAxis->p11 / s;
+    float y = z - pAxis->velocity;
+
+    pAxis->position = pAxis->position + ( k0 * y );
+    pAxis->velocity = pAxis->velocity + ( k1 * y );
+    pAxis->p00 = pAxis->p00 - ( k0 * pAxis->p01 );
+    pAxis->p01 = pAxis->p01 - ( k0 * pAxis->p11 );
+    pAxis->p11 = ( 1.0f - k1 ) * pAxis->p11;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSetOrigin( GpsFusion_t * pFusion,
+                          int32_t latitude,
+                          int32_t longitude )
+{
+    pFusion->originLatitude = latitude;
+    pFusion->originLongitude = longitude;
+    pFusion->metresPerMicrodegreeLongitude =
+        FUSION_METRES_PER_MICRODEGREE * ( float ) GPSGeo_CosQ15( latitude ) / 32768.0f;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvToLocal( const GpsFusion_t * pFusion,
+                        int32_t latitude,
+                        int32_t longitude,
+                        float * pEast,
+                        float * pNorth )
+{
+    *pEast = ( float ) ( longitude - pFusion->originLongitude ) * pFusion->metresPerMicrodegreeLongitude;
+    *pNorth = ( float ) ( latitude - pFusion->originLatitude ) * FUSION_METRES_PER_MICRODEGREE;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvToGlobal( const GpsFusion_t * pFusion,
+                         float east,
+                         float north,
+                         int32_t * pLatitude,
+                         int32_t * pLongitude )
+{
+    *pLatitude = pFusion->originLatitude + ( int32_t ) lroundf( north / FUSION_METRES_PER_MICRODEGREE );
+    *pLongitude = pFusion->originLongitude;
+
+    /* Longitude is undefined on the poles. */
+    if( pFusion->metresPerMicrodegreeLongitude > 0.0f )
+    {
+        *pLongitude = *pLongitude + ( int32_t ) lroundf( east / pFusion->metresPerMicrodegreeLongitude );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvUpdateHeading( GpsFusion_t * pFusion )
+{
+    float ve = pFusion->east.velocity;
+    float vn = pFusion->north.velocity;
+    float heading = 0.0f;
+
+    if( ( ( ve * ve ) + ( vn * vn ) ) >= ( FUSION_HEADING_MIN_SPEED_MPS * FUSION_HEADING_MIN_SPEED_MPS ) )
+    {
+        heading = atan2f( ve, vn ) * FUSION_RAD_TO_DEG;
+
+        if( heading < 0.0f )
+        {
+            heading = heading + 360.0f;
+        }
+
+        pFusion->heading = heading;
+        pFusion->headingValid = true;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void GPSFusion_Init( GpsFusion_t * pFusion )
+{
+    if( pFusion != NULL )
+    {
+        memset( pFusion, 0, sizeof( GpsFusion_t ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void GPSFusion_Predict( GpsFusion_t * pFusion,
+                        uint32_t nowMs )
+{
+    uint32_t elapsedMs = 0;
+    int32_t latitude = 0;
+    int32_t longitude = 0;
+    float dt = 0.0f;
+
+    if( ( pFusion == NULL ) || ( pFusion->initialized == false ) )
+    {
+        return;
+    }
+
+    elapsedMs = nowMs - pFusion->lastPredictMs;
+    pFusion->lastPredictMs = nowMs;
+
+    if( elapsedMs > FUSION_MAX_PREDICT_MS )
+    {
+        elapsedMs = FUSION_MAX_PREDICT_MS;
+    }
+
+    dt = ( float ) elapsedMs / 1000.0f;
+    prvPredictAxis( &pFusion->east, dt );
+    prvPredictAxis( &pFusion->north, dt );
+
+    /* Move the origin along on long dead reckoning or long trips. */
+    if( ( fabsf( pFusion->east.position ) > FUSION_RECENTER_DISTANCE_M ) ||
+        ( fabsf( pFusion->north.position ) > FUSION_RECENTER_DISTANCE_M ) )
+    {
+        prvToGlobal( pFusion, pFusion->east.position, pFusion->north.position, &latitude, &longitude );
+        prvSetOrigin( pFusion, latitude, longitude );
+        pFusion->east.position = 0.0f;
+        pFusion->north.position = 0.0f;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void GPSFusion_UpdateFix( GpsFusion_t * pFusion,
+                          int32_t latitude,
+                          int32_t longitude,
+                          uint8_t hdop,
+                          uint32_t fixMs )
+{
+    float east = 0.0f;
+    float north = 0.0f;
+    float sigma = 0.0f;
+    float r = 0.0f;
+    float age = 0.0f;
+
+    if( pFusion == NULL )
+    {
+        return;
+    }
+
+    /* A fix newer than the state moves the state to it first. */
+    if( ( pFusion->initialized == true ) && ( ( int32_t ) ( fixMs - pFusion->lastPredictMs ) > 0 ) )
+    {
+        GPSFusion_Predict( pFusion, fixMs );
+    }
+
+    sigma = FUSION_GPS_UERE_M * ( float ) ( ( hdop != 0 ) ? hdop : FUSION_GPS_DEFAULT_HDOP ) / 10.0f;
+    r = sigma * sigma;
+
+    if( pFusion->initialized == false )
+    {
+        prvSetOrigin( pFusion, latitude, longitude );
+        memset( &pFusion->east, 0, sizeof( GpsFusionAxis_t ) );
+        memset( &pFusion->north, 0, sizeof( GpsFusionAxis_t ) );
+        pFusion->east.p00 = r;
+        pFusion->north.p00 = r;
+        pFusion->east.p11 = FUSION_INITIAL_VELOCITY_VAR;
+        pFusion->north.p11 = FUSION_INITIAL_VELOCITY_VAR;
+        pFusion->lastPredictMs = fixMs;
+        pFusion->initialized = true;
+    }
+    else
+    {
+        age = ( float ) ( pFusion->lastPredictMs - fixMs ) / 1000.0f;
+        prvToLocal( pFusion, latitude, longitude, &east, &north );
+
+        if( ( fabsf( east - ( pFusion->east.position - ( age * pFusion->east.velocity ) ) ) > FUSION_RESET_DISTANCE_M ) ||
+            ( fabsf( north - ( pFusion->north.position - ( age * pFusion->north.velocity ) ) ) > FUSION_RESET_DISTANCE_M ) )
+        {
+            /* Dead reckoning drifted too far, take the fix as is moved on to now. */
+            pFusion->east.position = east + ( age * pFusion->east.velocity );
+            pFusion->north.position = north + ( age * pFusion->north.velocity );
+            pFusion->east.p00 = r;
+            pFusion->north.p00 = r;
+            pFusion->east.p01 = 0.0f;
+            pFusion->north.p01 = 0.0f;
+        }
+        else
+        {
+            prvUpdateAxisPosition( &pFusion->east, east, r, age );
+            prvUpdateAxisPosition( &pFusion->north, north, r, age );
+        }
+
+        prvUpdateHeading( pFusion );
+    }
+
+    pFusion->lastFixMs = fixMs;
+}
+
+/*-----------------------------------------------------------*/
+
+void GPSFusion_UpdateSpeed( GpsFusion_t * pFusion,
+                            float speedKph )
+{
+    float speed = speedKph / 3.6f;
+    float headingRad = 0.0f;
+
+    if( ( pFusion == NULL ) || ( pFusion->initialized == false ) )
+    {
+        return;
+    }
+
+    if( speed < FUSION_STOP_SPEED_MPS )
+    {
+        /* Stopped, this also stops the position from wandering. */
+        prvUpdateAxisVelocity( &pFusion->east, 0.0f, FUSION_STOP_NOISE );
+        prvUpdateAxisVelocity( &pFusion->north, 0.0f, FUSION_STOP_NOISE );
+    }
+    else if( pFusion->headingValid == true )
+    {
+        headingRad = pFusion->heading * FUSION_DEG_TO_RAD;
+        prvUpdateAxisVelocity( &pFusion->east, speed * sinf( headingRad ), FUSION_SPEED_NOISE );
+        prvUpdateAxisVelocity( &pFusion->north, speed * cosf( headingRad ), FUSION_SPEED_NOISE );
+        prvUpdateHeading( pFusion );
+    }
+    else
+    {
+        /* No direction to apply the speed along yet. */
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void GPSFusion_UpdateCourse( GpsFusion_t * pFusion,
+                             float courseDeg,
+                             float speedKph )
+{
+    float speed = speedKph / 3.6f;
+    float headingRad = courseDeg * FUSION_DEG_TO_RAD;
+
+    /* The course is noise at walking speed. */
+    if( ( pFusion == NULL ) || ( pFusion->initialized == false ) ||
+        ( speed < FUSION_HEADING_MIN_SPEED_MPS ) )
+    {
+        return;
+    }
+
+    prvUpdateAxisVelocity( &pFusion->east, speed * sinf( headingRad ), FUSION_COURSE_NOISE );
+    prvUpdateAxisVelocity( &pFusion->north, speed * cosf( headingRad ), FUSION_COURSE_NOISE );
+    prvUpdateHeading( pFusion );
+}
+
+/*-----------------------------------------------------------*/
+
+bool GPSFusion_GetState( const GpsFusion_t * pFusion,
+                         int32_t * pLatitude,
+                         int32_t * pLongitude,
+                         float * pHeading )
+{
+    bool retGetState = false;
+
+    if( ( pFusion != NULL ) && ( pFusion->initialized == true ) )
+    {
+        prvToGlobal( pFusion, pFusion->east.position, pFusion->north.position, pLatitude, pLongitude );
+        *pHeading = pFusion->heading;
+        retGetState = true;
+    }
+
+    return retGetState;
+}
+
+/*-----------------------------------------------------------*/
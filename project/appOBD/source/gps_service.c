@@ -0,0 +1,312 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file gps_service.c
+ * @brief Implementation of the background GPS acquisition task.
+ *
+ * The GPS task is the only one talking to the dongle GPS. It writes each fix
+ * into one of two snapshot slots and then publishes the slot by bumping a
+ * sequence number. Readers copy the slot selected by the sequence and retry if
+ * the sequence moved meanwhile, so they never wait on the writer.
+ *
+ * While paused the task sleeps until it is resumed.
+ *
+ * A trip replay runs on the clock of the log, which only the telemetry task
+ * moves on. There is no task then, the telemetry task polls the GPS itself
+ * with GPSService_Poll.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "FreeRTOS_IO.h"
+#include "gps_library.h"
+#include "gps_nmea.h"
+
+#include "../include/gps_service.h"
+#include "../include/obd_config.h"
+
+#if ( TRIP_REPLAY_ENABLE == 1 )
+    #include "../include/trip_replay.h"
+#endif
+
+// log print header
+#include "cms_log.h"
+
+/*-----------------------------------------------------------*/
+
+#if ( TRIP_REPLAY_ENABLE == 1 )
+    /* Fix ages are compared with the replay clock of the telemetry task. */
+    #define xTaskGetTickCountMs()       TripReplay_NowMs()
+#else
+    #define xTaskGetTickCountMs()       ( uint32_t ) ( xTaskGetTickCount() * portTICK_PERIOD_MS )
+#endif
+
+#define GPS_SNAPSHOT_READ_RETRY         ( 4U )
+
+typedef struct GpsSnapshot
+{
+    ObdGpsData_t gpsData;
+    uint32_t fixTicksMs;
+} GpsSnapshot_t;
+
+/*-----------------------------------------------------------*/
+
+static const char *TAG = "gpsService";
+
+static GpsSnapshot_t gpsSnapshots[ 2 ];
+
+#if ( GPS_SERVICE_USE_NMEA == 1 )
+    /* Sentences can span two reads, the parser state lives with the task. */
+    static GpsNmeaParser_t gpsNmeaParser;
+#endif
+
+/* 0 means no fix published yet. Odd/even selects the snapshot slot. */
+static uint32_t gpsSnapshotSequence = 0;
+
+static TaskHandle_t gpsTaskHandle = NULL;
+static bool gpsServiceActive = true;
+
+#if ( TRIP_REPLAY_ENABLE == 1 )
+    static Peripheral_Descriptor_t gpsReplayDevice = NULL;
+    static uint32_t gpsReplayPollMs = 0;
+    static bool gpsReplayPollDue = true;    /* First poll, or first after a pause. */
+#endif
+
+/*-----------------------------------------------------------*/
+
+static void publishFix( const ObdGpsData_t * pGpsData )
+{
+    uint32_t nextSequence = __atomic_load_n( &gpsSnapshotSequence, __ATOMIC_RELAXED ) + 1;
+    GpsSnapshot_t * pSnapshot = &gpsSnapshots[ nextSequence & 1U ];
+
+    /* Readers only copy the slot of the current sequence, this one is free. */
+    memcpy( &pSnapshot->gpsData, pGpsData, sizeof( ObdGpsData_t ) );
+    pSnapshot->fixTicksMs = xTaskGetTickCountMs();
+
+    __atomic_store_n( &gpsSnapshotSequence, nextSequence, __ATOMIC_RELEASE );
+
+    /* Next write to the other slot must not become visible before the sequence. */
+    __atomic_thread_fence( __ATOMIC_SEQ_CST );
+}
+
+/*-----------------------------------------------------------*/
+
+static void beginGps( Peripheral_Descriptor_t obdDevice )
+{
+    if( GPSLib_Begin( obdDevice ) == false )
+    {
+        CMS_LOGW( TAG, "GPS is not ready yet, keep polling." );
+    }
+
+    #if ( GPS_SERVICE_USE_NMEA == 1 )
+        GPSNmea_Init( &gpsNmeaParser );
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+static void pollGps( Peripheral_Descriptor_t obdDevice )
+{
+    ObdGpsData_t gpsData = { 0 };
+    bool retGetData = false;
+
+    #if ( GPS_SERVICE_USE_NMEA == 1 )
+        retGetData = GPSLib_GetDataNMEA( obdDevice, &gpsNmeaParser, &gpsData );
+    #else
+        retGetData = GPSLib_GetData( obdDevice, &gpsData );
+    #endif
+
+    if( retGetData == true )
+    {
+        publishFix( &gpsData );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( TRIP_REPLAY_ENABLE == 0 )
+
+static void gpsServiceTask( void * pParameters )
+{
+    Peripheral_Descriptor_t obdDevice = ( Peripheral_Descriptor_t ) pParameters;
+    TickType_t lastWakeTime = 0;
+
+    beginGps( obdDevice );
+
+    lastWakeTime = xTaskGetTickCount();
+
+    while( true )
+    {
+        if( __atomic_load_n( &gpsServiceActive, __ATOMIC_RELAXED ) == false )
+        {
+            ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+            /* A sentence cut by the pause is not completed by the next read. */
+            #if ( GPS_SERVICE_USE_NMEA == 1 )
+                GPSNmea_Init( &gpsNmeaParser );
+            #endif
+
+            lastWakeTime = xTaskGetTickCount();
+            continue;
+        }
+
+        pollGps( obdDevice );
+
+        vTaskDelayUntil( &lastWakeTime, pdMS_TO_TICKS( GPS_SERVICE_POLL_INTERVAL_MS ) );
+    }
+}
+
+#endif /* if ( TRIP_REPLAY_ENABLE == 0 ) */
+
+/*-----------------------------------------------------------*/
+
+bool GPSService_Start( Peripheral_Descriptor_t obdDevice )
+{
+    bool retStart = true;
+
+    if( obdDevice == NULL )
+    {
+        CMS_LOGE( TAG, "GPS service needs the obd device." );
+        retStart = false;
+    }
+    else
+    {
+        #if ( TRIP_REPLAY_ENABLE == 1 )
+            /* No task, GPSService_Poll runs in the telemetry task. */
+            beginGps( obdDevice );
+            gpsReplayDevice = obdDevice;
+            gpsReplayPollDue = true;
+        #else
+            if( xTaskCreate( gpsServiceTask,
+                             "gpsServiceTask",
+                             GPS_SERVICE_TASK_STACK_SIZE,
+                             ( void * ) obdDevice,
+                             GPS_SERVICE_TASK_PRIORITY,
+                             &gpsTaskHandle ) != pdPASS )
+            {
+                CMS_LOGE( TAG, "Failed to create GPS service task." );
+                retStart = false;
+            }
+        #endif
+    }
+
+    return retStart;
+}
+
+/*-----------------------------------------------------------*/
+
+void GPSService_SetActive( bool active )
+{
+    bool wasActive = __atomic_exchange_n( &gpsServiceActive, active, __ATOMIC_RELAXED );
+
+    if( ( active == true ) && ( wasActive == false ) && ( gpsTaskHandle != NULL ) )
+    {
+        ( void ) xTaskNotifyGive( gpsTaskHandle );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+bool GPSService_GetLatestFix( ObdGpsData_t * pGpsData,
+                              uint32_t * pAgeMs )
+{
+    bool retGetFix = false;
+    uint32_t sequence = 0;
+    uint32_t fixTicksMs = 0;
+    uint32_t i = 0;
+
+    if( pGpsData == NULL )
+    {
+        return false;
+    }
+
+    for( i = 0; i < GPS_SNAPSHOT_READ_RETRY; i++ )
+    {
+        sequence = __atomic_load_n( &gpsSnapshotSequence, __ATOMIC_ACQUIRE );
+
+        if( sequence == 0 )
+        {
+            break;
+        }
+
+        memcpy( pGpsData, &gpsSnapshots[ sequence & 1U ].gpsData, sizeof( ObdGpsData_t ) );
+        fixTicksMs = gpsSnapshots[ sequence & 1U ].fixTicksMs;
+        __atomic_thread_fence( __ATOMIC_ACQUIRE );
+
+        /* The writer only reuses this slot after it has moved the sequence. */
+        if( __atomic_load_n( &gpsSnapshotSequence, __ATOMIC_RELAXED ) == sequence )
+        {
+            retGetFix = true;
+            break;
+        }
+    }
+
+    if( ( retGetFix == true ) && ( pAgeMs != NULL ) )
+    {
+        *pAgeMs = xTaskGetTickCountMs() - fixTicksMs;
+    }
+
+    return retGetFix;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( TRIP_REPLAY_ENABLE == 1 )
+
+void GPSService_Poll( void )
+{
+    uint32_t nowMs = xTaskGetTickCountMs();
+
+    if( gpsReplayDevice == NULL )
+    {
+        return;
+    }
+
+    if( __atomic_load_n( &gpsServiceActive, __ATOMIC_RELAXED ) == false )
+    {
+        gpsReplayPollDue = true;
+    }
+    else if( ( gpsReplayPollDue == true ) || ( ( nowMs - gpsReplayPollMs ) >= GPS_SERVICE_POLL_INTERVAL_MS ) )
+    {
+        /* A sentence cut by the pause is not completed by the next read. */
+        #if ( GPS_SERVICE_USE_NMEA == 1 )
+            if( gpsReplayPollDue == true )
+            {
+                GPSNmea_Init( &gpsNmeaParser );
+            }
+        #endif
+
+        pollGps( gpsReplayDevice );
+        gpsReplayPollMs = nowMs;
+        gpsReplayPollDue = false;
+    }
+    else
+    {
+        /* Empty Else MISRA 15.7 */
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+#endif /* if ( TRIP_REPLAY_ENABLE == 1 ) */
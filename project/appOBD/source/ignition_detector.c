@@ -0,0 +1,85 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file ignition_detector.c
+ * @brief Implementation of the engine start detection.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "../include/ignition_detector.h"
+#include "../include/obd_config.h"
+
+/*-----------------------------------------------------------*/
+
+void IgnitionDetector_Init( IgnitionDetector_t * pDetector )
+{
+    pDetector->restVoltage = 0.0f;
+    pDetector->lastCheckMs = 0;
+    pDetector->candidate = false;
+}
+
+/*-----------------------------------------------------------*/
+
+bool IgnitionDetector_Update( IgnitionDetector_t * pDetector,
+                              float voltage,
+                              uint64_t nowMs )
+{
+    bool candidate = false;
+    bool check = false;
+
+    if( ( isnan( voltage ) ) || ( voltage < IGNITION_MIN_VOLTAGE ) )
+    {
+        return false;
+    }
+
+    if( voltage >= IGNITION_CHARGING_VOLTAGE )
+    {
+        candidate = true;
+    }
+    else if( pDetector->restVoltage == 0.0f )
+    {
+        pDetector->restVoltage = voltage;
+    }
+    else if( ( voltage >= ( pDetector->restVoltage + IGNITION_CHARGING_RISE ) ) ||
+             ( voltage <= ( pDetector->restVoltage - IGNITION_CRANKING_DIP ) ) )
+    {
+        candidate = true;
+    }
+    else
+    {
+        /* Slow enough to ignore the noise of single readings. */
+        pDetector->restVoltage += ( voltage - pDetector->restVoltage ) / IGNITION_REST_FILTER;
+    }
+
+    if( ( candidate == true ) &&
+        ( ( pDetector->candidate == false ) || ( ( nowMs - pDetector->lastCheckMs ) >= IGNITION_RPM_CHECK_INTERVAL_MS ) ) )
+    {
+        pDetector->lastCheckMs = nowMs;
+        check = true;
+    }
+
+    pDetector->candidate = candidate;
+
+    return check;
+}
+
+/*-----------------------------------------------------------*/
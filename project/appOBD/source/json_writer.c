@@ -0,0 +1,541 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file json_writer.c
+ * @brief Implementation of the bounded streaming JSON writer.
+ *
+ * The writer stops at the end of the buffer and remembers the overflow, the
+ * buffer is always null terminated. Numbers are converted with integer
+ * arithmetic instead of printf.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../include/json_writer.h"
+
+/*-----------------------------------------------------------*/
+
+#define JSON_WRITER_INDENT          ( 4U )
+#define JSON_WRITER_DECIMALS_MAX    ( 9U )
+
+/* 2^63 as double, larger values do not fit the integer conversion. */
+#define JSON_WRITER_INT64_LIMIT     ( 9223372036854775807.0 )
+
+static const uint32_t powersOfTen[ JSON_WRITER_DECIMALS_MAX + 1U ] =
+{
+    1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
+
+/*-----------------------------------------------------------*/
+
+static void prvPutChar( JsonWriter_t * pWriter,
+                        char c )
+{
+    if( ( pWriter->length + 1U ) < pWriter->bufferSize )
+    {
+        pWriter->pBuffer[ pWriter->length ] = c;
+        pWriter->length = pWriter->length + 1U;
+        pWriter->pBuffer[ pWriter->length ] = '\0';
+    }
+    else
+    {
+        pWriter->overflow = true;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPutData( JsonWriter_t * pWriter,
+                        const char * pData,
+                        size_t length )
+{
+    if( ( pWriter->length + length ) < pWriter->bufferSize )
+    {
+        memcpy( &pWriter->pBuffer[ pWriter->length ], pData, length );
+        pWriter->length = pWriter->length + length;
+        pWriter->pBuffer[ pWriter->length ] = '\0';
+    }
+    else
+    {
+        pWriter->overflow = true;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvNewLine( JsonWriter_t * pWriter )
+{
+    uint8_t i = 0;
+
+    if( ( pWriter->options & JSON_WRITER_PRETTY ) != 0U )
+    {
+        prvPutData( pWriter, "\r\n", 2 );
+
+        for( i = 0; i < pWriter->depth; i++ )
+        {
+            prvPutData( pWriter, "    ", JSON_WRITER_INDENT );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Separator, indent and member name in front of every value. */
+static void prvValuePrefix( JsonWriter_t * pWriter,
+                            const char * pKey )
+{
+    if( pWriter->needComma[ pWriter->depth ] == true )
+    {
+        prvPutChar( pWriter, ',' );
+    }
+
+    pWriter->needComma[ pWriter->depth ] = true;
+
+    if( pWriter->depth > 0U )
+    {
+        prvNewLine( pWriter );
+    }
+
+    if( pKey != NULL )
+    {
+        prvPutChar( pWriter, '"' );
+        prvPutData( pWriter, pKey, strlen( pKey ) );
+
+        if( ( pWriter->options & JSON_WRITER_PRETTY ) != 0U )
+        {
+            prvPutData( pWriter, "\": ", 3 );
+        }
+        else
+        {
+            prvPutData( pWriter, "\":", 2 );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvOpen( JsonWriter_t * pWriter,
+                     const char * pKey,
+                     char c )
+{
+    size_t openLength = pWriter->length;
+    bool parentComma = pWriter->needComma[ pWriter->depth ];
+
+    prvValuePrefix( pWriter, pKey );
+    prvPutChar( pWriter, c );
+
+    if( pWriter->depth < ( JSON_WRITER_DEPTH_MAX - 1U ) )
+    {
+        pWriter->depth = pWriter->depth + 1U;
+        pWriter->needComma[ pWriter->depth ] = false;
+
+        /* Restored if the level ends up empty and is dropped. */
+        pWriter->openLength[ pWriter->depth ] = openLength;
+        pWriter->openComma[ pWriter->depth ] = parentComma;
+    }
+    else
+    {
+        pWriter->overflow = true;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvClose( JsonWriter_t * pWriter,
+                      char c )
+{
+    bool hasMember = pWriter->needComma[ pWriter->depth ];
+    uint8_t depth = pWriter->depth;
+
+    if( depth > 0U )
+    {
+        pWriter->depth = depth - 1U;
+    }
+    else
+    {
+        pWriter->overflow = true;
+    }
+
+    if( ( hasMember == false ) && ( depth > 1U ) && ( ( pWriter->options & JSON_WRITER_OMIT_EMPTY ) != 0U ) )
+    {
+        /* Take back the member name and the opening bracket. */
+        pWriter->length = pWriter->openLength[ depth ];
+        pWriter->pBuffer[ pWriter->length ] = '\0';
+        pWriter->needComma[ pWriter->depth ] = pWriter->openComma[ depth ];
+        return;
+    }
+
+    if( hasMember == true )
+    {
+        prvNewLine( pWriter );
+    }
+
+    prvPutChar( pWriter, c );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Digits of an unsigned value, at least minDigits with leading zeros. */
+static void prvPutUnsigned( JsonWriter_t * pWriter,
+                            uint64_t value,
+                            uint8_t minDigits )
+{
+    char digits[ 20 ];
+    uint8_t count = 0;
+
+    do
+    {
+        digits[ sizeof( digits ) - 1U - count ] = ( char ) ( '0' + ( value % 10U ) );
+        value = value / 10U;
+        count = count + 1U;
+    } while( ( value != 0U ) || ( count < minDigits ) );
+
+    prvPutData( pWriter, &digits[ sizeof( digits ) - count ], count );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPutFixed( JsonWriter_t * pWriter,
+                         int64_t value,
+                         uint8_t decimals )
+{
+    uint64_t magnitude = ( value < 0 ) ? ( uint64_t ) ( -( value + 1 ) ) + 1U : ( uint64_t ) value;
+    uint32_t scale = 0;
+
+    if( decimals > JSON_WRITER_DECIMALS_MAX )
+    {
+        decimals = JSON_WRITER_DECIMALS_MAX;
+    }
+
+    if( ( pWriter->options & JSON_WRITER_TRIM_ZEROS ) != 0U )
+    {
+        while( ( decimals > 0U ) && ( ( magnitude % 10U ) == 0U ) )
+        {
+            magnitude = magnitude / 10U;
+            decimals = decimals - 1U;
+        }
+    }
+
+    scale = powersOfTen[ decimals ];
+
+    if( ( value < 0 ) && ( magnitude != 0U ) )
+    {
+        prvPutChar( pWriter, '-' );
+    }
+
+    prvPutUnsigned( pWriter, magnitude / scale, 1 );
+
+    if( decimals > 0U )
+    {
+        prvPutChar( pWriter, '.' );
+        prvPutUnsigned( pWriter, magnitude % scale, decimals );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void JsonWriter_Init( JsonWriter_t * pWriter,
+                      char * pBuffer,
+                      size_t bufferSize,
+                      uint8_t options )
+{
+    memset( pWriter, 0, sizeof( JsonWriter_t ) );
+    pWriter->pBuffer = pBuffer;
+    pWriter->bufferSize = bufferSize;
+    pWriter->options = options;
+
+    if( bufferSize > 0U )
+    {
+        pBuffer[ 0 ] = '\0';
+    }
+    else
+    {
+        pWriter->overflow = true;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void JsonWriter_BeginObject( JsonWriter_t * pWriter,
+                             const char * pKey )
+{
+    prvOpen( pWriter, pKey, '{' );
+}
+
+/*-----------------------------------------------------------*/
+
+void JsonWriter_EndObject( JsonWriter_t * pWriter )
+{
+    prvClose( pWriter, '}' );
+}
+
+/*-----------------------------------------------------------*/
+
+void JsonWriter_BeginArray( JsonWriter_t * pWriter,
+                            const char * pKey )
+{
+    prvOpen( pWriter, pKey, '[' );
+}
+
+/*-----------------------------------------------------------*/
+
+void JsonWriter_EndArray( JsonWriter_t * pWriter )
+{
+    prvClose( pWriter, ']' );
+}
+
+/*-----------------------------------------------------------*/
+
+void JsonWriter_AddString( JsonWriter_t * pWriter,
+                           const char * pKey,
+                           const char * pValue )
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    const char * pRun = pValue;
+    char escape[ 6 ] = { '\\', 'u', '0', '0', '0', '0' };
+    unsigned char c = 0;
+
+    if( ( *pValue == '\0' ) && ( pKey != NULL ) && ( ( pWriter->options & JSON_WRITER_OMIT_EMPTY ) != 0U ) )
+    {
+        return;
+    }
+
+    prvValuePrefix( pWriter, pKey );
+    prvPutChar( pWriter, '"' );
+
+    /* Copy runs of plain characters at once. */
+    for( ; *pValue != '\0'; pValue++ )
+    {
+        c = ( unsigned char ) *pValue;
+
+        if( ( c == '"' ) || ( c == '\\' ) || ( c < 0x20U ) )
+        {
+            prvPutData( pWriter, pRun, ( size_t ) ( pValue - pRun ) );
+            pRun = pValue + 1;
+
+            if( ( c == '"' ) || ( c == '\\' ) )
+            {
+                escape[ 1 ] = ( char ) c;
+                prvPutData( pWriter, escape, 2 );
+            }
+            else
+            {
+                escape[ 1 ] = 'u';
+                escape[ 4 ] = hexDigits[ c >> 4 ];
+                escape[ 5 ] = hexDigits[ c & 0x0FU ];
+                prvPutData( pWriter, escape, 6 );
+            }
+        }
+    }
+
+    prvPutData( pWriter, pRun, ( size_t ) ( pValue - pRun ) );
+    prvPutChar( pWriter, '"' );
+}
+
+/*-----------------------------------------------------------*/
+
+void JsonWriter_AddBase64( JsonWriter_t * pWriter,
+                           const char * pKey,
+                           const uint8_t * pData,
+                           size_t length )
+{
+    static const char base64Digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char quad[ 4 ];
+    uint32_t triple = 0;
+    size_t i = 0;
+
+    if( ( length == 0U ) && ( pKey != NULL ) && ( ( pWriter->options & JSON_WRITER_OMIT_EMPTY ) != 0U ) )
+    {
+        return;
+    }
+
+    prvValuePrefix( pWriter, pKey );
+    prvPutChar( pWriter, '"' );
+
+    for( i = 0; i < length; i += 3U )
+    {
+        triple = ( uint32_t ) pData[ i ] << 16;
+
+        if( ( i + 1U ) < length )
+        {
+            triple |= ( uint32_t ) pData[ i + 1U ] << 8;
+        }
+
+        if( ( i + 2U ) < length )
+        {
+            triple |= pData[ i + 2U ];
+        }
+
+        quad[ 0 ] = base64Digits[ ( triple >> 18 ) & 0x3FU ];
+        quad[ 1 ] = base64Digits[ ( triple >> 12 ) & 0x3FU ];
+        quad[ 2 ] = ( ( i + 1U ) < length ) ? base64Digits[ ( triple >> 6 ) & 0x3FU ] : '=';
+        quad[ 3 ] = ( ( i + 2U ) < length ) ? base64Digits[ triple & 0x3FU ] : '=';
+        prvPutData( pWriter, quad, 4 );
+    }
+
+    prvPutChar( pWriter, '"' );
+}
+
+/*-----------------------------------------------------------*/
+
+char * JsonWriter_BeginString( JsonWriter_t * pWriter,
+                               const char * pKey,
+                               size_t * pAvailable )
+{
+    char * pPosition = NULL;
+
+    pWriter->stringOpenLength = pWriter->length;
+    pWriter->stringOpenComma = pWriter->needComma[ pWriter->depth ];
+    prvValuePrefix( pWriter, pKey );
+    prvPutChar( pWriter, '"' );
+    *pAvailable = 0;
+
+    /* Keep one character for the closing quote. */
+    if( ( pWriter->overflow == false ) && ( ( pWriter->length + 2U ) < pWriter->bufferSize ) )
+    {
+        pPosition = &pWriter->pBuffer[ pWriter->length ];
+        *pAvailable = pWriter->bufferSize - pWriter->length - 1U;
+    }
+
+    return pPosition;
+}
+
+/*-----------------------------------------------------------*/
+
+void JsonWriter_EndString( JsonWriter_t * pWriter,
+                           size_t length )
+{
+    if( ( length == 0U ) && ( ( pWriter->options & JSON_WRITER_OMIT_EMPTY ) != 0U ) )
+    {
+        pWriter->length = pWriter->stringOpenLength;
+        pWriter->pBuffer[ pWriter->length ] = '\0';
+        pWriter->needComma[ pWriter->depth ] = pWriter->stringOpenComma;
+        return;
+    }
+
+    if( ( pWriter->length + length + 1U ) < pWriter->bufferSize )
+    {
+        pWriter->length = pWriter->length + length;
+    }
+    else
+    {
+        pWriter->overflow = true;
+    }
+
+    prvPutChar( pWriter, '"' );
+}
+
+/*-----------------------------------------------------------*/
+
+void JsonWriter_AddInt( JsonWriter_t * pWriter,
+                        const char * pKey,
+                        int64_t value )
+{
+    prvValuePrefix( pWriter, pKey );
+    prvPutFixed( pWriter, value, 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+void JsonWriter_AddFixed( JsonWriter_t * pWriter,
+                          const char * pKey,
+                          int64_t value,
+                          uint8_t decimals )
+{
+    prvValuePrefix( pWriter, pKey );
+    prvPutFixed( pWriter, value, decimals );
+}
+
+/*-----------------------------------------------------------*/
+
+void JsonWriter_AddDouble( JsonWriter_t * pWriter,
+                           const char * pKey,
+                           double value,
+                           uint8_t decimals )
+{
+    double scaled = 0.0;
+
+    if( decimals > JSON_WRITER_DECIMALS_MAX )
+    {
+        decimals = JSON_WRITER_DECIMALS_MAX;
+    }
+
+    scaled = value * ( double ) powersOfTen[ decimals ];
+
+    /* Also false for NaN. */
+    if( ( scaled < JSON_WRITER_INT64_LIMIT ) && ( scaled > -JSON_WRITER_INT64_LIMIT ) )
+    {
+        prvValuePrefix( pWriter, pKey );
+        prvPutFixed( pWriter, ( int64_t ) ( ( scaled < 0.0 ) ? ( scaled - 0.5 ) : ( scaled + 0.5 ) ), decimals );
+    }
+    else
+    {
+        JsonWriter_AddNull( pWriter, pKey );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void JsonWriter_AddBool( JsonWriter_t * pWriter,
+                         const char * pKey,
+                         bool value )
+{
+    prvValuePrefix( pWriter, pKey );
+
+    if( value == true )
+    {
+        prvPutData( pWriter, "true", 4 );
+    }
+    else
+    {
+        prvPutData( pWriter, "false", 5 );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void JsonWriter_AddNull( JsonWriter_t * pWriter,
+                         const char * pKey )
+{
+    if( ( pKey != NULL ) && ( ( pWriter->options & JSON_WRITER_OMIT_EMPTY ) != 0U ) )
+    {
+        return;
+    }
+
+    prvValuePrefix( pWriter, pKey );
+    prvPutData( pWriter, "null", 4 );
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t JsonWriter_Finish( const JsonWriter_t * pWriter )
+{
+    int32_t length = -1;
+
+    if( ( pWriter->overflow == false ) && ( pWriter->depth == 0U ) )
+    {
+        length = ( int32_t ) pWriter->length;
+    }
+
+    return length;
+}
+
+/*-----------------------------------------------------------*/
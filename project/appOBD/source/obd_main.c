@@ -23,16 +23,14 @@
 
 #include <string.h>
 #include <stdint.h>
+#include <stddef.h>
+#include <math.h>
 #include <assert.h>
 
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
 
-#include "core_mqtt.h"
-#include "core_mqtt_agent.h"
-#include "core_mqtt_agent_tasks.h"
-
 #include "obd_data.h"
 #include "FreeRTOS_IO.h"
 
@@ -43,6 +41,24 @@
 #include "buzz_library.h"
 #include "secure_device.h"
 
+#include "../include/gps_fusion.h"
+#include "../include/gorilla_codec.h"
+#include "../include/gps_service.h"
+#include "../include/clock_service.h"
+#include "../include/obd_payload.h"
+#include "../include/publish_service.h"
+#include "../include/runtime_config.h"
+#include "../include/vehicle_state.h"
+#include "../include/ignition_detector.h"
+#include "../include/stream_stats.h"
+#include "../include/window_aggregate.h"
+#include "../include/event_engine.h"
+#include "../include/signal_registry.h"
+#include "../include/telemetry_batch.h"
+#include "../include/trip_odometer.h"
+#include "../include/trip_path.h"
+#include "../include/trip_checkpoint.h"
+#include "../include/trip_replay.h"
 #include "../include/obd_context.h"
 #include "../include/obd_config.h"
 
@@ -52,15 +68,22 @@
 /*-----------------------------------------------------------*/
 
 #define OBD_AGGREGATED_DATA_INTERVAL_STEPS      ( OBD_AGGREGATED_DATA_INTERVAL_MS / OBD_DATA_COLLECT_INTERVAL_MS )
-#define OBD_TELEMETRY_DATA_INTERVAL_STEPS       ( OBD_TELEMETRY_DATA_INTERVAL_MS / OBD_DATA_COLLECT_INTERVAL_MS )
 #define OBD_SIMULATED_TRIP_STEPS                ( OBD_SIMULATED_TRIP_MS / OBD_TELEMETRY_DATA_INTERVAL_MS )
 
-#define xTaskGetTickCountMs()                   ( uint32_t ) ( xTaskGetTickCount() * portTICK_PERIOD_MS )
-
-#define TIME_SELECTION_NONE                     ( 0 )
-#define TIME_SELECTION_GPS                      ( 1 )
-#define TIME_SELECTION_NTP                      ( 2 )
-#define TIME_SELECTION_UPTIME                   ( 3 )
+#if ( TRIP_REPLAY_ENABLE == 1 )
+    /* The task runs on the clock of the replayed trip, only its pacing waits are shortened. */
+    #define xTaskGetTickCountMs()               TripReplay_NowMs()
+    #define obdWaitMs( waitMs )                 TripReplay_WaitMs( waitMs )
+    #define obdStageBegin()                     TripReplay_GetTimeUs()
+    #define obdStageEnd( stage, startUs )       TripReplay_AddStageTime( ( stage ), ( startUs ) )
+    #define obdPollGps()                        GPSService_Poll()
+#else
+    #define xTaskGetTickCountMs()               ( uint32_t ) ( xTaskGetTickCount() * portTICK_PERIOD_MS )
+    #define obdWaitMs( waitMs )                 vTaskDelay( pdMS_TO_TICKS( waitMs ) )
+    #define obdStageBegin()                     ( 0U )
+    #define obdStageEnd( stage, startUs )       ( void ) ( startUs )
+    #define obdPollGps()                        ( void ) 0
+#endif
 
 #define MAX_DTC_CODES                           ( 6U )
 #define MAX_RETRY_TIMES                         ( 3U )
@@ -70,7 +93,29 @@
     #define OBD_TELEMETRY_TYPE_OIL_TEMP_PID     PID_ENGINE_OIL_TEMP
 #endif
 
-#define OBD_MQTT_QOS                            MQTTQoS1
+/* Number precision of the payload, the pretty encoding keeps the %lf default. */
+#if ( OBD_PAYLOAD_ENCODING != OBD_PAYLOAD_ENCODING_PRETTY )
+    #define OBD_PAYLOAD_DECIMALS_ANGLE          ( 1 )
+    #define OBD_PAYLOAD_DECIMALS_SPEED          ( 1 )
+    #define OBD_PAYLOAD_DECIMALS_DISTANCE       ( 3 )
+    #define OBD_PAYLOAD_DECIMALS_FUEL           ( 2 )
+    #define OBD_PAYLOAD_DECIMALS_FUEL_ML        ( 0 )
+    #define OBD_PAYLOAD_DECIMALS_TEMPERATURE    ( 0 )
+    #define OBD_PAYLOAD_DECIMALS_RPM            ( 0 )
+    #define OBD_PAYLOAD_DECIMALS_PERCENT        ( 1 )
+    #define OBD_PAYLOAD_DECIMALS_ACCELERATION   ( 2 )
+#else
+    #define OBD_PAYLOAD_DECIMALS_ANGLE          OBD_PAYLOAD_DECIMALS_DEFAULT
+    #define OBD_PAYLOAD_DECIMALS_SPEED          OBD_PAYLOAD_DECIMALS_DEFAULT
+    #define OBD_PAYLOAD_DECIMALS_DISTANCE       OBD_PAYLOAD_DECIMALS_DEFAULT
+    #define OBD_PAYLOAD_DECIMALS_FUEL           OBD_PAYLOAD_DECIMALS_DEFAULT
+    #define OBD_PAYLOAD_DECIMALS_FUEL_ML        OBD_PAYLOAD_DECIMALS_DEFAULT
+    #define OBD_PAYLOAD_DECIMALS_TEMPERATURE    OBD_PAYLOAD_DECIMALS_DEFAULT
+    #define OBD_PAYLOAD_DECIMALS_RPM            OBD_PAYLOAD_DECIMALS_DEFAULT
+    #define OBD_PAYLOAD_DECIMALS_PERCENT        OBD_PAYLOAD_DECIMALS_DEFAULT
+    #define OBD_PAYLOAD_DECIMALS_ACCELERATION   OBD_PAYLOAD_DECIMALS_DEFAULT
+#endif
+#define OBD_PAYLOAD_DECIMALS_DEFAULT            ( 6 )
 
 /*-----------------------------------------------------------*/
 
@@ -79,18 +124,15 @@ static const char *TAG = "vehicleTelemetry";
 static obdContext_t gObdContext =
 {
     .obdAggregatedData           = { 0 },
-    .obdTelemetryData            = { 0 },
     .thingName                   = "ThingNameDefault",
     .tripId                      = "123",
     .vin                         = "WASM_test_car",
-    .telemetryIndex              = 0,
-    .latitude                    = 0.0,
-    .longitude                   = 0.0,
-    .startLatitude               = 0.0,
-    .startLongitude              = 0.0,
+    .latitude                    = 0,
+    .longitude                   = 0,
+    .startLatitude               = 0,
+    .startLongitude              = 0,
     .transmission_gear_position  = "neutral",
-    .isoTime                     = "1970-01-01T00:00:00.0000Z",
-    .timeSelection               = TIME_SELECTION_NONE,
+    .clockSource                 = CLOCK_SOURCE_UPTIME,
     .lastUpdateTicksMs           = 0,
     .updateCount                 = 0,
     .highSpeedDurationMs         = 0,
@@ -103,158 +145,113 @@ static obdContext_t gObdContext =
     .obdDeviceConnected          = false
 };
 
-static const char OBD_DATA_TRIP_TOPIC[] = "dt/cvra/%s/trip";
-static const char OBD_DATA_TRIP_FORMAT_1[] =
-"{ \r\n\
-    \"MessageId\": \"%s\", \r\n\
-    \"CreationTimeStamp\": \"%s\", \r\n\
-    \"SendTimeStamp\": \"%s\", \r\n\
-    \"VIN\": \"%s\", \r\n\
-    \"TripId\": \"%s\", \r\n\
-";
-static const char OBD_DATA_TRIP_FORMAT_2[] =
-"    \"TripSummary\": { \r\n\
-        \"StartTime\": \"%s\", \r\n";
-
-static const char OBD_DATA_TRIP_FORMAT_3[] =
-"        \"Distance\": %lf, \r\n\
-        \"Duration\": %u, \r\n\
-        \"Fuel\": %lf, \r\n\
-";
-static const char OBD_DATA_TRIP_FORMAT_4[] =
-"        \"StartLocation\": { \r\n\
-            \"Latitude\": %lf, \r\n\
-            \"Longitude\": %lf, \r\n\
-            \"Altitude\": %lf \r\n\
-        }, \r\n\
-";
-static const char OBD_DATA_TRIP_FORMAT_5[] =
-"        \"EndLocation\": { \r\n\
-            \"Latitude\": %lf, \r\n\
-            \"Longitude\": %lf, \r\n\
-            \"Altitude\": %lf \r\n\
-        }, \r\n\
-        \"SpeedProfile\": %lf \r\n\
-    } \r\n\
-}";
+#define OBD_SIGNAL_AGGREGATE_ALL    ( SIGNAL_AGGREGATE_STATS | SIGNAL_AGGREGATE_WINDOW | SIGNAL_AGGREGATE_EVENTS )
+
+static bool decodeFahrenheit( const SignalRegistry_t * pRegistry,
+                              const SignalDescriptor_t * pDescriptor,
+                              int32_t raw,
+                              double * pValue );
+static bool derivePedalPosition( const SignalRegistry_t * pRegistry,
+                                 const SignalDescriptor_t * pDescriptor,
+                                 int32_t raw,
+                                 double * pValue );
+static bool deriveAcceleration( const SignalRegistry_t * pRegistry,
+                                const SignalDescriptor_t * pDescriptor,
+                                int32_t raw,
+                                double * pValue );
+
+/* The vehicle signals, a derived signal follows its input. */
+static const SignalDescriptor_t obdSignals[ OBD_SIGNAL_MAX ] =
+{
+    [ OBD_SIGNAL_VEHICLE_SPEED ] =
+    {
+        SIGNAL_SOURCE_PID, PID_SPEED, 0, NULL, 0,
+        OBD_SIGNAL_AGGREGATE_ALL, OBD_KEY_SPEED, OBD_PAYLOAD_DECIMALS_SPEED
+    },
+    [ OBD_SIGNAL_ENGINE_SPEED ] =
+    {
+        SIGNAL_SOURCE_PID, PID_RPM, 0, NULL, 0,
+        OBD_SIGNAL_AGGREGATE_ALL, OBD_KEY_ENGINE_SPEED, OBD_PAYLOAD_DECIMALS_RPM
+    },
+    [ OBD_SIGNAL_OIL_TEMP ] =
+    {
+        SIGNAL_SOURCE_PID, OBD_TELEMETRY_TYPE_OIL_TEMP_PID, 0, decodeFahrenheit, OBD_SIGNAL_SLOW_INTERVAL_MS,
+        OBD_SIGNAL_AGGREGATE_ALL, OBD_KEY_OIL_TEMP, OBD_PAYLOAD_DECIMALS_TEMPERATURE
+    },
+    [ OBD_SIGNAL_ACCELERATOR_PEDAL ] =
+    {
+        SIGNAL_SOURCE_DERIVED, 0, OBD_SIGNAL_ENGINE_SPEED, derivePedalPosition, 0,
+        OBD_SIGNAL_AGGREGATE_ALL, OBD_KEY_THROTTLE, OBD_PAYLOAD_DECIMALS_PERCENT
+    },
+    [ OBD_SIGNAL_ACCELERATION ] =
+    {
+        SIGNAL_SOURCE_DERIVED, 0, OBD_SIGNAL_VEHICLE_SPEED, deriveAcceleration, 0,
+        OBD_SIGNAL_AGGREGATE_ALL, OBD_KEY_ACCELERATION, OBD_PAYLOAD_DECIMALS_ACCELERATION
+    },
+    [ OBD_SIGNAL_FUEL_LEVEL ] =
+    {
+        SIGNAL_SOURCE_PID, PID_FUEL_LEVEL, 0, NULL, OBD_SIGNAL_SLOW_INTERVAL_MS,
+        OBD_SIGNAL_AGGREGATE_ALL, OBD_KEY_FUEL_LEVEL, OBD_PAYLOAD_DECIMALS_PERCENT
+    },
+    [ OBD_SIGNAL_GPS_SPEED ] =
+    {
+        SIGNAL_SOURCE_GPS, 0, 0, NULL, 0,
+        0, OBD_KEY_GPS_SPEED, OBD_PAYLOAD_DECIMALS_SPEED
+    }
+};
 
-static const char OBD_DATA_TELEMETRY_TOPIC[] = "dt/cvra/%s/cardata";
-/* The value field is vary from the field. Use strcat to cat the string. */
-static const char OBD_DATA_TELEMETRY_FORMAT_1[] =
-"{ \r\n\
-    \"MessageId\": \"%s\", \r\n\
-    \"SimulationId\": \"%s\", \r\n\
-    \"CreationTimeStamp\": \"%s\", \r\n\
-    \"SendTimeStamp\": \"%s\", \r\n\
-    \"VIN\": \"%s\", \r\n\
-    \"TripId\": \"%s\", \r\n\
-    \"DriverID\": \"%s\", \r\n\
-";
-
-static const char OBD_DATA_TELEMETRY_FORMAT_2[] =
-"    \"GeoLocation\": { \r\n\
-        \"Latitude\": %lf, \r\n\
-        \"Longitude\": %lf, \r\n\
-        \"Altitude\": %lf, \r\n\
-        \"Heading\": %lf, \r\n\
-        \"Speed\": %lf \r\n\
-    }, \r\n\
-";
-
-static const char OBD_DATA_TELEMETRY_FORMAT_3[] =
-"    \"Communications\": { \r\n\
-        \"GSM\": { \r\n\
-            \"Satelites\": \"%s\", \r\n\
-            \"Fix\": \"%s\", \r\n\
-            \"NetworkType\": \"%s\", \r\n\
-            \"MNC\": \"%s\", \r\n\
-            \"MCC\": \"%s\", \r\n\
-            \"LAC\": \"%s\", \r\n\
-            \"CID\": \"%s\" \r\n\
-        }, \r\n\
-        \"WiFi\": { \r\n\
-            \"NetworkID\": \"%s\" \r\n\
-        }, \r\n\
-        \"Wired\": { \r\n\
-            \"NetworkID\": \"%s\" \r\n\
-        } \r\n\
-    }, \r\n\
-";
-
-static const char OBD_DATA_TELEMETRY_FORMAT_4[] =
-"    \"Acceleration\": { \r\n\
-        \"MaxLongitudinal\": { \r\n\
-            \"Axis\": %lf, \r\n\
-            \"Value\": %lf \r\n\
-        }, \r\n\
-        \"MaxLateral\": { \r\n\
-            \"Axis\": %lf, \r\n\
-            \"Value\": %lf \r\n\
-        } \r\n\
-    }, \r\n\
-    \"Throttle\": { \r\n\
-        \"Max\": %lf, \r\n\
-        \"Average\": %lf \r\n\
-    }, \r\n\
-    \"Speed\": { \r\n\
-        \"Max\": %lf, \r\n\
-        \"Average\": %lf \r\n\
-    }, \r\n\
-";
-
-static const char OBD_DATA_TELEMETRY_FORMAT_5[] =
-"    \"Odometer\": { \r\n\
-        \"Metres\": %lf, \r\n\
-        \"TicksFL\": %lf, \r\n\
-        \"TicksFR\": %lf, \r\n\
-        \"TicksRL\": %lf, \r\n\
-        \"TicksRR\": %lf \r\n\
-    }, \r\n\
-";
-
-static const char OBD_DATA_TELEMETRY_FORMAT_6[] =
-"    \"Fuel\": %lf, \r\n\
-    \"Name\": \"%s\", \r\n\
-";
-
-static const char OBD_DATA_TELEMETRY_FORMAT_7[] =
-"    \"OilTemp\": %lf, \r\n\
-    \"FuelInfo\": { \r\n\
-        \"CurrentTripConsumption\": %lf, \r\n\
-        \"TankCapacity\": %lf \r\n\
-    }, \r\n\
-";
-
-static const char OBD_DATA_TELEMETRY_FORMAT_8[] =
-"    \"IgnitionStatus\": \"%s\" \r\n\
-}";
+/* Driving event rules, in the order of obdEventRules. */
+typedef enum ObdEventRule
+{
+    OBD_EVENT_RULE_HARSH_ACCELERATION = 0,
+    OBD_EVENT_RULE_HARSH_BRAKING,
+    OBD_EVENT_RULE_OVER_SPEED,
+    OBD_EVENT_RULE_OVER_REV,
+    OBD_EVENT_RULE_LONG_IDLE,
+    OBD_EVENT_RULE_MAX
+} ObdEventRule_t;
+
+/* Rules that switch to the event sampling rate while in progress. */
+#define OBD_EVENT_RULES_DYNAMIC     ( ( 1UL << OBD_EVENT_RULE_HARSH_ACCELERATION ) | \
+                                      ( 1UL << OBD_EVENT_RULE_HARSH_BRAKING ) |      \
+                                      ( 1UL << OBD_EVENT_RULE_OVER_SPEED ) |         \
+                                      ( 1UL << OBD_EVENT_RULE_OVER_REV ) )
+
+static const EventRule_t obdEventRules[ OBD_EVENT_RULE_MAX ] =
+{
+    [ OBD_EVENT_RULE_HARSH_ACCELERATION ] =
+    {
+        "HarshAcceleration", OBD_SIGNAL_ACCELERATION, EVENT_RULE_ABOVE,
+        OBD_EVENT_HARSH_ACCELERATION, OBD_EVENT_ACCELERATION_HYSTERESIS, 0
+    },
+    [ OBD_EVENT_RULE_HARSH_BRAKING ] =
+    {
+        "HarshBraking", OBD_SIGNAL_ACCELERATION, EVENT_RULE_BELOW,
+        OBD_EVENT_HARSH_BRAKING, OBD_EVENT_ACCELERATION_HYSTERESIS, 0
+    },
+    [ OBD_EVENT_RULE_OVER_SPEED ] =
+    {
+        "OverSpeed", OBD_SIGNAL_VEHICLE_SPEED, EVENT_RULE_ABOVE,
+        CAR_HIGH_SPEED_THRESHOLD, OBD_EVENT_OVER_SPEED_HYSTERESIS, OBD_EVENT_OVER_SPEED_MS
+    },
+    [ OBD_EVENT_RULE_OVER_REV ] =
+    {
+        "OverRev", OBD_SIGNAL_ENGINE_SPEED, EVENT_RULE_ABOVE,
+        OBD_EVENT_OVER_REV_RPM, OBD_EVENT_OVER_REV_HYSTERESIS, OBD_EVENT_OVER_REV_MS
+    },
+    [ OBD_EVENT_RULE_LONG_IDLE ] =
+    {
+        "LongIdle", OBD_SIGNAL_VEHICLE_SPEED, EVENT_RULE_BELOW,
+        CAR_IDLE_SPEED_THRESHOLD, CAR_IDLE_SPEED_THRESHOLD, OBD_EVENT_LONG_IDLE_MS
+    }
+};
 
+static const char OBD_DATA_TRIP_TOPIC[] = "dt/cvra/%s/trip";
+static const char OBD_DATA_EVENT_TOPIC[] = "dt/cvra/%s/event";
+static const char OBD_DATA_AGGREGATED_TOPIC[] = "dt/cvra/%s/aggregated";
+static const char OBD_DATA_TELEMETRY_TOPIC[] = "dt/cvra/%s/cardata";
 static const char OBD_DATA_DTC_TOPIC[] = "dt/cvra/%s/dtc";
-static const char OBD_DATA_DTC_FORMAT[] =
-"{ \r\n\
-    \"MessageId\": \"%s\", \r\n\
-    \"CreationTimeStamp\": \"%s\", \r\n\
-    \"SendTimeStamp\": \"%s\", \r\n\
-    \"VIN\": \"%s\", \r\n\
-    \"DTC\": { \r\n\
-        \"Code\": \"P%04x\", \r\n\
-        \"Changed\": \"%s\" \r\n\
-    } \r\n\
-}";
-
 static const char OBD_MAINTENANCE_TOPIC[] = "dt/cvra/%s/maintenance";
-static const char OBD_MAINTENANCE_FORMAT[] =
-"{ \r\n\
-    \"MessageId\": \"%s\", \r\n\
-    \"CreationTimeStamp\": \"%s\", \r\n\
-    \"SendTimeStamp\": \"%s\", \r\n\
-    \"VIN\": \"%s\", \r\n\
-    \"Maintenance\": \r\n\
-    { \r\n\
-        \"Id\": \"%s\", \r\n\
-        \"Val\": \"%s\" \r\n\
-    } \r\n\
-}";
 
 /*-----------------------------------------------------------*/
 
@@ -267,25 +264,13 @@ static void genTripId( obdContext_t * pObdContext )
 {
     ObdGpsData_t gpsData = { 0 };
     uint32_t randomBuf = 0;
-    bool retGetData = false;
+    uint32_t fixAgeMs = 0;
 
-    /* retIoctl = FreeRTOS_ioctl( gObdContext.obdDevice, ioctlOBD_GPS_READ, &gpsData ); */
-    retGetData = GPSLib_GetData( gObdContext.obdDevice, &gpsData );
-
-    if( retGetData == true )
-    {
-        // char * p = pObdContext->tripId + sprintf( pObdContext->tripId, 
-        //                                           "%04u%02u%02u%02u%02u%02u",
-        //                                           ( unsigned int ) ( gpsData.date % 100 ) + 2000, 
-        //                                           ( unsigned int ) ( gpsData.date / 100 ) % 100, 
-        //                                           ( unsigned int ) ( gpsData.date / 10000 ),
-        //                                           ( unsigned int ) ( gpsData.time / 1000000 ), 
-        //                                           ( unsigned int ) ( gpsData.time % 1000000 ) / 10000, 
-        //                                           ( unsigned int ) ( gpsData.time % 10000 ) / 100 );
-        // *p = '\0';
-        snprintf( pObdContext->tripId, 
+    if( ( GPSService_GetLatestFix( &gpsData, &fixAgeMs ) == true ) && ( fixAgeMs <= GPS_FIX_MAX_AGE_MS ) )
+    {
+        snprintf( pObdContext->tripId,
+                  sizeof( pObdContext->tripId ),
                   "%04u%02u%02u%02u%02u%02u",
-                  sizeof(pObdContext->tripId),
                   ( unsigned int ) ( gpsData.date % 100 ) + 2000, 
                   ( unsigned int ) ( gpsData.date / 100 ) % 100, 
                   ( unsigned int ) ( gpsData.date / 10000 ),
@@ -305,189 +290,253 @@ static void genTripId( obdContext_t * pObdContext )
 
 /*-----------------------------------------------------------*/
 
-static void covertTicksToTimeFormat( uint64_t ticksMs,
-                                     char * pTime,
-                                     uint32_t bufferLength )
+/* Discipline the clock, the latest GPS fix is preferred to NTP. */
+static void updateTimestamp( obdContext_t * pObdContext )
 {
-    /* Use gettickcount as time stamp from 1970-01-01 00:00:00.0000. */
-    uint64_t upTimeMs = 0;
-    uint64_t temp = 0;
-    uint32_t days = 1;
-    uint32_t hours = 0;
-    uint32_t minutes = 0;
-    uint32_t seconds = 0;
-    uint32_t remainMs = 0;
-
-    upTimeMs = ticksMs;
-    temp = upTimeMs / ( uint64_t ) ( 24 * 60 * 60 * 1000 );
-    days = ( temp <= UINT32_MAX ) ? ( uint32_t ) temp : 0;
-
-    upTimeMs = upTimeMs - days * ( uint64_t ) ( 24 * 60 * 60 * 1000 );
-    temp = upTimeMs / ( uint64_t ) ( 60 * 60 * 1000 );
-    hours = ( temp <= UINT32_MAX ) ? ( uint32_t ) temp : 0;
-    
-    upTimeMs = upTimeMs - hours * ( uint64_t ) ( 60 * 60 * 1000 );
-    temp = upTimeMs / ( uint64_t ) ( 60 * 1000 );
-    minutes = ( temp <= UINT32_MAX ) ? ( uint32_t ) temp : 0;
-
-    upTimeMs = upTimeMs - minutes * ( uint64_t ) ( 60 * 1000 );
-    temp = upTimeMs / ( uint64_t ) ( 1000 );
-    seconds = ( temp <= UINT32_MAX ) ? ( uint32_t ) temp : 0;
-
-    upTimeMs = upTimeMs - seconds * ( uint64_t ) ( 1000 );
-    remainMs = ( temp <= UINT32_MAX ) ? ( uint32_t ) temp : 0;
-
-    snprintf( pTime, bufferLength, "%04u-%02u-%02uT%02u:%02u:%02u.%04uZ",
-              ( uint32_t ) 1970,
-              ( uint32_t ) 1,
-              ( uint32_t ) ( days + 1 ),
-              ( uint32_t ) hours,
-              ( uint32_t ) minutes,
-              ( uint32_t ) seconds,
-              ( uint32_t ) remainMs );
+    ObdGpsData_t gpsData = { 0 };
+    uint32_t fixAgeMs = 0;
+    ClockSource_t source = CLOCK_SOURCE_UPTIME;
+
+    if( ( GPSService_GetLatestFix( &gpsData, &fixAgeMs ) == false ) ||
+        ( fixAgeMs > GPS_FIX_MAX_AGE_MS ) ||
+        ( ClockService_SyncGps( &gpsData, fixAgeMs ) == false ) )
+    {
+        ( void ) ClockService_SyncNtp();
+    }
+
+    source = ClockService_GetSource();
+
+    if( source != pObdContext->clockSource )
+    {
+        CMS_LOGI( TAG, "Timestamp source %s.",
+                  ( source == CLOCK_SOURCE_GPS ) ? "GPS" : ( ( source == CLOCK_SOURCE_NTP ) ? "NTP" : "UPTIME" ) );
+        pObdContext->clockSource = source;
+    }
 }
 
 /*-----------------------------------------------------------*/
 
-static void updateTimestamp( obdContext_t * pObdContext,
-                             ObdGpsData_t * pGpsData )
+/* Format the timestamps of a message only when it is built. */
+static void formatMessageTimes( obdContext_t * pObdContext,
+                                uint64_t createdTicksMs )
 {
-    /* Time source selection. */
-    if( pObdContext->timeSelection == TIME_SELECTION_NONE )
-    {
-        if( pGpsData != NULL )
-        {
-            CMS_LOGI( TAG, "Timestamp source GPS." );
-            pObdContext->timeSelection = TIME_SELECTION_GPS;
-        }
-        else if( OBDLib_ReadUTCTime( pObdContext->obdDevice, pObdContext->isoTime, OBD_ISO_TIME_MAX ) == true )
-        {
-            CMS_LOGI( TAG, "Timestamp source NTP." );
-            pObdContext->timeSelection = TIME_SELECTION_NTP;
-        }
-        else
-        {
-            CMS_LOGI( TAG, "Timestamp source UPTIME." );
-            pObdContext->timeSelection = TIME_SELECTION_UPTIME;
-        }
-    }
+    ( void ) ClockService_Format( ClockService_TicksToEpochMs( ( uint32_t ) createdTicksMs ),
+                                  pObdContext->creationTime, OBD_ISO_TIME_MAX );
+    ( void ) ClockService_Format( ClockService_NowMs(), pObdContext->sendTime, OBD_ISO_TIME_MAX );
+}
 
-    /* If we can't get GPS data, we use the uptime. */
-    if( pObdContext->timeSelection == TIME_SELECTION_GPS )
-    {
-        if( pGpsData != NULL )
-        {
-            float kph = ( float ) ( ( int ) ( pGpsData->speed * 1.852f * 10 ) ) / 10;
-
-            pObdContext->timeSelection = TIME_SELECTION_GPS;
-            char * p = pObdContext->isoTime + snprintf( pObdContext->isoTime, OBD_ISO_TIME_MAX, "%04u-%02u-%02uT%02u:%02u:%02u",
-                                                        ( unsigned int ) ( pGpsData->date % 100 ) + 2000,
-                                                        ( unsigned int ) ( pGpsData->date / 100 ) % 100,
-                                                        ( unsigned int ) ( pGpsData->date / 10000 ),
-                                                        ( unsigned int ) ( pGpsData->time / 1000000 ),
-                                                        ( unsigned int ) ( pGpsData->time % 1000000 ) / 10000,
-                                                        ( unsigned int ) ( pGpsData->time % 10000 ) / 100 );
-            unsigned char tenth = ( pGpsData->time % 100 ) / 10;
-
-            if( tenth )
-            {
-                p += sprintf( p, ".%c000", '0' + tenth );
-            }
+/*-----------------------------------------------------------*/
 
-            *p = 'Z';
-            *( p+1 ) = '\0';
+static void genSimulateGearPosition( obdContext_t * pObdContext )
+{
+    double vehicleSpeed = SignalRegistry_Get( &pObdContext->signals, OBD_SIGNAL_VEHICLE_SPEED );
 
-            CMS_LOGD( TAG, "[GPS] %lf %lf %lf km/h SATS %d Course: %d %s.",
-                            pGpsData->lat, pGpsData->lng, kph, pGpsData->sat, pGpsData->heading, pObdContext->isoTime );
-        }
+    if( vehicleSpeed == 0 )
+    {
+        strncpy( pObdContext->transmission_gear_position, "neutral", OBD_TRANSMISSION_GEAR_POSITION_MAX );
+    }
+    else if( vehicleSpeed < 30 )
+    {
+        strncpy( pObdContext->transmission_gear_position, "first", OBD_TRANSMISSION_GEAR_POSITION_MAX );
+    }
+    else if( vehicleSpeed < 50 )
+    {
+        strncpy( pObdContext->transmission_gear_position, "second", OBD_TRANSMISSION_GEAR_POSITION_MAX );
+    }
+    else if( vehicleSpeed < 70 )
+    {
+        strncpy( pObdContext->transmission_gear_position, "third", OBD_TRANSMISSION_GEAR_POSITION_MAX );
     }
-    else if( pObdContext->timeSelection == TIME_SELECTION_NTP )
+    else if( vehicleSpeed < 90 )
     {
-        OBDLib_ReadUTCTime( pObdContext->obdDevice, pObdContext->isoTime, OBD_ISO_TIME_MAX );
+        strncpy( pObdContext->transmission_gear_position, "fourth", OBD_TRANSMISSION_GEAR_POSITION_MAX );
     }
-    else if( pObdContext->timeSelection == TIME_SELECTION_UPTIME )
+    else if( vehicleSpeed < 110 )
     {
-        pObdContext->timeSelection = TIME_SELECTION_UPTIME;
-        covertTicksToTimeFormat( ( uint64_t ) xTaskGetTickCountMs(), pObdContext->isoTime, OBD_ISO_TIME_MAX );
+        strncpy( pObdContext->transmission_gear_position, "fifth", OBD_TRANSMISSION_GEAR_POSITION_MAX );
     }
     else
     {
-        CMS_LOGE( TAG, "Unable to update time with source %u.", pObdContext->timeSelection );
+        strncpy( pObdContext->transmission_gear_position, "sixth", OBD_TRANSMISSION_GEAR_POSITION_MAX );
     }
 }
 
 /*-----------------------------------------------------------*/
 
-static void genSimulateGearPosition( obdContext_t * pObdContext )
+/* A new value of a signal for the aggregators of its descriptor. */
+static void addSignalValue( obdContext_t * pObdContext,
+                            ObdSignal_t signal,
+                            double value,
+                            uint64_t timeMs )
 {
-    if( pObdContext->obdTelemetryData.vehicle_speed == 0 )
+    const SignalDescriptor_t * pDescriptor = &obdSignals[ signal ];
+    Event_t * pEvent = NULL;
+    uint32_t eventCount = 0;
+    uint32_t i = 0;
+
+    if( ( pDescriptor->aggregators & SIGNAL_AGGREGATE_STATS ) != 0U )
     {
-        strncpy( pObdContext->transmission_gear_position, "neutral", OBD_TRANSMISSION_GEAR_POSITION_MAX );
+        StreamStats_Add( &pObdContext->signalStats[ signal ], value, timeMs );
     }
-    else if( pObdContext->obdTelemetryData.vehicle_speed < 30 )
+
+    if( ( pDescriptor->aggregators & SIGNAL_AGGREGATE_WINDOW ) != 0U )
     {
-        strncpy( pObdContext->transmission_gear_position, "first", OBD_TRANSMISSION_GEAR_POSITION_MAX );
+        WindowAggregate_Add( &pObdContext->window, ( uint32_t ) signal, value );
     }
-    else if( pObdContext->obdTelemetryData.vehicle_speed < 50 )
+
+    if( ( pDescriptor->aggregators & SIGNAL_AGGREGATE_EVENTS ) != 0U )
     {
-        strncpy( pObdContext->transmission_gear_position, "second", OBD_TRANSMISSION_GEAR_POSITION_MAX );
+        /* With no room left the rules still follow the value, their events are
+         * raised on a later value once the pending ones are sent. */
+        if( pObdContext->pendingEventCount < EVENT_ENGINE_MAX_RULES )
+        {
+            pEvent = &pObdContext->pendingEvents[ pObdContext->pendingEventCount ];
+        }
+
+        eventCount = EventEngine_Update( &pObdContext->eventEngine, ( uint32_t ) signal, value, timeMs, pEvent,
+                                         ( pEvent != NULL ) ? ( EVENT_ENGINE_MAX_RULES - pObdContext->pendingEventCount ) : 0U );
     }
-    else if( pObdContext->obdTelemetryData.vehicle_speed < 70 )
+
+    for( i = 0; i < eventCount; i++ )
     {
-        strncpy( pObdContext->transmission_gear_position, "third", OBD_TRANSMISSION_GEAR_POSITION_MAX );
+        if( pEvent[ i ].rule == OBD_EVENT_RULE_HARSH_ACCELERATION )
+        {
+            pObdContext->obdAggregatedData.high_acceleration_event++;
+        }
+        else if( pEvent[ i ].rule == OBD_EVENT_RULE_HARSH_BRAKING )
+        {
+            pObdContext->obdAggregatedData.high_braking_event++;
+        }
+        else
+        {
+            /* Empty Else MISRA 15.7 */
+        }
     }
-    else if( pObdContext->obdTelemetryData.vehicle_speed < 90 )
+
+    pObdContext->pendingEventCount = pObdContext->pendingEventCount + eventCount;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool decodeFahrenheit( const SignalRegistry_t * pRegistry,
+                              const SignalDescriptor_t * pDescriptor,
+                              int32_t raw,
+                              double * pValue )
+{
+    ( void ) pRegistry;
+    ( void ) pDescriptor;
+
+    *pValue = ( ( double ) raw * 1.8 ) + 32.0;
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Simulated from the engine speed. */
+static bool derivePedalPosition( const SignalRegistry_t * pRegistry,
+                                 const SignalDescriptor_t * pDescriptor,
+                                 int32_t raw,
+                                 double * pValue )
+{
+    double engineSpeed = SignalRegistry_Get( pRegistry, pDescriptor->input );
+
+    ( void ) raw;
+
+    if( engineSpeed <= 0 )
     {
-        strncpy( pObdContext->transmission_gear_position, "fourth", OBD_TRANSMISSION_GEAR_POSITION_MAX );
+        *pValue = 0;
     }
-    else if( pObdContext->obdTelemetryData.vehicle_speed < 110 )
+    else if( engineSpeed <= CAR_ACCELARATOR_PADEL_RPM_THRESHOLD )
     {
-        strncpy( pObdContext->transmission_gear_position, "fifth", OBD_TRANSMISSION_GEAR_POSITION_MAX );
+        *pValue = ( engineSpeed * 100.0 ) / CAR_ACCELARATOR_PADEL_RPM_THRESHOLD;
     }
     else
     {
-        strncpy( pObdContext->transmission_gear_position, "sixth", OBD_TRANSMISSION_GEAR_POSITION_MAX );
+        *pValue = 100;
     }
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Change of the speed between its last two reads, in km/h per second. */
+static bool deriveAcceleration( const SignalRegistry_t * pRegistry,
+                                const SignalDescriptor_t * pDescriptor,
+                                int32_t raw,
+                                double * pValue )
+{
+    uint32_t input = pDescriptor->input;
+    uint64_t timeDiffMs = pRegistry->updatedMs[ input ] - pRegistry->previousMs[ input ];
+    bool derived = false;
+
+    ( void ) raw;
+
+    if( ( pRegistry->previousMs[ input ] != 0U ) && ( timeDiffMs != 0U ) )
+    {
+        *pValue = ( pRegistry->value[ input ] - pRegistry->previous[ input ] ) * ( 1000 ) / timeDiffMs;
+        derived = true;
+    }
+
+    return derived;
 }
 
 /*-----------------------------------------------------------*/
 
-static void genSimulatePadelPosition( obdContext_t * pObdContext )
+static bool readSignalPid( void * pContext,
+                           uint8_t pid,
+                           int32_t * pRaw )
 {
-    if( pObdContext->obdTelemetryData.engine_speed <= 0 )
+    obdContext_t * pObdContext = ( obdContext_t * ) pContext;
+    int pidValue = 0;
+    bool retReadPID = false;
+
+    if( pObdContext->obdDeviceConnected == true )
     {
-        pObdContext->obdTelemetryData.accelerator_pedal_position = 0;
+        retReadPID = OBDLib_ReadPID( pObdContext->obdDevice, pid, &pidValue );
     }
-    else if( ( pObdContext->obdTelemetryData.engine_speed > 0 ) &&
-             ( pObdContext->obdTelemetryData.engine_speed <= CAR_ACCELARATOR_PADEL_RPM_THRESHOLD ) )
+    else if( pid == PID_SPEED )
     {
-        pObdContext->obdTelemetryData.accelerator_pedal_position =
-            ( pObdContext->obdTelemetryData.engine_speed * 100.0 ) / CAR_ACCELARATOR_PADEL_RPM_THRESHOLD;
+        /* If OBD not connected, we use the simulated speed. */
+        pidValue = OBD_SIMULATED_VEHICLE_SPEED;
+        retReadPID = true;
     }
     else
     {
-        pObdContext->obdTelemetryData.accelerator_pedal_position = 100;
+        /* Empty Else MISRA 15.7 */
     }
 
-    pObdContext->obdAggregatedData.accelerator_pedal_position_mean =
-        ( pObdContext->obdAggregatedData.accelerator_pedal_position_mean * ( pObdContext->updateCount ) ) +
-        pObdContext->obdTelemetryData.accelerator_pedal_position;
-    pObdContext->obdAggregatedData.accelerator_pedal_position_mean =
-        pObdContext->obdAggregatedData.accelerator_pedal_position_mean / ( pObdContext->updateCount + 1 );
+    *pRaw = ( int32_t ) pidValue;
+
+    return retReadPID;
 }
 
 /*-----------------------------------------------------------*/
 
 static void resetTelemetryData( obdContext_t * pObdContext )
 {
+    uint32_t i = 0;
+
     memset( &pObdContext->obdAggregatedData, 0, sizeof( ObdAggregatedData_t ) );
-    memset( &pObdContext->obdTelemetryData, 0, sizeof( ObdTelemetryData_t ) );
-    pObdContext->telemetryIndex = 0;
+
+    for( i = 0; i < OBD_SIGNAL_MAX; i++ )
+    {
+        StreamStats_Init( &pObdContext->signalStats[ i ] );
+    }
+
+    WindowAggregate_Init( &pObdContext->window, ( uint64_t ) xTaskGetTickCountMs() );
+    EventEngine_Reset( &pObdContext->eventEngine );
+    pObdContext->pendingEventCount = 0;
+
+    SignalRegistry_Reset( &pObdContext->signals );
     pObdContext->latitude = 0;
     pObdContext->longitude = 0;
     pObdContext->startLatitude = 0;
     pObdContext->startLongitude = 0;
-    pObdContext->timeSelection = TIME_SELECTION_NONE;
+    pObdContext->heading = 0;
+    pObdContext->lastFusedFixMs = 0;
+    GPSFusion_Init( &pObdContext->gpsFusion );
     pObdContext->lastUpdateTicksMs = 0;
     pObdContext->updateCount = 0;
     pObdContext->highSpeedDurationMs = 0;
@@ -495,6 +544,14 @@ static void resetTelemetryData( obdContext_t * pObdContext )
     pObdContext->idleSpeedDurationIntervalMs = 0;
     pObdContext->higRpmDurationIntervalMs = 0;
     pObdContext->fuel_consumed_since_restart = 0.0;
+    pObdContext->odometer = 0.0;
+    TripOdometer_Init( &pObdContext->tripOdometer );
+    TripPath_Init( &pObdContext->tripPath );
+    TelemetryBatch_Init( &pObdContext->telemetryBatch );
+    TelemetryDeadband_Init( &pObdContext->telemetryDeadband );
+
+    /* The battery rests at a new voltage after a drive. */
+    IgnitionDetector_Init( &pObdContext->ignitionDetector );
 }
 
 /*-----------------------------------------------------------*/
@@ -511,240 +568,680 @@ static double obdReadVehicleSpeed( obdContext_t * pObdContext )
     }
     else
     {
-        pidValue = OBD_SIMULATED_VEHICLE_SPEED;
+        pidValue = OBD_SIMULATED_VEHICLE_SPEED;
+    }
+
+    if( retIoctl == pdPASS )
+    {
+        vehicleSpeed = ( double ) pidValue;
+    }
+
+    return vehicleSpeed;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool isEngineRunning( const obdContext_t * pObdContext )
+{
+    return SignalRegistry_IsFresh( &pObdContext->signals, OBD_SIGNAL_ENGINE_SPEED,
+                                   ( uint64_t ) xTaskGetTickCountMs(), IGNITION_RPM_MAX_AGE_MS ) &&
+           ( SignalRegistry_Get( &pObdContext->signals, OBD_SIGNAL_ENGINE_SPEED ) > 0.0 );
+}
+
+/*-----------------------------------------------------------*/
+
+static bool waitForIgnition( obdContext_t * pObdContext,
+                             uint32_t timeoutMs )
+{
+    uint32_t startMs = xTaskGetTickCountMs();
+    float voltage = 0.0f;
+    int rpm = 0;
+    bool ignition = false;
+
+    while( true )
+    {
+        if( ( pObdContext->obdDeviceConnected == false ) ||
+            ( OBDLib_ReadBatteryVoltage( pObdContext->obdDevice, &voltage ) == false ) )
+        {
+            /* No battery voltage, check the vehicle once per call instead. */
+            ignition = ( obdReadVehicleSpeed( pObdContext ) > CAR_IDLE_SPEED_THRESHOLD ) ||
+                       ( ( pObdContext->obdDeviceConnected == true ) &&
+                         ( OBDLib_ReadPID( pObdContext->obdDevice, PID_RPM, &rpm ) == true ) && ( rpm > 0 ) );
+
+            if( ignition == false )
+            {
+                obdWaitMs( timeoutMs );
+            }
+
+            break;
+        }
+
+        /* The RPM is only read when the voltage looks like an engine start. */
+        if( ( IgnitionDetector_Update( &pObdContext->ignitionDetector, voltage, ( uint64_t ) xTaskGetTickCountMs() ) == true ) &&
+            ( OBDLib_ReadPID( pObdContext->obdDevice, PID_RPM, &rpm ) == true ) && ( rpm > 0 ) )
+        {
+            CMS_LOGI( TAG, "Engine started, battery %.1f V, rest %.1f V, %d rpm.",
+                      voltage, pObdContext->ignitionDetector.restVoltage, rpm );
+            ignition = true;
+            break;
+        }
+
+        if( ( xTaskGetTickCountMs() - startMs ) >= timeoutMs )
+        {
+            break;
+        }
+
+        obdWaitMs( IGNITION_POLL_INTERVAL_MS );
+    }
+
+    return ignition;
+}
+
+/*-----------------------------------------------------------*/
+
+static double updateGPSData( obdContext_t * pObdContext, bool useSimulatledGPSData )
+{
+    ObdGpsData_t gpsData = { 0 };
+    bool retGetData = false;
+    uint32_t fixAgeMs = 0;
+    uint32_t nowMs = xTaskGetTickCountMs();
+    uint32_t fixTimeMs = 0;
+    float heading = 0.0f;
+    double kph = 0.0;
+
+    /* The replayed GPS is read on the clock of the log, the service task reads it otherwise. */
+    obdPollGps();
+
+    /* Without any fix the fusion filter has no position to start from. */
+    if( ( useSimulatledGPSData == true ) && ( pObdContext->gpsFusion.initialized == false ) )
+    {
+        udpateSimulatedGPSData( pObdContext );
+        TripOdometer_AddFix( &pObdContext->tripOdometer, pObdContext->latitude, pObdContext->longitude, 10 );
+        TripPath_AddPoint( &pObdContext->tripPath, pObdContext->latitude, pObdContext->longitude );
+        return kph;
+    }
+
+    GPSFusion_Predict( &pObdContext->gpsFusion, nowMs );
+
+    /* Update GPS data from the latest published fix. */
+    retGetData = GPSService_GetLatestFix( &gpsData, &fixAgeMs );
+
+    if( ( retGetData == true ) && ( fixAgeMs <= GPS_FIX_MAX_AGE_MS ) )
+    {
+        if( pObdContext->gpsReceived == false )
+        {
+            pObdContext->gpsReceived = true;
+            buzz_beep( pObdContext->buzzDevice, BUZZ_SHORT_BEEP_DURATION_MS, 3 );
+        }
+
+        CMS_LOGD( TAG, "GPS good data." );
+        pObdContext->gpsSatellites = gpsData.sat;
+        pObdContext->gpsFixQuality = gpsData.fixQuality;
+        pObdContext->gpsFixMode = gpsData.fixMode;
+
+        /* The same fix is read again until the GPS service publishes a new one. */
+        fixTimeMs = nowMs - fixAgeMs;
+
+        if( ( ( gpsData.lat != 0 ) || ( gpsData.lng != 0 ) ) &&
+            ( ( pObdContext->gpsFusion.initialized == false ) ||
+              ( ( fixTimeMs - pObdContext->lastFusedFixMs ) >= ( GPS_SERVICE_POLL_INTERVAL_MS / 2 ) ) ) )
+        {
+            GPSFusion_UpdateFix( &pObdContext->gpsFusion, gpsData.lat, gpsData.lng, gpsData.hdop, fixTimeMs );
+            GPSFusion_UpdateCourse( &pObdContext->gpsFusion, ( float ) gpsData.heading,
+                                    ( float ) ( gpsData.speed * 1.852 ) );
+            TripOdometer_AddFix( &pObdContext->tripOdometer, gpsData.lat, gpsData.lng, gpsData.hdop );
+            pObdContext->lastFusedFixMs = fixTimeMs;
+        }
+
+        if( ( pObdContext->startLatitude == 0 ) && ( pObdContext->startLongitude == 0 ) &&
+            ( ( gpsData.lat != 0 ) || ( gpsData.lng != 0 ) ) )
+        {
+            pObdContext->startLatitude = gpsData.lat;
+            pObdContext->startLongitude = gpsData.lng;
+        }
+
+        kph = ( double ) ( ( int ) ( gpsData.speed * 1.852f * 10 ) ) / 10;
+
+        if( SignalRegistry_Set( &pObdContext->signals, OBD_SIGNAL_GPS_SPEED, kph, nowMs ) == true )
+        {
+            addSignalValue( pObdContext, OBD_SIGNAL_GPS_SPEED, kph, nowMs );
+        }
+    }
+
+    /* Dead reckon on the vehicle speed while the GPS is lost, up to a limit. */
+    if( ( ( nowMs - pObdContext->gpsFusion.lastFixMs ) <= GPS_FUSION_MAX_DEAD_RECKONING_MS ) &&
+        ( GPSFusion_GetState( &pObdContext->gpsFusion, &pObdContext->latitude,
+                              &pObdContext->longitude, &heading ) == true ) )
+    {
+        pObdContext->heading = ( double ) heading;
+        TripPath_AddPoint( &pObdContext->tripPath, pObdContext->latitude, pObdContext->longitude );
+    }
+    else
+    {
+        /* Empty Else MISRA 15.7 */
+    }
+
+    return kph;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool waitGpsFix( uint32_t timeoutMs )
+{
+    ObdGpsData_t gpsData = { 0 };
+    uint32_t fixAgeMs = 0;
+    uint32_t startMs = xTaskGetTickCountMs();
+    bool retFix = false;
+
+    while( true )
+    {
+        obdPollGps();
+
+        if( ( GPSService_GetLatestFix( &gpsData, &fixAgeMs ) == true ) && ( fixAgeMs <= GPS_FIX_MAX_AGE_MS ) &&
+            ( ( gpsData.lat != 0 ) || ( gpsData.lng != 0 ) ) )
+        {
+            retFix = true;
+            break;
+        }
+
+        if( ( xTaskGetTickCountMs() - startMs ) >= timeoutMs )
+        {
+            break;
+        }
+
+        obdWaitMs( GPS_SERVICE_POLL_INTERVAL_MS / 4 );
+    }
+
+    return retFix;
+}
+
+/*-----------------------------------------------------------*/
+
+static void updateAggregatedData( obdContext_t * pObdContext )
+{
+    ObdAggregatedData_t * pAggregated = &pObdContext->obdAggregatedData;
+    const StreamStats_t * pStats = pObdContext->signalStats;
+
+    pAggregated->vehicle_speed_mean = pStats[ OBD_SIGNAL_VEHICLE_SPEED ].mean;
+    pAggregated->vehicle_speed_max = pStats[ OBD_SIGNAL_VEHICLE_SPEED ].max;
+    pAggregated->engine_speed_mean = pStats[ OBD_SIGNAL_ENGINE_SPEED ].mean;
+    pAggregated->oil_temp_mean = pStats[ OBD_SIGNAL_OIL_TEMP ].mean;
+    pAggregated->accelerator_pedal_position_mean = pStats[ OBD_SIGNAL_ACCELERATOR_PEDAL ].mean;
+}
+
+/*-----------------------------------------------------------*/
+
+static void updateTelemetryData( obdContext_t * pObdContext )
+{
+    SignalRegistry_t * pSignals = &pObdContext->signals;
+    uint64_t currentTicksMs = ( uint64_t ) xTaskGetTickCountMs();
+    uint64_t timeDiffMs = currentTicksMs - pObdContext->lastUpdateTicksMs;
+    uint32_t updated = 0;
+    uint32_t signal = 0;
+    double vehicleSpeed = 0;
+    uint64_t stageStartUs = obdStageBegin();
+
+    /* Read the signals that are due, the derived ones follow. */
+    updated = SignalRegistry_Acquire( pSignals, currentTicksMs, readSignalPid, pObdContext );
+    obdStageEnd( TRIP_REPLAY_STAGE_ACQUIRE, stageStartUs );
+
+    if( ( updated & SIGNAL_BIT( OBD_SIGNAL_ENGINE_SPEED ) ) != 0U )
+    {
+        /* Update the simulated high rpm oil temperature. */
+        if( SignalRegistry_Get( pSignals, OBD_SIGNAL_ENGINE_SPEED ) > ( ( double ) CAR_HIGH_OIL_TEMP_RPM ) )
+        {
+            pObdContext->higRpmDurationIntervalMs = pObdContext->higRpmDurationIntervalMs + timeDiffMs;
+        }
+        else
+        {
+            pObdContext->higRpmDurationIntervalMs = 0;
+        }
+    }
+
+    if( pObdContext->higRpmDurationIntervalMs > CAR_HIGH_OIL_TEMP_RPM_DURATION_MS )
+    {
+        CMS_LOGI( TAG, "CAR high oil temp." );
+        pSignals->value[ OBD_SIGNAL_OIL_TEMP ] = CAR_HIGH_OIL_TEMP;
+    }
+
+    if( ( updated & SIGNAL_BIT( OBD_SIGNAL_VEHICLE_SPEED ) ) != 0U )
+    {
+        vehicleSpeed = SignalRegistry_Get( pSignals, OBD_SIGNAL_VEHICLE_SPEED );
+        GPSFusion_UpdateSpeed( &pObdContext->gpsFusion, ( float ) vehicleSpeed );
+        TripOdometer_AddSpeed( &pObdContext->tripOdometer, ( float ) vehicleSpeed, ( uint32_t ) currentTicksMs );
+
+        /* Update the simulated high speed duration. */
+        if( vehicleSpeed > ( ( double ) CAR_HIGH_SPEED_THRESHOLD ) )
+        {
+            pObdContext->highSpeedDurationMs = pObdContext->highSpeedDurationMs + timeDiffMs;
+        }
+
+        /* Update the idle time. */
+        if( vehicleSpeed <= ( ( double ) CAR_IDLE_SPEED_THRESHOLD ) )
+        {
+            pObdContext->idleSpeedDurationMs = pObdContext->idleSpeedDurationMs + timeDiffMs;
+            pObdContext->idleSpeedDurationIntervalMs = pObdContext->idleSpeedDurationIntervalMs + timeDiffMs;
+        }
+        else
+        {
+            pObdContext->idleSpeedDurationIntervalMs = 0;
+        }
+
+        /* Update the simulated gear position. */
+        genSimulateGearPosition( pObdContext );
+    }
+
+    if( ( updated & SIGNAL_BIT( OBD_SIGNAL_FUEL_LEVEL ) ) != 0U )
+    {
+        pObdContext->fuel_level = SignalRegistry_Get( pSignals, OBD_SIGNAL_FUEL_LEVEL ) / 100.0;
+        /* Update the simulated fuel_consumed_since_restart. */
+        pObdContext->fuel_consumed_since_restart =
+            ( pObdContext->start_fuel_level - pObdContext->fuel_level ) * CAR_GAS_TANK_SIZE;
+    }
+
+    /* Hand the new values to their aggregators. */
+    stageStartUs = obdStageBegin();
+
+    for( signal = 0; signal < OBD_SIGNAL_MAX; signal++ )
+    {
+        if( ( updated & SIGNAL_BIT( signal ) ) != 0U )
+        {
+            addSignalValue( pObdContext, ( ObdSignal_t ) signal, pSignals->value[ signal ], currentTicksMs );
+        }
+    }
+
+    pObdContext->odometer = ( double ) TripOdometer_GetDistanceMm( &pObdContext->tripOdometer ) / 1000000.0;
+    updateAggregatedData( pObdContext );
+    obdStageEnd( TRIP_REPLAY_STAGE_AGGREGATE, stageStartUs );
+
+    /* Update ticks. */
+    pObdContext->lastUpdateTicksMs = currentTicksMs;
+    pObdContext->updateCount = pObdContext->updateCount + 1;
+}
+
+/*-----------------------------------------------------------*/
+
+static void addPlaceholder( ObdPayload_t * pPayload,
+                            ObdPayloadKey_t key )
+{
+    /* Not measured yet. The compact encodings leave the null out. */
+    #if ( OBD_PAYLOAD_ENCODING != OBD_PAYLOAD_ENCODING_PRETTY )
+        ObdPayload_AddNull( pPayload, key );
+    #else
+        ObdPayload_AddDouble( pPayload, key, 0.0, OBD_PAYLOAD_DECIMALS_DEFAULT );
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+/* Hand the message to the publisher task, it never waits on the network. */
+static BaseType_t publishMessage( obdContext_t * pObdContext,
+                                  const ObdPayload_t * pPayload )
+{
+    BaseType_t retMqtt = pdFAIL;
+    int32_t msgLength = ObdPayload_Finish( pPayload );
+
+    if( msgLength < 0 )
+    {
+        CMS_LOGE( TAG, "Message to %s exceeds %u bytes.", pObdContext->topicBuf, ( unsigned int ) OBD_MESSAGE_BUF_SIZE );
+    }
+    else if( PublishService_Send( pObdContext->topicBuf, pObdContext->messageBuf, ( size_t ) msgLength ) == true )
+    {
+        retMqtt = pdPASS;
+    }
+    else
+    {
+        /* Empty Else MISRA 15.7 */
+    }
+
+    return retMqtt;
+}
+
+/*-----------------------------------------------------------*/
+
+static const char * gpsFixToString( const obdContext_t * pObdContext )
+{
+    const char * pFix = "";
+
+    if( pObdContext->gpsReceived == false )
+    {
+        pFix = "";
+    }
+    else if( pObdContext->gpsFixMode == 3 )
+    {
+        pFix = "3D";
+    }
+    else if( ( pObdContext->gpsFixMode == 2 ) || ( pObdContext->gpsFixQuality > 0 ) )
+    {
+        pFix = "2D";
+    }
+    else
+    {
+        pFix = "none";
+    }
+
+    return pFix;
+}
+
+/*-----------------------------------------------------------*/
+
+static void addTelemetrySample( obdContext_t * pObdContext )
+{
+    ObdSample_t sample;
+
+    sample.timestampMs = pObdContext->lastUpdateTicksMs;
+    sample.latitude = pObdContext->latitude;
+    sample.longitude = pObdContext->longitude;
+    sample.heading = pObdContext->heading;
+    sample.speed = SignalRegistry_Get( &pObdContext->signals, OBD_SIGNAL_VEHICLE_SPEED );
+    sample.odometer = pObdContext->odometer;
+    sample.fuel = pObdContext->fuel_level * CAR_GAS_TANK_SIZE;
+    sample.oilTemp = SignalRegistry_Get( &pObdContext->signals, OBD_SIGNAL_OIL_TEMP );
+
+    /* Nothing moved beyond its deadband, the receiver holds the last values. */
+    if( TelemetryDeadband_Filter( &pObdContext->telemetryDeadband, &sample ) == false )
+    {
+        return;
+    }
+
+    if( TelemetryBatch_Add( &pObdContext->telemetryBatch, &sample ) == false )
+    {
+        CMS_LOGW( TAG, "Telemetry batch full, sample dropped." );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* One field of all samples, an array with null for the values not reported or a
+ * Gorilla stream of offset and value where a held value costs one bit. */
+static void addSampleColumn( ObdPayload_t * pPayload,
+                             ObdPayloadKey_t key,
+                             const TelemetryBatch_t * pBatch,
+                             ObdSampleField_t field,
+                             size_t fieldOffset,
+                             uint8_t decimals,
+                             bool gorilla )
+{
+    uint8_t stream[ GORILLA_MAX_BYTES( OBD_TELEMETRY_BATCH_MAX_SAMPLES ) ];
+    GorillaEncoder_t encoder;
+    double scale = pow( 10.0, decimals );
+    uint16_t i = 0;
+    double value = 0.0;
+
+    if( gorilla == true )
+    {
+        GorillaEncoder_Init( &encoder, stream, sizeof( stream ) );
+
+        for( i = 0; i < pBatch->count; i++ )
+        {
+            memcpy( &value, ( const uint8_t * ) &pBatch->samples[ i ] + fieldOffset, sizeof( double ) );
+
+            /* Rounded to the field precision, repeated values cost one bit. */
+            ( void ) GorillaEncoder_Append( &encoder,
+                                            TelemetryBatch_GetOffsetMs( pBatch, i ),
+                                            ( float ) ( round( value * scale ) / scale ) );
+        }
+
+        ObdPayload_AddBytes( pPayload, key, stream, GorillaEncoder_Finish( &encoder ) );
+    }
+    else
+    {
+        ObdPayload_BeginArray( pPayload, key );
+
+        for( i = 0; i < pBatch->count; i++ )
+        {
+            if( ( pBatch->samples[ i ].reported & OBD_SAMPLE_FIELD_BIT( field ) ) != 0U )
+            {
+                memcpy( &value, ( const uint8_t * ) &pBatch->samples[ i ] + fieldOffset, sizeof( double ) );
+                ObdPayload_AddDouble( pPayload, OBD_KEY_NONE, value, decimals );
+            }
+            else
+            {
+                ObdPayload_AddNull( pPayload, OBD_KEY_NONE );
+            }
+        }
+
+        ObdPayload_EndArray( pPayload );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void addSamplePosition( ObdPayload_t * pPayload,
+                               const ObdSample_t * pSample,
+                               int32_t microdegree )
+{
+    if( ( pSample->reported & OBD_SAMPLE_FIELD_BIT( OBD_SAMPLE_FIELD_POSITION ) ) != 0U )
+    {
+        ObdPayload_AddFixed( pPayload, OBD_KEY_NONE, microdegree, 6 );
+    }
+    else
+    {
+        ObdPayload_AddNull( pPayload, OBD_KEY_NONE );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t sendObdTelemetryData( obdContext_t * pObdContext )
+{
+    char messageId[ OBD_MESSAGE_ID_MAX ] = { 0 };
+    char satellites[ 4 ] = { 0 };
+    ObdPayload_t payload;
+    const TelemetryBatch_t * pBatch = &pObdContext->telemetryBatch;
+    uint16_t i = 0;
+    bool gorilla = ( OBD_TELEMETRY_BATCH_GORILLA == 1 );
+    BaseType_t retMqtt = pdPASS;
+
+    if( pBatch->count == 0U )
+    {
+        return pdPASS;
+    }
+
+    /* A batch that waits on the SD card is sent compact, it is replayed
+     * behind many others when the link is back. */
+    #if ( ( STORE_FORWARD_ENABLE == 1 ) && ( STORE_FORWARD_BATCH_GORILLA == 1 ) )
+        if( PublishService_IsStoring() == true )
+        {
+            gorilla = true;
+        }
+    #endif
+
+    formatMessageTimes( pObdContext, pBatch->samples[ 0 ].timestampMs );
+    snprintf( messageId, OBD_MESSAGE_ID_MAX, "%s-%s", pObdContext->vin, pObdContext->creationTime );
+
+    snprintf( pObdContext->topicBuf, OBD_TOPIC_BUF_SIZE, OBD_DATA_TELEMETRY_TOPIC, pObdContext->thingName );
+
+    if( pObdContext->gpsReceived == true )
+    {
+        snprintf( satellites, sizeof( satellites ), "%u", ( unsigned int ) pObdContext->gpsSatellites );
+    }
+
+    ObdPayload_Init( &payload, pObdContext->messageBuf, OBD_MESSAGE_BUF_SIZE );
+    ObdPayload_BeginObject( &payload, OBD_KEY_NONE );
+    ObdPayload_AddString( &payload, OBD_KEY_MESSAGE_ID, messageId );
+    ObdPayload_AddString( &payload, OBD_KEY_SIMULATION_ID, "iotlabtpesim" );
+    ObdPayload_AddString( &payload, OBD_KEY_CREATION_TIME_STAMP, pObdContext->creationTime );
+    ObdPayload_AddString( &payload, OBD_KEY_SEND_TIME_STAMP, pObdContext->sendTime );
+    ObdPayload_AddString( &payload, OBD_KEY_VIN, pObdContext->vin );
+    ObdPayload_AddString( &payload, OBD_KEY_TRIP_ID, pObdContext->tripId );
+    ObdPayload_AddString( &payload, OBD_KEY_DRIVER_ID, "" );
+    ObdPayload_AddString( &payload, OBD_KEY_NAME, pObdContext->tripName );   /* Name unique route name for this trip */
+
+    ObdPayload_BeginObject( &payload, OBD_KEY_COMMUNICATIONS );
+    ObdPayload_BeginObject( &payload, OBD_KEY_GSM );
+    ObdPayload_AddString( &payload, OBD_KEY_SATELITES, satellites );
+    ObdPayload_AddString( &payload, OBD_KEY_FIX, gpsFixToString( pObdContext ) );
+    ObdPayload_EndObject( &payload );
+    ObdPayload_EndObject( &payload );
+
+    ObdPayload_BeginObject( &payload, OBD_KEY_FUEL_INFO );
+    ObdPayload_AddDouble( &payload, OBD_KEY_CURRENT_TRIP_CONSUMPTION, pObdContext->fuel_consumed_since_restart, OBD_PAYLOAD_DECIMALS_FUEL );
+    ObdPayload_AddDouble( &payload, OBD_KEY_TANK_CAPACITY, CAR_GAS_TANK_SIZE, OBD_PAYLOAD_DECIMALS_FUEL );
+    ObdPayload_EndObject( &payload );
+
+    ObdPayload_AddString( &payload, OBD_KEY_IGNITION_STATUS, pObdContext->ignition_status );
+
+    /* One column per field, the offset is milliseconds from CreationTimeStamp.
+     * A null value did not move beyond its deadband and holds the last value. */
+    ObdPayload_BeginObject( &payload, OBD_KEY_SAMPLES );
+
+    ObdPayload_BeginArray( &payload, OBD_KEY_OFFSET );
+    for( i = 0; i < pBatch->count; i++ )
+    {
+        ObdPayload_AddInt( &payload, OBD_KEY_NONE, TelemetryBatch_GetOffsetMs( pBatch, i ) );
+    }
+    ObdPayload_EndArray( &payload );
+
+    ObdPayload_BeginArray( &payload, OBD_KEY_LATITUDE );
+    for( i = 0; i < pBatch->count; i++ )
+    {
+        addSamplePosition( &payload, &pBatch->samples[ i ], pBatch->samples[ i ].latitude );
     }
+    ObdPayload_EndArray( &payload );
 
-    if( retIoctl == pdPASS )
+    ObdPayload_BeginArray( &payload, OBD_KEY_LONGITUDE );
+    for( i = 0; i < pBatch->count; i++ )
     {
-        vehicleSpeed = ( double ) pidValue;
+        addSamplePosition( &payload, &pBatch->samples[ i ], pBatch->samples[ i ].longitude );
     }
+    ObdPayload_EndArray( &payload );
 
-    return vehicleSpeed;
+    addSampleColumn( &payload, OBD_KEY_HEADING, pBatch, OBD_SAMPLE_FIELD_HEADING, offsetof( ObdSample_t, heading ), OBD_PAYLOAD_DECIMALS_ANGLE, gorilla );
+    addSampleColumn( &payload, OBD_KEY_SPEED, pBatch, OBD_SAMPLE_FIELD_SPEED, offsetof( ObdSample_t, speed ), OBD_PAYLOAD_DECIMALS_SPEED, gorilla );    /* KM/H */
+    addSampleColumn( &payload, OBD_KEY_ODOMETER, pBatch, OBD_SAMPLE_FIELD_ODOMETER, offsetof( ObdSample_t, odometer ), OBD_PAYLOAD_DECIMALS_DISTANCE, gorilla );    /* KM */
+    addSampleColumn( &payload, OBD_KEY_FUEL, pBatch, OBD_SAMPLE_FIELD_FUEL, offsetof( ObdSample_t, fuel ), OBD_PAYLOAD_DECIMALS_FUEL, gorilla );    /* Fuel in L */
+    addSampleColumn( &payload, OBD_KEY_OIL_TEMP, pBatch, OBD_SAMPLE_FIELD_OIL_TEMP, offsetof( ObdSample_t, oilTemp ), OBD_PAYLOAD_DECIMALS_TEMPERATURE, gorilla );
+
+    ObdPayload_EndObject( &payload );
+    ObdPayload_EndObject( &payload );
+
+    retMqtt = publishMessage( pObdContext, &payload );
+    TelemetryBatch_Init( &pObdContext->telemetryBatch );
+
+    return retMqtt;
 }
 
 /*-----------------------------------------------------------*/
 
-static double updateGPSData( obdContext_t * pObdContext, bool useSimulatledGPSData )
+static void addWindowSignals( ObdPayload_t * pPayload,
+                              const obdContext_t * pObdContext,
+                              bool sliding )
 {
-    ObdGpsData_t gpsData = { 0 };
-    bool retGetData = false;
-    double kph = 0.0;
+    WindowSummary_t summary;
+    uint64_t durationMs = 0;
+    uint32_t signal = 0;
+
+    ObdPayload_BeginObject( pPayload, ( sliding == true ) ? OBD_KEY_SLIDING : OBD_KEY_TUMBLING );
 
-    /* Update GPS data. */
-    if( useSimulatledGPSData == false )
+    for( signal = 0; signal < OBD_SIGNAL_MAX; signal++ )
     {
-        retGetData = GPSLib_GetData( pObdContext->obdDevice, &gpsData );
+        durationMs = ( sliding == true ) ? WindowAggregate_GetSliding( &pObdContext->window, signal, &summary ) :
+                     WindowAggregate_GetTumbling( &pObdContext->window, signal, &summary );
 
-        if( retGetData == true )
+        if( signal == 0U )
         {
-            if( pObdContext->gpsReceived == false )
-            {
-                pObdContext->gpsReceived = true;
-                buzz_beep( pObdContext->buzzDevice, BUZZ_SHORT_BEEP_DURATION_MS, 3 );
-            }
-
-            CMS_LOGD( TAG, "GPS good data." );
-            pObdContext->latitude = gpsData.lat;
-            pObdContext->longitude = gpsData.lng;
-
-            if( ( pObdContext->startLatitude == 0 ) && ( pObdContext->startLongitude == 0 ) &&
-                ( ( gpsData.lat != 0 ) || ( gpsData.lng != 0 ) ) )
-            {
-                pObdContext->startLatitude = gpsData.lat;
-                pObdContext->startLongitude = gpsData.lng;
-            }
+            ObdPayload_AddInt( pPayload, OBD_KEY_DURATION, ( int64_t ) durationMs );   /* Duration in milliseconds */
+        }
 
-            kph = ( double ) ( ( int ) ( gpsData.speed * 1.852f * 10 ) ) / 10;
+        /* Left out when the signal was not read in the window. */
+        if( summary.count > 0U )
+        {
+            ObdPayload_BeginObject( pPayload, obdSignals[ signal ].key );
+            ObdPayload_AddInt( pPayload, OBD_KEY_SAMPLE_COUNT, summary.count );
+            ObdPayload_AddDouble( pPayload, OBD_KEY_AVERAGE, summary.sum / ( double ) summary.count, obdSignals[ signal ].decimals );
+            ObdPayload_AddDouble( pPayload, OBD_KEY_MIN, summary.min, obdSignals[ signal ].decimals );
+            ObdPayload_AddDouble( pPayload, OBD_KEY_MAX, summary.max, obdSignals[ signal ].decimals );
+            ObdPayload_EndObject( pPayload );
         }
     }
-    else
-    {
-        udpateSimulatedGPSData( pObdContext );
-    }
 
-    return kph;
+    ObdPayload_EndObject( pPayload );
 }
 
 /*-----------------------------------------------------------*/
 
-static void updateTelemetryData( obdContext_t * pObdContext )
+/* Close the open window, then send it and the sliding window ending with it. */
+static BaseType_t sendObdAggregatedData( obdContext_t * pObdContext )
 {
-    int32_t pidValue = 0;
-    ObdTelemetryDataType_t pidIndex = OBD_TELEMETRY_TYPE_STEERING_WHEEL_ANGLE;
-    uint64_t currentTicksMs = ( uint64_t ) xTaskGetTickCountMs();
-    uint64_t timeDiffMs = currentTicksMs - pObdContext->lastUpdateTicksMs;
-
-    bool retReadPID = true;
-    
-    /* If OBD not connected, we use the simulated data. */
-    if( gObdContext.obdDeviceConnected == false )
-    {
-        pObdContext->obdTelemetryData.vehicle_speed = OBD_SIMULATED_VEHICLE_SPEED;
-        pObdContext->updateCount = pObdContext->updateCount + 1;
-        return;
-    }
-
-    /* Update telemetry and aggregated data. */
-    for( pidIndex = OBD_TELEMETRY_TYPE_STEERING_WHEEL_ANGLE; pidIndex < OBD_TELEMETRY_TYPE_MAX; pidIndex++ )
-    {
-        switch( pidIndex )
-        {
-            case OBD_TELEMETRY_TYPE_OIL_TEMP:
-                retReadPID = OBDLib_ReadPID( pObdContext->obdDevice, OBD_TELEMETRY_TYPE_OIL_TEMP_PID, &pidValue );
-
-                if( retReadPID == true )
-                {
-                    pObdContext->obdTelemetryData.oil_temp = ( double ) pidValue;
-                    /* Convert to Fahrenheit. */
-                    pObdContext->obdTelemetryData.oil_temp = pObdContext->obdTelemetryData.oil_temp * 1.8 + 32.0;
-                    if( pObdContext->obdAggregatedData.oil_temp_mean == 0 )
-                    {
-                        pObdContext->obdAggregatedData.oil_temp_mean = pObdContext->obdTelemetryData.oil_temp;
-                    }
-                    else
-                    {
-                        pObdContext->obdAggregatedData.oil_temp_mean =
-                            ( pObdContext->obdAggregatedData.oil_temp_mean * ( pObdContext->updateCount ) ) +
-                            pObdContext->obdTelemetryData.oil_temp;
-                        pObdContext->obdAggregatedData.oil_temp_mean =
-                            pObdContext->obdAggregatedData.oil_temp_mean / ( pObdContext->updateCount + 1 );
-                    }
-                }
-                
-                if( pObdContext->higRpmDurationIntervalMs > CAR_HIGH_OIL_TEMP_RPM_DURATION_MS )
-                {
-                    CMS_LOGI( TAG, "CAR high oil temp." );
-                    pObdContext->obdTelemetryData.oil_temp = CAR_HIGH_OIL_TEMP;
-                }
-
-                break;
-
-            case OBD_TELEMETRY_TYPE_ENGINE_SPEED:
-                retReadPID = OBDLib_ReadPID( pObdContext->obdDevice, PID_RPM, &pidValue );
+    char messageId[ OBD_MESSAGE_ID_MAX ] = { 0 };
+    ObdPayload_t payload;
+    uint64_t nowMs = ( uint64_t ) xTaskGetTickCountMs();
 
-                if( retReadPID == true )
-                {
-                    pObdContext->obdTelemetryData.engine_speed = ( double ) pidValue;
-
-                    if( pObdContext->obdAggregatedData.engine_speed_mean == 0 )
-                    {
-                        pObdContext->obdAggregatedData.engine_speed_mean = pObdContext->obdTelemetryData.engine_speed;
-                    }
-                    else
-                    {
-                        pObdContext->obdAggregatedData.engine_speed_mean =
-                            ( pObdContext->obdAggregatedData.engine_speed_mean * ( pObdContext->updateCount ) ) +
-                            pObdContext->obdTelemetryData.engine_speed;
-                        pObdContext->obdAggregatedData.engine_speed_mean =
-                            pObdContext->obdAggregatedData.engine_speed_mean / ( pObdContext->updateCount + 1 );
-                    }
-
-                    /* Update the simulated high rpm oil temperature. */
-                    if( pObdContext->obdTelemetryData.engine_speed > ( ( double ) CAR_HIGH_OIL_TEMP_RPM ) )
-                    {
-                        pObdContext->higRpmDurationIntervalMs = pObdContext->higRpmDurationIntervalMs + timeDiffMs;
-                    }
-                    else
-                    {
-                        pObdContext->higRpmDurationIntervalMs = 0;
-                    }
-
-                    /* Update the simulated padel position. */
-                    genSimulatePadelPosition( pObdContext );
-                }
+    WindowAggregate_Close( &pObdContext->window, nowMs );
 
-                break;
+    formatMessageTimes( pObdContext, pObdContext->windowStartTicksMs );
+    snprintf( messageId, OBD_MESSAGE_ID_MAX, "%s-%s", pObdContext->vin, pObdContext->creationTime );
 
-            case OBD_TELEMETRY_TYPE_VEHICLE_SPEED:
-                retReadPID = OBDLib_ReadPID( pObdContext->obdDevice, PID_SPEED, &pidValue );
+    snprintf( pObdContext->topicBuf, OBD_TOPIC_BUF_SIZE, OBD_DATA_AGGREGATED_TOPIC, pObdContext->thingName );
 
-                if( retReadPID == true )
-                {
-                    /* Update the simulated Acceleration. */
-                    double previous_speed = pObdContext->obdTelemetryData.vehicle_speed;
-                    pObdContext->obdTelemetryData.vehicle_speed = ( double ) pidValue;
-
-                    if( timeDiffMs != 0 )
-                    {
-                        pObdContext->obdTelemetryData.acceleration =
-                            ( pObdContext->obdTelemetryData.vehicle_speed - previous_speed ) * ( 1000 ) / timeDiffMs;
-                    }
-
-                    /* CMS_LOGD( TAG, "Acceleration %lf.", pObdContext->obdTelemetryData.acceleration ); */
-
-                    /* Update the simulated high speed duration. */
-                    if( pObdContext->obdTelemetryData.vehicle_speed > ( ( double ) CAR_HIGH_SPEED_THRESHOLD ) )
-                    {
-                        pObdContext->highSpeedDurationMs = pObdContext->highSpeedDurationMs + timeDiffMs;
-                    }
-
-                    /* Update the idle time. */
-                    if( pObdContext->obdTelemetryData.vehicle_speed <= ( ( double ) CAR_IDLE_SPEED_THRESHOLD ) )
-                    {
-                        pObdContext->idleSpeedDurationMs = pObdContext->idleSpeedDurationMs + timeDiffMs;
-                        pObdContext->idleSpeedDurationIntervalMs = pObdContext->idleSpeedDurationIntervalMs + timeDiffMs;
-                    }
-                    else
-                    {
-                        pObdContext->idleSpeedDurationIntervalMs = 0;
-                    }
-
-                    /* Update the simulated gear position. */
-                    genSimulateGearPosition( pObdContext );
-
-                    /* Update the aggregated vehicle speed mean. */
-                    if( pObdContext->obdAggregatedData.vehicle_speed_mean == 0 )
-                    {
-                        pObdContext->obdAggregatedData.vehicle_speed_mean = pObdContext->obdTelemetryData.vehicle_speed;
-                    }
-                    else
-                    {
-                        pObdContext->obdAggregatedData.vehicle_speed_mean =
-                            ( pObdContext->obdAggregatedData.vehicle_speed_mean * ( pObdContext->updateCount ) ) +
-                            pObdContext->obdTelemetryData.vehicle_speed;
-                        pObdContext->obdAggregatedData.vehicle_speed_mean =
-                            pObdContext->obdAggregatedData.vehicle_speed_mean / ( pObdContext->updateCount + 1 );
-                    }
-                }
+    ObdPayload_Init( &payload, pObdContext->messageBuf, OBD_MESSAGE_BUF_SIZE );
+    ObdPayload_BeginObject( &payload, OBD_KEY_NONE );
+    ObdPayload_AddString( &payload, OBD_KEY_MESSAGE_ID, messageId );
+    ObdPayload_AddString( &payload, OBD_KEY_CREATION_TIME_STAMP, pObdContext->creationTime );
+    ObdPayload_AddString( &payload, OBD_KEY_SEND_TIME_STAMP, pObdContext->sendTime );
+    ObdPayload_AddString( &payload, OBD_KEY_VIN, pObdContext->vin );
+    ObdPayload_AddString( &payload, OBD_KEY_TRIP_ID, pObdContext->tripId );
+    addWindowSignals( &payload, pObdContext, false );
+    addWindowSignals( &payload, pObdContext, true );
+    ObdPayload_EndObject( &payload );
 
-                break;
+    pObdContext->windowStartTicksMs = nowMs;
 
-            /*
-             * case OBD_TELEMETRY_TYPE_TORQUE_AT_TRANSMISSION:
-             *  retIoctl = OBDLib_ReadPID( pObdContext->obdDevice, PID_ENGINE_TORQUE_PERCENTAGE, &pidValue );
-             *  if( retIoctl == pdPASS )
-             *  {
-             *      pObdContext->obdTelemetryData.torque_at_transmission = ( double )pidValue;
-             *  }
-             *  break;
-             */
-            case OBD_TELEMETRY_TYPE_FUEL_LEVEL:
-                retReadPID = OBDLib_ReadPID( pObdContext->obdDevice, PID_FUEL_LEVEL, &pidValue );
-
-                if( retReadPID == true )
-                {
-                    pObdContext->fuel_level = ( double ) pidValue / 100.0;
-                    /* Update the simulated fuel_consumed_since_restart. */
-                    pObdContext->fuel_consumed_since_restart =
-                        ( pObdContext->start_fuel_level - pObdContext->fuel_level ) * CAR_GAS_TANK_SIZE;
-                }
+    return publishMessage( pObdContext, &payload );
+}
 
-                break;
+/*-----------------------------------------------------------*/
 
-            case OBD_TELEMETRY_TYPE_ODOMETER:
-                /* Update simulated data. */
-                pObdContext->odometer = pObdContext->obdAggregatedData.vehicle_speed_mean *
-                                        ( currentTicksMs - pObdContext->startTicksMs ) / ( 60 * 60 * 1000 );
-                break;
+/* Send the raised driving events, one message each. */
+static BaseType_t sendObdEventData( obdContext_t * pObdContext )
+{
+    char messageId[ OBD_MESSAGE_ID_MAX ] = { 0 };
+    const Event_t * pEvent = NULL;
+    const EventRule_t * pRule = NULL;
+    ObdPayload_t payload;
+    BaseType_t retMqtt = pdPASS;
+    uint32_t i = 0;
 
-            default:
-                break;
+    for( i = 0; i < pObdContext->pendingEventCount; i++ )
+    {
+        pEvent = &pObdContext->pendingEvents[ i ];
+        pRule = &obdEventRules[ pEvent->rule ];
+
+        formatMessageTimes( pObdContext, pEvent->startMs );
+        snprintf( messageId, OBD_MESSAGE_ID_MAX, "%s-%s-%s", pObdContext->vin, pObdContext->creationTime, pRule->pName );
+
+        snprintf( pObdContext->topicBuf, OBD_TOPIC_BUF_SIZE, OBD_DATA_EVENT_TOPIC, pObdContext->thingName );
+
+        ObdPayload_Init( &payload, pObdContext->messageBuf, OBD_MESSAGE_BUF_SIZE );
+        ObdPayload_BeginObject( &payload, OBD_KEY_NONE );
+        ObdPayload_AddString( &payload, OBD_KEY_MESSAGE_ID, messageId );
+        ObdPayload_AddString( &payload, OBD_KEY_CREATION_TIME_STAMP, pObdContext->creationTime );
+        ObdPayload_AddString( &payload, OBD_KEY_SEND_TIME_STAMP, pObdContext->sendTime );
+        ObdPayload_AddString( &payload, OBD_KEY_VIN, pObdContext->vin );
+        ObdPayload_AddString( &payload, OBD_KEY_TRIP_ID, pObdContext->tripId );
+        ObdPayload_BeginObject( &payload, OBD_KEY_EVENT );
+        ObdPayload_AddString( &payload, OBD_KEY_TYPE, pRule->pName );
+        ObdPayload_AddDouble( &payload, OBD_KEY_VALUE, pEvent->peak, obdSignals[ pRule->signal ].decimals );
+        ObdPayload_AddInt( &payload, OBD_KEY_DURATION, pEvent->durationMs );   /* Duration in milliseconds */
+        ObdPayload_BeginObject( &payload, OBD_KEY_GEO_LOCATION );
+        ObdPayload_AddFixed( &payload, OBD_KEY_LATITUDE, pObdContext->latitude, 6 );
+        ObdPayload_AddFixed( &payload, OBD_KEY_LONGITUDE, pObdContext->longitude, 6 );
+        ObdPayload_EndObject( &payload );
+        ObdPayload_EndObject( &payload );
+        ObdPayload_EndObject( &payload );
+
+        CMS_LOGI( TAG, "Event %s value %lf.", pRule->pName, pEvent->peak );
+
+        if( publishMessage( pObdContext, &payload ) == pdFAIL )
+        {
+            retMqtt = pdFAIL;
         }
     }
 
-    /* Update ticks. */
-    pObdContext->lastUpdateTicksMs = ( uint64_t ) xTaskGetTickCountMs();
-    pObdContext->updateCount = pObdContext->updateCount + 1;
+    pObdContext->pendingEventCount = 0;
+
+    return retMqtt;
 }
 
 /*-----------------------------------------------------------*/
@@ -756,31 +1253,41 @@ static BaseType_t checkObdDtcData( obdContext_t * pObdContext )
     int retCodeRead = 0;
     char messageId[ OBD_MESSAGE_ID_MAX ] = { 0 };
     BaseType_t retMqtt = pdPASS;
-
-    snprintf( messageId, OBD_MESSAGE_ID_MAX, "%s-%s", pObdContext->vin, pObdContext->isoTime );
+    char dtcCode[ 8 ] = { 0 };
+    ObdPayload_t payload;
+    uint32_t readTicksMs = xTaskGetTickCountMs();
 
     if( pObdContext->obdDeviceConnected == true )
     {
         retCodeRead = OBDLib_ReadDTC( pObdContext->obdDevice, dtc, MAX_DTC_CODES );
     }
 
+    /* Send the collected samples first to keep the messages in order. */
+    if( ( retCodeRead > 0 ) && ( pdFAIL == sendObdTelemetryData( pObdContext ) ) )
+    {
+        CMS_LOGE( TAG, "Failed to send OBD telemetry data" );
+    }
+
     for( i = 0; i < retCodeRead; i++ )
     {
         snprintf( pObdContext->topicBuf, OBD_TOPIC_BUF_SIZE, OBD_DATA_DTC_TOPIC, pObdContext->thingName );
-        snprintf( pObdContext->messageBuf, OBD_MESSAGE_BUF_SIZE, OBD_DATA_DTC_FORMAT,
-                  messageId,
-                  pObdContext->isoTime,     // CreationTimeStamp
-                  pObdContext->isoTime,     // SendTimeStamp
-                  pObdContext->vin,         // vin
-                  dtc[ i ],                 // DTC code
-                  "true"                    // changed alwasy true
-                  );
-
-        retMqtt = mqttAgentPublish( OBD_MQTT_QOS,
-                                    pObdContext->topicBuf,
-                                    strlen( pObdContext->topicBuf ),
-                                    pObdContext->messageBuf,
-                                    strlen( pObdContext->messageBuf ) );
+        snprintf( dtcCode, sizeof( dtcCode ), "P%04x", dtc[ i ] );
+        formatMessageTimes( pObdContext, readTicksMs );
+        snprintf( messageId, OBD_MESSAGE_ID_MAX, "%s-%s", pObdContext->vin, pObdContext->creationTime );
+
+        ObdPayload_Init( &payload, pObdContext->messageBuf, OBD_MESSAGE_BUF_SIZE );
+        ObdPayload_BeginObject( &payload, OBD_KEY_NONE );
+        ObdPayload_AddString( &payload, OBD_KEY_MESSAGE_ID, messageId );
+        ObdPayload_AddString( &payload, OBD_KEY_CREATION_TIME_STAMP, pObdContext->creationTime );
+        ObdPayload_AddString( &payload, OBD_KEY_SEND_TIME_STAMP, pObdContext->sendTime );
+        ObdPayload_AddString( &payload, OBD_KEY_VIN, pObdContext->vin );
+        ObdPayload_BeginObject( &payload, OBD_KEY_DTC );
+        ObdPayload_AddString( &payload, OBD_KEY_CODE, dtcCode );
+        ObdPayload_AddString( &payload, OBD_KEY_CHANGED, "true" );   /* changed alwasy true */
+        ObdPayload_EndObject( &payload );
+        ObdPayload_EndObject( &payload );
+
+        retMqtt = publishMessage( pObdContext, &payload );
 
         OBDLib_ClearDTC( pObdContext->obdDevice );
     }
@@ -791,162 +1298,129 @@ static BaseType_t checkObdDtcData( obdContext_t * pObdContext )
 
 /*-----------------------------------------------------------*/
 
-static BaseType_t sendObdTelemetryData( obdContext_t * pObdContext )
+/* Trip statistics of one signal, left out when it was never read. */
+static void addSignalStatistics( ObdPayload_t * pPayload,
+                                 ObdPayloadKey_t key,
+                                 const StreamStats_t * pStats,
+                                 uint8_t decimals )
 {
-    BaseType_t retMqtt = pdPASS;
-    char messageId[ OBD_MESSAGE_ID_MAX ] = { 0 };
-    uint32_t msgLength = 0;
-    
-    snprintf( messageId, OBD_MESSAGE_ID_MAX, "%s-%s", pObdContext->vin, pObdContext->isoTime );
-
-    snprintf( pObdContext->topicBuf, OBD_TOPIC_BUF_SIZE, OBD_DATA_TELEMETRY_TOPIC, pObdContext->thingName );
+    if( pStats->count == 0U )
+    {
+        return;
+    }
 
-    msgLength = snprintf( pObdContext->messageBuf,
-            OBD_MESSAGE_BUF_SIZE, OBD_DATA_TELEMETRY_FORMAT_1,
-              messageId,                // messageId
-              "iotlabtpesim",           // SimulationId
-              pObdContext->isoTime,     // CreationTimeStamp
-              pObdContext->isoTime,     // SendTimeStamp
-              pObdContext->vin,         // vin
-              pObdContext->tripId,      // TripId
-              ""                        // DriverID
-    );
-
-    msgLength = msgLength + snprintf( &pObdContext->messageBuf[ msgLength ], 
-            OBD_MESSAGE_BUF_SIZE, OBD_DATA_TELEMETRY_FORMAT_2,
-              // GeoLocation data
-              pObdContext->latitude,    // Latitude
-              pObdContext->longitude,    // Longitude
-              0.0,                      // Altitude
-              0.0,                      // Heading
-              pObdContext->obdTelemetryData.vehicle_speed      // Speed KM/H
-    );
-    
-    msgLength = msgLength + snprintf( &pObdContext->messageBuf[ msgLength ], 
-            OBD_MESSAGE_BUF_SIZE - msgLength, OBD_DATA_TELEMETRY_FORMAT_3,
-              // Communications
-              "",                       // Satelites
-              "",                       // Fix
-              "",                       // NetworkType
-              "",                       // MNC
-              "",                       // MCC
-              "",                       // LAC
-              "",                       // CID
-              // WIFI
-              "",                       // NetworkID
-              // Wired
-              ""                       // NetworkID
-    );
-    
-    msgLength = msgLength + snprintf( &pObdContext->messageBuf[ msgLength ], 
-            OBD_MESSAGE_BUF_SIZE - msgLength, OBD_DATA_TELEMETRY_FORMAT_4,
-              // Acceleration
-              // MaxLongitudinal
-              0.0,                      // Axis
-              0.0,                      // Value
-              // MaxLateral
-              0.0,                      // Axis
-              0.0,                      // Value
-              // Throttle
-              0.0,                      // Max
-              0.0,                      // Average
-              // Speed
-              pObdContext->obdTelemetryData.vehicle_speed,      // Max
-              pObdContext->obdAggregatedData.vehicle_speed_mean     // Average
-    );
-    
-    msgLength = msgLength + snprintf( &pObdContext->messageBuf[ msgLength ],
-            OBD_MESSAGE_BUF_SIZE - msgLength, OBD_DATA_TELEMETRY_FORMAT_5,
-              // Odometer
-              pObdContext->odometer,    // metres KM can be 0
-              0.0,                      // TicksFL
-              0.0,                      // TicksFR
-              0.0,                      // TicksRL
-              0.0                       // TicksRR
-    );
-    
-    msgLength = msgLength + snprintf( &pObdContext->messageBuf[ msgLength ],
-            OBD_MESSAGE_BUF_SIZE - msgLength, OBD_DATA_TELEMETRY_FORMAT_6,
-              pObdContext->fuel_level * CAR_GAS_TANK_SIZE,  // Fuel in L
-              pObdContext->tripName                         // Name unique route name for this trip
-    );
-    
-    msgLength = msgLength + snprintf( &pObdContext->messageBuf[ msgLength ],
-            OBD_MESSAGE_BUF_SIZE - msgLength, OBD_DATA_TELEMETRY_FORMAT_7,
-              pObdContext->obdTelemetryData.oil_temp,       // OilTemp
-
-              // FuelInfo
-              pObdContext->fuel_consumed_since_restart,     // CurrentTripConsumption
-              CAR_GAS_TANK_SIZE                            // TankCapacity
-    );
-    
-    msgLength = msgLength + snprintf( &pObdContext->messageBuf[ msgLength ],
-            OBD_MESSAGE_BUF_SIZE - msgLength, OBD_DATA_TELEMETRY_FORMAT_8,
-            pObdContext->ignition_status                  // IgnitionStatus
-    );
-
-    retMqtt = mqttAgentPublish( OBD_MQTT_QOS,
-                                pObdContext->topicBuf,
-                                strlen( pObdContext->topicBuf ),
-                                pObdContext->messageBuf,
-                                strlen( pObdContext->messageBuf )
-                              );
-    return retMqtt;
+    ObdPayload_BeginObject( pPayload, key );
+    ObdPayload_AddInt( pPayload, OBD_KEY_SAMPLE_COUNT, pStats->count );
+    ObdPayload_AddDouble( pPayload, OBD_KEY_AVERAGE, pStats->mean, decimals );
+    ObdPayload_AddDouble( pPayload, OBD_KEY_TIME_AVERAGE, StreamStats_GetTimeWeightedMean( pStats ), decimals );
+    ObdPayload_AddDouble( pPayload, OBD_KEY_MIN, pStats->min, decimals );
+    ObdPayload_AddDouble( pPayload, OBD_KEY_MAX, pStats->max, decimals );
+    ObdPayload_AddDouble( pPayload, OBD_KEY_STD_DEV, StreamStats_GetStdDev( pStats ), decimals );
+    ObdPayload_AddDouble( pPayload, OBD_KEY_P50, StreamQuantile_Get( &pStats->p50 ), decimals );
+    ObdPayload_AddDouble( pPayload, OBD_KEY_P95, StreamQuantile_Get( &pStats->p95 ), decimals );
+    ObdPayload_EndObject( pPayload );
 }
 
 /*-----------------------------------------------------------*/
 
 static BaseType_t sendObdTripData( obdContext_t * pObdContext )
 {
-    BaseType_t retMqtt = pdPASS;
     char messageId[ OBD_MESSAGE_ID_MAX ] = { 0 };
-    uint32_t msgLength = 0;
     uint32_t tripDuration = ( uint32_t ) ( pObdContext->lastUpdateTicksMs - pObdContext->startTicksMs );
-
-    snprintf( messageId, OBD_MESSAGE_ID_MAX, "%s-%s", pObdContext->vin, pObdContext->isoTime );
+    ObdPayload_t payload;
+    char * pPath = NULL;
+    size_t pathSpace = 0;
+    bool pathEscape = true;
+    int32_t pathLength = 0;
+    uint32_t signal = 0;
+
+    formatMessageTimes( pObdContext, pObdContext->lastUpdateTicksMs );
+    snprintf( messageId, OBD_MESSAGE_ID_MAX, "%s-%s", pObdContext->vin, pObdContext->creationTime );
     
     snprintf( pObdContext->topicBuf, OBD_TOPIC_BUF_SIZE, OBD_DATA_TRIP_TOPIC, pObdContext->thingName );
-    msgLength = snprintf( pObdContext->messageBuf, OBD_MESSAGE_BUF_SIZE, OBD_DATA_TRIP_FORMAT_1,
-              messageId,                // MessageId
-              pObdContext->isoTime,     // CreationTimeStamp
-              pObdContext->isoTime,     // SendTimeStamp
-              pObdContext->vin,         // vin
-              pObdContext->tripId       // TripId
-    );
-    msgLength = msgLength + snprintf( &pObdContext->messageBuf[ msgLength ], 
-                OBD_MESSAGE_BUF_SIZE - msgLength, OBD_DATA_TRIP_FORMAT_2,
-              // TripSummary
-              pObdContext->obdAggregatedData.start_time        // StartTime
-    );
-
-    msgLength = msgLength + snprintf( &pObdContext->messageBuf[ msgLength ], 
-                OBD_MESSAGE_BUF_SIZE - msgLength, OBD_DATA_TRIP_FORMAT_3,
-              pObdContext->odometer,                            // Distance
-              tripDuration,                                     // Duration in milliseconds
-              pObdContext->fuel_consumed_since_restart * 1000.0  // Fuel in ml
-    );
-    msgLength = msgLength + snprintf( &pObdContext->messageBuf[ msgLength ], 
-                OBD_MESSAGE_BUF_SIZE - msgLength, OBD_DATA_TRIP_FORMAT_4,
-              // StartLocation
-              pObdContext->startLatitude,   // Latitude
-              pObdContext->startLongitude,  // Longitude
-              0.0                          // Altitude
-    );
-    msgLength = msgLength + snprintf( &pObdContext->messageBuf[ msgLength ], 
-                OBD_MESSAGE_BUF_SIZE - msgLength, OBD_DATA_TRIP_FORMAT_5,
-              // EndLocation
-              pObdContext->latitude,        // Latitude
-              pObdContext->longitude,       // Longitude
-              0.0,                          // Altitude
-              0.0                           // SpeedProfiler
-              );
-
-    retMqtt = mqttAgentPublish( OBD_MQTT_QOS,
-                                pObdContext->topicBuf,
-                                strlen( pObdContext->topicBuf ),
-                                pObdContext->messageBuf,
-                                strlen( pObdContext->messageBuf ) );
-    return retMqtt;
+
+    ObdPayload_Init( &payload, pObdContext->messageBuf, OBD_MESSAGE_BUF_SIZE );
+    ObdPayload_BeginObject( &payload, OBD_KEY_NONE );
+    ObdPayload_AddString( &payload, OBD_KEY_MESSAGE_ID, messageId );
+    ObdPayload_AddString( &payload, OBD_KEY_CREATION_TIME_STAMP, pObdContext->creationTime );
+    ObdPayload_AddString( &payload, OBD_KEY_SEND_TIME_STAMP, pObdContext->sendTime );
+    ObdPayload_AddString( &payload, OBD_KEY_VIN, pObdContext->vin );
+    ObdPayload_AddString( &payload, OBD_KEY_TRIP_ID, pObdContext->tripId );
+
+    ObdPayload_BeginObject( &payload, OBD_KEY_TRIP_SUMMARY );
+    ObdPayload_AddString( &payload, OBD_KEY_START_TIME, pObdContext->obdAggregatedData.start_time );
+    ObdPayload_AddDouble( &payload, OBD_KEY_DISTANCE, pObdContext->odometer, OBD_PAYLOAD_DECIMALS_DISTANCE );
+    ObdPayload_AddInt( &payload, OBD_KEY_DURATION, tripDuration );   /* Duration in milliseconds */
+    ObdPayload_AddDouble( &payload, OBD_KEY_FUEL, pObdContext->fuel_consumed_since_restart * 1000.0, OBD_PAYLOAD_DECIMALS_FUEL_ML );    /* Fuel in ml */
+
+    ObdPayload_BeginObject( &payload, OBD_KEY_START_LOCATION );
+    ObdPayload_AddFixed( &payload, OBD_KEY_LATITUDE, pObdContext->startLatitude, 6 );
+    ObdPayload_AddFixed( &payload, OBD_KEY_LONGITUDE, pObdContext->startLongitude, 6 );
+    addPlaceholder( &payload, OBD_KEY_ALTITUDE );
+    ObdPayload_EndObject( &payload );
+
+    ObdPayload_BeginObject( &payload, OBD_KEY_END_LOCATION );
+    ObdPayload_AddFixed( &payload, OBD_KEY_LATITUDE, pObdContext->latitude, 6 );
+    ObdPayload_AddFixed( &payload, OBD_KEY_LONGITUDE, pObdContext->longitude, 6 );
+    addPlaceholder( &payload, OBD_KEY_ALTITUDE );
+    ObdPayload_EndObject( &payload );
+
+    addPlaceholder( &payload, OBD_KEY_SPEED_PROFILE );
+
+    ObdPayload_BeginObject( &payload, OBD_KEY_STATISTICS );
+
+    for( signal = 0; signal < OBD_SIGNAL_MAX; signal++ )
+    {
+        addSignalStatistics( &payload, obdSignals[ signal ].key,
+                             &pObdContext->signalStats[ signal ], obdSignals[ signal ].decimals );
+    }
+
+    ObdPayload_EndObject( &payload );
+
+    /* Encoded polyline of the trip path written in place, drop points until it fits. */
+    TripPath_Finish( &pObdContext->tripPath );
+    pPath = ObdPayload_BeginString( &payload, OBD_KEY_PATH, &pathSpace, &pathEscape );
+
+    if( pPath != NULL )
+    {
+        pathSpace = ( pathSpace > OBD_PAYLOAD_CLOSING_SPACE ) ? ( pathSpace - OBD_PAYLOAD_CLOSING_SPACE ) : 0;
+        pathLength = TripPath_Encode( &pObdContext->tripPath, pPath, pathSpace, pathEscape );
+
+        while( ( pathLength < 0 ) && ( TripPath_Compact( &pObdContext->tripPath ) == true ) )
+        {
+            pathLength = TripPath_Encode( &pObdContext->tripPath, pPath, pathSpace, pathEscape );
+        }
+    }
+
+    ObdPayload_EndString( &payload, ( pathLength > 0 ) ? ( size_t ) pathLength : 0 );
+    ObdPayload_EndObject( &payload );
+    ObdPayload_EndObject( &payload );
+
+    return publishMessage( pObdContext, &payload );
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t sendMaintenanceData( obdContext_t * pObdContext,
+                                       const char * pMessageId,
+                                       const char * pId,
+                                       const char * pVal )
+{
+    ObdPayload_t payload;
+
+    ObdPayload_Init( &payload, pObdContext->messageBuf, OBD_MESSAGE_BUF_SIZE );
+    ObdPayload_BeginObject( &payload, OBD_KEY_NONE );
+    ObdPayload_AddString( &payload, OBD_KEY_MESSAGE_ID, pMessageId );
+    ObdPayload_AddString( &payload, OBD_KEY_CREATION_TIME_STAMP, pObdContext->creationTime );
+    ObdPayload_AddString( &payload, OBD_KEY_SEND_TIME_STAMP, pObdContext->sendTime );
+    ObdPayload_AddString( &payload, OBD_KEY_VIN, pObdContext->vin );
+    ObdPayload_BeginObject( &payload, OBD_KEY_MAINTENANCE );
+    ObdPayload_AddString( &payload, OBD_KEY_ID, pId );
+    ObdPayload_AddString( &payload, OBD_KEY_VAL, pVal );
+    ObdPayload_EndObject( &payload );
+    ObdPayload_EndObject( &payload );
+
+    return publishMessage( pObdContext, &payload );
 }
 
 /*-----------------------------------------------------------*/
@@ -955,62 +1429,212 @@ static BaseType_t resetCarError( obdContext_t * pObdContext )
 {
     BaseType_t retMqtt = pdPASS;
     char messageId[ OBD_MESSAGE_ID_MAX ] = { 0 };
-    uint32_t msgLength = 0;
     
-    snprintf( messageId, OBD_MESSAGE_ID_MAX, "%s-%s", pObdContext->vin, pObdContext->isoTime );
+    formatMessageTimes( pObdContext, xTaskGetTickCountMs() );
+    snprintf( messageId, OBD_MESSAGE_ID_MAX, "%s-%s", pObdContext->vin, pObdContext->creationTime );
     
     snprintf( pObdContext->topicBuf, OBD_TOPIC_BUF_SIZE, OBD_MAINTENANCE_TOPIC, pObdContext->thingName );
     
     /* Anomalies. */
-    msgLength = snprintf( pObdContext->messageBuf, OBD_MESSAGE_BUF_SIZE, OBD_MAINTENANCE_FORMAT,
-              messageId,                // MessageId
-              pObdContext->isoTime,     // CreationTimeStamp
-              pObdContext->isoTime,     // SendTimeStamp
-              pObdContext->vin,         // vin
-              // maintenance
-              "anomalies",              // ID
-              "A:OilTemp"               // Val
-    );
-
-    retMqtt = mqttAgentPublish( OBD_MQTT_QOS,
-                                pObdContext->topicBuf,
-                                strlen( pObdContext->topicBuf ),
-                                pObdContext->messageBuf,
-                                msgLength );
+    retMqtt = sendMaintenanceData( pObdContext, messageId, "anomalies", "A:OilTemp" );
 
     if( retMqtt == pdPASS )
     {
         /* DTC. */
-        msgLength = snprintf( pObdContext->messageBuf, OBD_MESSAGE_BUF_SIZE, OBD_MAINTENANCE_FORMAT,
-                  messageId,                // MessageId
-                  pObdContext->isoTime,     // CreationTimeStamp
-                  pObdContext->isoTime,     // SendTimeStamp
-                  pObdContext->vin,         // vin
-                  // maintenance
-                  "trouble_codes",          // ID
-                  ""                        // Val
-        );
-
-        retMqtt = mqttAgentPublish( OBD_MQTT_QOS,
-                                    pObdContext->topicBuf,
-                                    strlen( pObdContext->topicBuf ),
-                                    pObdContext->messageBuf,
-                                    msgLength );
+        retMqtt = sendMaintenanceData( pObdContext, messageId, "trouble_codes", "" );
     }
     return retMqtt;
 }
 
 /*-----------------------------------------------------------*/
 
+static void applyRuntimeConfig( obdContext_t * pObdContext )
+{
+    const RuntimeConfig_t * pConfig = &pObdContext->config;
+    uint32_t i = 0;
+
+    TelemetryBatch_SetLimits( &pObdContext->telemetryBatch, pConfig->batchMaxSamples, pConfig->batchMaxMs );
+
+    for( i = 0; i < OBD_SIGNAL_MAX; i++ )
+    {
+        SignalRegistry_SetEnabled( &pObdContext->signals, i, ( pConfig->enabledSignals & SIGNAL_BIT( i ) ) != 0U );
+    }
+
+    PublishService_SetOptions( pConfig->qos, pConfig->compression );
+
+    CMS_LOGI( TAG, "Collect every %u ms, sample every %u ms, batch %u samples or %u ms, signals 0x%x, qos %u.",
+              ( unsigned int ) pConfig->collectIntervalMs, ( unsigned int ) pConfig->telemetryIntervalMs,
+              ( unsigned int ) pConfig->batchMaxSamples, ( unsigned int ) pConfig->batchMaxMs,
+              ( unsigned int ) pConfig->enabledSignals, ( unsigned int ) pConfig->qos );
+}
+
+/*-----------------------------------------------------------*/
+
+static void updateVehicleState( obdContext_t * pObdContext,
+                                bool running,
+                                double gpsSpeed )
+{
+    double speed = SignalRegistry_Get( &pObdContext->signals, OBD_SIGNAL_VEHICLE_SPEED );
+    bool eventActive = ( EventEngine_GetActive( &pObdContext->eventEngine ) & OBD_EVENT_RULES_DYNAMIC ) != 0U;
+
+    if( gpsSpeed > speed )
+    {
+        speed = gpsSpeed;
+    }
+
+    if( VehicleState_Update( &pObdContext->vehicleState, running, speed, eventActive,
+                             ( uint64_t ) xTaskGetTickCountMs() ) == true )
+    {
+        CMS_LOGI( TAG, "Vehicle state %s.", VehicleState_GetName( pObdContext->vehicleState.state ) );
+    }
+
+    /* Also follows the configured intervals. */
+    VehicleState_GetProfile( pObdContext->vehicleState.state,
+                             pObdContext->config.collectIntervalMs,
+                             pObdContext->config.telemetryIntervalMs,
+                             &pObdContext->rates );
+    GPSService_SetActive( pObdContext->rates.gpsActive );
+}
+
+/*-----------------------------------------------------------*/
+
+static void saveTripCheckpoint( obdContext_t * pObdContext,
+                                bool ended )
+{
+    ObdTripCheckpoint_t * pCheckpoint = &pObdContext->checkpoint;
+    uint64_t nowTicksMs = ( uint64_t ) xTaskGetTickCountMs();
+
+    /* The gap to the next boot can only be measured on the wall clock. */
+    if( ( TRIP_REPLAY_ENABLE == 0 ) && ( ClockService_GetSource() != CLOCK_SOURCE_UPTIME ) )
+    {
+        memset( pCheckpoint, 0, sizeof( ObdTripCheckpoint_t ) );
+        strncpy( pCheckpoint->tripId, pObdContext->tripId, OBD_TRIP_ID_MAX - 1 );
+        pCheckpoint->savedEpochMs = ClockService_NowMs();
+        pCheckpoint->startEpochMs = pCheckpoint->savedEpochMs - ( nowTicksMs - pObdContext->startTicksMs );
+        pCheckpoint->distanceMm = TripOdometer_GetDistanceMm( &pObdContext->tripOdometer );
+        pCheckpoint->highSpeedDurationMs = pObdContext->highSpeedDurationMs;
+        pCheckpoint->idleSpeedDurationMs = pObdContext->idleSpeedDurationMs;
+        pCheckpoint->startFuelLevel = pObdContext->start_fuel_level;
+        pCheckpoint->startLatitude = pObdContext->startLatitude;
+        pCheckpoint->startLongitude = pObdContext->startLongitude;
+        pCheckpoint->startDirection = pObdContext->startDirection;
+        pCheckpoint->ended = ended;
+        pCheckpoint->highAccelerationEvents = pObdContext->obdAggregatedData.high_acceleration_event;
+        pCheckpoint->highBrakingEvents = pObdContext->obdAggregatedData.high_braking_event;
+        memcpy( pCheckpoint->signalStats, pObdContext->signalStats, sizeof( pCheckpoint->signalStats ) );
+        memcpy( &pCheckpoint->tripPath, &pObdContext->tripPath, sizeof( TripPath_t ) );
+
+        ( void ) TripCheckpoint_Save( pCheckpoint );
+    }
+
+    pObdContext->checkpointTicksMs = nowTicksMs;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Takes the trip id and distance of a checkpoint saved shortly before, or of
+ * the RTC memory for a trip started after the last checkpoint ended. */
+static TripResume_t resumeTrip( obdContext_t * pObdContext )
+{
+    const ObdTripCheckpoint_t * pCheckpoint = NULL;
+    char odometerTripId[ OBD_TRIP_ID_MAX ] = { 0 };
+    bool odometerResumed = false;
+    uint64_t distanceMm = 0;
+    TripResume_t resume = TRIP_RESUME_NONE;
+
+    if( ( TRIP_REPLAY_ENABLE == 0 ) && ( TripCheckpoint_Load( &pObdContext->checkpoint ) == true ) )
+    {
+        pCheckpoint = &pObdContext->checkpoint;
+    }
+
+    odometerResumed = TripOdometer_Resume( &pObdContext->tripOdometer, odometerTripId, OBD_TRIP_ID_MAX );
+    resume = TripCheckpoint_GetResume( pCheckpoint, ( odometerResumed == true ) ? odometerTripId : NULL,
+                                       ClockService_GetSource() != CLOCK_SOURCE_UPTIME, ClockService_NowMs() );
+
+    if( resume == TRIP_RESUME_CHECKPOINT )
+    {
+        distanceMm = pCheckpoint->distanceMm;
+
+        /* The RTC memory survives a soft reset and may have the distance after
+         * the checkpoint. The distance only grows, the larger one is newer. */
+        if( ( odometerResumed == true ) && ( strcmp( odometerTripId, pCheckpoint->tripId ) == 0 ) &&
+            ( TripOdometer_GetDistanceMm( &pObdContext->tripOdometer ) > distanceMm ) )
+        {
+            distanceMm = TripOdometer_GetDistanceMm( &pObdContext->tripOdometer );
+        }
+
+        strcpy( pObdContext->tripId, pCheckpoint->tripId );
+        TripOdometer_Continue( &pObdContext->tripOdometer, pCheckpoint->tripId, distanceMm );
+    }
+    else if( resume == TRIP_RESUME_ODOMETER )
+    {
+        strcpy( pObdContext->tripId, odometerTripId );
+    }
+    else
+    {
+        /* A stale or ended trip is not continued by a later soft reset either. */
+        TripOdometer_Stop( &pObdContext->tripOdometer );
+    }
+
+    return resume;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Replaces the start information of a resumed trip with the checkpoint. The
+ * windows are not restored, they only cover the last minutes of the uptime of
+ * the previous boot. */
+static void restoreTripCheckpoint( obdContext_t * pObdContext )
+{
+    const ObdTripCheckpoint_t * pCheckpoint = &pObdContext->checkpoint;
+    uint64_t nowTicksMs = ( uint64_t ) xTaskGetTickCountMs();
+    uint32_t i = 0;
+
+    /* May be before boot and wrap, only differences of the ticks are used. */
+    pObdContext->startTicksMs = nowTicksMs - ( ClockService_NowMs() - pCheckpoint->startEpochMs );
+    ( void ) ClockService_Format( pCheckpoint->startEpochMs,
+                                  pObdContext->obdAggregatedData.start_time,
+                                  sizeof( pObdContext->obdAggregatedData.start_time ) );
+    pObdContext->start_fuel_level = pCheckpoint->startFuelLevel;
+    pObdContext->highSpeedDurationMs = pCheckpoint->highSpeedDurationMs;
+    pObdContext->idleSpeedDurationMs = pCheckpoint->idleSpeedDurationMs;
+    pObdContext->obdAggregatedData.high_acceleration_event = pCheckpoint->highAccelerationEvents;
+    pObdContext->obdAggregatedData.high_braking_event = pCheckpoint->highBrakingEvents;
+    memcpy( &pObdContext->tripPath, &pCheckpoint->tripPath, sizeof( TripPath_t ) );
+
+    if( ( pCheckpoint->startLatitude != 0 ) || ( pCheckpoint->startLongitude != 0 ) )
+    {
+        pObdContext->startLatitude = pCheckpoint->startLatitude;
+        pObdContext->startLongitude = pCheckpoint->startLongitude;
+        pObdContext->startDirection = pCheckpoint->startDirection;
+    }
+
+    /* The last values did not hold while the device was off. */
+    for( i = 0; i < OBD_SIGNAL_MAX; i++ )
+    {
+        pObdContext->signalStats[ i ] = pCheckpoint->signalStats[ i ];
+        pObdContext->signalStats[ i ].lastTimeMs = nowTicksMs;
+    }
+
+    snprintf( pObdContext->tripName, OBD_TRIP_NAME_MAX, "trip_%s", pObdContext->tripId );
+}
+
+/*-----------------------------------------------------------*/
+
 void vehicleTelemetryReportTask( void )
 {
     uint64_t loopSteps = 0;
     uint32_t startTicksMs = 0, elapsedTicksMs = 0;
+    uint32_t lastSampleTicksMs = 0;
     bool ignitionStatus = false;
     int i = 0;
-    double vehicleSpeed = 0;
     double gpsSpeed = 0;
     bool useSimulatledGPSData = false;
+    bool tripResumed = false;
+    TripResume_t tripResume = TRIP_RESUME_NONE;
+    bool tripStarting = false;
+    uint64_t stepStartUs = 0;
+    uint64_t stageStartUs = 0;
 
     gObdContext.buzzDevice = FreeRTOS_open( ( int8_t * )( "/dev/buzz" ), 0 );
 
@@ -1022,7 +1646,12 @@ void vehicleTelemetryReportTask( void )
 
     /* Open the OBD devices. */
     CMS_LOGI( TAG, "Start obd device init." );
-    gObdContext.obdDevice = FreeRTOS_open( ( int8_t *) ( "/dev/obd" ), 0 );
+    #if ( TRIP_REPLAY_ENABLE == 1 )
+        /* The recorded trip answers in place of the vehicle. */
+        gObdContext.obdDevice = TripReplay_Open( TRIP_REPLAY_SPEED );
+    #else
+        gObdContext.obdDevice = FreeRTOS_open( ( int8_t *) ( "/dev/obd" ), 0 );
+    #endif
 
     if( gObdContext.obdDevice == NULL )
     {
@@ -1075,15 +1704,33 @@ void vehicleTelemetryReportTask( void )
     #endif /* ifdef OBD_DEFAULT_VIN */
     CMS_LOGD( TAG, "thing name is : %s.", gObdContext.thingName );
 
-    /* Enable GPS device. */
-    GPSLib_Begin( gObdContext.obdDevice );
+    /* Timestamps count from boot until GPS or NTP sets the clock. */
+    ClockService_Init();
+
+    /* Enable GPS device. The GPS service polls it in the background. */
+    GPSService_Start( gObdContext.obdDevice );
+
+    SignalRegistry_Init( &gObdContext.signals, obdSignals, OBD_SIGNAL_MAX );
+    EventEngine_Init( &gObdContext.eventEngine, obdEventRules, OBD_EVENT_RULE_MAX );
+    RuntimeConfig_Init( &gObdContext.config, OBD_SIGNAL_MAX );
+    VehicleState_Init( &gObdContext.vehicleState );
+
+    /* Messages are sent from the publisher task. */
+    if( PublishService_Start() == false )
+    {
+        CMS_LOGE( TAG, "Publish service not started." );
+    }
+
+    /* Settings received later are applied at the top of the loop. */
+    applyRuntimeConfig( &gObdContext );
+    ( void ) RuntimeConfig_Subscribe( gObdContext.thingName );
 
     /* the external trip loop. */
     while( true )
     {
         resetTelemetryData( &gObdContext );
 
-        updateTimestamp( &gObdContext, NULL );
+        updateTimestamp( &gObdContext );
 
         /* Reset car previous error. */
         if( pdFAIL == resetCarError( &gObdContext ) )
@@ -1099,64 +1746,127 @@ void vehicleTelemetryReportTask( void )
         while( true )
         {
             startTicksMs = xTaskGetTickCountMs();
+            stepStartUs = obdStageBegin();
 
-            updateTimestamp( &gObdContext, NULL );
+            /* Parked, the GPS is paused and only the battery voltage is polled
+             * until the engine starts. Nothing else runs in the step. */
+            if( ignitionStatus == false )
+            {
+                updateVehicleState( &gObdContext, false, 0.0 );
 
-            /* Check the DTC events. */
-            if( pdFAIL == checkObdDtcData( &gObdContext ) )
+                if( waitForIgnition( &gObdContext, gObdContext.rates.collectIntervalMs ) == false )
+                {
+                    continue;
+                }
+
+                ignitionStatus = true;
+                tripStarting = true;
+
+                /* The GPS kept tracking while paused, the next poll reports its fix. */
+                GPSService_SetActive( true );
+
+                if( waitGpsFix( VEHICLE_STATE_GPS_RESUME_MS ) == false )
+                {
+                    CMS_LOGW( TAG, "GPS is not ready, use simulated GPS data." );
+                    useSimulatledGPSData = true;
+                    gObdContext.startLatitude = 0;
+                    gObdContext.startLongitude = 0;
+                    gObdContext.startDirection = 0;
+                }
+            }
+
+            /* All settings of a config message change at the same step. */
+            if( RuntimeConfig_Fetch( &gObdContext.config ) == true )
             {
-                CMS_LOGE( TAG, "Failed to check obd DTC data" );
+                applyRuntimeConfig( &gObdContext );
+                ( void ) RuntimeConfig_Save( &gObdContext.config );
             }
 
-            /* Check the Location data events. */
-            gpsSpeed = updateGPSData( &gObdContext, useSimulatledGPSData );
+            updateTimestamp( &gObdContext );
 
-            /* Check the ignition status. */
-            if( ignitionStatus == false )
+            if( tripStarting == true )
             {
-                /* Wait until there is speed. */
-                vehicleSpeed = obdReadVehicleSpeed( &gObdContext );
+                /* Continue the trip that a reset interrupted, or use time info as trip ID. */
+                tripResume = resumeTrip( &gObdContext );
+                tripResumed = ( tripResume == TRIP_RESUME_CHECKPOINT );
 
-                if( ( vehicleSpeed <= CAR_IDLE_SPEED_THRESHOLD ) && ( gpsSpeed <= CAR_IDLE_SPEED_THRESHOLD ) )
+                if( tripResumed == true )
                 {
-                    vTaskDelay( pdMS_TO_TICKS(OBD_DATA_COLLECT_INTERVAL_MS) );
-                    continue;
+                    CMS_LOGI( TAG, "Resume trip id %s from checkpoint.", gObdContext.tripId );
+                }
+                else if( tripResume == TRIP_RESUME_ODOMETER )
+                {
+                    snprintf( gObdContext.tripName, OBD_TRIP_NAME_MAX, "trip_%s", gObdContext.tripId );
+                    CMS_LOGI( TAG, "Resume trip id %s.", gObdContext.tripId );
                 }
                 else
                 {
-                    ignitionStatus = true;
-                    if( gpsSpeed == 0 )
-                    {
-                        CMS_LOGW( TAG, "GPS is not ready, use simulated GPS data." );
-                        useSimulatledGPSData = true;
-                        gObdContext.startLatitude = 0;
-                        gObdContext.startLongitude = 0;
-                        gObdContext.startDirection = 0;
-                    }
-
-                    CMS_LOGD( TAG, "Vehicle speed %lf gps speed %lf for ignition.", vehicleSpeed, gpsSpeed );
-
-                    /* Use time info as trip ID. */
                     genTripId( &gObdContext );
+                    TripOdometer_Start( &gObdContext.tripOdometer, gObdContext.tripId );
                     CMS_LOGI( TAG, "Start a new trip id %s.", gObdContext.tripId );
+                }
 
-                    /* Save the start information. */
-                    gObdContext.startTicksMs = ( uint64_t ) xTaskGetTickCountMs();
-                    gObdContext.lastUpdateTicksMs = gObdContext.startTicksMs;
-                    updateTelemetryData( &gObdContext );
-                    strcpy( gObdContext.obdAggregatedData.start_time, gObdContext.isoTime );
-                    gObdContext.start_fuel_level = gObdContext.fuel_level;
+                /* The path and the windows start with the engine. */
+                TripPath_Init( &gObdContext.tripPath );
+                WindowAggregate_Init( &gObdContext.window, ( uint64_t ) xTaskGetTickCountMs() );
+                gObdContext.windowStartTicksMs = ( uint64_t ) xTaskGetTickCountMs();
+
+                /* Save the start information. */
+                gObdContext.startTicksMs = ( uint64_t ) xTaskGetTickCountMs();
+                gObdContext.lastUpdateTicksMs = gObdContext.startTicksMs;
+                gObdContext.checkpointTicksMs = gObdContext.startTicksMs;
+                ( void ) ClockService_Format( ClockService_TicksToEpochMs( ( uint32_t ) gObdContext.startTicksMs ),
+                                              gObdContext.obdAggregatedData.start_time,
+                                              sizeof( gObdContext.obdAggregatedData.start_time ) );
+
+                /* Before the first values of this boot, they add to the restored ones. */
+                if( tripResumed == true )
+                {
+                    restoreTripCheckpoint( &gObdContext );
+                }
+
+                /* save the ignition event. */
+                strncpy( gObdContext.ignition_status, "run", OBD_IGNITION_MAX );
+            }
+
+            /* Check the DTC events. */
+            if( pdFAIL == checkObdDtcData( &gObdContext ) )
+            {
+                CMS_LOGE( TAG, "Failed to check obd DTC data" );
+            }
+
+            /* Check the Location data events. */
+            stageStartUs = obdStageBegin();
+            gpsSpeed = updateGPSData( &gObdContext, useSimulatledGPSData );
+            obdStageEnd( TRIP_REPLAY_STAGE_GPS, stageStartUs );
+
+            /* Update telemetry data. */
+            updateTelemetryData( &gObdContext );
+
+            if( tripStarting == true )
+            {
+                tripStarting = false;
 
-                    /* save the ignition event. */
-                    strncpy( gObdContext.ignition_status, "run", OBD_IGNITION_MAX );
+                /* The first level read, a resumed trip keeps its own. */
+                if( tripResumed == false )
+                {
+                    gObdContext.start_fuel_level = gObdContext.fuel_level;
                 }
             }
-            else
+
+            /* Send the driving events at once. */
+            stageStartUs = obdStageBegin();
+
+            if( pdFAIL == sendObdEventData( &gObdContext ) )
             {
-                /* Update telemetry data. */
-                updateTelemetryData( &gObdContext );
+                CMS_LOGE( TAG, "Failed to send OBD event data" );
             }
 
+            obdStageEnd( TRIP_REPLAY_STAGE_ENCODE, stageStartUs );
+
+            /* The rates of the next steps follow the driving state. */
+            updateVehicleState( &gObdContext, true, gpsSpeed );
+
             /* Check the ignition off events. */
             if( ( gObdContext.obdDeviceConnected == false ) && ( gObdContext.updateCount > OBD_SIMULATED_TRIP_STEPS ) )
             {
@@ -1164,7 +1874,7 @@ void vehicleTelemetryReportTask( void )
                 break;
             }
             else if( ( gObdContext.idleSpeedDurationIntervalMs >= ( ( uint64_t ) CAR_IGINITION_IDLE_OFF_MS ) ) &&
-                ( gpsSpeed == 0 ) )
+                ( gpsSpeed == 0 ) && ( isEngineRunning( &gObdContext ) == false ) )
             {
                 CMS_LOGI( TAG, "Idle speed duration interval ms %u %u.",
                         ( gObdContext.idleSpeedDurationIntervalMs <= UINT32_MAX ) ? ( uint32_t ) gObdContext.idleSpeedDurationIntervalMs : 0,
@@ -1175,45 +1885,94 @@ void vehicleTelemetryReportTask( void )
             }
 
             /* Check the telemetry data events. */
-            if( ( loopSteps % OBD_TELEMETRY_DATA_INTERVAL_STEPS ) == 0 )
+            /* Half a step early is on time, the loop period jitters. */
+            if( ( loopSteps == 0 ) ||
+                ( ( startTicksMs - lastSampleTicksMs + ( gObdContext.rates.collectIntervalMs / 2U ) ) >= gObdContext.rates.telemetryIntervalMs ) )
             {
-                if( pdFAIL == sendObdTelemetryData( &gObdContext ) )
+                lastSampleTicksMs = startTicksMs;
+                stageStartUs = obdStageBegin();
+                addTelemetrySample( &gObdContext );
+                obdStageEnd( TRIP_REPLAY_STAGE_AGGREGATE, stageStartUs );
+
+                stageStartUs = obdStageBegin();
+
+                if( ( TelemetryBatch_IsDue( &gObdContext.telemetryBatch, ( uint64_t ) xTaskGetTickCountMs() ) == true ) &&
+                    ( pdFAIL == sendObdTelemetryData( &gObdContext ) ) )
                 {
                     CMS_LOGE( TAG, "Failed to send OBD telemetry data" );
                 }
+
+                obdStageEnd( TRIP_REPLAY_STAGE_ENCODE, stageStartUs );
+            }
+
+            /* Check the aggregated data events. */
+            stageStartUs = obdStageBegin();
+
+            if( ( WindowAggregate_IsDue( &gObdContext.window, ( uint64_t ) xTaskGetTickCountMs() ) == true ) &&
+                ( pdFAIL == sendObdAggregatedData( &gObdContext ) ) )
+            {
+                CMS_LOGE( TAG, "Failed to send OBD aggregated data" );
+            }
+
+            obdStageEnd( TRIP_REPLAY_STAGE_ENCODE, stageStartUs );
+
+            /* Check the trip checkpoint. */
+            if( ( ( uint64_t ) xTaskGetTickCountMs() - gObdContext.checkpointTicksMs ) >= ( uint64_t ) TRIP_CHECKPOINT_INTERVAL_MS )
+            {
+                saveTripCheckpoint( &gObdContext, false );
             }
 
+            obdStageEnd( TRIP_REPLAY_STAGE_STEP, stepStartUs );
+
             /* Calculate remain time. */
             elapsedTicksMs = xTaskGetTickCountMs() - startTicksMs;
 
-            if( OBD_DATA_COLLECT_INTERVAL_MS > elapsedTicksMs )
+            if( gObdContext.rates.collectIntervalMs > elapsedTicksMs )
             {
-                if( ( OBD_DATA_COLLECT_INTERVAL_MS - elapsedTicksMs ) < 10 )
+                if( ( gObdContext.rates.collectIntervalMs - elapsedTicksMs ) < 10 )
                 {
-                    vTaskDelay( pdMS_TO_TICKS(10) );
+                    obdWaitMs( 10 );
                 }
                 else
                 {
-                    vTaskDelay( pdMS_TO_TICKS(OBD_DATA_COLLECT_INTERVAL_MS - elapsedTicksMs) );
+                    obdWaitMs( gObdContext.rates.collectIntervalMs - elapsedTicksMs );
                 }
             }
             else
             {
                 CMS_LOGW( TAG, "elapsed time %u ms too long %u.",
-                          elapsedTicksMs, OBD_DATA_COLLECT_INTERVAL_MS );
-                vTaskDelay( pdMS_TO_TICKS(10) );
+                          elapsedTicksMs, gObdContext.rates.collectIntervalMs );
+                obdWaitMs( 10 );
             }
 
             loopSteps = loopSteps + 1;
         }
 
-        /* Send the trip data. */
+        /* Send the samples left and the trip data. */
         updateTelemetryData( &gObdContext );
         strcpy( gObdContext.transmission_gear_position, "neutral" );
+        if( pdFAIL == sendObdTelemetryData( &gObdContext ) )
+        {
+            CMS_LOGE( TAG, "Failed to send OBD telemetry data" );
+        }
+
+        if( pdFAIL == sendObdAggregatedData( &gObdContext ) )
+        {
+            CMS_LOGE( TAG, "Failed to send OBD aggregated data" );
+        }
+
         if( pdFAIL == sendObdTripData( &gObdContext ) )
         {
             CMS_LOGE( TAG, "Failed to send OBD trip data" );
         }
+
+        /* A trip that ended is not resumed. */
+        saveTripCheckpoint( &gObdContext, true );
+        TripOdometer_Stop( &gObdContext.tripOdometer );
+
+        #if ( TRIP_REPLAY_ENABLE == 1 )
+            TripReplay_Report();
+        #endif
     }
 
     /* Delete the task if it is complete. */
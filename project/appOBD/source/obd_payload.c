@@ -0,0 +1,310 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file obd_payload.c
+ * @brief Implementation of the payload building interface.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "../include/obd_payload.h"
+
+/*-----------------------------------------------------------*/
+
+#if ( OBD_PAYLOAD_ENCODING == OBD_PAYLOAD_ENCODING_COMPACT )
+    #define OBD_PAYLOAD_JSON_OPTIONS    ( JSON_WRITER_OMIT_EMPTY | JSON_WRITER_TRIM_ZEROS )
+#else
+    #define OBD_PAYLOAD_JSON_OPTIONS    ( JSON_WRITER_PRETTY )
+#endif
+
+#define OBD_PAYLOAD_KEY_NAME( key, number, name )    [ key ] = name,
+
+static const char * const keyNames[ OBD_KEY_COUNT ] =
+{
+    OBD_PAYLOAD_KEYS( OBD_PAYLOAD_KEY_NAME )
+};
+
+/*-----------------------------------------------------------*/
+
+const char * ObdPayload_KeyName( ObdPayloadKey_t key )
+{
+    const char * pName = NULL;
+
+    if( ( key > OBD_KEY_NONE ) && ( key < OBD_KEY_COUNT ) )
+    {
+        pName = keyNames[ key ];
+    }
+
+    return pName;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( OBD_PAYLOAD_ENCODING == OBD_PAYLOAD_ENCODING_CBOR )
+
+void ObdPayload_Init( ObdPayload_t * pPayload,
+                      char * pBuffer,
+                      size_t bufferSize )
+{
+    CborWriter_Init( &pPayload->cbor, ( uint8_t * ) pBuffer, bufferSize, OBD_PAYLOAD_CBOR_VERSION );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_BeginObject( ObdPayload_t * pPayload,
+                             ObdPayloadKey_t key )
+{
+    CborWriter_BeginMap( &pPayload->cbor, ( uint16_t ) key );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_EndObject( ObdPayload_t * pPayload )
+{
+    CborWriter_EndMap( &pPayload->cbor );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_BeginArray( ObdPayload_t * pPayload,
+                            ObdPayloadKey_t key )
+{
+    CborWriter_BeginArray( &pPayload->cbor, ( uint16_t ) key );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_EndArray( ObdPayload_t * pPayload )
+{
+    CborWriter_EndArray( &pPayload->cbor );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_AddString( ObdPayload_t * pPayload,
+                           ObdPayloadKey_t key,
+                           const char * pValue )
+{
+    CborWriter_AddText( &pPayload->cbor, ( uint16_t ) key, pValue );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_AddBytes( ObdPayload_t * pPayload,
+                          ObdPayloadKey_t key,
+                          const uint8_t * pData,
+                          size_t length )
+{
+    CborWriter_AddBytes( &pPayload->cbor, ( uint16_t ) key, pData, length );
+}
+
+/*-----------------------------------------------------------*/
+
+char * ObdPayload_BeginString( ObdPayload_t * pPayload,
+                               ObdPayloadKey_t key,
+                               size_t * pAvailable,
+                               bool * pEscape )
+{
+    *pEscape = false;
+
+    return CborWriter_BeginText( &pPayload->cbor, ( uint16_t ) key, pAvailable );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_EndString( ObdPayload_t * pPayload,
+                           size_t length )
+{
+    CborWriter_EndText( &pPayload->cbor, length );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_AddInt( ObdPayload_t * pPayload,
+                        ObdPayloadKey_t key,
+                        int64_t value )
+{
+    CborWriter_AddInt( &pPayload->cbor, ( uint16_t ) key, value );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_AddFixed( ObdPayload_t * pPayload,
+                          ObdPayloadKey_t key,
+                          int64_t value,
+                          uint8_t decimals )
+{
+    CborWriter_AddDecimal( &pPayload->cbor, ( uint16_t ) key, value, decimals );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_AddDouble( ObdPayload_t * pPayload,
+                           ObdPayloadKey_t key,
+                           double value,
+                           uint8_t decimals )
+{
+    CborWriter_AddNumber( &pPayload->cbor, ( uint16_t ) key, value, decimals );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_AddNull( ObdPayload_t * pPayload,
+                         ObdPayloadKey_t key )
+{
+    /* Absent members are null in the binary encoding. */
+    CborWriter_AddNull( &pPayload->cbor, ( uint16_t ) key );
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t ObdPayload_Finish( const ObdPayload_t * pPayload )
+{
+    return CborWriter_Finish( &pPayload->cbor );
+}
+
+/*-----------------------------------------------------------*/
+
+#else /* if ( OBD_PAYLOAD_ENCODING == OBD_PAYLOAD_ENCODING_CBOR ) */
+
+void ObdPayload_Init( ObdPayload_t * pPayload,
+                      char * pBuffer,
+                      size_t bufferSize )
+{
+    JsonWriter_Init( &pPayload->json, pBuffer, bufferSize, OBD_PAYLOAD_JSON_OPTIONS );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_BeginObject( ObdPayload_t * pPayload,
+                             ObdPayloadKey_t key )
+{
+    JsonWriter_BeginObject( &pPayload->json, ObdPayload_KeyName( key ) );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_EndObject( ObdPayload_t * pPayload )
+{
+    JsonWriter_EndObject( &pPayload->json );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_BeginArray( ObdPayload_t * pPayload,
+                            ObdPayloadKey_t key )
+{
+    JsonWriter_BeginArray( &pPayload->json, ObdPayload_KeyName( key ) );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_EndArray( ObdPayload_t * pPayload )
+{
+    JsonWriter_EndArray( &pPayload->json );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_AddString( ObdPayload_t * pPayload,
+                           ObdPayloadKey_t key,
+                           const char * pValue )
+{
+    JsonWriter_AddString( &pPayload->json, ObdPayload_KeyName( key ), pValue );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_AddBytes( ObdPayload_t * pPayload,
+                          ObdPayloadKey_t key,
+                          const uint8_t * pData,
+                          size_t length )
+{
+    JsonWriter_AddBase64( &pPayload->json, ObdPayload_KeyName( key ), pData, length );
+}
+
+/*-----------------------------------------------------------*/
+
+char * ObdPayload_BeginString( ObdPayload_t * pPayload,
+                               ObdPayloadKey_t key,
+                               size_t * pAvailable,
+                               bool * pEscape )
+{
+    *pEscape = true;
+
+    return JsonWriter_BeginString( &pPayload->json, ObdPayload_KeyName( key ), pAvailable );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_EndString( ObdPayload_t * pPayload,
+                           size_t length )
+{
+    JsonWriter_EndString( &pPayload->json, length );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_AddInt( ObdPayload_t * pPayload,
+                        ObdPayloadKey_t key,
+                        int64_t value )
+{
+    JsonWriter_AddInt( &pPayload->json, ObdPayload_KeyName( key ), value );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_AddFixed( ObdPayload_t * pPayload,
+                          ObdPayloadKey_t key,
+                          int64_t value,
+                          uint8_t decimals )
+{
+    JsonWriter_AddFixed( &pPayload->json, ObdPayload_KeyName( key ), value, decimals );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_AddDouble( ObdPayload_t * pPayload,
+                           ObdPayloadKey_t key,
+                           double value,
+                           uint8_t decimals )
+{
+    JsonWriter_AddDouble( &pPayload->json, ObdPayload_KeyName( key ), value, decimals );
+}
+
+/*-----------------------------------------------------------*/
+
+void ObdPayload_AddNull( ObdPayload_t * pPayload,
+                         ObdPayloadKey_t key )
+{
+    JsonWriter_AddNull( &pPayload->json, ObdPayload_KeyName( key ) );
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t ObdPayload_Finish( const ObdPayload_t * pPayload )
+{
+    return JsonWriter_Finish( &pPayload->json );
+}
+
+/*-----------------------------------------------------------*/
+
+#endif /* if ( OBD_PAYLOAD_ENCODING == OBD_PAYLOAD_ENCODING_CBOR ) */
@@ -0,0 +1,240 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file payload_compress.c
+ * @brief Implementation of the LZSS payload compression.
+ *
+ * The whole payload is in memory, so the window is the payload itself. Only
+ * a hash table of the last position of every 3 byte prefix is kept, one
+ * candidate is tried per position.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../include/payload_compress.h"
+
+/*-----------------------------------------------------------*/
+
+#define LZSS_WINDOW_SIZE        ( 4096U )
+#define LZSS_MATCH_MIN          ( 3U )
+#define LZSS_MATCH_MAX          ( 18U )
+#define LZSS_HASH_BITS          ( 9U )
+#define LZSS_HASH_SIZE          ( 1U << LZSS_HASH_BITS )
+#define LZSS_NO_POSITION        ( 0xFFFFU )
+
+static uint16_t lastPosition[ LZSS_HASH_SIZE ];
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvHash( const uint8_t * pData )
+{
+    uint32_t value = ( ( uint32_t ) pData[ 0 ] << 16 ) | ( ( uint32_t ) pData[ 1 ] << 8 ) | pData[ 2 ];
+
+    return ( uint32_t ) ( value * 2654435761U ) >> ( 32U - LZSS_HASH_BITS );
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t PayloadCompress_Encode( const uint8_t * pInput,
+                                size_t inputLength,
+                                uint8_t * pOutput,
+                                size_t outputSize )
+{
+    size_t in = 0;
+    size_t out = PAYLOAD_COMPRESS_HEADER_SIZE;
+    size_t flagIndex = 0;
+    uint8_t flagBit = 8;
+    size_t candidate = 0;
+    size_t matchLength = 0;
+    size_t maxLength = 0;
+    size_t distance = 0;
+    uint32_t hash = 0;
+
+    if( ( inputLength > PAYLOAD_COMPRESS_INPUT_MAX ) || ( outputSize < PAYLOAD_COMPRESS_HEADER_SIZE ) )
+    {
+        return -1;
+    }
+
+    pOutput[ 0 ] = PAYLOAD_COMPRESS_HEADER_LZSS;
+    pOutput[ 1 ] = ( uint8_t ) ( inputLength >> 8 );
+    pOutput[ 2 ] = ( uint8_t ) ( inputLength & 0xFFU );
+    memset( lastPosition, 0xFF, sizeof( lastPosition ) );
+
+    while( in < inputLength )
+    {
+        /* Start a new group, the match is up to 2 bytes more. */
+        if( flagBit == 8U )
+        {
+            if( ( out + 3U ) > outputSize )
+            {
+                return -1;
+            }
+
+            flagIndex = out;
+            pOutput[ flagIndex ] = 0;
+            out = out + 1U;
+            flagBit = 0;
+        }
+        else if( ( out + 2U ) > outputSize )
+        {
+            return -1;
+        }
+        else
+        {
+            /* Empty Else MISRA 15.7 */
+        }
+
+        matchLength = 0;
+        maxLength = inputLength - in;
+
+        if( maxLength > LZSS_MATCH_MAX )
+        {
+            maxLength = LZSS_MATCH_MAX;
+        }
+
+        if( maxLength >= LZSS_MATCH_MIN )
+        {
+            hash = prvHash( &pInput[ in ] );
+            candidate = lastPosition[ hash ];
+            lastPosition[ hash ] = ( uint16_t ) in;
+
+            if( ( candidate != LZSS_NO_POSITION ) && ( ( in - candidate ) <= LZSS_WINDOW_SIZE ) )
+            {
+                while( ( matchLength < maxLength ) && ( pInput[ candidate + matchLength ] == pInput[ in + matchLength ] ) )
+                {
+                    matchLength++;
+                }
+            }
+        }
+
+        if( matchLength >= LZSS_MATCH_MIN )
+        {
+            distance = in - candidate - 1U;
+            pOutput[ out ] = ( uint8_t ) ( distance >> 4 );
+            pOutput[ out + 1U ] = ( uint8_t ) ( ( ( distance & 0x0FU ) << 4 ) | ( matchLength - LZSS_MATCH_MIN ) );
+            out = out + 2U;
+
+            /* Index the skipped positions for later matches. */
+            for( in = in + 1U; ( matchLength > 1U ) && ( ( in + LZSS_MATCH_MIN ) <= inputLength ); matchLength-- )
+            {
+                lastPosition[ prvHash( &pInput[ in ] ) ] = ( uint16_t ) in;
+                in++;
+            }
+
+            in = in + matchLength - 1U;
+        }
+        else
+        {
+            pOutput[ flagIndex ] |= ( uint8_t ) ( 1U << flagBit );
+            pOutput[ out ] = pInput[ in ];
+            out = out + 1U;
+            in++;
+        }
+
+        flagBit++;
+    }
+
+    return ( int32_t ) out;
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t PayloadCompress_Decode( const uint8_t * pInput,
+                                size_t inputLength,
+                                uint8_t * pOutput,
+                                size_t outputSize )
+{
+    size_t in = PAYLOAD_COMPRESS_HEADER_SIZE;
+    size_t out = 0;
+    size_t length = 0;
+    size_t distance = 0;
+    size_t matchLength = 0;
+    uint8_t flags = 0;
+    uint8_t flagBit = 8;
+
+    if( ( inputLength < PAYLOAD_COMPRESS_HEADER_SIZE ) || ( pInput[ 0 ] != PAYLOAD_COMPRESS_HEADER_LZSS ) )
+    {
+        return -1;
+    }
+
+    length = ( ( size_t ) pInput[ 1 ] << 8 ) | pInput[ 2 ];
+
+    if( length > outputSize )
+    {
+        return -1;
+    }
+
+    while( out < length )
+    {
+        if( flagBit == 8U )
+        {
+            if( in >= inputLength )
+            {
+                return -1;
+            }
+
+            flags = pInput[ in ];
+            in++;
+            flagBit = 0;
+        }
+
+        if( ( flags & ( 1U << flagBit ) ) != 0U )
+        {
+            if( in >= inputLength )
+            {
+                return -1;
+            }
+
+            pOutput[ out ] = pInput[ in ];
+            out++;
+            in++;
+        }
+        else
+        {
+            if( ( in + 2U ) > inputLength )
+            {
+                return -1;
+            }
+
+            distance = ( ( ( size_t ) pInput[ in ] << 4 ) | ( ( size_t ) pInput[ in + 1U ] >> 4 ) ) + 1U;
+            matchLength = ( size_t ) ( pInput[ in + 1U ] & 0x0FU ) + LZSS_MATCH_MIN;
+            in = in + 2U;
+
+            if( ( distance > out ) || ( ( out + matchLength ) > length ) )
+            {
+                return -1;
+            }
+
+            /* Byte by byte, the match may overlap the output. */
+            for( ; matchLength > 0U; matchLength-- )
+            {
+                pOutput[ out ] = pOutput[ out - distance ];
+                out++;
+            }
+        }
+
+        flagBit++;
+    }
+
+    return ( int32_t ) out;
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,378 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file publish_service.c
+ * @brief Implementation of the background MQTT publisher.
+ *
+ * The ring holds fixed size message records. The telemetry task fills the
+ * record at the head and then moves the head, the publisher task sends the
+ * record at the tail and then moves the tail. Each index has a single writer,
+ * so the ring needs no lock. The publisher waits for a PUBACK while the
+ * telemetry task keeps sampling into the free records.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "core_mqtt.h"
+#include "core_mqtt_agent.h"
+#include "core_mqtt_agent_tasks.h"
+
+#include "obd_data.h"
+#include "FreeRTOS_IO.h"
+
+#include "../include/publish_service.h"
+#include "../include/payload_compress.h"
+#include "../include/store_forward.h"
+#include "../include/obd_context.h"
+#include "../include/obd_config.h"
+
+// log print header
+#include "cms_log.h"
+
+/*-----------------------------------------------------------*/
+
+#define PUBLISH_SERVICE_OPTION_QOS_MASK     ( 0x03U )
+#define PUBLISH_SERVICE_OPTION_COMPRESSION  ( 0x04U )
+
+/* The agent refuses a payload larger than its buffer. */
+_Static_assert( OBD_MESSAGE_BUF_SIZE <= MQTT_AGENT_PAYLOAD_BUF_SIZE,
+                "OBD_MESSAGE_BUF_SIZE does not fit MQTT_AGENT_PAYLOAD_BUF_SIZE" );
+
+typedef struct PublishRecord
+{
+    char topic[ OBD_TOPIC_BUF_SIZE ];
+    size_t length;
+    char message[ OBD_MESSAGE_BUF_SIZE ];
+} PublishRecord_t;
+
+/*-----------------------------------------------------------*/
+
+static const char *TAG = "publishService";
+
+extern MQTTAgentContext_t xGlobalMqttAgentContext;
+
+static PublishRecord_t publishRing[ PUBLISH_SERVICE_RING_SIZE ];
+
+/* Free running indexes. The telemetry task writes the head, the publisher the tail. */
+static uint32_t publishRingHead = 0;
+static uint32_t publishRingTail = 0;
+
+/* Each counter has a single writer task. */
+static PublishServiceStats_t publishStats = { 0 };
+
+static TaskHandle_t publishTaskHandle = NULL;
+
+/* QoS and compression in one word, so a change is seen at once. */
+static uint32_t publishOptions = ( uint32_t ) MQTTQoS1 |
+                                 ( ( OBD_PAYLOAD_COMPRESSION == 1 ) ? PUBLISH_SERVICE_OPTION_COMPRESSION : 0U );
+
+#if ( OBD_PAYLOAD_COMPRESSION == 1 )
+    static uint8_t publishCompressBuf[ OBD_MESSAGE_BUF_SIZE ];
+#endif
+
+#if ( STORE_FORWARD_ENABLE == 1 )
+    static PublishRecord_t publishReplayRecord;
+
+/* Written by the publisher, read by the telemetry task. */
+    static bool publishStoring = false;
+#endif
+
+/*-----------------------------------------------------------*/
+
+static bool isMqttConnected( void )
+{
+    return xGlobalMqttAgentContext.mqttContext.connectStatus != MQTTNotConnected;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool storeMessage( const char * pTopic,
+                          const char * pMessage,
+                          size_t messageLength )
+{
+    #if ( STORE_FORWARD_ENABLE == 1 )
+        return StoreForward_Push( pTopic, ( const uint8_t * ) pMessage, messageLength );
+    #else
+        ( void ) pTopic;
+        ( void ) pMessage;
+        ( void ) messageLength;
+
+        return false;
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+static void publishRecord( const PublishRecord_t * pRecord,
+                           uint32_t options )
+{
+    BaseType_t retMqtt = pdFALSE;
+    const char * pMessage = pRecord->message;
+    size_t messageLength = pRecord->length;
+    bool storeFirst = false;
+
+    #if ( OBD_PAYLOAD_COMPRESSION == 1 )
+        int32_t compressedLength = -1;
+
+        /* Sent as is when the compressed payload does not fit in the saving limit. */
+        if( ( ( options & PUBLISH_SERVICE_OPTION_COMPRESSION ) != 0U ) &&
+            ( messageLength >= OBD_PAYLOAD_COMPRESSION_MIN_SIZE ) )
+        {
+            compressedLength = PayloadCompress_Encode( ( const uint8_t * ) pRecord->message,
+                                                       messageLength,
+                                                       publishCompressBuf,
+                                                       ( messageLength * ( 100U - OBD_PAYLOAD_COMPRESSION_MIN_SAVING ) ) / 100U );
+        }
+
+        if( compressedLength > 0 )
+        {
+            CMS_LOGD( TAG, "Message compressed from %u to %d bytes.", ( unsigned int ) messageLength, ( int ) compressedLength );
+            pMessage = ( const char * ) publishCompressBuf;
+            messageLength = ( size_t ) compressedLength;
+        }
+    #endif /* if ( OBD_PAYLOAD_COMPRESSION == 1 ) */
+
+    #if ( STORE_FORWARD_ENABLE == 1 )
+        /* Queued behind the stored messages to keep the order. */
+        storeFirst = ( isMqttConnected() == false ) || ( StoreForward_IsEmpty() == false );
+    #endif
+
+    if( storeFirst == false )
+    {
+        retMqtt = mqttAgentPublish( ( MQTTQoS_t ) ( options & PUBLISH_SERVICE_OPTION_QOS_MASK ),
+                                    pRecord->topic,
+                                    strlen( pRecord->topic ),
+                                    pMessage,
+                                    messageLength );
+    }
+
+    if( retMqtt == pdTRUE )
+    {
+        publishStats.published++;
+    }
+    else if( storeMessage( pRecord->topic, pMessage, messageLength ) == true )
+    {
+        CMS_LOGD( TAG, "Message to %s stored for later.", pRecord->topic );
+        publishStats.stored++;
+    }
+    else
+    {
+        CMS_LOGE( TAG, "Message to %s lost.", pRecord->topic );
+        publishStats.failed++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( STORE_FORWARD_ENABLE == 1 )
+    static void replayStoredMessages( uint32_t options )
+    {
+        PublishRecord_t * pRecord = &publishReplayRecord;
+        uint32_t i = 0;
+
+        /* A few messages per wake up limits the burst after a reconnection. */
+        for( i = 0; ( i < STORE_FORWARD_REPLAY_PER_LOOP ) && ( isMqttConnected() == true ); i++ )
+        {
+            if( StoreForward_Peek( pRecord->topic, OBD_TOPIC_BUF_SIZE,
+                                   ( uint8_t * ) pRecord->message, OBD_MESSAGE_BUF_SIZE, &pRecord->length ) == false )
+            {
+                break;
+            }
+
+            /* Removed from the queue only on PUBACK. */
+            if( mqttAgentPublish( ( MQTTQoS_t ) ( options & PUBLISH_SERVICE_OPTION_QOS_MASK ),
+                                  pRecord->topic,
+                                  strlen( pRecord->topic ),
+                                  pRecord->message,
+                                  pRecord->length ) != pdTRUE )
+            {
+                break;
+            }
+
+            StoreForward_Pop();
+            publishStats.published++;
+        }
+    }
+#endif /* if ( STORE_FORWARD_ENABLE == 1 ) */
+
+/*-----------------------------------------------------------*/
+
+static void publishServiceTask( void * pParameters )
+{
+    uint32_t tail = 0;
+    uint32_t lastDropped = 0;
+    uint32_t dropped = 0;
+    uint32_t options = 0;
+
+    ( void ) pParameters;
+
+    while( true )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, pdMS_TO_TICKS( PUBLISH_SERVICE_IDLE_MS ) );
+
+        tail = __atomic_load_n( &publishRingTail, __ATOMIC_RELAXED );
+        options = __atomic_load_n( &publishOptions, __ATOMIC_RELAXED );
+
+        /* The record is read only after the head that publishes it. */
+        while( tail != __atomic_load_n( &publishRingHead, __ATOMIC_ACQUIRE ) )
+        {
+            publishRecord( &publishRing[ tail % PUBLISH_SERVICE_RING_SIZE ], options );
+
+            /* Give the record back once it is no longer used. */
+            tail = tail + 1U;
+            __atomic_store_n( &publishRingTail, tail, __ATOMIC_RELEASE );
+        }
+
+        #if ( STORE_FORWARD_ENABLE == 1 )
+            replayStoredMessages( options );
+            __atomic_store_n( &publishStoring,
+                              ( isMqttConnected() == false ) || ( StoreForward_IsEmpty() == false ),
+                              __ATOMIC_RELAXED );
+        #endif
+
+        dropped = __atomic_load_n( &publishStats.dropped, __ATOMIC_RELAXED );
+
+        if( dropped != lastDropped )
+        {
+            CMS_LOGW( TAG, "Publish ring full, %u messages dropped, at most %u waiting.",
+                      ( unsigned int ) dropped,
+                      ( unsigned int ) __atomic_load_n( &publishStats.highWater, __ATOMIC_RELAXED ) );
+            lastDropped = dropped;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+bool PublishService_Start( void )
+{
+    bool retStart = true;
+
+    #if ( STORE_FORWARD_ENABLE == 1 )
+        if( StoreForward_Init() == false )
+        {
+            CMS_LOGW( TAG, "Store and forward queue not available." );
+        }
+    #endif
+
+    if( xTaskCreate( publishServiceTask,
+                     "publishServiceTask",
+                     PUBLISH_SERVICE_TASK_STACK_SIZE,
+                     NULL,
+                     PUBLISH_SERVICE_TASK_PRIORITY,
+                     &publishTaskHandle ) != pdPASS )
+    {
+        CMS_LOGE( TAG, "Failed to create publish service task." );
+        retStart = false;
+    }
+
+    return retStart;
+}
+
+/*-----------------------------------------------------------*/
+
+bool PublishService_Send( const char * pTopic,
+                          const char * pMessage,
+                          size_t messageLength )
+{
+    uint32_t head = __atomic_load_n( &publishRingHead, __ATOMIC_RELAXED );
+    uint32_t waiting = head - __atomic_load_n( &publishRingTail, __ATOMIC_ACQUIRE );
+    size_t topicLength = strlen( pTopic );
+    PublishRecord_t * pRecord = NULL;
+
+    if( ( topicLength >= OBD_TOPIC_BUF_SIZE ) || ( messageLength > OBD_MESSAGE_BUF_SIZE ) )
+    {
+        CMS_LOGE( TAG, "Message to %s too large.", pTopic );
+        return false;
+    }
+
+    if( waiting >= PUBLISH_SERVICE_RING_SIZE )
+    {
+        __atomic_store_n( &publishStats.dropped, publishStats.dropped + 1U, __ATOMIC_RELAXED );
+        return false;
+    }
+
+    pRecord = &publishRing[ head % PUBLISH_SERVICE_RING_SIZE ];
+    memcpy( pRecord->topic, pTopic, topicLength + 1U );
+    memcpy( pRecord->message, pMessage, messageLength );
+    pRecord->length = messageLength;
+
+    /* The record must be complete before the publisher can see it. */
+    __atomic_store_n( &publishRingHead, head + 1U, __ATOMIC_RELEASE );
+
+    publishStats.queued++;
+
+    if( ( waiting + 1U ) > publishStats.highWater )
+    {
+        __atomic_store_n( &publishStats.highWater, waiting + 1U, __ATOMIC_RELAXED );
+    }
+
+    if( publishTaskHandle != NULL )
+    {
+        xTaskNotifyGive( publishTaskHandle );
+    }
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
+
+void PublishService_SetOptions( uint8_t qos,
+                                bool compression )
+{
+    uint32_t options = ( uint32_t ) qos & PUBLISH_SERVICE_OPTION_QOS_MASK;
+
+    if( compression == true )
+    {
+        options = options | PUBLISH_SERVICE_OPTION_COMPRESSION;
+    }
+
+    __atomic_store_n( &publishOptions, options, __ATOMIC_RELAXED );
+}
+
+/*-----------------------------------------------------------*/
+
+void PublishService_GetStats( PublishServiceStats_t * pStats )
+{
+    /* Counters are 32 bit words, each one is read whole. */
+    pStats->queued = __atomic_load_n( &publishStats.queued, __ATOMIC_RELAXED );
+    pStats->dropped = __atomic_load_n( &publishStats.dropped, __ATOMIC_RELAXED );
+    pStats->published = __atomic_load_n( &publishStats.published, __ATOMIC_RELAXED );
+    pStats->stored = __atomic_load_n( &publishStats.stored, __ATOMIC_RELAXED );
+    pStats->failed = __atomic_load_n( &publishStats.failed, __ATOMIC_RELAXED );
+    pStats->highWater = __atomic_load_n( &publishStats.highWater, __ATOMIC_RELAXED );
+}
+
+/*-----------------------------------------------------------*/
+
+bool PublishService_IsStoring( void )
+{
+    #if ( STORE_FORWARD_ENABLE == 1 )
+        return __atomic_load_n( &publishStoring, __ATOMIC_RELAXED );
+    #else
+        return false;
+    #endif
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,409 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file runtime_config.c
+ * @brief Implementation of the runtime settings.
+ *
+ * Documents are parsed in the MQTT agent task. Each accepted document is
+ * merged into a full copy of the settings, which is then published to the
+ * telemetry task through two slots and a sequence number, the same way the
+ * GPS service publishes its fixes. The telemetry task applies the settings of
+ * one document together at the top of its loop.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "core_mqtt.h"
+#include "core_mqtt_agent.h"
+#include "core_mqtt_agent_tasks.h"
+
+#include "cJSON.h"
+#include "nvs.h"
+
+#include "../include/runtime_config.h"
+#include "../include/obd_config.h"
+
+// log print header
+#include "cms_log.h"
+
+/*-----------------------------------------------------------*/
+
+#define RUNTIME_CONFIG_NVS_NAMESPACE    "obdConfig"
+#define RUNTIME_CONFIG_NVS_KEY          "runtime"
+#define RUNTIME_CONFIG_STORE_MAGIC      ( 0x52434631UL )  /* "RCF1", changes with RuntimeConfig_t. */
+#define RUNTIME_CONFIG_TOPIC_MAX        ( 64 )
+#define RUNTIME_CONFIG_READ_RETRY       ( 4U )
+
+typedef struct RuntimeConfigStore
+{
+    uint32_t magic;
+    RuntimeConfig_t config;
+} RuntimeConfigStore_t;
+
+/* A setting held in a uint32_t field of RuntimeConfig_t. */
+typedef struct RuntimeConfigField
+{
+    const char * pName;
+    size_t offset;
+    uint32_t min;
+    uint32_t max;
+} RuntimeConfigField_t;
+
+/*-----------------------------------------------------------*/
+
+static const char *TAG = "runtimeConfig";
+
+static const RuntimeConfigField_t configFields[] =
+{
+    { "CollectIntervalMs",   offsetof( RuntimeConfig_t, collectIntervalMs ),   RUNTIME_CONFIG_MIN_INTERVAL_MS, RUNTIME_CONFIG_MAX_INTERVAL_MS },
+    { "TelemetryIntervalMs", offsetof( RuntimeConfig_t, telemetryIntervalMs ), RUNTIME_CONFIG_MIN_INTERVAL_MS, RUNTIME_CONFIG_MAX_INTERVAL_MS },
+    { "BatchMaxSamples",     offsetof( RuntimeConfig_t, batchMaxSamples ),     1U,                             OBD_TELEMETRY_BATCH_MAX_SAMPLES },
+    { "BatchMaxMs",          offsetof( RuntimeConfig_t, batchMaxMs ),          RUNTIME_CONFIG_MIN_INTERVAL_MS, RUNTIME_CONFIG_MAX_BATCH_MS },
+    { "Signals",             offsetof( RuntimeConfig_t, enabledSignals ),      0U,                             UINT32_MAX }
+};
+
+/* The topic must outlive the subscription. */
+static char configTopic[ RUNTIME_CONFIG_TOPIC_MAX ];
+
+/* Used by the MQTT agent task only. */
+static char configMessage[ RUNTIME_CONFIG_MESSAGE_MAX ];
+static RuntimeConfig_t configLatest;
+
+static uint32_t configSignalMask = 0;
+
+static RuntimeConfig_t configSlots[ 2 ];
+
+/* 0 means nothing received yet. Odd/even selects the slot. */
+static uint32_t configSequence = 0;
+
+/* Used by the telemetry task only. */
+static uint32_t configFetchedSequence = 0;
+
+/*-----------------------------------------------------------*/
+
+static uint32_t * configField( RuntimeConfig_t * pConfig,
+                               const RuntimeConfigField_t * pField )
+{
+    return ( uint32_t * ) ( ( uint8_t * ) pConfig + pField->offset );
+}
+
+/*-----------------------------------------------------------*/
+
+static bool isConfigValid( RuntimeConfig_t * pConfig )
+{
+    bool valid = true;
+    uint32_t value = 0;
+    size_t i = 0;
+
+    for( i = 0; ( i < ( sizeof( configFields ) / sizeof( configFields[ 0 ] ) ) ) && ( valid == true ); i++ )
+    {
+        value = *configField( pConfig, &configFields[ i ] );
+
+        if( ( value < configFields[ i ].min ) || ( value > configFields[ i ].max ) )
+        {
+            CMS_LOGW( TAG, "%s %u out of range.", configFields[ i ].pName, ( unsigned int ) value );
+            valid = false;
+        }
+    }
+
+    if( valid == false )
+    {
+        /* Already logged. */
+    }
+    else if( pConfig->telemetryIntervalMs < pConfig->collectIntervalMs )
+    {
+        CMS_LOGW( TAG, "Telemetry interval shorter than the collect interval." );
+        valid = false;
+    }
+    else if( ( pConfig->enabledSignals & ~configSignalMask ) != 0U )
+    {
+        CMS_LOGW( TAG, "Unknown signals 0x%x.", ( unsigned int ) pConfig->enabledSignals );
+        valid = false;
+    }
+    else if( pConfig->qos > ( uint8_t ) MQTTQoS1 )
+    {
+        CMS_LOGW( TAG, "Qos %u not supported.", ( unsigned int ) pConfig->qos );
+        valid = false;
+    }
+    else if( ( pConfig->compression == true ) && ( OBD_PAYLOAD_COMPRESSION != 1 ) )
+    {
+        CMS_LOGW( TAG, "Compression not built in." );
+        valid = false;
+    }
+    else
+    {
+        /* Empty Else MISRA 15.7 */
+    }
+
+    return valid;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool parseConfig( const cJSON * pJson,
+                         RuntimeConfig_t * pConfig )
+{
+    const cJSON * pItem = NULL;
+    bool parsed = true;
+    size_t i = 0;
+
+    for( i = 0; ( i < ( sizeof( configFields ) / sizeof( configFields[ 0 ] ) ) ) && ( parsed == true ); i++ )
+    {
+        pItem = cJSON_GetObjectItem( pJson, configFields[ i ].pName );
+
+        if( pItem == NULL )
+        {
+            /* Keeps its value. */
+        }
+        else if( ( cJSON_IsNumber( pItem ) == 0 ) || ( pItem->valuedouble < 0.0 ) ||
+                 ( pItem->valuedouble > ( double ) UINT32_MAX ) || ( floor( pItem->valuedouble ) != pItem->valuedouble ) )
+        {
+            CMS_LOGW( TAG, "%s is not a count.", configFields[ i ].pName );
+            parsed = false;
+        }
+        else
+        {
+            *configField( pConfig, &configFields[ i ] ) = ( uint32_t ) pItem->valuedouble;
+        }
+    }
+
+    pItem = cJSON_GetObjectItem( pJson, "Qos" );
+
+    if( ( parsed == false ) || ( pItem == NULL ) )
+    {
+        /* Keeps its value. */
+    }
+    else if( ( cJSON_IsNumber( pItem ) == 0 ) || ( pItem->valueint < 0 ) || ( pItem->valueint > UINT8_MAX ) )
+    {
+        CMS_LOGW( TAG, "Qos is not a number." );
+        parsed = false;
+    }
+    else
+    {
+        pConfig->qos = ( uint8_t ) pItem->valueint;
+    }
+
+    pItem = cJSON_GetObjectItem( pJson, "Compression" );
+
+    if( ( parsed == false ) || ( pItem == NULL ) )
+    {
+        /* Keeps its value. */
+    }
+    else if( cJSON_IsBool( pItem ) == 0 )
+    {
+        CMS_LOGW( TAG, "Compression is not a boolean." );
+        parsed = false;
+    }
+    else
+    {
+        pConfig->compression = ( cJSON_IsTrue( pItem ) != 0 );
+    }
+
+    return parsed;
+}
+
+/*-----------------------------------------------------------*/
+
+static void publishConfig( const RuntimeConfig_t * pConfig )
+{
+    uint32_t nextSequence = __atomic_load_n( &configSequence, __ATOMIC_RELAXED ) + 1;
+
+    /* The reader only copies the slot of the current sequence, this one is free. */
+    memcpy( &configSlots[ nextSequence & 1U ], pConfig, sizeof( RuntimeConfig_t ) );
+
+    __atomic_store_n( &configSequence, nextSequence, __ATOMIC_RELEASE );
+
+    /* Next write to the other slot must not become visible before the sequence. */
+    __atomic_thread_fence( __ATOMIC_SEQ_CST );
+}
+
+/*-----------------------------------------------------------*/
+
+static void configCallback( void * pContext,
+                            MQTTPublishInfo_t * pPublishInfo )
+{
+    RuntimeConfig_t config;
+    cJSON * pJson = NULL;
+    bool accepted = false;
+
+    ( void ) pContext;
+
+    if( pPublishInfo->payloadLength >= RUNTIME_CONFIG_MESSAGE_MAX )
+    {
+        CMS_LOGE( TAG, "Config message of %u bytes too large.", ( unsigned int ) pPublishInfo->payloadLength );
+        return;
+    }
+
+    memcpy( configMessage, pPublishInfo->pPayload, pPublishInfo->payloadLength );
+    configMessage[ pPublishInfo->payloadLength ] = '\0';
+
+    pJson = cJSON_Parse( configMessage );
+
+    if( pJson == NULL )
+    {
+        CMS_LOGE( TAG, "cJSON_Parse failed." );
+        return;
+    }
+
+    /* Fields left out keep the value of the last accepted document. */
+    memcpy( &config, &configLatest, sizeof( RuntimeConfig_t ) );
+
+    if( ( parseConfig( pJson, &config ) == true ) && ( isConfigValid( &config ) == true ) )
+    {
+        memcpy( &configLatest, &config, sizeof( RuntimeConfig_t ) );
+        publishConfig( &config );
+        accepted = true;
+    }
+
+    cJSON_Delete( pJson );
+
+    CMS_LOGI( TAG, "Config %s.", ( accepted == true ) ? "accepted" : "rejected" );
+}
+
+/*-----------------------------------------------------------*/
+
+void RuntimeConfig_Init( RuntimeConfig_t * pConfig,
+                         uint32_t signalCount )
+{
+    RuntimeConfigStore_t store;
+    size_t storeLength = sizeof( RuntimeConfigStore_t );
+    nvs_handle_t handle;
+
+    configSignalMask = ( signalCount >= 32U ) ? UINT32_MAX : ( ( 1UL << signalCount ) - 1UL );
+
+    pConfig->collectIntervalMs = OBD_DATA_COLLECT_INTERVAL_MS;
+    pConfig->telemetryIntervalMs = OBD_TELEMETRY_DATA_INTERVAL_MS;
+    pConfig->batchMaxSamples = OBD_TELEMETRY_BATCH_MAX_SAMPLES;
+    pConfig->batchMaxMs = OBD_TELEMETRY_BATCH_MAX_MS;
+    pConfig->enabledSignals = configSignalMask;
+    pConfig->qos = ( uint8_t ) MQTTQoS1;
+    pConfig->compression = ( OBD_PAYLOAD_COMPRESSION == 1 );
+
+    if( nvs_open( RUNTIME_CONFIG_NVS_NAMESPACE, NVS_READONLY, &handle ) == ESP_OK )
+    {
+        if( ( nvs_get_blob( handle, RUNTIME_CONFIG_NVS_KEY, &store, &storeLength ) == ESP_OK ) &&
+            ( storeLength == sizeof( RuntimeConfigStore_t ) ) &&
+            ( store.magic == RUNTIME_CONFIG_STORE_MAGIC ) &&
+            ( isConfigValid( &store.config ) == true ) )
+        {
+            memcpy( pConfig, &store.config, sizeof( RuntimeConfig_t ) );
+            CMS_LOGI( TAG, "Config loaded from NVS." );
+        }
+
+        nvs_close( handle );
+    }
+
+    memcpy( &configLatest, pConfig, sizeof( RuntimeConfig_t ) );
+}
+
+/*-----------------------------------------------------------*/
+
+bool RuntimeConfig_Subscribe( const char * pThingName )
+{
+    bool retSubscribe = false;
+
+    snprintf( configTopic, RUNTIME_CONFIG_TOPIC_MAX, RUNTIME_CONFIG_TOPIC_FORMAT, pThingName );
+
+    if( mqttAgentSubscribe( MQTTQoS1, configTopic, configCallback, NULL ) == pdTRUE )
+    {
+        retSubscribe = true;
+    }
+    else
+    {
+        CMS_LOGE( TAG, "Failed to subscribe to %s.", configTopic );
+    }
+
+    return retSubscribe;
+}
+
+/*-----------------------------------------------------------*/
+
+bool RuntimeConfig_Fetch( RuntimeConfig_t * pConfig )
+{
+    bool retFetch = false;
+    uint32_t sequence = 0;
+    uint32_t i = 0;
+
+    for( i = 0; i < RUNTIME_CONFIG_READ_RETRY; i++ )
+    {
+        sequence = __atomic_load_n( &configSequence, __ATOMIC_ACQUIRE );
+
+        if( sequence == configFetchedSequence )
+        {
+            break;
+        }
+
+        memcpy( pConfig, &configSlots[ sequence & 1U ], sizeof( RuntimeConfig_t ) );
+        __atomic_thread_fence( __ATOMIC_ACQUIRE );
+
+        /* The writer only reuses this slot after it has moved the sequence. */
+        if( __atomic_load_n( &configSequence, __ATOMIC_RELAXED ) == sequence )
+        {
+            configFetchedSequence = sequence;
+            retFetch = true;
+            break;
+        }
+    }
+
+    return retFetch;
+}
+
+/*-----------------------------------------------------------*/
+
+bool RuntimeConfig_Save( const RuntimeConfig_t * pConfig )
+{
+    RuntimeConfigStore_t store;
+    nvs_handle_t handle;
+    esp_err_t err = ESP_OK;
+
+    memset( &store, 0, sizeof( RuntimeConfigStore_t ) );
+    store.magic = RUNTIME_CONFIG_STORE_MAGIC;
+    memcpy( &store.config, pConfig, sizeof( RuntimeConfig_t ) );
+
+    err = nvs_open( RUNTIME_CONFIG_NVS_NAMESPACE, NVS_READWRITE, &handle );
+
+    if( err == ESP_OK )
+    {
+        err = nvs_set_blob( handle, RUNTIME_CONFIG_NVS_KEY, &store, sizeof( RuntimeConfigStore_t ) );
+
+        if( err == ESP_OK )
+        {
+            err = nvs_commit( handle );
+        }
+
+        nvs_close( handle );
+    }
+
+    if( err != ESP_OK )
+    {
+        CMS_LOGE( TAG, "Failed to save config, error %d.", ( int ) err );
+    }
+
+    return err == ESP_OK;
+}
+
+/*-----------------------------------------------------------*/
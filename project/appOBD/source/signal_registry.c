@@ -0,0 +1,199 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file signal_registry.c
+ * @brief Implementation of the signal registry.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../include/signal_registry.h"
+
+/*-----------------------------------------------------------*/
+
+static void storeValue( SignalRegistry_t * pRegistry,
+                        uint32_t signal,
+                        double value,
+                        uint64_t nowMs )
+{
+    pRegistry->previous[ signal ] = pRegistry->value[ signal ];
+    pRegistry->previousMs[ signal ] = pRegistry->updatedMs[ signal ];
+    pRegistry->value[ signal ] = value;
+    pRegistry->updatedMs[ signal ] = nowMs;
+    pRegistry->valid = pRegistry->valid | SIGNAL_BIT( signal );
+}
+
+/*-----------------------------------------------------------*/
+
+static bool decodeValue( const SignalRegistry_t * pRegistry,
+                         const SignalDescriptor_t * pDescriptor,
+                         int32_t raw,
+                         double * pValue )
+{
+    bool decoded = true;
+
+    if( pDescriptor->decode != NULL )
+    {
+        decoded = pDescriptor->decode( pRegistry, pDescriptor, raw, pValue );
+    }
+    else
+    {
+        *pValue = ( double ) raw;
+    }
+
+    return decoded;
+}
+
+/*-----------------------------------------------------------*/
+
+void SignalRegistry_Init( SignalRegistry_t * pRegistry,
+                          const SignalDescriptor_t * pDescriptors,
+                          uint32_t count )
+{
+    memset( pRegistry, 0, sizeof( SignalRegistry_t ) );
+    pRegistry->pDescriptors = pDescriptors;
+    pRegistry->count = ( count < SIGNAL_REGISTRY_MAX_SIGNALS ) ? count : SIGNAL_REGISTRY_MAX_SIGNALS;
+    pRegistry->enabled = ( uint32_t ) ( ( 1ULL << pRegistry->count ) - 1U );
+}
+
+/*-----------------------------------------------------------*/
+
+void SignalRegistry_Reset( SignalRegistry_t * pRegistry )
+{
+    pRegistry->valid = 0;
+    memset( pRegistry->value, 0, sizeof( pRegistry->value ) );
+    memset( pRegistry->previous, 0, sizeof( pRegistry->previous ) );
+    memset( pRegistry->updatedMs, 0, sizeof( pRegistry->updatedMs ) );
+    memset( pRegistry->previousMs, 0, sizeof( pRegistry->previousMs ) );
+}
+
+/*-----------------------------------------------------------*/
+
+void SignalRegistry_SetEnabled( SignalRegistry_t * pRegistry,
+                                uint32_t signal,
+                                bool enabled )
+{
+    if( signal < pRegistry->count )
+    {
+        if( enabled == true )
+        {
+            pRegistry->enabled = pRegistry->enabled | SIGNAL_BIT( signal );
+        }
+        else
+        {
+            pRegistry->enabled = pRegistry->enabled & ~SIGNAL_BIT( signal );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t SignalRegistry_Acquire( SignalRegistry_t * pRegistry,
+                                 uint64_t nowMs,
+                                 SignalReadPid_t readPid,
+                                 void * pContext )
+{
+    const SignalDescriptor_t * pDescriptor = NULL;
+    uint32_t updated = 0;
+    uint32_t signal = 0;
+    int32_t raw = 0;
+    double value = 0.0;
+    bool acquired = false;
+
+    for( signal = 0; signal < pRegistry->count; signal++ )
+    {
+        pDescriptor = &pRegistry->pDescriptors[ signal ];
+        acquired = false;
+
+        if( ( pRegistry->enabled & SIGNAL_BIT( signal ) ) == 0U )
+        {
+            /* Disabled. */
+        }
+        else if( pDescriptor->source == SIGNAL_SOURCE_PID )
+        {
+            if( ( ( pRegistry->valid & SIGNAL_BIT( signal ) ) == 0U ) ||
+                ( ( nowMs - pRegistry->updatedMs[ signal ] ) >= pDescriptor->intervalMs ) )
+            {
+                acquired = ( readPid( pContext, pDescriptor->pid, &raw ) == true ) &&
+                           ( decodeValue( pRegistry, pDescriptor, raw, &value ) == true );
+            }
+        }
+        else if( pDescriptor->source == SIGNAL_SOURCE_DERIVED )
+        {
+            if( ( updated & SIGNAL_BIT( pDescriptor->input ) ) != 0U )
+            {
+                acquired = decodeValue( pRegistry, pDescriptor, 0, &value );
+            }
+        }
+        else
+        {
+            /* Set by the GPS stage. */
+        }
+
+        if( acquired == true )
+        {
+            storeValue( pRegistry, signal, value, nowMs );
+            updated = updated | SIGNAL_BIT( signal );
+        }
+    }
+
+    return updated;
+}
+
+/*-----------------------------------------------------------*/
+
+bool SignalRegistry_Set( SignalRegistry_t * pRegistry,
+                         uint32_t signal,
+                         double value,
+                         uint64_t nowMs )
+{
+    bool set = false;
+
+    if( ( signal < pRegistry->count ) && ( ( pRegistry->enabled & SIGNAL_BIT( signal ) ) != 0U ) )
+    {
+        storeValue( pRegistry, signal, value, nowMs );
+        set = true;
+    }
+
+    return set;
+}
+
+/*-----------------------------------------------------------*/
+
+double SignalRegistry_Get( const SignalRegistry_t * pRegistry,
+                           uint32_t signal )
+{
+    return pRegistry->value[ signal ];
+}
+
+/*-----------------------------------------------------------*/
+
+bool SignalRegistry_IsFresh( const SignalRegistry_t * pRegistry,
+                             uint32_t signal,
+                             uint64_t nowMs,
+                             uint32_t maxAgeMs )
+{
+    return ( signal < pRegistry->count ) &&
+           ( ( pRegistry->valid & SIGNAL_BIT( signal ) ) != 0U ) &&
+           ( ( nowMs - pRegistry->updatedMs[ signal ] ) <= maxAgeMs );
+}
+
+/*-----------------------------------------------------------*/
@@ -44,12 +44,12 @@ static const char *TAG = "gpsRoute";
 
 void udpateSimulatedGPSData( obdContext_t * pObdContext )
 {
-    double gpsStep = 0.0;
+    int32_t gpsStep = 0;
 
-    const double x1 = OBD_SIMULATED_TRIP_X1;
-    const double y1 = OBD_SIMULATED_TRIP_Y1;
-    const double x2 = OBD_SIMULATED_TRIP_X2;
-    const double y2 = OBD_SIMULATED_TRIP_Y2;
+    const int32_t x1 = OBD_SIMULATED_TRIP_X1;
+    const int32_t y1 = OBD_SIMULATED_TRIP_Y1;
+    const int32_t x2 = OBD_SIMULATED_TRIP_X2;
+    const int32_t y2 = OBD_SIMULATED_TRIP_Y2;
 
     CMS_LOGI( TAG, "Simulated GPS data." );
     if( ( pObdContext->startLatitude == 0 ) && ( pObdContext->startLongitude == 0 ) )
@@ -58,21 +58,21 @@ void udpateSimulatedGPSData( obdContext_t * pObdContext )
         pObdContext->startLongitude = y1;
     }
 
-    if( pObdContext->obdTelemetryData.vehicle_speed >= 100 )
+    if( SignalRegistry_Get( &pObdContext->signals, OBD_SIGNAL_VEHICLE_SPEED ) >= 100 )
     {
-        gpsStep = 0.0004;
+        gpsStep = 400;
     }
-    else if( pObdContext->obdTelemetryData.vehicle_speed >= 50 )
+    else if( SignalRegistry_Get( &pObdContext->signals, OBD_SIGNAL_VEHICLE_SPEED ) >= 50 )
     {
-        gpsStep = 0.0002;
+        gpsStep = 200;
     }
-    else if( pObdContext->obdTelemetryData.vehicle_speed > 0 )
+    else if( SignalRegistry_Get( &pObdContext->signals, OBD_SIGNAL_VEHICLE_SPEED ) > 0 )
     {
-        gpsStep = 0.0001;
+        gpsStep = 100;
     }
     else
     {
-        gpsStep = 0.0;
+        gpsStep = 0;
     }
 
     if( ( pObdContext->latitude == 0 ) && ( pObdContext->longitude == 0 ) )
@@ -0,0 +1,607 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file store_forward.c
+ * @brief Implementation of the persistent message queue.
+ *
+ * Record layout, little endian:
+ *   magic (2) | topic length (1) | 0 (1) | payload length (2) | 0 (2) |
+ *   sequence (4) | CRC-32 of all other bytes (4) | topic | payload
+ *
+ * Sequence numbers grow by one per record. The reader expects the next
+ * sequence at its position, or at the start of the next segment when the
+ * writer moved on, anything else is the end of the queue.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/unistd.h>
+
+#include "sdkconfig.h"
+
+#include "../include/store_forward.h"
+#include "../include/obd_config.h"
+
+// log print header
+#include "cms_log.h"
+
+/*-----------------------------------------------------------*/
+
+#ifdef CONFIG_FILE_SYSTEM_ENABLE
+    #define STORE_FORWARD_DIR               CONFIG_FS_MOUNT_POINT "/sfq"
+#else
+    #define STORE_FORWARD_DIR               "/sfq"
+#endif
+
+#define STORE_FORWARD_CURSOR_PATH           STORE_FORWARD_DIR "/cursor.dat"
+#define STORE_FORWARD_PATH_MAX              ( 64 )
+
+#define STORE_FORWARD_RECORD_MAGIC          ( 0x5346U )
+#define STORE_FORWARD_CURSOR_MAGIC          ( 0x43525355UL )
+#define STORE_FORWARD_HEADER_SIZE           ( 16U )
+#define STORE_FORWARD_CRC_OFFSET            ( 12U )
+#define STORE_FORWARD_CHUNK_SIZE            ( 64U )
+#define STORE_FORWARD_ANY_SEQUENCE          ( 0UL )
+
+#define STORE_FORWARD_ALIGNED( size )       ( ( ( size ) + STORE_FORWARD_ALIGN - 1U ) & ~( ( uint32_t ) STORE_FORWARD_ALIGN - 1U ) )
+
+typedef struct StoreForwardPosition
+{
+    uint32_t segment;
+    uint32_t offset;
+    uint32_t sequence;
+} StoreForwardPosition_t;
+
+typedef struct StoreForwardCursor
+{
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t crc;
+} StoreForwardCursor_t;
+
+typedef struct StoreForwardRecord
+{
+    uint8_t header[ STORE_FORWARD_HEADER_SIZE ];
+    uint32_t topicLength;
+    uint32_t payloadLength;
+    uint32_t sequence;
+    uint32_t crc;
+    uint32_t alignedSize;
+} StoreForwardRecord_t;
+
+typedef struct StoreForward
+{
+    bool initialized;
+    StoreForwardPosition_t write;   /* Sequence is the next to write. */
+    StoreForwardPosition_t read;    /* Sequence is the next to read. */
+    StoreForwardPosition_t peeked;  /* Read position after the peeked record. */
+    bool hasPeeked;
+    uint32_t unsavedPops;           /* Messages removed since the cursor was saved. */
+    uint32_t savedSegment;          /* Segment of the saved cursor. */
+    uint32_t droppedSegments;
+} StoreForward_t;
+
+/*-----------------------------------------------------------*/
+
+static const char *TAG = "storeForward";
+
+static StoreForward_t storeForward = { 0 };
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvCrc32( uint32_t crc,
+                          const uint8_t * pData,
+                          size_t length )
+{
+    uint8_t bit = 0;
+
+    crc = ~crc;
+
+    while( length > 0U )
+    {
+        crc = crc ^ *pData;
+
+        for( bit = 0; bit < 8U; bit++ )
+        {
+            crc = ( crc >> 1 ) ^ ( 0xEDB88320UL & ( 0UL - ( crc & 1UL ) ) );
+        }
+
+        pData++;
+        length--;
+    }
+
+    return ~crc;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSegmentPath( char * pPath,
+                            uint32_t segment )
+{
+    snprintf( pPath, STORE_FORWARD_PATH_MAX, STORE_FORWARD_DIR "/seg%u.dat", ( unsigned int ) segment );
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvGetUint( const uint8_t * pData,
+                            uint8_t size )
+{
+    uint32_t value = 0;
+
+    while( size > 0U )
+    {
+        size--;
+        value = ( value << 8 ) | pData[ size ];
+    }
+
+    return value;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPutUint( uint8_t * pData,
+                        uint32_t value,
+                        uint8_t size )
+{
+    uint8_t i = 0;
+
+    for( i = 0; i < size; i++ )
+    {
+        pData[ i ] = ( uint8_t ) ( value >> ( 8U * i ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Read and check the header, the CRC is not verified. */
+static bool prvReadHeader( FILE * fp,
+                           uint32_t offset,
+                           StoreForwardRecord_t * pRecord )
+{
+    if( ( ( offset + STORE_FORWARD_HEADER_SIZE ) > STORE_FORWARD_SEGMENT_SIZE ) ||
+        ( fseek( fp, ( long ) offset, SEEK_SET ) != 0 ) ||
+        ( fread( pRecord->header, 1, STORE_FORWARD_HEADER_SIZE, fp ) != STORE_FORWARD_HEADER_SIZE ) ||
+        ( prvGetUint( &pRecord->header[ 0 ], 2 ) != STORE_FORWARD_RECORD_MAGIC ) )
+    {
+        return false;
+    }
+
+    pRecord->topicLength = pRecord->header[ 2 ];
+    pRecord->payloadLength = prvGetUint( &pRecord->header[ 4 ], 2 );
+    pRecord->sequence = prvGetUint( &pRecord->header[ 8 ], 4 );
+    pRecord->crc = prvGetUint( &pRecord->header[ STORE_FORWARD_CRC_OFFSET ], 4 );
+    pRecord->alignedSize = STORE_FORWARD_ALIGNED( STORE_FORWARD_HEADER_SIZE + pRecord->topicLength + pRecord->payloadLength );
+
+    return ( offset + pRecord->alignedSize ) <= STORE_FORWARD_SEGMENT_SIZE;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Verify the CRC of the record after its header in small chunks. */
+static bool prvVerifyRecord( FILE * fp,
+                             const StoreForwardRecord_t * pRecord )
+{
+    uint8_t chunk[ STORE_FORWARD_CHUNK_SIZE ];
+    uint32_t remaining = pRecord->topicLength + pRecord->payloadLength;
+    uint32_t size = 0;
+    uint32_t crc = prvCrc32( 0, pRecord->header, STORE_FORWARD_CRC_OFFSET );
+
+    while( remaining > 0U )
+    {
+        size = ( remaining > STORE_FORWARD_CHUNK_SIZE ) ? STORE_FORWARD_CHUNK_SIZE : remaining;
+
+        if( fread( chunk, 1, size, fp ) != size )
+        {
+            return false;
+        }
+
+        crc = prvCrc32( crc, chunk, size );
+        remaining = remaining - size;
+    }
+
+    return crc == pRecord->crc;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool prvPreallocate( uint32_t segment )
+{
+    static const uint8_t zeros[ STORE_FORWARD_ALIGN ] = { 0 };
+    char path[ STORE_FORWARD_PATH_MAX ];
+    struct stat fileStat;
+    FILE * fp = NULL;
+    uint32_t offset = 0;
+    bool ret = true;
+
+    prvSegmentPath( path, segment );
+
+    if( ( stat( path, &fileStat ) == 0 ) && ( fileStat.st_size >= ( off_t ) STORE_FORWARD_SEGMENT_SIZE ) )
+    {
+        return true;
+    }
+
+    fp = fopen( path, "wb" );
+
+    if( fp == NULL )
+    {
+        CMS_LOGE( TAG, "Create %s failed.", path );
+        return false;
+    }
+
+    for( offset = 0; ( offset < STORE_FORWARD_SEGMENT_SIZE ) && ( ret == true ); offset += STORE_FORWARD_ALIGN )
+    {
+        ret = ( fwrite( zeros, 1, STORE_FORWARD_ALIGN, fp ) == STORE_FORWARD_ALIGN );
+    }
+
+    fclose( fp );
+
+    return ret;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSaveCursor( void )
+{
+    StoreForwardCursor_t cursor;
+    FILE * fp = NULL;
+
+    cursor.magic = STORE_FORWARD_CURSOR_MAGIC;
+    cursor.sequence = storeForward.read.sequence;
+    cursor.crc = prvCrc32( 0, ( const uint8_t * ) &cursor, offsetof( StoreForwardCursor_t, crc ) );
+
+    fp = fopen( STORE_FORWARD_CURSOR_PATH, "wb" );
+
+    if( fp != NULL )
+    {
+        ( void ) fwrite( &cursor, 1, sizeof( cursor ), fp );
+        fflush( fp );
+        fsync( fileno( fp ) );
+        fclose( fp );
+        storeForward.unsavedPops = 0;
+        storeForward.savedSegment = storeForward.read.segment;
+    }
+    else
+    {
+        CMS_LOGW( TAG, "Save cursor failed." );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Get the sequence of the next message to send or STORE_FORWARD_ANY_SEQUENCE. */
+static uint32_t prvLoadCursor( void )
+{
+    StoreForwardCursor_t cursor;
+    FILE * fp = fopen( STORE_FORWARD_CURSOR_PATH, "rb" );
+    uint32_t ret = STORE_FORWARD_ANY_SEQUENCE;
+
+    if( fp != NULL )
+    {
+        if( ( fread( &cursor, 1, sizeof( cursor ), fp ) == sizeof( cursor ) ) &&
+            ( cursor.magic == STORE_FORWARD_CURSOR_MAGIC ) &&
+            ( cursor.crc == prvCrc32( 0, ( const uint8_t * ) &cursor, offsetof( StoreForwardCursor_t, crc ) ) ) )
+        {
+            ret = cursor.sequence;
+        }
+
+        fclose( fp );
+    }
+
+    return ret;
+}
+
+/*-----------------------------------------------------------*/
+
+bool StoreForward_Init( void )
+{
+    #ifdef CONFIG_FILE_SYSTEM_ENABLE
+        char path[ STORE_FORWARD_PATH_MAX ];
+        StoreForwardRecord_t record;
+        StoreForwardPosition_t oldest = { 0, 0, UINT32_MAX };
+        FILE * fp = NULL;
+        uint32_t segment = 0;
+        uint32_t offset = 0;
+        uint32_t previous = 0;
+        uint32_t cursor = prvLoadCursor();
+        bool cursorFound = false;
+
+        memset( &storeForward, 0, sizeof( storeForward ) );
+        storeForward.write.sequence = 1;
+
+        if( ( mkdir( STORE_FORWARD_DIR, 0775 ) != 0 ) && ( errno != EEXIST ) )
+        {
+            CMS_LOGE( TAG, "Create %s failed.", STORE_FORWARD_DIR );
+            return false;
+        }
+
+        /* Find the newest and the oldest valid record. The records of a segment
+         * follow each other, older records after them are left from a previous
+         * round of the ring. */
+        for( segment = 0; segment < STORE_FORWARD_SEGMENT_COUNT; segment++ )
+        {
+            if( prvPreallocate( segment ) == false )
+            {
+                return false;
+            }
+
+            prvSegmentPath( path, segment );
+            fp = fopen( path, "rb" );
+
+            if( fp == NULL )
+            {
+                return false;
+            }
+
+            for( offset = 0; prvReadHeader( fp, offset, &record ) == true; offset += record.alignedSize )
+            {
+                if( ( prvVerifyRecord( fp, &record ) == false ) ||
+                    ( ( offset > 0U ) && ( record.sequence != ( previous + 1U ) ) ) )
+                {
+                    break;
+                }
+
+                previous = record.sequence;
+
+                if( record.sequence >= storeForward.write.sequence )
+                {
+                    storeForward.write.segment = segment;
+                    storeForward.write.offset = offset + record.alignedSize;
+                    storeForward.write.sequence = record.sequence + 1U;
+                }
+
+                if( record.sequence < oldest.sequence )
+                {
+                    oldest.segment = segment;
+                    oldest.offset = offset;
+                    oldest.sequence = record.sequence;
+                }
+
+                if( record.sequence == cursor )
+                {
+                    storeForward.read.segment = segment;
+                    storeForward.read.offset = offset;
+                    storeForward.read.sequence = record.sequence;
+                    cursorFound = true;
+                }
+            }
+
+            fclose( fp );
+        }
+
+        if( ( cursorFound == false ) && ( cursor >= storeForward.write.sequence ) )
+        {
+            storeForward.read = storeForward.write;
+        }
+        else if( cursorFound == false )
+        {
+            /* Send again what is left rather than lose it, or skip the dropped records. */
+            storeForward.read = ( oldest.sequence != UINT32_MAX ) ? oldest : storeForward.write;
+            CMS_LOGW( TAG, "No valid cursor, replay from sequence %u.", ( unsigned int ) storeForward.read.sequence );
+        }
+        else
+        {
+            /* Empty Else MISRA 15.7 */
+        }
+
+        storeForward.savedSegment = storeForward.read.segment;
+        storeForward.initialized = true;
+        CMS_LOGI( TAG, "Queue from sequence %u to %u.",
+                  ( unsigned int ) storeForward.read.sequence,
+                  ( unsigned int ) storeForward.write.sequence );
+
+        return true;
+    #else /* ifdef CONFIG_FILE_SYSTEM_ENABLE */
+        return false;
+    #endif /* ifdef CONFIG_FILE_SYSTEM_ENABLE */
+}
+
+/*-----------------------------------------------------------*/
+
+bool StoreForward_IsEmpty( void )
+{
+    /* A reader at the end of a segment may still have to move on, Peek finds out. */
+    return ( storeForward.initialized == false ) ||
+           ( storeForward.read.sequence == storeForward.write.sequence );
+}
+
+/*-----------------------------------------------------------*/
+
+bool StoreForward_Push( const char * pTopic,
+                        const uint8_t * pPayload,
+                        size_t payloadLength )
+{
+    char path[ STORE_FORWARD_PATH_MAX ];
+    uint8_t header[ STORE_FORWARD_HEADER_SIZE ] = { 0 };
+    size_t topicLength = strlen( pTopic );
+    uint32_t alignedSize = STORE_FORWARD_ALIGNED( STORE_FORWARD_HEADER_SIZE + topicLength + payloadLength );
+    uint32_t next = 0;
+    uint32_t crc = 0;
+    FILE * fp = NULL;
+    bool ret = false;
+
+    if( ( storeForward.initialized == false ) || ( topicLength > UINT8_MAX ) ||
+        ( payloadLength > UINT16_MAX ) || ( alignedSize > STORE_FORWARD_SEGMENT_SIZE ) )
+    {
+        return false;
+    }
+
+    if( ( storeForward.write.offset + alignedSize ) > STORE_FORWARD_SEGMENT_SIZE )
+    {
+        next = ( storeForward.write.segment + 1U ) % STORE_FORWARD_SEGMENT_COUNT;
+
+        /* Full, drop the oldest segment. */
+        if( ( next == storeForward.read.segment ) && ( StoreForward_IsEmpty() == false ) )
+        {
+            storeForward.read.segment = ( next + 1U ) % STORE_FORWARD_SEGMENT_COUNT;
+            storeForward.read.offset = 0;
+            storeForward.read.sequence = STORE_FORWARD_ANY_SEQUENCE;
+            storeForward.hasPeeked = false;
+            storeForward.droppedSegments++;
+            CMS_LOGW( TAG, "Queue full, segment %u dropped.", ( unsigned int ) next );
+        }
+
+        storeForward.write.segment = next;
+        storeForward.write.offset = 0;
+    }
+
+    prvPutUint( &header[ 0 ], STORE_FORWARD_RECORD_MAGIC, 2 );
+    header[ 2 ] = ( uint8_t ) topicLength;
+    prvPutUint( &header[ 4 ], ( uint32_t ) payloadLength, 2 );
+    prvPutUint( &header[ 8 ], storeForward.write.sequence, 4 );
+    crc = prvCrc32( 0, header, STORE_FORWARD_CRC_OFFSET );
+    crc = prvCrc32( crc, ( const uint8_t * ) pTopic, topicLength );
+    crc = prvCrc32( crc, pPayload, payloadLength );
+    prvPutUint( &header[ STORE_FORWARD_CRC_OFFSET ], crc, 4 );
+
+    prvSegmentPath( path, storeForward.write.segment );
+    fp = fopen( path, "r+b" );
+
+    if( fp != NULL )
+    {
+        /* The record starts at an aligned offset, the padding is not written. */
+        ret = ( fseek( fp, ( long ) storeForward.write.offset, SEEK_SET ) == 0 ) &&
+              ( fwrite( header, 1, sizeof( header ), fp ) == sizeof( header ) ) &&
+              ( fwrite( pTopic, 1, topicLength, fp ) == topicLength ) &&
+              ( fwrite( pPayload, 1, payloadLength, fp ) == payloadLength ) &&
+              ( fflush( fp ) == 0 ) &&
+              ( fsync( fileno( fp ) ) == 0 );
+        fclose( fp );
+    }
+
+    if( ret == true )
+    {
+        storeForward.write.offset = storeForward.write.offset + alignedSize;
+        storeForward.write.sequence = storeForward.write.sequence + 1U;
+    }
+    else
+    {
+        CMS_LOGE( TAG, "Write %s failed.", path );
+    }
+
+    return ret;
+}
+
+/*-----------------------------------------------------------*/
+
+bool StoreForward_Peek( char * pTopic,
+                        size_t topicSize,
+                        uint8_t * pPayload,
+                        size_t payloadSize,
+                        size_t * pPayloadLength )
+{
+    char path[ STORE_FORWARD_PATH_MAX ];
+    StoreForwardRecord_t record;
+    StoreForwardPosition_t * pRead = &storeForward.read;
+    FILE * fp = NULL;
+    uint32_t attempt = 0;
+    bool found = false;
+    bool valid = false;
+
+    storeForward.hasPeeked = false;
+
+    for( attempt = 0; ( attempt <= STORE_FORWARD_SEGMENT_COUNT ) && ( StoreForward_IsEmpty() == false ); attempt++ )
+    {
+        prvSegmentPath( path, pRead->segment );
+        fp = fopen( path, "rb" );
+
+        if( fp == NULL )
+        {
+            return false;
+        }
+
+        found = ( prvReadHeader( fp, pRead->offset, &record ) == true ) &&
+                ( ( pRead->sequence == STORE_FORWARD_ANY_SEQUENCE ) || ( record.sequence == pRead->sequence ) );
+        valid = found &&
+                ( record.topicLength < topicSize ) &&
+                ( record.payloadLength <= payloadSize ) &&
+                ( fread( pTopic, 1, record.topicLength, fp ) == record.topicLength ) &&
+                ( fread( pPayload, 1, record.payloadLength, fp ) == record.payloadLength ) &&
+                ( record.crc == prvCrc32( prvCrc32( prvCrc32( 0, record.header, STORE_FORWARD_CRC_OFFSET ),
+                                                    ( const uint8_t * ) pTopic, record.topicLength ),
+                                          pPayload, record.payloadLength ) );
+        fclose( fp );
+
+        if( valid == true )
+        {
+            pTopic[ record.topicLength ] = '\0';
+            *pPayloadLength = record.payloadLength;
+            storeForward.peeked.segment = pRead->segment;
+            storeForward.peeked.offset = pRead->offset + record.alignedSize;
+            storeForward.peeked.sequence = record.sequence + 1U;
+            storeForward.hasPeeked = true;
+            break;
+        }
+        else if( found == true )
+        {
+            /* Damaged record, skip it. */
+            CMS_LOGW( TAG, "Record %u damaged, skipped.", ( unsigned int ) record.sequence );
+            pRead->offset = pRead->offset + record.alignedSize;
+            pRead->sequence = record.sequence + 1U;
+        }
+        else if( ( pRead->sequence == STORE_FORWARD_ANY_SEQUENCE ) || ( pRead->segment == storeForward.write.segment ) )
+        {
+            /* Nothing where the queue should continue. */
+            CMS_LOGW( TAG, "Queue lost at sequence %u.", ( unsigned int ) pRead->sequence );
+            *pRead = storeForward.write;
+        }
+        else
+        {
+            /* The writer moved on to the next segment. */
+            pRead->segment = ( pRead->segment + 1U ) % STORE_FORWARD_SEGMENT_COUNT;
+            pRead->offset = 0;
+        }
+    }
+
+    return storeForward.hasPeeked;
+}
+
+/*-----------------------------------------------------------*/
+
+void StoreForward_Pop( void )
+{
+    if( storeForward.hasPeeked == true )
+    {
+        storeForward.read = storeForward.peeked;
+        storeForward.hasPeeked = false;
+        storeForward.unsavedPops++;
+
+        /* A cursor behind by a few messages only sends them twice after a
+         * restart. One in a dropped segment would send the whole queue again. */
+        if( ( storeForward.unsavedPops >= STORE_FORWARD_CURSOR_SAVE_EVERY ) ||
+            ( storeForward.read.segment != storeForward.savedSegment ) ||
+            ( StoreForward_IsEmpty() == true ) )
+        {
+            prvSaveCursor();
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t StoreForward_GetDroppedSegments( void )
+{
+    return storeForward.droppedSegments;
+}
+
+/*-----------------------------------------------------------*/
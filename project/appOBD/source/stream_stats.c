@@ -0,0 +1,243 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file stream_stats.c
+ * @brief Implementation of the streaming statistics.
+ *
+ * The quantile estimate follows Jain and Chlamtac, "The P-square algorithm
+ * for dynamic calculation of quantiles and histograms without storing
+ * observations", 1985.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "../include/stream_stats.h"
+
+/*-----------------------------------------------------------*/
+
+/* Piecewise parabolic prediction of marker i moved by d. */
+static double parabolic( const StreamQuantile_t * pQuantile,
+                         int32_t i,
+                         int32_t d )
+{
+    const double * q = pQuantile->height;
+    const int32_t * n = pQuantile->position;
+
+    return q[ i ] + ( ( double ) d / ( double ) ( n[ i + 1 ] - n[ i - 1 ] ) ) *
+           ( ( ( double ) ( n[ i ] - n[ i - 1 ] + d ) * ( q[ i + 1 ] - q[ i ] ) / ( double ) ( n[ i + 1 ] - n[ i ] ) ) +
+             ( ( double ) ( n[ i + 1 ] - n[ i ] - d ) * ( q[ i ] - q[ i - 1 ] ) / ( double ) ( n[ i ] - n[ i - 1 ] ) ) );
+}
+
+/*-----------------------------------------------------------*/
+
+void StreamQuantile_Init( StreamQuantile_t * pQuantile,
+                          double quantile )
+{
+    memset( pQuantile, 0, sizeof( StreamQuantile_t ) );
+    pQuantile->quantile = quantile;
+}
+
+/*-----------------------------------------------------------*/
+
+void StreamQuantile_Add( StreamQuantile_t * pQuantile,
+                         double value )
+{
+    double * q = pQuantile->height;
+    int32_t * n = pQuantile->position;
+    double p = pQuantile->quantile;
+    double height = 0.0;
+    double offset = 0.0;
+    int32_t i = 0;
+    int32_t k = 0;
+    int32_t d = 0;
+
+    /* The first values are kept sorted and become the markers. */
+    if( pQuantile->count < STREAM_QUANTILE_MARKERS )
+    {
+        for( i = ( int32_t ) pQuantile->count; ( i > 0 ) && ( q[ i - 1 ] > value ); i-- )
+        {
+            q[ i ] = q[ i - 1 ];
+        }
+
+        q[ i ] = value;
+        pQuantile->count++;
+
+        if( pQuantile->count == STREAM_QUANTILE_MARKERS )
+        {
+            for( i = 0; i < STREAM_QUANTILE_MARKERS; i++ )
+            {
+                n[ i ] = i;
+            }
+
+            pQuantile->desired[ 0 ] = 0.0;
+            pQuantile->desired[ 1 ] = 2.0 * p;
+            pQuantile->desired[ 2 ] = 4.0 * p;
+            pQuantile->desired[ 3 ] = 2.0 + 2.0 * p;
+            pQuantile->desired[ 4 ] = 4.0;
+        }
+
+        return;
+    }
+
+    /* Find the cell of the value, the extreme markers follow it. */
+    if( value < q[ 0 ] )
+    {
+        q[ 0 ] = value;
+        k = 0;
+    }
+    else if( value >= q[ 4 ] )
+    {
+        q[ 4 ] = value;
+        k = 3;
+    }
+    else
+    {
+        for( k = 0; value >= q[ k + 1 ]; k++ )
+        {
+        }
+    }
+
+    for( i = k + 1; i < STREAM_QUANTILE_MARKERS; i++ )
+    {
+        n[ i ]++;
+    }
+
+    pQuantile->desired[ 1 ] += p / 2.0;
+    pQuantile->desired[ 2 ] += p;
+    pQuantile->desired[ 3 ] += ( 1.0 + p ) / 2.0;
+    pQuantile->desired[ 4 ] += 1.0;
+    pQuantile->count++;
+
+    /* Move the middle markers one rank towards their wanted rank. */
+    for( i = 1; i < ( STREAM_QUANTILE_MARKERS - 1 ); i++ )
+    {
+        offset = pQuantile->desired[ i ] - ( double ) n[ i ];
+
+        if( ( ( offset >= 1.0 ) && ( ( n[ i + 1 ] - n[ i ] ) > 1 ) ) ||
+            ( ( offset <= -1.0 ) && ( ( n[ i - 1 ] - n[ i ] ) < -1 ) ) )
+        {
+            d = ( offset > 0.0 ) ? 1 : -1;
+            height = parabolic( pQuantile, i, d );
+
+            if( ( height <= q[ i - 1 ] ) || ( height >= q[ i + 1 ] ) )
+            {
+                /* Linear when the parabola leaves the neighbours. */
+                height = q[ i ] + ( double ) d * ( q[ i + d ] - q[ i ] ) / ( double ) ( n[ i + d ] - n[ i ] );
+            }
+
+            q[ i ] = height;
+            n[ i ] += d;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+double StreamQuantile_Get( const StreamQuantile_t * pQuantile )
+{
+    double value = 0.0;
+
+    if( pQuantile->count > STREAM_QUANTILE_MARKERS )
+    {
+        value = pQuantile->height[ 2 ];
+    }
+    else if( pQuantile->count > 0U )
+    {
+        /* Nearest rank of the sorted values. */
+        value = pQuantile->height[ ( uint32_t ) ( pQuantile->quantile * ( double ) ( pQuantile->count - 1U ) + 0.5 ) ];
+    }
+    else
+    {
+        /* Empty Else MISRA 15.7 */
+    }
+
+    return value;
+}
+
+/*-----------------------------------------------------------*/
+
+void StreamStats_Init( StreamStats_t * pStats )
+{
+    memset( pStats, 0, sizeof( StreamStats_t ) );
+    StreamQuantile_Init( &pStats->p50, 0.5 );
+    StreamQuantile_Init( &pStats->p95, 0.95 );
+}
+
+/*-----------------------------------------------------------*/
+
+void StreamStats_Add( StreamStats_t * pStats,
+                      double value,
+                      uint64_t timeMs )
+{
+    double delta = value - pStats->mean;
+
+    if( pStats->count == 0U )
+    {
+        pStats->min = value;
+        pStats->max = value;
+    }
+    else
+    {
+        pStats->min = ( value < pStats->min ) ? value : pStats->min;
+        pStats->max = ( value > pStats->max ) ? value : pStats->max;
+
+        /* The previous value held until now. */
+        if( timeMs > pStats->lastTimeMs )
+        {
+            pStats->weightedSum += pStats->lastValue * ( double ) ( timeMs - pStats->lastTimeMs );
+            pStats->weightedMs += timeMs - pStats->lastTimeMs;
+        }
+    }
+
+    pStats->count++;
+    pStats->mean += delta / ( double ) pStats->count;
+    pStats->m2 += delta * ( value - pStats->mean );
+
+    StreamQuantile_Add( &pStats->p50, value );
+    StreamQuantile_Add( &pStats->p95, value );
+
+    pStats->lastValue = value;
+    pStats->lastTimeMs = timeMs;
+}
+
+/*-----------------------------------------------------------*/
+
+double StreamStats_GetVariance( const StreamStats_t * pStats )
+{
+    return ( pStats->count > 1U ) ? ( pStats->m2 / ( double ) ( pStats->count - 1U ) ) : 0.0;
+}
+
+/*-----------------------------------------------------------*/
+
+double StreamStats_GetStdDev( const StreamStats_t * pStats )
+{
+    return sqrt( StreamStats_GetVariance( pStats ) );
+}
+
+/*-----------------------------------------------------------*/
+
+double StreamStats_GetTimeWeightedMean( const StreamStats_t * pStats )
+{
+    return ( pStats->weightedMs > 0U ) ? ( pStats->weightedSum / ( double ) pStats->weightedMs ) : pStats->mean;
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,218 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file telemetry_batch.c
+ * @brief Implementation of the telemetry sample batch.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../include/telemetry_batch.h"
+
+typedef struct SampleDeadband
+{
+    size_t fieldOffset; /* Of a double in ObdSample_t. */
+    double deadband;
+    uint32_t heartbeatMs;
+} SampleDeadband_t;
+
+/* Indexed by ObdSampleField_t, the position is compared separately. */
+static const SampleDeadband_t sampleDeadbands[ OBD_SAMPLE_FIELD_MAX ] =
+{
+    [ OBD_SAMPLE_FIELD_POSITION ] = { 0U,                                  OBD_DEADBAND_POSITION,    OBD_TELEMETRY_HEARTBEAT_MS      },
+    [ OBD_SAMPLE_FIELD_HEADING ]  = { offsetof( ObdSample_t, heading ),    OBD_DEADBAND_HEADING,     OBD_TELEMETRY_HEARTBEAT_MS      },
+    [ OBD_SAMPLE_FIELD_SPEED ]    = { offsetof( ObdSample_t, speed ),      OBD_DEADBAND_SPEED,       OBD_TELEMETRY_HEARTBEAT_MS      },
+    [ OBD_SAMPLE_FIELD_ODOMETER ] = { offsetof( ObdSample_t, odometer ),   OBD_DEADBAND_DISTANCE,    OBD_TELEMETRY_SLOW_HEARTBEAT_MS },
+    [ OBD_SAMPLE_FIELD_FUEL ]     = { offsetof( ObdSample_t, fuel ),       OBD_DEADBAND_FUEL,        OBD_TELEMETRY_SLOW_HEARTBEAT_MS },
+    [ OBD_SAMPLE_FIELD_OIL_TEMP ] = { offsetof( ObdSample_t, oilTemp ),    OBD_DEADBAND_TEMPERATURE, OBD_TELEMETRY_SLOW_HEARTBEAT_MS },
+};
+
+/*-----------------------------------------------------------*/
+
+static double * sampleField( ObdSample_t * pSample,
+                             size_t fieldOffset )
+{
+    return ( double * ) ( ( uint8_t * ) pSample + fieldOffset );
+}
+
+/*-----------------------------------------------------------*/
+
+void TelemetryBatch_Init( TelemetryBatch_t * pBatch )
+{
+    pBatch->count = 0;
+
+    if( pBatch->maxSamples == 0U )
+    {
+        TelemetryBatch_SetLimits( pBatch, OBD_TELEMETRY_BATCH_MAX_SAMPLES, OBD_TELEMETRY_BATCH_MAX_MS );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void TelemetryBatch_SetLimits( TelemetryBatch_t * pBatch,
+                               uint32_t maxSamples,
+                               uint32_t maxMs )
+{
+    if( ( maxSamples == 0U ) || ( maxSamples > OBD_TELEMETRY_BATCH_MAX_SAMPLES ) )
+    {
+        maxSamples = OBD_TELEMETRY_BATCH_MAX_SAMPLES;
+    }
+
+    pBatch->maxSamples = ( uint16_t ) maxSamples;
+    pBatch->maxMs = maxMs;
+}
+
+/*-----------------------------------------------------------*/
+
+bool TelemetryBatch_Add( TelemetryBatch_t * pBatch,
+                         const ObdSample_t * pSample )
+{
+    bool added = false;
+
+    /* Past maxSamples when the limit was lowered, the batch is due anyway. */
+    if( pBatch->count < OBD_TELEMETRY_BATCH_MAX_SAMPLES )
+    {
+        memcpy( &pBatch->samples[ pBatch->count ], pSample, sizeof( ObdSample_t ) );
+        pBatch->count = pBatch->count + 1U;
+        added = true;
+    }
+
+    return added;
+}
+
+/*-----------------------------------------------------------*/
+
+bool TelemetryBatch_IsDue( const TelemetryBatch_t * pBatch,
+                           uint64_t nowMs )
+{
+    bool due = false;
+
+    if( pBatch->count >= pBatch->maxSamples )
+    {
+        due = true;
+    }
+    else if( ( pBatch->count > 0U ) && ( ( nowMs - pBatch->samples[ 0 ].timestampMs ) >= pBatch->maxMs ) )
+    {
+        due = true;
+    }
+    else
+    {
+        /* Empty Else MISRA 15.7 */
+    }
+
+    return due;
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t TelemetryBatch_GetOffsetMs( const TelemetryBatch_t * pBatch,
+                                     uint16_t index )
+{
+    return ( uint32_t ) ( pBatch->samples[ index ].timestampMs - pBatch->samples[ 0 ].timestampMs );
+}
+
+/*-----------------------------------------------------------*/
+
+void TelemetryDeadband_Init( TelemetryDeadband_t * pDeadband )
+{
+    memset( pDeadband, 0, sizeof( TelemetryDeadband_t ) );
+}
+
+/*-----------------------------------------------------------*/
+
+bool TelemetryDeadband_Filter( TelemetryDeadband_t * pDeadband,
+                               ObdSample_t * pSample )
+{
+    uint32_t i = 0;
+    bool moved = false;
+    double * pValue = NULL;
+    double * pLast = NULL;
+
+    pSample->reported = 0U;
+
+    for( i = 0; i < ( uint32_t ) OBD_SAMPLE_FIELD_MAX; i++ )
+    {
+        #if ( OBD_TELEMETRY_DEADBAND == 1 )
+            if( i == ( uint32_t ) OBD_SAMPLE_FIELD_POSITION )
+            {
+                moved = ( labs( ( long ) pSample->latitude - ( long ) pDeadband->last.latitude ) > ( long ) sampleDeadbands[ i ].deadband ) ||
+                        ( labs( ( long ) pSample->longitude - ( long ) pDeadband->last.longitude ) > ( long ) sampleDeadbands[ i ].deadband );
+            }
+            else
+            {
+                pValue = sampleField( pSample, sampleDeadbands[ i ].fieldOffset );
+                pLast = sampleField( &pDeadband->last, sampleDeadbands[ i ].fieldOffset );
+                moved = fabs( *pValue - *pLast ) > sampleDeadbands[ i ].deadband;
+            }
+
+            moved = moved || ( pDeadband->started == false ) ||
+                    ( ( pSample->timestampMs - pDeadband->lastReportMs[ i ] ) >= sampleDeadbands[ i ].heartbeatMs );
+        #else
+            moved = true;
+        #endif /* if ( OBD_TELEMETRY_DEADBAND == 1 ) */
+
+        if( moved == true )
+        {
+            pSample->reported = pSample->reported | OBD_SAMPLE_FIELD_BIT( i );
+            pDeadband->lastReportMs[ i ] = pSample->timestampMs;
+        }
+    }
+
+    /* Hold the fields not reported at the value the receiver already has. */
+    for( i = 0; i < ( uint32_t ) OBD_SAMPLE_FIELD_MAX; i++ )
+    {
+        if( i == ( uint32_t ) OBD_SAMPLE_FIELD_POSITION )
+        {
+            if( ( pSample->reported & OBD_SAMPLE_FIELD_BIT( i ) ) != 0U )
+            {
+                pDeadband->last.latitude = pSample->latitude;
+                pDeadband->last.longitude = pSample->longitude;
+            }
+            else
+            {
+                pSample->latitude = pDeadband->last.latitude;
+                pSample->longitude = pDeadband->last.longitude;
+            }
+        }
+        else
+        {
+            pValue = sampleField( pSample, sampleDeadbands[ i ].fieldOffset );
+            pLast = sampleField( &pDeadband->last, sampleDeadbands[ i ].fieldOffset );
+
+            if( ( pSample->reported & OBD_SAMPLE_FIELD_BIT( i ) ) != 0U )
+            {
+                *pLast = *pValue;
+            }
+            else
+            {
+                *pValue = *pLast;
+            }
+        }
+    }
+
+    pDeadband->started = true;
+
+    return pSample->reported != 0U;
+}
+
+/*-----------------------------------------------------------*/
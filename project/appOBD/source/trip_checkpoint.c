@@ -0,0 +1,147 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file trip_checkpoint.c
+ * @brief Implementation of the trip checkpoint.
+ *
+ * The checkpoint is one NVS blob behind a magic number. NVS writes the new
+ * blob before it erases the old one, so a reset while saving keeps one of
+ * them whole.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "nvs.h"
+
+#include "../include/trip_checkpoint.h"
+#include "../include/obd_config.h"
+
+// log print header
+#include "cms_log.h"
+
+/*-----------------------------------------------------------*/
+
+#define TRIP_CHECKPOINT_NVS_NAMESPACE   "obdTrip"
+#define TRIP_CHECKPOINT_NVS_KEY         "checkpoint"
+#define TRIP_CHECKPOINT_MAGIC           ( 0x54435032UL )  /* "TCP2", changes with ObdTripCheckpoint_t. */
+
+typedef struct TripCheckpointStore
+{
+    uint32_t magic;
+    ObdTripCheckpoint_t checkpoint;
+} TripCheckpointStore_t;
+
+/*-----------------------------------------------------------*/
+
+static const char *TAG = "tripCheckpoint";
+
+/* Too large for the telemetry task stack. */
+static TripCheckpointStore_t checkpointStore;
+
+/*-----------------------------------------------------------*/
+
+bool TripCheckpoint_Save( const ObdTripCheckpoint_t * pCheckpoint )
+{
+    nvs_handle_t handle;
+    esp_err_t err = ESP_OK;
+
+    checkpointStore.magic = TRIP_CHECKPOINT_MAGIC;
+    memcpy( &checkpointStore.checkpoint, pCheckpoint, sizeof( ObdTripCheckpoint_t ) );
+
+    err = nvs_open( TRIP_CHECKPOINT_NVS_NAMESPACE, NVS_READWRITE, &handle );
+
+    if( err == ESP_OK )
+    {
+        err = nvs_set_blob( handle, TRIP_CHECKPOINT_NVS_KEY, &checkpointStore, sizeof( TripCheckpointStore_t ) );
+
+        if( err == ESP_OK )
+        {
+            err = nvs_commit( handle );
+        }
+
+        nvs_close( handle );
+    }
+
+    if( err != ESP_OK )
+    {
+        CMS_LOGE( TAG, "Failed to save trip checkpoint, error %d.", ( int ) err );
+    }
+
+    return err == ESP_OK;
+}
+
+/*-----------------------------------------------------------*/
+
+bool TripCheckpoint_Load( ObdTripCheckpoint_t * pCheckpoint )
+{
+    size_t storeLength = sizeof( TripCheckpointStore_t );
+    nvs_handle_t handle;
+    bool retLoad = false;
+
+    if( nvs_open( TRIP_CHECKPOINT_NVS_NAMESPACE, NVS_READONLY, &handle ) == ESP_OK )
+    {
+        if( ( nvs_get_blob( handle, TRIP_CHECKPOINT_NVS_KEY, &checkpointStore, &storeLength ) == ESP_OK ) &&
+            ( storeLength == sizeof( TripCheckpointStore_t ) ) &&
+            ( checkpointStore.magic == TRIP_CHECKPOINT_MAGIC ) &&
+            ( checkpointStore.checkpoint.tripId[ OBD_TRIP_ID_MAX - 1 ] == '\0' ) )
+        {
+            memcpy( pCheckpoint, &checkpointStore.checkpoint, sizeof( ObdTripCheckpoint_t ) );
+            retLoad = true;
+        }
+
+        nvs_close( handle );
+    }
+
+    return retLoad;
+}
+
+/*-----------------------------------------------------------*/
+
+TripResume_t TripCheckpoint_GetResume( const ObdTripCheckpoint_t * pCheckpoint,
+                                       const char * pOdometerTripId,
+                                       bool clockValid,
+                                       uint64_t nowEpochMs )
+{
+    TripResume_t resume = TRIP_RESUME_NONE;
+
+    if( ( clockValid == true ) && ( pCheckpoint != NULL ) &&
+        ( nowEpochMs >= pCheckpoint->savedEpochMs ) &&
+        ( ( nowEpochMs - pCheckpoint->savedEpochMs ) <= ( uint64_t ) TRIP_CHECKPOINT_MAX_GAP_MS ) )
+    {
+        if( pCheckpoint->ended == false )
+        {
+            resume = TRIP_RESUME_CHECKPOINT;
+        }
+        else if( ( pOdometerTripId != NULL ) && ( strcmp( pOdometerTripId, pCheckpoint->tripId ) != 0 ) )
+        {
+            /* Started after the checkpoint, so it is not older than the gap either. */
+            resume = TRIP_RESUME_ODOMETER;
+        }
+        else
+        {
+            /* Empty Else MISRA 15.7 */
+        }
+    }
+
+    return resume;
+}
+
+/*-----------------------------------------------------------*/
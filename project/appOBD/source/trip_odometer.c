@@ -0,0 +1,259 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file trip_odometer.c
+ * @brief Implementation of the trip odometer.
+ *
+ * The distance is the sum of the segments between good GPS fixes. Each
+ * segment is cross-checked against the OBD speed integrated over the same
+ * interval, the speed distance is used when the GPS segment disagrees too
+ * much or when there is no usable fix.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "esp_attr.h"
+
+#include "gps_geo.h"
+
+#include "../include/trip_odometer.h"
+#include "../include/obd_config.h"
+
+/*-----------------------------------------------------------*/
+
+#define TRIP_ODOMETER_STORE_MAGIC       ( 0x4F444F31UL )  /* "ODO1" */
+#define TRIP_ODOMETER_TRIP_ID_MAX       ( 16 )
+#define TRIP_ODOMETER_MAX_SPEED_GAP_MS  ( 10000U )
+
+/* Fix noise is about 5 metre at HDOP 1.0, hdop is in 0.1 unit. */
+#define TRIP_ODOMETER_MM_PER_HDOP       ( 500U )
+
+typedef struct TripOdometerStore
+{
+    uint32_t magic;
+    char tripId[ TRIP_ODOMETER_TRIP_ID_MAX ];
+    uint64_t distanceMm;
+    uint32_t checksum;
+} TripOdometerStore_t;
+
+/*-----------------------------------------------------------*/
+
+/* Not cleared by the startup code, survives everything but a power loss. */
+static RTC_NOINIT_ATTR TripOdometerStore_t odometerStore;
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvStoreChecksum( const TripOdometerStore_t * pStore )
+{
+    const uint8_t * pData = ( const uint8_t * ) pStore;
+    uint32_t checksum = 0x811C9DC5UL;
+    size_t i = 0;
+
+    /* FNV-1a over everything but the checksum. */
+    for( i = 0; i < offsetof( TripOdometerStore_t, checksum ); i++ )
+    {
+        checksum = ( checksum ^ pData[ i ] ) * 0x01000193UL;
+    }
+
+    return checksum;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSave( const TripOdometer_t * pOdometer )
+{
+    /* Between trips the store holds the trip to resume, or nothing. */
+    if( pOdometer->active == false )
+    {
+        return;
+    }
+
+    odometerStore.distanceMm = TripOdometer_GetDistanceMm( pOdometer );
+    odometerStore.checksum = prvStoreChecksum( &odometerStore );
+}
+
+/*-----------------------------------------------------------*/
+
+void TripOdometer_Init( TripOdometer_t * pOdometer )
+{
+    if( pOdometer != NULL )
+    {
+        memset( pOdometer, 0, sizeof( TripOdometer_t ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void TripOdometer_Start( TripOdometer_t * pOdometer,
+                         const char * pTripId )
+{
+    TripOdometer_Continue( pOdometer, pTripId, 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+void TripOdometer_Continue( TripOdometer_t * pOdometer,
+                            const char * pTripId,
+                            uint64_t distanceMm )
+{
+    TripOdometer_Init( pOdometer );
+    pOdometer->distanceMm = distanceMm;
+    pOdometer->active = true;
+
+    memset( &odometerStore, 0, sizeof( TripOdometerStore_t ) );
+    odometerStore.magic = TRIP_ODOMETER_STORE_MAGIC;
+    strncpy( odometerStore.tripId, pTripId, TRIP_ODOMETER_TRIP_ID_MAX - 1 );
+    prvSave( pOdometer );
+}
+
+/*-----------------------------------------------------------*/
+
+bool TripOdometer_Resume( TripOdometer_t * pOdometer,
+                          char * pTripId,
+                          size_t tripIdSize )
+{
+    bool retResume = false;
+
+    TripOdometer_Init( pOdometer );
+
+    if( ( odometerStore.magic == TRIP_ODOMETER_STORE_MAGIC ) &&
+        ( odometerStore.checksum == prvStoreChecksum( &odometerStore ) ) &&
+        ( odometerStore.tripId[ TRIP_ODOMETER_TRIP_ID_MAX - 1 ] == '\0' ) &&
+        ( strlen( odometerStore.tripId ) < tripIdSize ) )
+    {
+        pOdometer->distanceMm = odometerStore.distanceMm;
+        pOdometer->active = true;
+        strcpy( pTripId, odometerStore.tripId );
+        retResume = true;
+    }
+
+    return retResume;
+}
+
+/*-----------------------------------------------------------*/
+
+void TripOdometer_Stop( TripOdometer_t * pOdometer )
+{
+    pOdometer->active = false;
+    memset( &odometerStore, 0, sizeof( TripOdometerStore_t ) );
+}
+
+/*-----------------------------------------------------------*/
+
+void TripOdometer_AddFix( TripOdometer_t * pOdometer,
+                          int32_t latitude,
+                          int32_t longitude,
+                          uint8_t hdop )
+{
+    uint32_t gpsMm = 0;
+    uint32_t speedMm = 0;
+    uint32_t segmentMm = 0;
+    uint32_t noiseMm = ( uint32_t ) hdop * TRIP_ODOMETER_MM_PER_HDOP;
+
+    if( ( pOdometer->active == false ) || ( hdop == 0 ) || ( hdop > TRIP_ODOMETER_MAX_HDOP ) )
+    {
+        return;
+    }
+
+    if( pOdometer->hasAnchor == false )
+    {
+        /* First fix of the trip, count what was driven before it. */
+        segmentMm = pOdometer->pendingSpeedMm;
+    }
+    else
+    {
+        gpsMm = GPSGeo_DistanceMm( pOdometer->anchorLatitude, pOdometer->anchorLongitude, latitude, longitude );
+        speedMm = pOdometer->pendingSpeedMm;
+
+        if( ( gpsMm < noiseMm ) && ( speedMm < noiseMm ) )
+        {
+            /* Still within the fix noise, keep the anchor. */
+            return;
+        }
+
+        segmentMm = gpsMm;
+
+        if( pOdometer->hasSpeed == true )
+        {
+            /* A GPS jump or a cut corner shows as a large disagreement. */
+            if( ( gpsMm > ( speedMm + ( speedMm / 100U * TRIP_ODOMETER_SPEED_TOLERANCE_PERCENT ) + TRIP_ODOMETER_SPEED_MARGIN_MM ) ) ||
+                ( speedMm > ( gpsMm + ( gpsMm / 100U * TRIP_ODOMETER_SPEED_TOLERANCE_PERCENT ) + TRIP_ODOMETER_SPEED_MARGIN_MM ) ) )
+            {
+                segmentMm = speedMm;
+            }
+        }
+    }
+
+    pOdometer->distanceMm = pOdometer->distanceMm + segmentMm;
+    pOdometer->pendingSpeedMm = 0;
+    pOdometer->anchorLatitude = latitude;
+    pOdometer->anchorLongitude = longitude;
+    pOdometer->hasAnchor = true;
+    prvSave( pOdometer );
+}
+
+/*-----------------------------------------------------------*/
+
+void TripOdometer_AddSpeed( TripOdometer_t * pOdometer,
+                            float speedKph,
+                            uint32_t nowMs )
+{
+    float speedMps = speedKph / 3.6f;
+    uint32_t elapsedMs = 0;
+
+    if( pOdometer->active == false )
+    {
+        return;
+    }
+
+    if( speedMps < 0.0f )
+    {
+        speedMps = 0.0f;
+    }
+
+    if( pOdometer->hasSpeed == true )
+    {
+        elapsedMs = nowMs - pOdometer->lastSpeedMs;
+
+        if( elapsedMs > TRIP_ODOMETER_MAX_SPEED_GAP_MS )
+        {
+            elapsedMs = TRIP_ODOMETER_MAX_SPEED_GAP_MS;
+        }
+
+        /* Trapezoid, metre per second times milisecond is millimetre. */
+        pOdometer->pendingSpeedMm = pOdometer->pendingSpeedMm +
+                                    ( uint32_t ) ( ( pOdometer->lastSpeedMps + speedMps ) * 0.5f * ( float ) elapsedMs );
+    }
+
+    pOdometer->lastSpeedMs = nowMs;
+    pOdometer->lastSpeedMps = speedMps;
+    pOdometer->hasSpeed = true;
+    prvSave( pOdometer );
+}
+
+/*-----------------------------------------------------------*/
+
+uint64_t TripOdometer_GetDistanceMm( const TripOdometer_t * pOdometer )
+{
+    return pOdometer->distanceMm + pOdometer->pendingSpeedMm;
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,284 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file trip_path.c
+ * @brief Implementation of the streaming trajectory simplifier.
+ *
+ * This is the opening window variant of Douglas-Peucker. The positions after
+ * the last kept point stay in a small window, every new position is checked
+ * as the end of a line from the last kept point. When a position in the
+ * window deviates more than the tolerance, the previous position is kept.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "gps_geo.h"
+
+#include "../include/trip_path.h"
+
+/*-----------------------------------------------------------*/
+
+#define TRIP_PATH_METRES_PER_MICRODEGREE    ( 0.11131949f )
+
+/*-----------------------------------------------------------*/
+
+/* Squared distance of p to the segment a-b in square metre. */
+static float prvDeviationSquared( const TripPathPoint_t * pA,
+                                  const TripPathPoint_t * pB,
+                                  const TripPathPoint_t * pP )
+{
+    float scaleLongitude = TRIP_PATH_METRES_PER_MICRODEGREE * ( float ) GPSGeo_CosQ15( pA->latitude ) / 32768.0f;
+    float bx = ( float ) ( pB->longitude - pA->longitude ) * scaleLongitude;
+    float by = ( float ) ( pB->latitude - pA->latitude ) * TRIP_PATH_METRES_PER_MICRODEGREE;
+    float px = ( float ) ( pP->longitude - pA->longitude ) * scaleLongitude;
+    float py = ( float ) ( pP->latitude - pA->latitude ) * TRIP_PATH_METRES_PER_MICRODEGREE;
+    float lengthSquared = ( bx * bx ) + ( by * by );
+    float t = 0.0f;
+
+    if( lengthSquared > 0.0f )
+    {
+        t = ( ( px * bx ) + ( py * by ) ) / lengthSquared;
+
+        if( t < 0.0f )
+        {
+            t = 0.0f;
+        }
+        else if( t > 1.0f )
+        {
+            t = 1.0f;
+        }
+        else
+        {
+            /* Empty Else MISRA 15.7 */
+        }
+    }
+
+    px = px - ( t * bx );
+    py = py - ( t * by );
+
+    return ( px * px ) + ( py * py );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvKeepPoint( TripPath_t * pPath,
+                          const TripPathPoint_t * pPoint )
+{
+    if( pPath->count >= TRIP_PATH_MAX_POINTS )
+    {
+        ( void ) TripPath_Compact( pPath );
+    }
+
+    pPath->points[ pPath->count ] = *pPoint;
+    pPath->count = pPath->count + 1U;
+}
+
+/*-----------------------------------------------------------*/
+
+void TripPath_Init( TripPath_t * pPath )
+{
+    if( pPath != NULL )
+    {
+        memset( pPath, 0, sizeof( TripPath_t ) );
+        pPath->toleranceM = TRIP_PATH_TOLERANCE_M;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void TripPath_AddPoint( TripPath_t * pPath,
+                        int32_t latitude,
+                        int32_t longitude )
+{
+    TripPathPoint_t point = { .latitude = latitude, .longitude = longitude };
+    const TripPathPoint_t * pAnchor = NULL;
+    const TripPathPoint_t * pLast = NULL;
+    float toleranceSquared = pPath->toleranceM * pPath->toleranceM;
+    bool keepLast = false;
+    uint16_t i = 0;
+
+    if( pPath->count == 0U )
+    {
+        prvKeepPoint( pPath, &point );
+        return;
+    }
+
+    pAnchor = &pPath->points[ pPath->count - 1U ];
+    pLast = ( pPath->windowCount > 0U ) ? &pPath->window[ pPath->windowCount - 1U ] : pAnchor;
+
+    /* Parked or no new fix. */
+    if( ( pLast->latitude == latitude ) && ( pLast->longitude == longitude ) )
+    {
+        return;
+    }
+
+    if( pPath->windowCount >= TRIP_PATH_WINDOW_MAX )
+    {
+        keepLast = true;
+    }
+    else
+    {
+        for( i = 0; i < pPath->windowCount; i++ )
+        {
+            if( prvDeviationSquared( pAnchor, &point, &pPath->window[ i ] ) > toleranceSquared )
+            {
+                keepLast = true;
+                break;
+            }
+        }
+    }
+
+    if( keepLast == true )
+    {
+        prvKeepPoint( pPath, pLast );
+        pPath->windowCount = 0;
+    }
+
+    pPath->window[ pPath->windowCount ] = point;
+    pPath->windowCount = pPath->windowCount + 1U;
+}
+
+/*-----------------------------------------------------------*/
+
+void TripPath_Finish( TripPath_t * pPath )
+{
+    if( pPath->windowCount > 0U )
+    {
+        prvKeepPoint( pPath, &pPath->window[ pPath->windowCount - 1U ] );
+        pPath->windowCount = 0;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+bool TripPath_Compact( TripPath_t * pPath )
+{
+    uint16_t previousCount = pPath->count;
+    uint16_t kept = 1;
+    uint16_t i = 0;
+    float toleranceSquared = 0.0f;
+
+    if( pPath->count < 3U )
+    {
+        return false;
+    }
+
+    pPath->toleranceM = pPath->toleranceM * 2.0f;
+    toleranceSquared = pPath->toleranceM * pPath->toleranceM;
+
+    /* Drop a point when the line between its neighbours represents it. */
+    for( i = 1; i < ( pPath->count - 1U ); i++ )
+    {
+        if( prvDeviationSquared( &pPath->points[ kept - 1U ], &pPath->points[ i + 1U ], &pPath->points[ i ] ) > toleranceSquared )
+        {
+            pPath->points[ kept ] = pPath->points[ i ];
+            kept = kept + 1U;
+        }
+    }
+
+    /* Every point is significant, fall back to drop every other one. */
+    if( ( kept + 1U ) == previousCount )
+    {
+        kept = 1;
+
+        for( i = 2; i < ( previousCount - 1U ); i = i + 2U )
+        {
+            pPath->points[ kept ] = pPath->points[ i ];
+            kept = kept + 1U;
+        }
+    }
+
+    pPath->points[ kept ] = pPath->points[ previousCount - 1U ];
+    pPath->count = kept + 1U;
+
+    return ( pPath->count < previousCount ) ? true : false;
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t TripPath_Encode( const TripPath_t * pPath,
+                         char * pBuffer,
+                         size_t bufferSize,
+                         bool jsonEscape )
+{
+    int32_t previous[ 2 ] = { 0, 0 };
+    int32_t value[ 2 ] = { 0, 0 };
+    uint32_t encoded = 0;
+    size_t length = 0;
+    uint16_t i = 0;
+    uint8_t axis = 0;
+    char chunk = 0;
+
+    if( bufferSize == 0U )
+    {
+        return -1;
+    }
+
+    for( i = 0; i < pPath->count; i++ )
+    {
+        /* Microdegree to 1e-5 degree, rounded half away from zero. */
+        value[ 0 ] = ( pPath->points[ i ].latitude + ( ( pPath->points[ i ].latitude >= 0 ) ? 5 : -5 ) ) / 10;
+        value[ 1 ] = ( pPath->points[ i ].longitude + ( ( pPath->points[ i ].longitude >= 0 ) ? 5 : -5 ) ) / 10;
+
+        for( axis = 0; axis < 2U; axis++ )
+        {
+            int32_t delta = value[ axis ] - previous[ axis ];
+
+            previous[ axis ] = value[ axis ];
+            encoded = ( delta < 0 ) ? ~( ( uint32_t ) delta << 1 ) : ( ( uint32_t ) delta << 1 );
+
+            do
+            {
+                chunk = ( char ) ( encoded & 0x1FU );
+                encoded >>= 5;
+
+                if( encoded != 0U )
+                {
+                    chunk = ( char ) ( chunk | 0x20 );
+                }
+
+                chunk = ( char ) ( chunk + 63 );
+
+                /* Room for the escape and the terminator. */
+                if( ( length + 2U ) >= bufferSize )
+                {
+                    pBuffer[ 0 ] = '\0';
+                    return -1;
+                }
+
+                if( ( jsonEscape == true ) && ( chunk == '\\' ) )
+                {
+                    pBuffer[ length ] = '\\';
+                    length = length + 1U;
+                }
+
+                pBuffer[ length ] = chunk;
+                length = length + 1U;
+            } while( encoded != 0U );
+        }
+    }
+
+    pBuffer[ length ] = '\0';
+
+    return ( int32_t ) length;
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,581 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file trip_replay.c
+ * @brief Implementation of the trip replay.
+ *
+ * The log is read ahead by one record. Each access to the device first takes
+ * the records up to the time of the log into a table of the latest response
+ * per command, so the GPS task and the telemetry task see the same state.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "sdkconfig.h"
+#include "esp_timer.h"
+
+#ifndef CONFIG_FILE_SYSTEM_ENABLE
+    #include "esp_vfs_semihost.h"
+#endif
+
+#include "FreeRTOS_IO.h"
+#include "FreeRTOS_DriverInterface.h"
+#include "obd_device.h"
+
+#include "../include/trip_replay.h"
+#include "../include/publish_service.h"
+#include "../include/obd_config.h"
+
+// log print header
+#include "cms_log.h"
+
+#if ( TRIP_REPLAY_ENABLE == 1 )
+
+/*-----------------------------------------------------------*/
+
+#define xTaskGetTickCountMs()               ( uint32_t ) ( xTaskGetTickCount() * portTICK_PERIOD_MS )
+
+#ifdef CONFIG_FILE_SYSTEM_ENABLE
+    #define TRIP_REPLAY_PATH                CONFIG_FS_MOUNT_POINT "/replay.log"
+#else
+    #define TRIP_REPLAY_HOST_DIR            "/host"
+    #define TRIP_REPLAY_PATH                TRIP_REPLAY_HOST_DIR "/replay.log"
+#endif
+
+#define TRIP_REPLAY_COMMAND_MAX             ( 16U )
+#define TRIP_REPLAY_RESPONSE_MAX            ( 512U )                            /* A read of NMEA sentences. */
+#define TRIP_REPLAY_LINE_MAX                ( TRIP_REPLAY_RESPONSE_MAX * 2U )   /* Room for time, command and escapes. */
+#define TRIP_REPLAY_PROMPT                  "\r>"
+
+typedef struct TripReplayResponse
+{
+    char command[ TRIP_REPLAY_COMMAND_MAX ];
+    char response[ TRIP_REPLAY_RESPONSE_MAX ];
+} TripReplayResponse_t;
+
+typedef struct TripReplayRecord
+{
+    uint32_t timeMs;
+    TripReplayResponse_t answer;
+} TripReplayRecord_t;
+
+typedef struct TripReplayStageTime
+{
+    uint32_t runs;
+    uint32_t maxUs;
+    uint64_t totalUs;
+} TripReplayStageTime_t;
+
+typedef struct TripReplayContext
+{
+    FILE * pFile;
+    SemaphoreHandle_t linkMutex;
+    uint32_t speed;
+    uint32_t startMs;                   /* Replay clock at the open. */
+    uint64_t startUs;
+    uint32_t skippedMs;                 /* Written by the telemetry task only. */
+    uint32_t logStartMs;                /* Time of the first record. */
+    uint32_t logReachedMs;              /* Time of the last record taken. */
+    char command[ TRIP_REPLAY_COMMAND_MAX ];    /* Last written. */
+    char line[ TRIP_REPLAY_LINE_MAX ];
+    bool skipLine;                      /* In a line longer than the buffer. */
+    TripReplayRecord_t next;
+    bool nextValid;
+    TripReplayResponse_t responses[ TRIP_REPLAY_MAX_COMMANDS ];
+    uint32_t responseCount;
+    uint32_t records;
+    uint32_t malformed;
+    uint32_t ignored;                   /* Records of commands beyond TRIP_REPLAY_MAX_COMMANDS. */
+    uint32_t requests;
+    TripReplayStageTime_t stages[ TRIP_REPLAY_STAGE_MAX ];
+} TripReplayContext_t;
+
+/*-----------------------------------------------------------*/
+
+static size_t prvReplayWrite( Peripheral_Descriptor_t const pxPeripheral,
+                              const void * pvBuffer,
+                              const size_t xBytes );
+
+static size_t prvReplayRead( Peripheral_Descriptor_t const pxPeripheral,
+                             void * const pvBuffer,
+                             const size_t xBytes );
+
+static BaseType_t prvReplayIoctl( Peripheral_Descriptor_t const pxPeripheral,
+                                  uint32_t ulRequest,
+                                  void * pvValue );
+
+/*-----------------------------------------------------------*/
+
+static const char *TAG = "tripReplay";
+
+static const char * const replayStageNames[ TRIP_REPLAY_STAGE_MAX ] =
+{
+    "acquire",
+    "gps",
+    "aggregate",
+    "encode",
+    "step"
+};
+
+static TripReplayContext_t replayContext;
+
+static Peripheral_device_t replayDevice =
+{
+    "/dev/replay",
+    NULL,
+    prvReplayWrite,
+    prvReplayRead,
+    prvReplayIoctl,
+    &replayContext
+};
+
+/*-----------------------------------------------------------*/
+
+static bool prvUnescape( const char * pIn,
+                         char * pOut,
+                         size_t outSize )
+{
+    size_t length = 0;
+    char c = '\0';
+    bool retUnescape = true;
+
+    while( ( *pIn != '\0' ) && ( *pIn != '\r' ) && ( *pIn != '\n' ) )
+    {
+        c = *pIn;
+
+        if( ( c == '\\' ) && ( pIn[ 1 ] != '\0' ) )
+        {
+            pIn++;
+            c = ( *pIn == 'r' ) ? '\r' : ( ( *pIn == 'n' ) ? '\n' : *pIn );
+        }
+
+        if( ( length + 1U ) >= outSize )
+        {
+            retUnescape = false;
+            break;
+        }
+
+        pOut[ length ] = c;
+        length++;
+        pIn++;
+    }
+
+    pOut[ length ] = '\0';
+
+    return retUnescape;
+}
+
+/*-----------------------------------------------------------*/
+
+/* "<milliseconds> <command> <response>", the response may be empty. */
+static bool prvParseRecord( const char * pLine,
+                            TripReplayRecord_t * pRecord )
+{
+    char * pEnd = NULL;
+    const char * pCommand = NULL;
+    size_t commandLength = 0;
+    unsigned long timeMs = strtoul( pLine, &pEnd, 10 );
+    bool retParse = false;
+
+    if( ( pEnd != pLine ) && ( *pEnd == ' ' ) )
+    {
+        pCommand = pEnd + 1;
+        commandLength = strcspn( pCommand, " \r\n" );
+
+        if( ( commandLength > 0U ) && ( commandLength < TRIP_REPLAY_COMMAND_MAX ) )
+        {
+            pRecord->timeMs = ( uint32_t ) timeMs;
+            memcpy( pRecord->answer.command, pCommand, commandLength );
+            pRecord->answer.command[ commandLength ] = '\0';
+
+            pEnd = ( char * ) &pCommand[ commandLength ];
+
+            if( *pEnd == ' ' )
+            {
+                pEnd++;
+            }
+
+            retParse = prvUnescape( pEnd, pRecord->answer.response, TRIP_REPLAY_RESPONSE_MAX );
+        }
+    }
+
+    return retParse;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool prvReadRecord( TripReplayRecord_t * pRecord )
+{
+    char * pLine = replayContext.line;
+    bool continued = false;
+    bool retRead = false;
+
+    while( ( retRead == false ) && ( fgets( pLine, TRIP_REPLAY_LINE_MAX, replayContext.pFile ) != NULL ) )
+    {
+        /* A line longer than the buffer is dropped up to its end. */
+        continued = replayContext.skipLine;
+        replayContext.skipLine = ( strchr( pLine, '\n' ) == NULL ) && ( feof( replayContext.pFile ) == 0 );
+
+        if( ( continued == false ) && ( replayContext.skipLine == false ) &&
+            ( pLine[ 0 ] != '#' ) && ( pLine[ 0 ] != '\r' ) && ( pLine[ 0 ] != '\n' ) )
+        {
+            retRead = prvParseRecord( pLine, pRecord );
+
+            if( retRead == false )
+            {
+                replayContext.malformed++;
+            }
+        }
+        else if( ( continued == false ) && ( replayContext.skipLine == true ) )
+        {
+            replayContext.malformed++;
+        }
+        else
+        {
+            /* Empty Else MISRA 15.7 */
+        }
+    }
+
+    return retRead;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvStoreResponse( const TripReplayResponse_t * pAnswer )
+{
+    uint32_t i = 0;
+
+    for( i = 0; i < replayContext.responseCount; i++ )
+    {
+        if( strcmp( replayContext.responses[ i ].command, pAnswer->command ) == 0 )
+        {
+            break;
+        }
+    }
+
+    if( i < TRIP_REPLAY_MAX_COMMANDS )
+    {
+        memcpy( &replayContext.responses[ i ], pAnswer, sizeof( TripReplayResponse_t ) );
+
+        if( i == replayContext.responseCount )
+        {
+            replayContext.responseCount++;
+        }
+    }
+    else
+    {
+        replayContext.ignored++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Takes the records up to the time of the log. */
+static void prvAdvance( void )
+{
+    uint32_t logTimeMs = replayContext.logStartMs + ( TripReplay_NowMs() - replayContext.startMs );
+
+    while( ( replayContext.nextValid == true ) && ( replayContext.next.timeMs <= logTimeMs ) )
+    {
+        prvStoreResponse( &replayContext.next.answer );
+        replayContext.logReachedMs = replayContext.next.timeMs;
+        replayContext.records++;
+        replayContext.nextValid = prvReadRecord( &replayContext.next );
+
+        if( replayContext.nextValid == false )
+        {
+            CMS_LOGI( TAG, "End of the replay log at %u ms, the last responses hold.",
+                      ( unsigned int ) replayContext.logReachedMs );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t prvReplayWrite( Peripheral_Descriptor_t const pxPeripheral,
+                              const void * pvBuffer,
+                              const size_t xBytes )
+{
+    const char * pCommand = ( const char * ) pvBuffer;
+    size_t length = 0;
+
+    ( void ) pxPeripheral;
+
+    while( ( length < xBytes ) && ( length < ( TRIP_REPLAY_COMMAND_MAX - 1U ) ) &&
+           ( pCommand[ length ] != '\r' ) && ( pCommand[ length ] != '\n' ) )
+    {
+        length++;
+    }
+
+    memcpy( replayContext.command, pCommand, length );
+    replayContext.command[ length ] = '\0';
+
+    return xBytes;
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t prvReplayRead( Peripheral_Descriptor_t const pxPeripheral,
+                             void * const pvBuffer,
+                             const size_t xBytes )
+{
+    const char * pResponse = NULL;
+    size_t retSize = 0;
+    uint32_t i = 0;
+
+    ( void ) pxPeripheral;
+
+    prvAdvance();
+    replayContext.requests++;
+
+    for( i = 0; i < replayContext.responseCount; i++ )
+    {
+        if( strcmp( replayContext.responses[ i ].command, replayContext.command ) == 0 )
+        {
+            pResponse = replayContext.responses[ i ].response;
+            break;
+        }
+    }
+
+    /* Settings of the adapter are not recorded. */
+    if( pResponse == NULL )
+    {
+        pResponse = ( strncmp( replayContext.command, "AT", 2 ) == 0 ) ? "OK" : "NO DATA";
+    }
+
+    if( xBytes > 0U )
+    {
+        ( void ) snprintf( ( char * ) pvBuffer, xBytes, "%s" TRIP_REPLAY_PROMPT, pResponse );
+        retSize = strlen( ( const char * ) pvBuffer );
+    }
+
+    return retSize;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvReplayIoctl( Peripheral_Descriptor_t const pxPeripheral,
+                                  uint32_t ulRequest,
+                                  void * pvValue )
+{
+    BaseType_t retValue = pdPASS;
+
+    ( void ) pxPeripheral;
+    ( void ) pvValue;
+
+    switch( ulRequest )
+    {
+        case ioctlOBD_READ_TIMEOUT:
+        case ioctlOBD_RESET:
+            /* The responses are there at once. */
+            break;
+
+        case ioctlOBD_LOCK:
+            if( xSemaphoreTake( replayContext.linkMutex, portMAX_DELAY ) != pdTRUE )
+            {
+                retValue = pdFAIL;
+            }
+            break;
+
+        case ioctlOBD_UNLOCK:
+            ( void ) xSemaphoreGive( replayContext.linkMutex );
+            break;
+
+        default:
+            /* The clock follows the GPS of the log, there is no NTP time. */
+            retValue = pdFAIL;
+            break;
+    }
+
+    return retValue;
+}
+
+/*-----------------------------------------------------------*/
+
+Peripheral_Descriptor_t TripReplay_Open( uint32_t speed )
+{
+    Peripheral_Descriptor_t retDevice = NULL;
+
+    #ifndef CONFIG_FILE_SYSTEM_ENABLE
+        /* Files of the host running OpenOCD. */
+        if( esp_vfs_semihost_register( TRIP_REPLAY_HOST_DIR, NULL ) != ESP_OK )
+        {
+            CMS_LOGE( TAG, "Failed to register semihosting on %s.", TRIP_REPLAY_HOST_DIR );
+        }
+    #endif
+
+    memset( &replayContext, 0, sizeof( TripReplayContext_t ) );
+    replayContext.pFile = fopen( TRIP_REPLAY_PATH, "r" );
+
+    if( replayContext.pFile == NULL )
+    {
+        CMS_LOGE( TAG, "Failed to open replay log %s.", TRIP_REPLAY_PATH );
+    }
+    else
+    {
+        replayContext.linkMutex = xSemaphoreCreateMutex();
+
+        if( replayContext.linkMutex == NULL )
+        {
+            CMS_LOGE( TAG, "Failed to create replay link mutex." );
+            ( void ) fclose( replayContext.pFile );
+            replayContext.pFile = NULL;
+        }
+        else
+        {
+            replayContext.speed = speed;
+            replayContext.nextValid = prvReadRecord( &replayContext.next );
+            replayContext.logStartMs = replayContext.next.timeMs;
+            replayContext.logReachedMs = replayContext.logStartMs;
+            replayContext.startMs = TripReplay_NowMs();
+            replayContext.startUs = TripReplay_GetTimeUs();
+
+            /* The responses of the first time are there for the adapter init. */
+            prvAdvance();
+
+            CMS_LOGI( TAG, "Replay %s at speed %u.", TRIP_REPLAY_PATH, ( unsigned int ) speed );
+            retDevice = ( Peripheral_Descriptor_t ) &replayDevice;
+        }
+    }
+
+    return retDevice;
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t TripReplay_NowMs( void )
+{
+    return xTaskGetTickCountMs() + __atomic_load_n( &replayContext.skippedMs, __ATOMIC_RELAXED );
+}
+
+/*-----------------------------------------------------------*/
+
+void TripReplay_WaitMs( uint32_t waitMs )
+{
+    uint32_t realMs = waitMs;
+    uint32_t startMs = xTaskGetTickCountMs();
+    uint32_t waitedMs = 0;
+
+    if( replayContext.speed == 0U )
+    {
+        /* A tick lets the publisher and the GPS task run. */
+        realMs = ( waitMs < TRIP_REPLAY_FAST_WAIT_MS ) ? waitMs : TRIP_REPLAY_FAST_WAIT_MS;
+    }
+    else
+    {
+        realMs = waitMs / replayContext.speed;
+    }
+
+    vTaskDelay( pdMS_TO_TICKS( realMs ) );
+
+    /* The clock moves on by the whole wait, whatever the ticks rounded to. */
+    waitedMs = xTaskGetTickCountMs() - startMs;
+
+    if( waitMs > waitedMs )
+    {
+        __atomic_store_n( &replayContext.skippedMs, replayContext.skippedMs + ( waitMs - waitedMs ), __ATOMIC_RELAXED );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+uint64_t TripReplay_GetTimeUs( void )
+{
+    return ( uint64_t ) esp_timer_get_time();
+}
+
+/*-----------------------------------------------------------*/
+
+void TripReplay_AddStageTime( TripReplayStage_t stage,
+                              uint64_t startUs )
+{
+    TripReplayStageTime_t * pStage = &replayContext.stages[ stage ];
+    uint64_t elapsedUs = TripReplay_GetTimeUs() - startUs;
+
+    pStage->runs++;
+    pStage->totalUs += elapsedUs;
+
+    if( elapsedUs > pStage->maxUs )
+    {
+        pStage->maxUs = ( elapsedUs <= UINT32_MAX ) ? ( uint32_t ) elapsedUs : UINT32_MAX;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void TripReplay_Report( void )
+{
+    const TripReplayStageTime_t * pStage = NULL;
+    PublishServiceStats_t publishStats = { 0 };
+    uint64_t wallMs = ( TripReplay_GetTimeUs() - replayContext.startUs ) / 1000U;
+    uint64_t logMs = replayContext.logReachedMs - replayContext.logStartMs;
+    uint64_t speedPercent = 0;
+    uint32_t i = 0;
+
+    if( wallMs == 0U )
+    {
+        wallMs = 1U;
+    }
+
+    speedPercent = ( logMs * 100U ) / wallMs;
+
+    /* The publisher started with the replay, its counters cover the same time. */
+    PublishService_GetStats( &publishStats );
+
+    CMS_LOGI( TAG, "Replayed %u ms of log in %u ms, %u.%02u times real time.",
+              ( unsigned int ) logMs, ( unsigned int ) wallMs,
+              ( unsigned int ) ( speedPercent / 100U ), ( unsigned int ) ( speedPercent % 100U ) );
+    CMS_LOGI( TAG, "%u records, %u per second, %u requests, %u malformed lines, %u records ignored.",
+              ( unsigned int ) replayContext.records,
+              ( unsigned int ) ( ( ( uint64_t ) replayContext.records * 1000U ) / wallMs ),
+              ( unsigned int ) replayContext.requests,
+              ( unsigned int ) replayContext.malformed,
+              ( unsigned int ) replayContext.ignored );
+    CMS_LOGI( TAG, "%u messages queued, %u per minute, %u published, %u stored, %u dropped, at most %u waiting.",
+              ( unsigned int ) publishStats.queued,
+              ( unsigned int ) ( ( ( uint64_t ) publishStats.queued * 60000U ) / wallMs ),
+              ( unsigned int ) publishStats.published,
+              ( unsigned int ) publishStats.stored,
+              ( unsigned int ) publishStats.dropped,
+              ( unsigned int ) publishStats.highWater );
+
+    for( i = 0; i < TRIP_REPLAY_STAGE_MAX; i++ )
+    {
+        pStage = &replayContext.stages[ i ];
+
+        CMS_LOGI( TAG, "Stage %s: %u runs, %u us mean, %u us max, %u ms total.",
+                  replayStageNames[ i ],
+                  ( unsigned int ) pStage->runs,
+                  ( unsigned int ) ( ( pStage->runs > 0U ) ? ( pStage->totalUs / pStage->runs ) : 0U ),
+                  ( unsigned int ) pStage->maxUs,
+                  ( unsigned int ) ( pStage->totalUs / 1000U ) );
+    }
+}
+
+#endif /* if ( TRIP_REPLAY_ENABLE == 1 ) */
+
+/*-----------------------------------------------------------*/
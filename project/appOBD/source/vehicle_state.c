@@ -0,0 +1,170 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file vehicle_state.c
+ * @brief Implementation of the vehicle state machine.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../include/vehicle_state.h"
+#include "../include/obd_config.h"
+
+/*-----------------------------------------------------------*/
+
+typedef struct VehicleStateRate
+{
+    const char * pName;
+    uint32_t intervalPercent;   /* Of the configured intervals. */
+    bool gpsActive;
+} VehicleStateRate_t;
+
+/*-----------------------------------------------------------*/
+
+static const VehicleStateRate_t vehicleStateRates[ VEHICLE_STATE_MAX ] =
+{
+    [ VEHICLE_STATE_OFF ]     = { "off",     VEHICLE_STATE_OFF_PERCENT,     false },
+    [ VEHICLE_STATE_IDLE ]    = { "idle",    VEHICLE_STATE_IDLE_PERCENT,    false },
+    [ VEHICLE_STATE_CITY ]    = { "city",    100U,                          true },
+    [ VEHICLE_STATE_HIGHWAY ] = { "highway", VEHICLE_STATE_HIGHWAY_PERCENT, true },
+    [ VEHICLE_STATE_EVENT ]   = { "event",   VEHICLE_STATE_EVENT_PERCENT,   true }
+};
+
+/*-----------------------------------------------------------*/
+
+static uint32_t scaleInterval( uint32_t intervalMs,
+                               uint32_t percent )
+{
+    uint32_t scaledMs = ( uint32_t ) ( ( ( uint64_t ) intervalMs * percent ) / 100U );
+
+    return ( scaledMs < VEHICLE_STATE_MIN_INTERVAL_MS ) ? VEHICLE_STATE_MIN_INTERVAL_MS : scaledMs;
+}
+
+/*-----------------------------------------------------------*/
+
+static VehicleState_t classify( VehicleState_t current,
+                                bool running,
+                                double speed,
+                                bool eventActive )
+{
+    VehicleState_t state = VEHICLE_STATE_CITY;
+
+    if( running == false )
+    {
+        state = VEHICLE_STATE_OFF;
+    }
+    else if( eventActive == true )
+    {
+        state = VEHICLE_STATE_EVENT;
+    }
+    else if( speed <= CAR_IDLE_SPEED_THRESHOLD )
+    {
+        state = VEHICLE_STATE_IDLE;
+    }
+    else if( ( speed >= VEHICLE_STATE_HIGHWAY_SPEED ) ||
+             ( ( current == VEHICLE_STATE_HIGHWAY ) &&
+               ( speed >= ( VEHICLE_STATE_HIGHWAY_SPEED - VEHICLE_STATE_SPEED_HYSTERESIS ) ) ) )
+    {
+        state = VEHICLE_STATE_HIGHWAY;
+    }
+    else
+    {
+        /* Empty Else MISRA 15.7 */
+    }
+
+    return state;
+}
+
+/*-----------------------------------------------------------*/
+
+void VehicleState_Init( VehicleStateMachine_t * pMachine )
+{
+    pMachine->state = VEHICLE_STATE_OFF;
+    pMachine->candidate = VEHICLE_STATE_OFF;
+    pMachine->candidateSinceMs = 0;
+}
+
+/*-----------------------------------------------------------*/
+
+bool VehicleState_Update( VehicleStateMachine_t * pMachine,
+                          bool running,
+                          double speed,
+                          bool eventActive,
+                          uint64_t nowMs )
+{
+    VehicleState_t target = classify( pMachine->state, running, speed, eventActive );
+    bool changed = false;
+
+    /* Ignition off ends the trip, it does not wait for the dwell time. */
+    if( ( target > pMachine->state ) || ( target == VEHICLE_STATE_OFF ) )
+    {
+        changed = ( target != pMachine->state );
+        pMachine->state = target;
+        pMachine->candidate = target;
+    }
+    else if( target == pMachine->state )
+    {
+        pMachine->candidate = target;
+    }
+    else if( target != pMachine->candidate )
+    {
+        pMachine->candidate = target;
+        pMachine->candidateSinceMs = nowMs;
+    }
+    else if( ( nowMs - pMachine->candidateSinceMs ) >= VEHICLE_STATE_DWELL_MS )
+    {
+        pMachine->state = target;
+        changed = true;
+    }
+    else
+    {
+        /* Empty Else MISRA 15.7 */
+    }
+
+    return changed;
+}
+
+/*-----------------------------------------------------------*/
+
+void VehicleState_GetProfile( VehicleState_t state,
+                              uint32_t collectIntervalMs,
+                              uint32_t telemetryIntervalMs,
+                              VehicleStateProfile_t * pProfile )
+{
+    const VehicleStateRate_t * pRate = &vehicleStateRates[ ( state < VEHICLE_STATE_MAX ) ? state : VEHICLE_STATE_CITY ];
+
+    pProfile->collectIntervalMs = scaleInterval( collectIntervalMs, pRate->intervalPercent );
+    pProfile->telemetryIntervalMs = scaleInterval( telemetryIntervalMs, pRate->intervalPercent );
+    pProfile->gpsActive = pRate->gpsActive;
+
+    if( pProfile->telemetryIntervalMs < pProfile->collectIntervalMs )
+    {
+        pProfile->telemetryIntervalMs = pProfile->collectIntervalMs;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+const char * VehicleState_GetName( VehicleState_t state )
+{
+    return ( state < VEHICLE_STATE_MAX ) ? vehicleStateRates[ state ].pName : "unknown";
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,175 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file window_aggregate.c
+ * @brief Implementation of the window aggregates.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../include/window_aggregate.h"
+
+/*-----------------------------------------------------------*/
+
+#define WINDOW_AGGREGATE_BUCKETS    ( OBD_AGGREGATED_SLIDING_WINDOWS + 1U )
+
+/*-----------------------------------------------------------*/
+
+static void mergeSummary( WindowSummary_t * pTotal,
+                          const WindowSummary_t * pSummary )
+{
+    if( pSummary->count == 0U )
+    {
+        return;
+    }
+
+    if( pTotal->count == 0U )
+    {
+        *pTotal = *pSummary;
+    }
+    else
+    {
+        pTotal->count += pSummary->count;
+        pTotal->sum += pSummary->sum;
+        pTotal->min = ( pSummary->min < pTotal->min ) ? pSummary->min : pTotal->min;
+        pTotal->max = ( pSummary->max > pTotal->max ) ? pSummary->max : pTotal->max;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* The closed bucket before the open one by age, 1 is the newest. */
+static const WindowBucket_t * getClosedBucket( const WindowAggregate_t * pWindow,
+                                               uint32_t age )
+{
+    return &pWindow->buckets[ ( pWindow->open + WINDOW_AGGREGATE_BUCKETS - age ) % WINDOW_AGGREGATE_BUCKETS ];
+}
+
+/*-----------------------------------------------------------*/
+
+void WindowAggregate_Init( WindowAggregate_t * pWindow,
+                           uint64_t nowMs )
+{
+    memset( pWindow, 0, sizeof( WindowAggregate_t ) );
+    pWindow->buckets[ 0 ].startMs = nowMs;
+}
+
+/*-----------------------------------------------------------*/
+
+void WindowAggregate_Add( WindowAggregate_t * pWindow,
+                          uint32_t signal,
+                          double value )
+{
+    WindowSummary_t * pSummary = NULL;
+
+    if( signal >= WINDOW_AGGREGATE_MAX_SIGNALS )
+    {
+        return;
+    }
+
+    pSummary = &pWindow->buckets[ pWindow->open ].signals[ signal ];
+
+    if( pSummary->count == 0U )
+    {
+        pSummary->min = value;
+        pSummary->max = value;
+    }
+    else
+    {
+        pSummary->min = ( value < pSummary->min ) ? value : pSummary->min;
+        pSummary->max = ( value > pSummary->max ) ? value : pSummary->max;
+    }
+
+    pSummary->count++;
+    pSummary->sum += value;
+}
+
+/*-----------------------------------------------------------*/
+
+bool WindowAggregate_IsDue( const WindowAggregate_t * pWindow,
+                            uint64_t nowMs )
+{
+    return ( nowMs - pWindow->buckets[ pWindow->open ].startMs ) >= OBD_AGGREGATED_DATA_INTERVAL_MS;
+}
+
+/*-----------------------------------------------------------*/
+
+void WindowAggregate_Close( WindowAggregate_t * pWindow,
+                            uint64_t nowMs )
+{
+    pWindow->buckets[ pWindow->open ].endMs = nowMs;
+    pWindow->open = ( pWindow->open + 1U ) % WINDOW_AGGREGATE_BUCKETS;
+
+    /* The oldest closed bucket is reused. */
+    memset( &pWindow->buckets[ pWindow->open ], 0, sizeof( WindowBucket_t ) );
+    pWindow->buckets[ pWindow->open ].startMs = nowMs;
+
+    if( pWindow->closed < OBD_AGGREGATED_SLIDING_WINDOWS )
+    {
+        pWindow->closed++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+uint64_t WindowAggregate_GetTumbling( const WindowAggregate_t * pWindow,
+                                      uint32_t signal,
+                                      WindowSummary_t * pSummary )
+{
+    const WindowBucket_t * pBucket = NULL;
+
+    memset( pSummary, 0, sizeof( WindowSummary_t ) );
+
+    if( ( pWindow->closed == 0U ) || ( signal >= WINDOW_AGGREGATE_MAX_SIGNALS ) )
+    {
+        return 0;
+    }
+
+    pBucket = getClosedBucket( pWindow, 1 );
+    *pSummary = pBucket->signals[ signal ];
+
+    return pBucket->endMs - pBucket->startMs;
+}
+
+/*-----------------------------------------------------------*/
+
+uint64_t WindowAggregate_GetSliding( const WindowAggregate_t * pWindow,
+                                     uint32_t signal,
+                                     WindowSummary_t * pSummary )
+{
+    uint32_t age = 0;
+
+    memset( pSummary, 0, sizeof( WindowSummary_t ) );
+
+    if( ( pWindow->closed == 0U ) || ( signal >= WINDOW_AGGREGATE_MAX_SIGNALS ) )
+    {
+        return 0;
+    }
+
+    for( age = 1; age <= pWindow->closed; age++ )
+    {
+        mergeSummary( pSummary, &getClosedBucket( pWindow, age )->signals[ signal ] );
+    }
+
+    return getClosedBucket( pWindow, 1 )->endMs - getClosedBucket( pWindow, pWindow->closed )->startMs;
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,256 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file json_writer_bench.c
+ * @brief Host benchmark of the telemetry message with JsonWriter, the
+ * snprintf chain it replaced and cJSON.
+ *
+ * cJSON is the ESP-IDF json component, it is built in when CMake finds its
+ * sources (CJSON_DIR, by default under IDF_PATH).
+ *
+ * Usage: json_writer_bench [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "json_writer.h"
+
+#if ( BENCH_WITH_CJSON == 1 )
+    #include "cJSON.h"
+#endif
+
+#define BENCH_MESSAGE_MAX          ( 4096 )
+#define BENCH_DEFAULT_ITERATIONS   ( 200000 )
+
+typedef struct BenchSample
+{
+    const char * pVin;
+    const char * pTripId;
+    const char * pTimestamp;
+    int32_t latitudeE6;
+    int32_t longitudeE6;
+    double heading;
+    double speed;
+    double engineSpeed;
+    double acceleratorPedal;
+    double fuelLevel;
+    double fuelConsumed;
+    double odometer;
+    double oilTemp;
+    int64_t idleDurationMs;
+    int64_t highSpeedDurationMs;
+    bool ignition;
+} BenchSample_t;
+
+static const BenchSample_t benchSample =
+{
+    "1HGBH41JXMN109186", "d41d8cd98f00b204", "2026-10-18T11:03:00.125Z",
+    47123456,         -122654321,        271.35,            88.4,
+    2350.0,           23.5,              41.75,             3.482,
+    12.345678,        92.0,              754000,            1834000,
+    true
+};
+
+static volatile size_t benchSink;
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNowNs( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+
+    return ( ( uint64_t ) now.tv_sec * 1000000000ULL ) + ( uint64_t ) now.tv_nsec;
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t prvWriter( char * pBuffer,
+                         size_t bufferSize,
+                         const BenchSample_t * pSample,
+                         uint8_t options )
+{
+    JsonWriter_t writer;
+
+    JsonWriter_Init( &writer, pBuffer, bufferSize, options );
+    JsonWriter_BeginObject( &writer, NULL );
+    JsonWriter_AddString( &writer, "VIN", pSample->pVin );
+    JsonWriter_AddString( &writer, "TripId", pSample->pTripId );
+    JsonWriter_AddString( &writer, "CreationTimeStamp", pSample->pTimestamp );
+    JsonWriter_BeginObject( &writer, "GeoLocation" );
+    JsonWriter_AddFixed( &writer, "Latitude", pSample->latitudeE6, 6 );
+    JsonWriter_AddFixed( &writer, "Longitude", pSample->longitudeE6, 6 );
+    JsonWriter_AddDouble( &writer, "Heading", pSample->heading, 6 );
+    JsonWriter_EndObject( &writer );
+    JsonWriter_AddDouble( &writer, "Speed", pSample->speed, 6 );
+    JsonWriter_AddDouble( &writer, "EngineSpeed", pSample->engineSpeed, 6 );
+    JsonWriter_AddDouble( &writer, "AcceleratorPedal", pSample->acceleratorPedal, 6 );
+    JsonWriter_AddDouble( &writer, "FuelLevel", pSample->fuelLevel, 6 );
+    JsonWriter_AddDouble( &writer, "FuelConsumed", pSample->fuelConsumed, 6 );
+    JsonWriter_AddDouble( &writer, "Odometer", pSample->odometer, 6 );
+    JsonWriter_AddDouble( &writer, "OilTemp", pSample->oilTemp, 6 );
+    JsonWriter_AddInt( &writer, "IdleDuration", pSample->idleDurationMs );
+    JsonWriter_AddInt( &writer, "HighSpeedDuration", pSample->highSpeedDurationMs );
+    JsonWriter_AddBool( &writer, "Ignition", pSample->ignition );
+    JsonWriter_EndObject( &writer );
+
+    return ( writer.overflow == true ) ? 0U : writer.length;
+}
+
+/*-----------------------------------------------------------*/
+
+/* The chained snprintf calls the writer replaced. */
+static size_t prvSnprintf( char * pBuffer,
+                           size_t bufferSize,
+                           const BenchSample_t * pSample,
+                           uint8_t options )
+{
+    int length = 0;
+
+    ( void ) options;
+
+    length = snprintf( pBuffer, bufferSize,
+                       "{\r\n    \"VIN\": \"%s\",\r\n    \"TripId\": \"%s\",\r\n    \"CreationTimeStamp\": \"%s\",\r\n"
+                       "    \"GeoLocation\": {\r\n        \"Latitude\": %lf,\r\n        \"Longitude\": %lf,\r\n"
+                       "        \"Heading\": %lf\r\n    },\r\n",
+                       pSample->pVin, pSample->pTripId, pSample->pTimestamp,
+                       pSample->latitudeE6 / 1e6, pSample->longitudeE6 / 1e6, pSample->heading );
+    length += snprintf( &pBuffer[ length ], bufferSize - ( size_t ) length,
+                        "    \"Speed\": %lf,\r\n    \"EngineSpeed\": %lf,\r\n    \"AcceleratorPedal\": %lf,\r\n"
+                        "    \"FuelLevel\": %lf,\r\n    \"FuelConsumed\": %lf,\r\n    \"Odometer\": %lf,\r\n"
+                        "    \"OilTemp\": %lf,\r\n",
+                        pSample->speed, pSample->engineSpeed, pSample->acceleratorPedal, pSample->fuelLevel,
+                        pSample->fuelConsumed, pSample->odometer, pSample->oilTemp );
+    length += snprintf( &pBuffer[ length ], bufferSize - ( size_t ) length,
+                        "    \"IdleDuration\": %lld,\r\n    \"HighSpeedDuration\": %lld,\r\n    \"Ignition\": %s\r\n}",
+                        ( long long ) pSample->idleDurationMs, ( long long ) pSample->highSpeedDurationMs,
+                        ( pSample->ignition == true ) ? "true" : "false" );
+
+    return ( ( size_t ) length < bufferSize ) ? ( size_t ) length : 0U;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( BENCH_WITH_CJSON == 1 )
+
+    static size_t prvCJson( char * pBuffer,
+                            size_t bufferSize,
+                            const BenchSample_t * pSample,
+                            uint8_t options )
+    {
+        cJSON * pRoot = cJSON_CreateObject();
+        cJSON * pGeo = cJSON_CreateObject();
+        cJSON_bool formatted = ( ( options & JSON_WRITER_PRETTY ) != 0U ) ? 1 : 0;
+        size_t length = 0;
+
+        cJSON_AddStringToObject( pRoot, "VIN", pSample->pVin );
+        cJSON_AddStringToObject( pRoot, "TripId", pSample->pTripId );
+        cJSON_AddStringToObject( pRoot, "CreationTimeStamp", pSample->pTimestamp );
+        cJSON_AddNumberToObject( pGeo, "Latitude", pSample->latitudeE6 / 1e6 );
+        cJSON_AddNumberToObject( pGeo, "Longitude", pSample->longitudeE6 / 1e6 );
+        cJSON_AddNumberToObject( pGeo, "Heading", pSample->heading );
+        cJSON_AddItemToObject( pRoot, "GeoLocation", pGeo );
+        cJSON_AddNumberToObject( pRoot, "Speed", pSample->speed );
+        cJSON_AddNumberToObject( pRoot, "EngineSpeed", pSample->engineSpeed );
+        cJSON_AddNumberToObject( pRoot, "AcceleratorPedal", pSample->acceleratorPedal );
+        cJSON_AddNumberToObject( pRoot, "FuelLevel", pSample->fuelLevel );
+        cJSON_AddNumberToObject( pRoot, "FuelConsumed", pSample->fuelConsumed );
+        cJSON_AddNumberToObject( pRoot, "Odometer", pSample->odometer );
+        cJSON_AddNumberToObject( pRoot, "OilTemp", pSample->oilTemp );
+        cJSON_AddNumberToObject( pRoot, "IdleDuration", ( double ) pSample->idleDurationMs );
+        cJSON_AddNumberToObject( pRoot, "HighSpeedDuration", ( double ) pSample->highSpeedDurationMs );
+        cJSON_AddBoolToObject( pRoot, "Ignition", pSample->ignition );
+
+        if( cJSON_PrintPreallocated( pRoot, pBuffer, ( int ) bufferSize, formatted ) != 0 )
+        {
+            length = strlen( pBuffer );
+        }
+
+        cJSON_Delete( pRoot );
+
+        return length;
+    }
+
+#endif /* if ( BENCH_WITH_CJSON == 1 ) */
+
+/*-----------------------------------------------------------*/
+
+static int prvRun( const char * pName,
+                   size_t ( * pEncode )( char *, size_t, const BenchSample_t *, uint8_t ),
+                   uint8_t options,
+                   long iterations )
+{
+    static char buffer[ BENCH_MESSAGE_MAX ];
+    size_t length = pEncode( buffer, sizeof( buffer ), &benchSample, options );
+    uint64_t startNs = 0;
+    uint64_t elapsedNs = 0;
+    long i = 0;
+
+    if( length == 0U )
+    {
+        printf( "%-18s failed to encode\n", pName );
+        return 1;
+    }
+
+    startNs = prvNowNs();
+
+    for( i = 0; i < iterations; i++ )
+    {
+        benchSink += pEncode( buffer, sizeof( buffer ), &benchSample, options );
+    }
+
+    elapsedNs = prvNowNs() - startNs;
+    printf( "%-18s %5u B %9.1f ns/msg\n", pName, ( unsigned int ) length, ( double ) elapsedNs / ( double ) iterations );
+
+    return 0;
+}
+
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    long iterations = ( argc > 1 ) ? strtol( argv[ 1 ], NULL, 10 ) : BENCH_DEFAULT_ITERATIONS;
+    int failures = 0;
+
+    if( iterations <= 0 )
+    {
+        iterations = 1;
+    }
+
+    printf( "Telemetry message, %ld iterations\n", iterations );
+    failures += prvRun( "snprintf, pretty", prvSnprintf, JSON_WRITER_PRETTY, iterations );
+    failures += prvRun( "writer, pretty", prvWriter, JSON_WRITER_PRETTY, iterations );
+    failures += prvRun( "writer, compact", prvWriter, JSON_WRITER_TRIM_ZEROS, iterations );
+    #if ( BENCH_WITH_CJSON == 1 )
+        failures += prvRun( "cJSON, pretty", prvCJson, JSON_WRITER_PRETTY, iterations );
+        failures += prvRun( "cJSON, compact", prvCJson, 0, iterations );
+    #else
+        printf( "cJSON not built, set CJSON_DIR to compare with it.\n" );
+    #endif
+
+    return ( failures == 0 ) ? 0 : 1;
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,248 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file payload_compress_bench.c
+ * @brief Host benchmark of the LZSS payload compression.
+ *
+ * The inputs are simulated batches of 10 telemetry samples in the three
+ * payload encodings, written with the device's JSON and CBOR writers.
+ *
+ * Usage: payload_compress_bench [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#include "json_writer.h"
+#include "cbor_writer.h"
+#include "payload_compress.h"
+
+#define BENCH_MESSAGE_MAX          ( 4096 )
+#define BENCH_SAMPLES              ( 10 )
+#define BENCH_DEFAULT_ITERATIONS   ( 20000 )
+
+typedef enum BenchEncoding
+{
+    BENCH_JSON_PRETTY = 0,
+    BENCH_JSON_COMPACT,
+    BENCH_CBOR
+} BenchEncoding_t;
+
+typedef struct BenchColumn
+{
+    const char * pName;
+    double start;
+    double step;
+    uint8_t decimals;
+} BenchColumn_t;
+
+/* Slowly drifting signals, as a car cruising through a town. */
+static const BenchColumn_t benchColumns[] =
+{
+    { "Offset",           0.0,          2000.0, 0 },
+    { "Latitude",         47.123456,    0.000173, 6 },
+    { "Longitude",        -122.654321,  0.000121, 6 },
+    { "Heading",          271.35,       1.7,    2 },
+    { "Speed",            48.4,         0.9,    1 },
+    { "EngineSpeed",      2150.0,       35.0,   0 },
+    { "AcceleratorPedal", 23.5,         -0.8,   1 },
+    { "FuelLevel",        41.75,        -0.01,  2 },
+    { "Odometer",         12.345678,    0.026,  6 },
+    { "OilTemp",          92.0,         0.0,    0 }
+};
+
+#define BENCH_COLUMNS    ( sizeof( benchColumns ) / sizeof( benchColumns[ 0 ] ) )
+
+static uint8_t message[ BENCH_MESSAGE_MAX ];
+static uint8_t compressed[ BENCH_MESSAGE_MAX + ( BENCH_MESSAGE_MAX / 8 ) + 16 ];
+static uint8_t decoded[ BENCH_MESSAGE_MAX ];
+static volatile int32_t benchSink;
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNowNs( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+
+    return ( ( uint64_t ) now.tv_sec * 1000000000ULL ) + ( uint64_t ) now.tv_nsec;
+}
+
+/*-----------------------------------------------------------*/
+
+static double prvSampleValue( const BenchColumn_t * pColumn,
+                              int sample )
+{
+    /* A little noise so the columns are not plain sequences. */
+    double noise = ( pColumn->step == 0.0 ) ? 0.0 : sin( sample * 1.7 ) * pColumn->step * 0.3;
+
+    return pColumn->start + ( pColumn->step * sample ) + noise;
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t prvJsonBatch( bool pretty )
+{
+    JsonWriter_t writer;
+    size_t column = 0;
+    int sample = 0;
+
+    JsonWriter_Init( &writer, ( char * ) message, sizeof( message ),
+                     ( pretty == true ) ? JSON_WRITER_PRETTY : ( JSON_WRITER_OMIT_EMPTY | JSON_WRITER_TRIM_ZEROS ) );
+    JsonWriter_BeginObject( &writer, NULL );
+    JsonWriter_AddString( &writer, "VIN", "1HGBH41JXMN109186" );
+    JsonWriter_AddString( &writer, "TripId", "d41d8cd98f00b204" );
+    JsonWriter_AddString( &writer, "TripName", "Morning commute" );
+    JsonWriter_AddString( &writer, "CreationTimeStamp", "2026-10-18T11:03:00.125Z" );
+    JsonWriter_AddString( &writer, "GpsStatus", "FIX_3D" );
+    JsonWriter_AddBool( &writer, "Ignition", true );
+    JsonWriter_BeginObject( &writer, "Samples" );
+
+    for( column = 0; column < BENCH_COLUMNS; column++ )
+    {
+        JsonWriter_BeginArray( &writer, benchColumns[ column ].pName );
+
+        for( sample = 0; sample < BENCH_SAMPLES; sample++ )
+        {
+            JsonWriter_AddDouble( &writer, NULL, prvSampleValue( &benchColumns[ column ], sample ),
+                                  ( pretty == true ) ? 6 : benchColumns[ column ].decimals );
+        }
+
+        JsonWriter_EndArray( &writer );
+    }
+
+    JsonWriter_EndObject( &writer );
+    JsonWriter_EndObject( &writer );
+
+    return ( writer.overflow == true ) ? 0U : writer.length;
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t prvCborBatch( void )
+{
+    CborWriter_t writer;
+    size_t column = 0;
+    int sample = 0;
+    int32_t length = 0;
+
+    CborWriter_Init( &writer, message, sizeof( message ), 1 );
+    CborWriter_BeginMap( &writer, CBOR_WRITER_NO_KEY );
+    CborWriter_AddText( &writer, 1, "1HGBH41JXMN109186" );
+    CborWriter_AddText( &writer, 2, "d41d8cd98f00b204" );
+    CborWriter_AddText( &writer, 3, "Morning commute" );
+    CborWriter_AddInt( &writer, 4, 1792321380125LL );
+    CborWriter_AddText( &writer, 5, "FIX_3D" );
+    CborWriter_AddInt( &writer, 6, 1 );
+    CborWriter_BeginMap( &writer, 7 );
+
+    for( column = 0; column < BENCH_COLUMNS; column++ )
+    {
+        CborWriter_BeginArray( &writer, ( uint16_t ) ( 20U + column ) );
+
+        for( sample = 0; sample < BENCH_SAMPLES; sample++ )
+        {
+            CborWriter_AddNumber( &writer, CBOR_WRITER_NO_KEY, prvSampleValue( &benchColumns[ column ], sample ),
+                                  benchColumns[ column ].decimals );
+        }
+
+        CborWriter_EndArray( &writer );
+    }
+
+    CborWriter_EndMap( &writer );
+    CborWriter_EndMap( &writer );
+    length = CborWriter_Finish( &writer );
+
+    return ( length < 0 ) ? 0U : ( size_t ) length;
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvRun( const char * pName,
+                   BenchEncoding_t encoding,
+                   long iterations )
+{
+    size_t length = ( encoding == BENCH_CBOR ) ? prvCborBatch() : prvJsonBatch( encoding == BENCH_JSON_PRETTY );
+    int32_t compressedLength = PayloadCompress_Encode( message, length, compressed, sizeof( compressed ) );
+    uint64_t encodeNs = 0;
+    uint64_t decodeNs = 0;
+    uint64_t startNs = 0;
+    long i = 0;
+
+    if( ( length == 0U ) || ( compressedLength < 0 ) ||
+        ( PayloadCompress_Decode( compressed, ( size_t ) compressedLength, decoded, sizeof( decoded ) ) != ( int32_t ) length ) ||
+        ( memcmp( message, decoded, length ) != 0 ) )
+    {
+        printf( "%-14s round trip failed\n", pName );
+        return 1;
+    }
+
+    startNs = prvNowNs();
+
+    for( i = 0; i < iterations; i++ )
+    {
+        benchSink += PayloadCompress_Encode( message, length, compressed, sizeof( compressed ) );
+    }
+
+    encodeNs = prvNowNs() - startNs;
+    startNs = prvNowNs();
+
+    for( i = 0; i < iterations; i++ )
+    {
+        benchSink += PayloadCompress_Decode( compressed, ( size_t ) compressedLength, decoded, sizeof( decoded ) );
+    }
+
+    decodeNs = prvNowNs() - startNs;
+
+    printf( "%-14s %5u -> %5d B (%3u%%), encode %6.1f MB/s, decode %6.1f MB/s\n",
+            pName, ( unsigned int ) length, ( int ) compressedLength,
+            ( unsigned int ) ( ( ( size_t ) compressedLength * 100U ) / length ),
+            ( ( double ) length * ( double ) iterations * 1000.0 ) / ( double ) ( encodeNs + 1U ),
+            ( ( double ) length * ( double ) iterations * 1000.0 ) / ( double ) ( decodeNs + 1U ) );
+
+    return 0;
+}
+
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    long iterations = ( argc > 1 ) ? strtol( argv[ 1 ], NULL, 10 ) : BENCH_DEFAULT_ITERATIONS;
+    int failures = 0;
+
+    if( iterations <= 0 )
+    {
+        iterations = 1;
+    }
+
+    printf( "Batch of %d samples, %ld iterations\n", BENCH_SAMPLES, iterations );
+    failures += prvRun( "JSON, pretty", BENCH_JSON_PRETTY, iterations );
+    failures += prvRun( "JSON, compact", BENCH_JSON_COMPACT, iterations );
+    failures += prvRun( "CBOR", BENCH_CBOR, iterations );
+
+    return ( failures == 0 ) ? 0 : 1;
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,433 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file cbor_decoder.c
+ * @brief Implementation of the host-side CBOR decoder.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "cbor_decoder.h"
+
+/*-----------------------------------------------------------*/
+
+#define CBOR_DECODER_DEPTH_MAX      ( 16U )
+
+typedef struct DiagnosticText
+{
+    char * pText;
+    size_t size;
+    size_t length;
+    bool overflow;
+} DiagnosticText_t;
+
+/*-----------------------------------------------------------*/
+
+static bool prvDiagnosticItem( CborDecoder_t * pDecoder,
+                               const CborItem_t * pItem,
+                               DiagnosticText_t * pOut,
+                               uint32_t depth );
+
+/*-----------------------------------------------------------*/
+
+static void prvAppend( DiagnosticText_t * pOut,
+                       const char * pFormat,
+                       ... )
+{
+    va_list args;
+    int written = 0;
+
+    if( pOut->overflow == true )
+    {
+        return;
+    }
+
+    va_start( args, pFormat );
+    written = vsnprintf( &pOut->pText[ pOut->length ], pOut->size - pOut->length, pFormat, args );
+    va_end( args );
+
+    if( ( written < 0 ) || ( ( size_t ) written >= ( pOut->size - pOut->length ) ) )
+    {
+        pOut->overflow = true;
+    }
+    else
+    {
+        pOut->length += ( size_t ) written;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvReadBigEndian( const uint8_t * pData,
+                                  size_t size )
+{
+    uint64_t value = 0;
+    size_t i = 0;
+
+    for( i = 0; i < size; i++ )
+    {
+        value = ( value << 8 ) | pData[ i ];
+    }
+
+    return value;
+}
+
+/*-----------------------------------------------------------*/
+
+double CborDecoder_HalfToDouble( uint16_t half )
+{
+    int exponent = ( half >> 10 ) & 0x1F;
+    int mantissa = half & 0x3FF;
+    double value = 0.0;
+
+    if( exponent == 0 )
+    {
+        value = ldexp( mantissa, -24 );
+    }
+    else if( exponent == 31 )
+    {
+        value = ( mantissa == 0 ) ? INFINITY : NAN;
+    }
+    else
+    {
+        value = ldexp( mantissa + 1024, exponent - 25 );
+    }
+
+    return ( ( half & 0x8000U ) != 0U ) ? -value : value;
+}
+
+/*-----------------------------------------------------------*/
+
+void CborDecoder_Init( CborDecoder_t * pDecoder,
+                       const uint8_t * pBuffer,
+                       size_t length )
+{
+    pDecoder->pBuffer = pBuffer;
+    pDecoder->length = length;
+    pDecoder->offset = 0;
+}
+
+/*-----------------------------------------------------------*/
+
+bool CborDecoder_Next( CborDecoder_t * pDecoder,
+                       CborItem_t * pItem )
+{
+    const uint8_t * pHead = &pDecoder->pBuffer[ pDecoder->offset ];
+    size_t remaining = pDecoder->length - pDecoder->offset;
+    uint8_t major = 0;
+    uint8_t info = 0;
+    uint32_t bits32 = 0;
+    uint64_t bits64 = 0;
+    float single = 0.0f;
+
+    memset( pItem, 0, sizeof( CborItem_t ) );
+
+    if( remaining == 0U )
+    {
+        return false;
+    }
+
+    major = pHead[ 0 ] >> 5;
+    info = pHead[ 0 ] & 0x1FU;
+
+    if( info < 24U )
+    {
+        pItem->headSize = 1;
+        pItem->argument = info;
+    }
+    else if( info <= 27U )
+    {
+        pItem->headSize = ( size_t ) 1U + ( ( size_t ) 1U << ( info - 24U ) );
+
+        if( pItem->headSize > remaining )
+        {
+            return false;
+        }
+
+        pItem->argument = prvReadBigEndian( &pHead[ 1 ], pItem->headSize - 1U );
+    }
+    else if( info == 31U )
+    {
+        pItem->headSize = 1;
+        pItem->indefinite = true;
+    }
+    else
+    {
+        return false;
+    }
+
+    pDecoder->offset += pItem->headSize;
+
+    switch( major )
+    {
+        case 0:
+            pItem->type = CBOR_TYPE_UNSIGNED;
+            break;
+
+        case 1:
+            pItem->type = CBOR_TYPE_NEGATIVE;
+            break;
+
+        case 2:
+        case 3:
+            pItem->type = ( major == 2U ) ? CBOR_TYPE_BYTES : CBOR_TYPE_TEXT;
+
+            /* The writer never chunks strings. */
+            if( ( pItem->indefinite == true ) || ( pItem->argument > ( pDecoder->length - pDecoder->offset ) ) )
+            {
+                return false;
+            }
+
+            pItem->pData = &pDecoder->pBuffer[ pDecoder->offset ];
+            pDecoder->offset += ( size_t ) pItem->argument;
+            break;
+
+        case 4:
+            pItem->type = CBOR_TYPE_ARRAY;
+            break;
+
+        case 5:
+            pItem->type = CBOR_TYPE_MAP;
+            break;
+
+        case 6:
+            pItem->type = CBOR_TYPE_TAG;
+            break;
+
+        default:
+
+            if( info == 31U )
+            {
+                pItem->type = CBOR_TYPE_BREAK;
+                pItem->indefinite = false;
+            }
+            else if( info == 25U )
+            {
+                pItem->type = CBOR_TYPE_FLOAT;
+                pItem->floatSize = 2;
+                pItem->number = CborDecoder_HalfToDouble( ( uint16_t ) pItem->argument );
+            }
+            else if( info == 26U )
+            {
+                pItem->type = CBOR_TYPE_FLOAT;
+                pItem->floatSize = 4;
+                bits32 = ( uint32_t ) pItem->argument;
+                memcpy( &single, &bits32, sizeof( single ) );
+                pItem->number = single;
+            }
+            else if( info == 27U )
+            {
+                pItem->type = CBOR_TYPE_FLOAT;
+                pItem->floatSize = 8;
+                bits64 = pItem->argument;
+                memcpy( &pItem->number, &bits64, sizeof( pItem->number ) );
+            }
+            else
+            {
+                pItem->type = CBOR_TYPE_SIMPLE;
+            }
+
+            break;
+    }
+
+    return ( ( pItem->indefinite == false ) ||
+             ( pItem->type == CBOR_TYPE_ARRAY ) ||
+             ( pItem->type == CBOR_TYPE_MAP ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/* The members of an array or map, count items or up to the break. */
+static bool prvDiagnosticContainer( CborDecoder_t * pDecoder,
+                                    const CborItem_t * pItem,
+                                    DiagnosticText_t * pOut,
+                                    uint32_t depth )
+{
+    bool isMap = ( pItem->type == CBOR_TYPE_MAP );
+    uint64_t count = ( isMap == true ) ? pItem->argument * 2U : pItem->argument;
+    uint64_t index = 0;
+    CborItem_t member;
+
+    prvAppend( pOut, "%s", ( isMap == true ) ? "{" : "[" );
+
+    if( pItem->indefinite == true )
+    {
+        prvAppend( pOut, "_ " );
+    }
+
+    for( index = 0; ( pItem->indefinite == true ) || ( index < count ); index++ )
+    {
+        if( CborDecoder_Next( pDecoder, &member ) == false )
+        {
+            return false;
+        }
+
+        if( member.type == CBOR_TYPE_BREAK )
+        {
+            if( ( pItem->indefinite == false ) || ( ( isMap == true ) && ( ( index % 2U ) != 0U ) ) )
+            {
+                return false;
+            }
+
+            break;
+        }
+
+        if( index > 0U )
+        {
+            prvAppend( pOut, "%s", ( ( isMap == true ) && ( ( index % 2U ) != 0U ) ) ? ": " : ", " );
+        }
+
+        if( prvDiagnosticItem( pDecoder, &member, pOut, depth + 1U ) == false )
+        {
+            return false;
+        }
+    }
+
+    prvAppend( pOut, "%s", ( isMap == true ) ? "}" : "]" );
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool prvDiagnosticItem( CborDecoder_t * pDecoder,
+                               const CborItem_t * pItem,
+                               DiagnosticText_t * pOut,
+                               uint32_t depth )
+{
+    CborItem_t content;
+    bool retOk = true;
+    size_t i = 0;
+
+    if( depth >= CBOR_DECODER_DEPTH_MAX )
+    {
+        return false;
+    }
+
+    switch( pItem->type )
+    {
+        case CBOR_TYPE_UNSIGNED:
+            prvAppend( pOut, "%llu", ( unsigned long long ) pItem->argument );
+            break;
+
+        case CBOR_TYPE_NEGATIVE:
+
+            /* -1 - n, printed without an intermediate that could overflow. */
+            if( pItem->argument == UINT64_MAX )
+            {
+                prvAppend( pOut, "-18446744073709551616" );
+            }
+            else
+            {
+                prvAppend( pOut, "-%llu", ( unsigned long long ) ( pItem->argument + 1U ) );
+            }
+
+            break;
+
+        case CBOR_TYPE_BYTES:
+            prvAppend( pOut, "h'" );
+
+            for( i = 0; i < pItem->argument; i++ )
+            {
+                prvAppend( pOut, "%02x", pItem->pData[ i ] );
+            }
+
+            prvAppend( pOut, "'" );
+            break;
+
+        case CBOR_TYPE_TEXT:
+            prvAppend( pOut, "\"%.*s\"", ( int ) pItem->argument, ( const char * ) pItem->pData );
+            break;
+
+        case CBOR_TYPE_ARRAY:
+        case CBOR_TYPE_MAP:
+            retOk = prvDiagnosticContainer( pDecoder, pItem, pOut, depth );
+            break;
+
+        case CBOR_TYPE_TAG:
+            prvAppend( pOut, "%llu(", ( unsigned long long ) pItem->argument );
+            retOk = ( CborDecoder_Next( pDecoder, &content ) == true ) &&
+                    ( content.type != CBOR_TYPE_BREAK ) &&
+                    ( prvDiagnosticItem( pDecoder, &content, pOut, depth + 1U ) == true );
+            prvAppend( pOut, ")" );
+            break;
+
+        case CBOR_TYPE_SIMPLE:
+
+            if( pItem->argument == 20U )
+            {
+                prvAppend( pOut, "false" );
+            }
+            else if( pItem->argument == 21U )
+            {
+                prvAppend( pOut, "true" );
+            }
+            else if( pItem->argument == 22U )
+            {
+                prvAppend( pOut, "null" );
+            }
+            else
+            {
+                prvAppend( pOut, "simple(%llu)", ( unsigned long long ) pItem->argument );
+            }
+
+            break;
+
+        case CBOR_TYPE_FLOAT:
+            prvAppend( pOut, "%.17g_%d", pItem->number,
+                       ( pItem->floatSize == 2U ) ? 1 : ( ( pItem->floatSize == 4U ) ? 2 : 3 ) );
+            break;
+
+        default:
+            retOk = false;
+            break;
+    }
+
+    return retOk;
+}
+
+/*-----------------------------------------------------------*/
+
+bool CborDecoder_ToDiagnostic( CborDecoder_t * pDecoder,
+                               char * pText,
+                               size_t textSize )
+{
+    DiagnosticText_t out = { pText, textSize, 0, false };
+    CborItem_t item;
+    bool retOk = false;
+
+    if( textSize > 0U )
+    {
+        pText[ 0 ] = '\0';
+
+        if( ( CborDecoder_Next( pDecoder, &item ) == true ) && ( item.type != CBOR_TYPE_BREAK ) )
+        {
+            retOk = prvDiagnosticItem( pDecoder, &item, &out, 0 );
+        }
+    }
+
+    return ( retOk == true ) && ( out.overflow == false );
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,116 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file cbor_decoder.h
+ * @brief Host-side CBOR (RFC 8949) decoder for checking the device output.
+ *
+ * Covers what cbor_writer.c produces: integers, byte and text strings,
+ * definite and indefinite arrays and maps, tags, simple values and the
+ * three float widths.
+ */
+
+#ifndef CBOR_DECODER_H
+#define CBOR_DECODER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum CborType
+{
+    CBOR_TYPE_UNSIGNED = 0,
+    CBOR_TYPE_NEGATIVE,
+    CBOR_TYPE_BYTES,
+    CBOR_TYPE_TEXT,
+    CBOR_TYPE_ARRAY,
+    CBOR_TYPE_MAP,
+    CBOR_TYPE_TAG,
+    CBOR_TYPE_SIMPLE,
+    CBOR_TYPE_FLOAT,
+    CBOR_TYPE_BREAK
+} CborType_t;
+
+typedef struct CborItem
+{
+    CborType_t type;
+    uint64_t argument;      /* Head argument: value, length, count, tag or simple value. */
+    size_t headSize;        /* 1, 2, 3, 5 or 9 bytes. */
+    bool indefinite;        /* Indefinite length array or map. */
+    const uint8_t * pData;  /* Content of a byte or text string. */
+    double number;          /* Value of a float. */
+    uint8_t floatSize;      /* 2, 4 or 8 bytes. */
+} CborItem_t;
+
+typedef struct CborDecoder
+{
+    const uint8_t * pBuffer;
+    size_t length;
+    size_t offset;
+} CborDecoder_t;
+
+/**
+ * @brief Start decoding a buffer.
+ *
+ * @param[in] pDecoder pointer to decoder state.
+ * @param[in] pBuffer the encoded data.
+ * @param[in] length length of the data.
+ */
+void CborDecoder_Init( CborDecoder_t * pDecoder,
+                       const uint8_t * pBuffer,
+                       size_t length );
+
+/**
+ * @brief Decode the next head, and the content of a string.
+ *
+ * Containers and tags are not entered, their items follow as the next heads.
+ *
+ * @param[in] pDecoder pointer to decoder state.
+ * @param[out] pItem the decoded item.
+ *
+ * @return true if an item is decoded, false at the end or on malformed data.
+ */
+bool CborDecoder_Next( CborDecoder_t * pDecoder,
+                       CborItem_t * pItem );
+
+/**
+ * @brief Decode one complete data item to diagnostic notation.
+ *
+ * Indefinite containers are written as [_ ] and {_ }, floats carry the width
+ * suffix _1, _2 or _3 of RFC 8949 section 8.1, e.g. 1.5_1 for a float16.
+ *
+ * @param[in] pDecoder pointer to decoder state.
+ * @param[out] pText buffer to receive the notation.
+ * @param[in] textSize size of the buffer.
+ *
+ * @return true if a complete item is decoded and fits the buffer.
+ */
+bool CborDecoder_ToDiagnostic( CborDecoder_t * pDecoder,
+                               char * pText,
+                               size_t textSize );
+
+/**
+ * @brief Convert a float16 to a double.
+ *
+ * @param[in] half the IEEE 754 binary16 bits.
+ *
+ * @return the value.
+ */
+double CborDecoder_HalfToDouble( uint16_t half );
+
+#endif /* CBOR_DECODER_H */
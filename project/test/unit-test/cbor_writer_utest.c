@@ -0,0 +1,377 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file cbor_writer_utest.c
+ * @brief Round trip of the CBOR writer through the host-side decoder.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "test_assert.h"
+#include "cbor_writer.h"
+#include "cbor_decoder.h"
+
+#define TEST_VERSION    ( 1U )
+
+static uint8_t buffer[ 80000 ];
+static char text[ 4096 ];
+
+/*-----------------------------------------------------------*/
+
+/* Diagnostic notation of the document after the version byte. */
+static const char * prvDiagnostic( const CborWriter_t * pWriter )
+{
+    CborDecoder_t decoder;
+    int32_t length = CborWriter_Finish( pWriter );
+
+    if( ( length < 1 ) || ( buffer[ 0 ] != TEST_VERSION ) )
+    {
+        return "<unfinished>";
+    }
+
+    CborDecoder_Init( &decoder, &buffer[ 1 ], ( size_t ) length - 1U );
+
+    if( CborDecoder_ToDiagnostic( &decoder, text, sizeof( text ) ) == false )
+    {
+        return "<malformed>";
+    }
+
+    /* Nothing may follow the item. */
+    return ( decoder.offset == decoder.length ) ? text : "<trailing data>";
+}
+
+/*-----------------------------------------------------------*/
+
+#define TEST_ASSERT_DIAGNOSTIC( expected, writer )                                  \
+    do {                                                                            \
+        const char * pActual_ = prvDiagnostic( &( writer ) );                       \
+        if( strcmp( ( expected ), pActual_ ) != 0 )                                 \
+        {                                                                           \
+            TEST_FAIL_AT( __FILE__, __LINE__, "expected %s, got %s", ( expected ), pActual_ ); \
+        }                                                                           \
+    } while( 0 )
+
+/*-----------------------------------------------------------*/
+
+/* A single element array, returns the head of the element. */
+static bool prvSingleItem( const CborWriter_t * pWriter,
+                           CborItem_t * pItem )
+{
+    CborDecoder_t decoder;
+    CborItem_t array;
+    int32_t length = CborWriter_Finish( pWriter );
+
+    CborDecoder_Init( &decoder, &buffer[ 1 ], ( length > 0 ) ? ( size_t ) length - 1U : 0U );
+
+    return ( length > 0 ) &&
+           ( CborDecoder_Next( &decoder, &array ) == true ) && ( array.type == CBOR_TYPE_ARRAY ) &&
+           ( CborDecoder_Next( &decoder, pItem ) == true );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckInt( int64_t value,
+                         size_t headSize )
+{
+    CborWriter_t writer;
+    CborItem_t item;
+
+    CborWriter_Init( &writer, buffer, sizeof( buffer ), TEST_VERSION );
+    CborWriter_BeginArray( &writer, CBOR_WRITER_NO_KEY );
+    CborWriter_AddInt( &writer, CBOR_WRITER_NO_KEY, value );
+    CborWriter_EndArray( &writer );
+
+    TEST_ASSERT( prvSingleItem( &writer, &item ) == true );
+    TEST_ASSERT_EQUAL_INT( headSize, item.headSize );
+
+    if( value < 0 )
+    {
+        TEST_ASSERT_EQUAL_INT( CBOR_TYPE_NEGATIVE, item.type );
+        TEST_ASSERT( item.argument == ( uint64_t ) ( -( value + 1 ) ) );
+    }
+    else
+    {
+        TEST_ASSERT_EQUAL_INT( CBOR_TYPE_UNSIGNED, item.type );
+        TEST_ASSERT( item.argument == ( uint64_t ) value );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Head_IntegerWidths( void )
+{
+    prvCheckInt( 0, 1 );
+    prvCheckInt( 23, 1 );
+    prvCheckInt( 24, 2 );
+    prvCheckInt( 255, 2 );
+    prvCheckInt( 256, 3 );
+    prvCheckInt( 65535, 3 );
+    prvCheckInt( 65536, 5 );
+    prvCheckInt( 4294967295LL, 5 );
+    prvCheckInt( 4294967296LL, 9 );
+    prvCheckInt( INT64_MAX, 9 );
+    prvCheckInt( -1, 1 );
+    prvCheckInt( -24, 1 );
+    prvCheckInt( -25, 2 );
+    prvCheckInt( -256, 2 );
+    prvCheckInt( -257, 3 );
+    prvCheckInt( -65537, 5 );
+    prvCheckInt( -4294967297LL, 9 );
+    prvCheckInt( INT64_MIN, 9 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Head_StringWidths( void )
+{
+    static char longText[ 70001 ];
+    const size_t lengths[] = { 0, 23, 24, 255, 256, 65535, 65536, 70000 };
+    const size_t headSizes[] = { 1, 1, 2, 2, 3, 3, 5, 5 };
+    CborWriter_t writer;
+    CborItem_t item;
+    size_t i = 0;
+
+    memset( longText, 'a', sizeof( longText ) - 1U );
+
+    for( i = 0; i < ( sizeof( lengths ) / sizeof( lengths[ 0 ] ) ); i++ )
+    {
+        longText[ lengths[ i ] ] = '\0';
+        CborWriter_Init( &writer, buffer, sizeof( buffer ), TEST_VERSION );
+        CborWriter_BeginArray( &writer, CBOR_WRITER_NO_KEY );
+        CborWriter_AddText( &writer, CBOR_WRITER_NO_KEY, longText );
+        CborWriter_EndArray( &writer );
+        longText[ lengths[ i ] ] = 'a';
+
+        TEST_ASSERT( prvSingleItem( &writer, &item ) == true );
+        TEST_ASSERT_EQUAL_INT( CBOR_TYPE_TEXT, item.type );
+        TEST_ASSERT_EQUAL_INT( headSizes[ i ], item.headSize );
+        TEST_ASSERT_EQUAL_INT( lengths[ i ], item.argument );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckNumber( double value,
+                            uint8_t decimals,
+                            const char * pExpected )
+{
+    CborWriter_t writer;
+
+    CborWriter_Init( &writer, buffer, sizeof( buffer ), TEST_VERSION );
+    CborWriter_BeginArray( &writer, CBOR_WRITER_NO_KEY );
+    CborWriter_AddNumber( &writer, CBOR_WRITER_NO_KEY, value, decimals );
+    CborWriter_EndArray( &writer );
+
+    TEST_ASSERT_DIAGNOSTIC( pExpected, writer );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Number_WidthSelection( void )
+{
+    prvCheckNumber( 3.0, 2, "[_ 3]" );
+    prvCheckNumber( 2.999, 2, "[_ 3]" );
+    prvCheckNumber( -1234.0, 0, "[_ -1234]" );
+    prvCheckNumber( 1.5, 1, "[_ 1.5_1]" );
+    prvCheckNumber( -2.25, 2, "[_ -2.25_1]" );
+    prvCheckNumber( 0.1, 1, "[_ 0.0999755859375_1]" );
+    prvCheckNumber( 0.1, 6, "[_ 0.10000000149011612_2]" );
+    prvCheckNumber( 88.4, 3, "[_ 88.400001525878906_2]" );
+    prvCheckNumber( 47.123456, 6, "[_ 47.123455999999997_3]" );
+    prvCheckNumber( 1e6 + 0.5, 1, "[_ 1000000.5_2]" );
+    prvCheckNumber( NAN, 2, "[_ null]" );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Nearest float16 value, infinity past its range. */
+static double prvNearestHalf( double value )
+{
+    int exponent = 0;
+
+    if( fabs( value ) >= 65520.0 )
+    {
+        return INFINITY;
+    }
+
+    if( value == 0.0 )
+    {
+        return 0.0;
+    }
+
+    exponent = ( int ) floor( log2( fabs( value ) ) );
+    exponent = ( exponent < -14 ) ? -14 : exponent;
+
+    return ldexp( round( ldexp( value, 10 - exponent ) ), exponent - 10 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Number_RoundTripIsSmallestExact( void )
+{
+    uint32_t state = 1U;
+    CborWriter_t writer;
+    CborItem_t item;
+    int i = 0;
+
+    for( i = 0; i < 20000; i++ )
+    {
+        uint8_t decimals = ( uint8_t ) ( i % 7 );
+        double scale = pow( 10.0, decimals );
+        double value = 0.0;
+        double rounded = 0.0;
+        double tolerance = 0.5 / scale;
+
+        state = ( state * 1103515245U ) + 12345U;
+        value = ( ( double ) ( state >> 8 ) / 16777216.0 - 0.5 ) * pow( 10.0, ( double ) ( i % 9 ) - 2.0 );
+        rounded = round( value * scale ) / scale;
+
+        CborWriter_Init( &writer, buffer, sizeof( buffer ), TEST_VERSION );
+        CborWriter_BeginArray( &writer, CBOR_WRITER_NO_KEY );
+        CborWriter_AddNumber( &writer, CBOR_WRITER_NO_KEY, value, decimals );
+        CborWriter_EndArray( &writer );
+
+        if( prvSingleItem( &writer, &item ) == false )
+        {
+            TEST_FAIL_AT( __FILE__, __LINE__, "%.17g did not decode", value );
+            continue;
+        }
+
+        if( item.type == CBOR_TYPE_FLOAT )
+        {
+            /* Within half of the last digit, and no narrower float would do. */
+            TEST_ASSERT_WITHIN( tolerance * 1.0001, rounded, item.number );
+
+            if( item.floatSize >= 4U )
+            {
+                TEST_ASSERT( fabs( prvNearestHalf( rounded ) - rounded ) > tolerance * 0.9999 );
+            }
+            else
+            {
+                TEST_ASSERT( fabs( prvNearestHalf( rounded ) - rounded ) <= tolerance * 1.0001 );
+            }
+
+            if( item.floatSize == 8U )
+            {
+                TEST_ASSERT( fabs( ( double ) ( float ) rounded - rounded ) > tolerance * 0.9999 );
+            }
+        }
+        else
+        {
+            /* Integers only when the rounded value has no fraction. */
+            TEST_ASSERT( ( item.type == CBOR_TYPE_UNSIGNED ) || ( item.type == CBOR_TYPE_NEGATIVE ) );
+            TEST_ASSERT( rounded == floor( rounded ) );
+            TEST_ASSERT_WITHIN( 0.0, fabs( rounded ),
+                                ( item.type == CBOR_TYPE_UNSIGNED ) ? ( double ) item.argument : ( double ) item.argument + 1.0 );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Decimal_Fraction( void )
+{
+    CborWriter_t writer;
+
+    CborWriter_Init( &writer, buffer, sizeof( buffer ), TEST_VERSION );
+    CborWriter_BeginArray( &writer, CBOR_WRITER_NO_KEY );
+    CborWriter_AddDecimal( &writer, CBOR_WRITER_NO_KEY, 12345, 2 );
+    CborWriter_AddDecimal( &writer, CBOR_WRITER_NO_KEY, -5, 1 );
+    CborWriter_AddDecimal( &writer, CBOR_WRITER_NO_KEY, 47123400, 6 );
+    CborWriter_AddDecimal( &writer, CBOR_WRITER_NO_KEY, 1200, 2 );
+    CborWriter_AddDecimal( &writer, CBOR_WRITER_NO_KEY, 0, 3 );
+    CborWriter_AddDecimal( &writer, CBOR_WRITER_NO_KEY, -122654321, 6 );
+    CborWriter_EndArray( &writer );
+
+    TEST_ASSERT_DIAGNOSTIC( "[_ 4([-2, 12345]), 4([-1, -5]), 4([-4, 471234]), 12, 0, 4([-6, -122654321])]", writer );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Map_OmitsEmptyMembers( void )
+{
+    CborWriter_t writer;
+    const uint8_t bytes[] = { 0xDE, 0xAD };
+    char * pPosition = NULL;
+    size_t available = 0;
+
+    CborWriter_Init( &writer, buffer, sizeof( buffer ), TEST_VERSION );
+    CborWriter_BeginMap( &writer, CBOR_WRITER_NO_KEY );
+    CborWriter_AddText( &writer, 1, "VIN1" );
+    CborWriter_AddText( &writer, 2, "" );
+    CborWriter_AddNull( &writer, 3 );
+    CborWriter_AddBytes( &writer, 4, bytes, sizeof( bytes ) );
+    CborWriter_BeginMap( &writer, 5 );
+    CborWriter_BeginArray( &writer, 6 );
+    CborWriter_EndArray( &writer );
+    CborWriter_EndMap( &writer );
+    CborWriter_BeginArray( &writer, 300 );
+    CborWriter_AddText( &writer, CBOR_WRITER_NO_KEY, "" );
+    CborWriter_AddNull( &writer, CBOR_WRITER_NO_KEY );
+    CborWriter_EndArray( &writer );
+    pPosition = CborWriter_BeginText( &writer, 7, &available );
+    TEST_ASSERT( ( pPosition != NULL ) && ( available > 5U ) );
+    memcpy( pPosition, "path", 4 );
+    CborWriter_EndText( &writer, 4 );
+    CborWriter_EndMap( &writer );
+
+    TEST_ASSERT_DIAGNOSTIC( "{_ 1: \"VIN1\", 4: h'dead', 300: [_ \"\", null], 7: \"path\"}", writer );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Overflow_IsReported( void )
+{
+    CborWriter_t writer;
+    size_t size = 0;
+
+    for( size = 1; size < 12U; size++ )
+    {
+        CborWriter_Init( &writer, buffer, size, TEST_VERSION );
+        CborWriter_BeginMap( &writer, CBOR_WRITER_NO_KEY );
+        CborWriter_AddText( &writer, 1, "abcdef" );
+        CborWriter_EndMap( &writer );
+
+        /* Version, map, key, text head, 6 bytes and break are 11 bytes. */
+        TEST_ASSERT_EQUAL_INT( ( size < 11U ) ? -1 : 11, CborWriter_Finish( &writer ) );
+    }
+
+    CborWriter_Init( &writer, buffer, sizeof( buffer ), TEST_VERSION );
+    CborWriter_BeginMap( &writer, CBOR_WRITER_NO_KEY );
+    TEST_ASSERT_EQUAL_INT( -1, CborWriter_Finish( &writer ) );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    RUN_TEST( test_Head_IntegerWidths );
+    RUN_TEST( test_Head_StringWidths );
+    RUN_TEST( test_Number_WidthSelection );
+    RUN_TEST( test_Number_RoundTripIsSmallestExact );
+    RUN_TEST( test_Decimal_Fraction );
+    RUN_TEST( test_Map_OmitsEmptyMembers );
+    RUN_TEST( test_Overflow_IsReported );
+
+    return TEST_RESULT();
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,249 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file clock_service_utest.c
+ * @brief Tests of the timestamps of a trip replay against the time of the log.
+ *
+ * Built with TRIP_REPLAY_ENABLE, the test supplies the ticks and the replay
+ * clock: the uptime plus the time skipped by the waits, as in trip_replay.c.
+ * The GPS fixes come through the GPS service from a fake receiver.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "test_assert.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "obd_config.h"
+#include "clock_service.h"
+#include "gps_service.h"
+#include "trip_replay.h"
+
+/* 2024-05-01T12:00:00.00Z, the GPS time of the first log line. */
+#define TEST_GPS_DATE       ( 10524U )
+#define TEST_GPS_TIME       ( 12000000U )
+#define TEST_GPS_EPOCH_MS   ( 1714564800000ULL )
+
+/* A step of the task at speed 100: 10 ms waited and 990 ms skipped. */
+#define TEST_STEP_REAL_MS   ( 10U )
+#define TEST_STEP_LOG_MS    ( 1000U )
+#define TEST_STEPS          ( 600U )
+
+static uint32_t realTicksMs;
+static uint32_t skippedMs;
+
+static int fakeGpsDevice;
+static ObdGpsData_t fakeGpsData;
+static bool fakeGpsFix;
+static uint32_t fakeGpsPolls;
+
+/*-----------------------------------------------------------*/
+
+TickType_t xTaskGetTickCount( void )
+{
+    return realTicksMs;
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t TripReplay_NowMs( void )
+{
+    return realTicksMs + skippedMs;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xTaskNotifyGive( TaskHandle_t xTaskToNotify )
+{
+    return 1;
+}
+
+/*-----------------------------------------------------------*/
+
+bool GPSLib_Begin( Peripheral_Descriptor_t obdDevice )
+{
+    return true;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Reports fakeGpsData once per fakeGpsFix. */
+bool GPSLib_GetDataNMEA( Peripheral_Descriptor_t obdDevice,
+                         struct GpsNmeaParser * pParser,
+                         ObdGpsData_t * gpsData )
+{
+    bool retFix = fakeGpsFix;
+
+    fakeGpsPolls++;
+
+    if( retFix == true )
+    {
+        memcpy( gpsData, &fakeGpsData, sizeof( ObdGpsData_t ) );
+        fakeGpsFix = false;
+    }
+
+    return retFix;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvReplayStep( void )
+{
+    realTicksMs += TEST_STEP_REAL_MS;
+    skippedMs += TEST_STEP_LOG_MS - TEST_STEP_REAL_MS;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Replays TEST_STEPS seconds of log from the given uptime and checks every
+ * message time against the log. The clock is set from the first fix one step
+ * after it was read, as the telemetry task does. */
+static void prvReplayTrip( uint32_t startTicksMs )
+{
+    ObdGpsData_t gpsData = { 0 };
+    uint32_t fixAgeMs = 0;
+    uint32_t logStartTicksMs = 0;
+    uint32_t createdTicksMs = 0;
+    uint64_t logMs = 0;
+    char isoTime[ CLOCK_SERVICE_ISO_TIME_LENGTH + 1U ];
+    uint32_t step = 0;
+
+    realTicksMs = startTicksMs;
+    skippedMs = 0;
+    ClockService_Init();
+    TEST_ASSERT( GPSService_Start( &fakeGpsDevice ) == true );
+
+    fakeGpsData.date = TEST_GPS_DATE;
+    fakeGpsData.time = TEST_GPS_TIME;
+    fakeGpsFix = true;
+    fakeGpsPolls = 0;
+    GPSService_Poll();
+    logStartTicksMs = TripReplay_NowMs();
+
+    for( step = 1; step <= TEST_STEPS; step++ )
+    {
+        prvReplayStep();
+        GPSService_Poll();
+        createdTicksMs = TripReplay_NowMs();
+        logMs = ( uint64_t ) step * TEST_STEP_LOG_MS;
+
+        if( step == 1U )
+        {
+            /* 10 ms on the ticks, a whole step of the log. */
+            TEST_ASSERT( GPSService_GetLatestFix( &gpsData, &fixAgeMs ) == true );
+            TEST_ASSERT_EQUAL_INT( TEST_STEP_LOG_MS, fixAgeMs );
+            TEST_ASSERT( ClockService_SyncGps( &gpsData, fixAgeMs ) == true );
+        }
+
+        TEST_ASSERT_EQUAL_INT( logMs, createdTicksMs - logStartTicksMs );
+        TEST_ASSERT_EQUAL_INT( TEST_GPS_EPOCH_MS + logMs, ClockService_TicksToEpochMs( createdTicksMs ) );
+        TEST_ASSERT_EQUAL_INT( TEST_GPS_EPOCH_MS + logMs, ClockService_NowMs() );
+    }
+
+    TEST_ASSERT_EQUAL_INT( CLOCK_SERVICE_ISO_TIME_LENGTH,
+                           ClockService_Format( ClockService_TicksToEpochMs( createdTicksMs ),
+                                                isoTime, sizeof( isoTime ) ) );
+    TEST_ASSERT( strcmp( isoTime, "2024-05-01T12:10:00.0000Z" ) == 0 );
+
+    /* One read per second of log, none of the recorded fixes is skipped. */
+    TEST_ASSERT_EQUAL_INT( TEST_STEPS + 1U, fakeGpsPolls );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Replay_FollowsLog( void )
+{
+    prvReplayTrip( 5000U );
+}
+
+/*-----------------------------------------------------------*/
+
+/* The replay clock wraps before the uptime when the skipped time grows. */
+static void test_Replay_FollowsLogAcrossWrap( void )
+{
+    prvReplayTrip( UINT32_MAX - 100000U );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Without a source the clock is the replay uptime, not 49 days behind it. */
+static void test_Replay_UptimeWithoutSource( void )
+{
+    uint32_t createdTicksMs = 0;
+
+    realTicksMs = 5000U;
+    skippedMs = 0;
+    ClockService_Init();
+
+    prvReplayStep();
+    prvReplayStep();
+    createdTicksMs = TripReplay_NowMs();
+    realTicksMs += 3U;
+
+    TEST_ASSERT_EQUAL_INT( 7000U, ClockService_TicksToEpochMs( createdTicksMs ) );
+    TEST_ASSERT_EQUAL_INT( 7003U, ClockService_NowMs() );
+}
+
+/*-----------------------------------------------------------*/
+
+/* The GPS is read every GPS_SERVICE_POLL_INTERVAL_MS of log, and at once when resumed. */
+static void test_Replay_GpsPolledOnLogClock( void )
+{
+    realTicksMs = 5000U;
+    skippedMs = 0;
+    fakeGpsFix = false;
+    fakeGpsPolls = 0;
+    TEST_ASSERT( GPSService_Start( &fakeGpsDevice ) == true );
+
+    GPSService_Poll();
+    TEST_ASSERT_EQUAL_INT( 1U, fakeGpsPolls );
+
+    realTicksMs += GPS_SERVICE_POLL_INTERVAL_MS - 1U;
+    GPSService_Poll();
+    TEST_ASSERT_EQUAL_INT( 1U, fakeGpsPolls );
+
+    prvReplayStep();
+    GPSService_Poll();
+    TEST_ASSERT_EQUAL_INT( 2U, fakeGpsPolls );
+
+    GPSService_SetActive( false );
+    prvReplayStep();
+    prvReplayStep();
+    GPSService_Poll();
+    TEST_ASSERT_EQUAL_INT( 2U, fakeGpsPolls );
+
+    GPSService_SetActive( true );
+    GPSService_Poll();
+    TEST_ASSERT_EQUAL_INT( 3U, fakeGpsPolls );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    RUN_TEST( test_Replay_FollowsLog );
+    RUN_TEST( test_Replay_FollowsLogAcrossWrap );
+    RUN_TEST( test_Replay_UptimeWithoutSource );
+    RUN_TEST( test_Replay_GpsPolledOnLogClock );
+
+    return TEST_RESULT();
+}
+
+/*-----------------------------------------------------------*/
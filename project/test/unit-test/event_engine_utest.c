@@ -0,0 +1,214 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file event_engine_utest.c
+ * @brief Tests of the event rules, hysteresis and peak capture.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "test_assert.h"
+#include "event_engine.h"
+
+#define TEST_SIGNAL_ACCEL    ( 3U )
+#define TEST_SIGNAL_TEMP     ( 5U )
+
+static const EventRule_t testRules[] =
+{
+    { "harshAcceleration", TEST_SIGNAL_ACCEL, EVENT_RULE_ABOVE, 10.0, 2.0, 1000 },
+    { "harshBraking", TEST_SIGNAL_ACCEL, EVENT_RULE_BELOW, -8.0, 1.0, 500 },
+    { "overheat", TEST_SIGNAL_TEMP, EVENT_RULE_ABOVE, 110.0, 5.0, 0 }
+};
+
+#define TEST_RULE_COUNT      ( sizeof( testRules ) / sizeof( testRules[ 0 ] ) )
+
+static EventEngine_t engine;
+static Event_t events[ EVENT_ENGINE_MAX_RULES ];
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvUpdate( uint32_t signal,
+                           double value,
+                           uint64_t timeMs )
+{
+    return EventEngine_Update( &engine, signal, value, timeMs, events, EVENT_ENGINE_MAX_RULES );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Raise_AfterMinDuration( void )
+{
+    EventEngine_Init( &engine, testRules, TEST_RULE_COUNT );
+
+    /* Exactly at the threshold is beyond it. */
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, 10.0, 1000 ) );
+    TEST_ASSERT_EQUAL_INT( 1, EventEngine_GetActive( &engine ) );
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, 14.0, 1500 ) );
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, 12.0, 1999 ) );
+    TEST_ASSERT_EQUAL_INT( 1, prvUpdate( TEST_SIGNAL_ACCEL, 11.0, 2000 ) );
+
+    TEST_ASSERT_EQUAL_INT( 0, events[ 0 ].rule );
+    TEST_ASSERT_EQUAL_INT( 1000, events[ 0 ].startMs );
+    TEST_ASSERT_EQUAL_INT( 1000, events[ 0 ].durationMs );
+    TEST_ASSERT( events[ 0 ].peak == 14.0 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Raise_ShortEpisodeIgnored( void )
+{
+    EventEngine_Init( &engine, testRules, TEST_RULE_COUNT );
+
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, 15.0, 0 ) );
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, 15.0, 999 ) );
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, 7.9, 1000 ) );
+    TEST_ASSERT_EQUAL_INT( 0, EventEngine_GetActive( &engine ) );
+
+    /* A new episode counts from its own start. */
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, 11.0, 1500 ) );
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, 11.0, 2400 ) );
+    TEST_ASSERT_EQUAL_INT( 1, prvUpdate( TEST_SIGNAL_ACCEL, 11.0, 2500 ) );
+    TEST_ASSERT_EQUAL_INT( 1500, events[ 0 ].startMs );
+    TEST_ASSERT( events[ 0 ].peak == 11.0 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Hysteresis_OneEventPerEpisode( void )
+{
+    EventEngine_Init( &engine, testRules, TEST_RULE_COUNT );
+
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, 12.0, 0 ) );
+    TEST_ASSERT_EQUAL_INT( 1, prvUpdate( TEST_SIGNAL_ACCEL, 12.0, 1000 ) );
+
+    /* Hovering around the threshold within the band raises nothing. */
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, 9.0, 2000 ) );
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, 10.5, 3000 ) );
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, 8.0, 4000 ) );
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, 20.0, 9000 ) );
+    TEST_ASSERT_EQUAL_INT( 1, EventEngine_GetActive( &engine ) );
+
+    /* Back past the band, armed again. */
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, 7.99, 10000 ) );
+    TEST_ASSERT_EQUAL_INT( 0, EventEngine_GetActive( &engine ) );
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, 10.0, 11000 ) );
+    TEST_ASSERT_EQUAL_INT( 1, prvUpdate( TEST_SIGNAL_ACCEL, 10.0, 12000 ) );
+    TEST_ASSERT_EQUAL_INT( 11000, events[ 0 ].startMs );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Below_PeakIsLowest( void )
+{
+    EventEngine_Init( &engine, testRules, TEST_RULE_COUNT );
+
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, -8.5, 0 ) );
+    TEST_ASSERT_EQUAL_INT( 2, EventEngine_GetActive( &engine ) );
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, -12.0, 200 ) );
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, -9.0, 400 ) );
+    TEST_ASSERT_EQUAL_INT( 1, prvUpdate( TEST_SIGNAL_ACCEL, -8.0, 600 ) );
+    TEST_ASSERT_EQUAL_INT( 1, events[ 0 ].rule );
+    TEST_ASSERT_EQUAL_INT( 600, events[ 0 ].durationMs );
+    TEST_ASSERT( events[ 0 ].peak == -12.0 );
+
+    /* -7.5 is within the band of the braking rule. */
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, -7.5, 700 ) );
+    TEST_ASSERT_EQUAL_INT( 2, EventEngine_GetActive( &engine ) );
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, 0.0, 800 ) );
+    TEST_ASSERT_EQUAL_INT( 0, EventEngine_GetActive( &engine ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Signals_Separate( void )
+{
+    EventEngine_Init( &engine, testRules, TEST_RULE_COUNT );
+
+    /* No duration, raised on the first value. Other signals leave it alone. */
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, 115.0, 0 ) );
+    TEST_ASSERT_EQUAL_INT( 1, EventEngine_GetActive( &engine ) );
+    TEST_ASSERT_EQUAL_INT( 1, prvUpdate( TEST_SIGNAL_TEMP, 112.0, 0 ) );
+    TEST_ASSERT_EQUAL_INT( 2, events[ 0 ].rule );
+    TEST_ASSERT_EQUAL_INT( 0, events[ 0 ].durationMs );
+    TEST_ASSERT_EQUAL_INT( 5, EventEngine_GetActive( &engine ) );
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( 7U, 1000.0, 10 ) );
+
+    /* Reset keeps the table and clears the states. */
+    EventEngine_Reset( &engine );
+    TEST_ASSERT_EQUAL_INT( 0, EventEngine_GetActive( &engine ) );
+    TEST_ASSERT_EQUAL_INT( 1, prvUpdate( TEST_SIGNAL_TEMP, 112.0, 20 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_NoRoom_RaisedLater( void )
+{
+    EventEngine_Init( &engine, testRules, TEST_RULE_COUNT );
+
+    TEST_ASSERT_EQUAL_INT( 0, prvUpdate( TEST_SIGNAL_ACCEL, 11.0, 0 ) );
+    TEST_ASSERT_EQUAL_INT( 0, EventEngine_Update( &engine, TEST_SIGNAL_ACCEL, 16.0, 1000, NULL, 0 ) );
+
+    /* The peak went on while there was no room. */
+    TEST_ASSERT_EQUAL_INT( 1, prvUpdate( TEST_SIGNAL_ACCEL, 13.0, 1200 ) );
+    TEST_ASSERT_EQUAL_INT( 0, events[ 0 ].startMs );
+    TEST_ASSERT_EQUAL_INT( 1200, events[ 0 ].durationMs );
+    TEST_ASSERT( events[ 0 ].peak == 16.0 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Init_ClampsRuleCount( void )
+{
+    EventRule_t rules[ EVENT_ENGINE_MAX_RULES + 2U ];
+    uint32_t i = 0;
+
+    for( i = 0; i < ( EVENT_ENGINE_MAX_RULES + 2U ); i++ )
+    {
+        rules[ i ] = testRules[ 2 ];
+    }
+
+    EventEngine_Init( &engine, rules, EVENT_ENGINE_MAX_RULES + 2U );
+    TEST_ASSERT_EQUAL_INT( EVENT_ENGINE_MAX_RULES, engine.ruleCount );
+
+    /* All due on one value with room for three, the others follow. */
+    TEST_ASSERT_EQUAL_INT( 3, EventEngine_Update( &engine, TEST_SIGNAL_TEMP, 120.0, 0, events, 3 ) );
+    TEST_ASSERT_EQUAL_INT( 2, events[ 2 ].rule );
+    TEST_ASSERT_EQUAL_INT( EVENT_ENGINE_MAX_RULES - 3U, prvUpdate( TEST_SIGNAL_TEMP, 125.0, 10 ) );
+    TEST_ASSERT_EQUAL_INT( 3, events[ 0 ].rule );
+    TEST_ASSERT( events[ 0 ].peak == 125.0 );
+    TEST_ASSERT_EQUAL_INT( ( 1UL << EVENT_ENGINE_MAX_RULES ) - 1UL, EventEngine_GetActive( &engine ) );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    RUN_TEST( test_Raise_AfterMinDuration );
+    RUN_TEST( test_Raise_ShortEpisodeIgnored );
+    RUN_TEST( test_Hysteresis_OneEventPerEpisode );
+    RUN_TEST( test_Below_PeakIsLowest );
+    RUN_TEST( test_Signals_Separate );
+    RUN_TEST( test_NoRoom_RaisedLater );
+    RUN_TEST( test_Init_ClampsRuleCount );
+
+    return TEST_RESULT();
+}
+
+/*-----------------------------------------------------------*/
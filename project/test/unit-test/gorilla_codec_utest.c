@@ -0,0 +1,327 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file gorilla_codec_utest.c
+ * @brief Round trip tests of the Gorilla time series codec.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "test_assert.h"
+#include "gorilla_codec.h"
+
+#define TEST_SAMPLES_MAX    ( 1000U )
+
+static uint8_t stream[ GORILLA_MAX_BYTES( TEST_SAMPLES_MAX ) ];
+static uint32_t timestamps[ TEST_SAMPLES_MAX ];
+static float values[ TEST_SAMPLES_MAX ];
+static uint32_t randomState = 88172645U;
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRandom( void )
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+
+    return randomState;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Encode count samples into a buffer of GORILLA_MAX_BYTES, decode and compare
+ * bit for bit. Returns the stream length. */
+static size_t prvRoundTrip( uint16_t count )
+{
+    GorillaEncoder_t encoder;
+    GorillaDecoder_t decoder;
+    size_t length = 0;
+    uint32_t timestampMs = 0;
+    float value = 0.0f;
+    uint16_t i = 0;
+
+    GorillaEncoder_Init( &encoder, stream, GORILLA_MAX_BYTES( count ) );
+
+    for( i = 0; i < count; i++ )
+    {
+        TEST_ASSERT( GorillaEncoder_Append( &encoder, timestamps[ i ], values[ i ] ) == true );
+    }
+
+    length = GorillaEncoder_Finish( &encoder );
+    TEST_ASSERT( length <= GORILLA_MAX_BYTES( count ) );
+    TEST_ASSERT_EQUAL_INT( count, GorillaDecoder_Init( &decoder, stream, length ) );
+
+    for( i = 0; i < count; i++ )
+    {
+        if( GorillaDecoder_Next( &decoder, &timestampMs, &value ) == false )
+        {
+            TEST_FAIL_AT( __FILE__, __LINE__, "sample %u of %u not decoded", i, count );
+            break;
+        }
+
+        TEST_ASSERT_EQUAL_INT( timestamps[ i ], timestampMs );
+        TEST_ASSERT( memcmp( &value, &values[ i ], sizeof( float ) ) == 0 );
+    }
+
+    TEST_ASSERT( GorillaDecoder_Next( &decoder, &timestampMs, &value ) == false );
+
+    return length;
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_RoundTrip_Empty( void )
+{
+    TEST_ASSERT_EQUAL_INT( 2, prvRoundTrip( 0 ) );
+    timestamps[ 0 ] = 123456789U;
+    values[ 0 ] = -3.25f;
+    TEST_ASSERT_EQUAL_INT( 10, prvRoundTrip( 1 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_RoundTrip_ConstantSignal( void )
+{
+    size_t length = 0;
+    uint16_t i = 0;
+
+    for( i = 0; i < TEST_SAMPLES_MAX; i++ )
+    {
+        timestamps[ i ] = 5000U + ( i * 2000U );
+        values[ i ] = 92.0f;
+    }
+
+    /* The second sample sets the delta, then each one costs 2 bits. */
+    length = prvRoundTrip( TEST_SAMPLES_MAX );
+    TEST_ASSERT( ( length * 8U ) <= ( 80U + 18U + ( ( TEST_SAMPLES_MAX - 2U ) * 2U ) + 7U ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_RoundTrip_DeltaOfDeltaRanges( void )
+{
+    /* The edges of every timestamp bucket, both signs. */
+    const int32_t jitters[] = { 0, 63, -64, 64, -65, 255, -256, 256, -257, 2047, -2048, 2048, -2049, 1000000, -1000000 };
+    uint32_t timestampMs = 0xFFFF0000U;
+    int32_t delta = 1000;
+    uint16_t i = 0;
+
+    for( i = 0; i < ( sizeof( jitters ) / sizeof( jitters[ 0 ] ) ) * 2U; i++ )
+    {
+        /* Every other sample returns to the regular interval. */
+        delta = ( ( i % 2U ) == 0U ) ? 1000 + jitters[ i / 2U ] : 1000;
+        timestampMs += ( uint32_t ) delta;
+        timestamps[ i ] = timestampMs;
+        values[ i ] = ( float ) i;
+    }
+
+    /* Crosses 2^32 and wraps around. */
+    prvRoundTrip( i );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_RoundTrip_SpecialFloats( void )
+{
+    const uint32_t bits[] = { 0x00000000U, 0x80000000U, 0x7F800000U, 0xFF800000U, 0x7FC00001U, 0x00000001U, 0x7F7FFFFFU, 0x3F800000U };
+    uint16_t i = 0;
+
+    for( i = 0; i < ( sizeof( bits ) / sizeof( bits[ 0 ] ) ); i++ )
+    {
+        timestamps[ i ] = i * 10U;
+        memcpy( &values[ i ], &bits[ i ], sizeof( float ) );
+    }
+
+    prvRoundTrip( i );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_RoundTrip_RandomStreams( void )
+{
+    uint32_t timestampMs = 0;
+    float walk = 0.0f;
+    uint16_t count = 0;
+    uint16_t i = 0;
+    int stream_ = 0;
+
+    for( stream_ = 0; stream_ < 3000; stream_++ )
+    {
+        count = ( uint16_t ) ( prvRandom() % ( TEST_SAMPLES_MAX + 1U ) );
+        timestampMs = prvRandom();
+        walk = ( float ) ( prvRandom() % 1000U ) / 10.0f;
+
+        for( i = 0; i < count; i++ )
+        {
+            switch( stream_ % 3 )
+            {
+                case 0:
+                    /* Regular interval with a little jitter, a 0.1 step walk. */
+                    timestampMs += 2000U + ( prvRandom() % 21U ) - 10U;
+                    walk += ( float ) ( ( int32_t ) ( prvRandom() % 3U ) - 1 ) * 0.1f;
+                    values[ i ] = roundf( walk * 10.0f ) / 10.0f;
+                    break;
+
+                case 1:
+                    /* Irregular times and held values. */
+                    timestampMs += prvRandom() % 100000U;
+                    values[ i ] = ( ( prvRandom() % 4U ) == 0U ) ? ( float ) ( prvRandom() % 50U ) : walk;
+                    walk = values[ i ];
+                    break;
+
+                default:
+                    /* Any time, any bit pattern. */
+                    timestampMs = prvRandom();
+                    {
+                        uint32_t bits = prvRandom();
+                        memcpy( &values[ i ], &bits, sizeof( float ) );
+                    }
+                    break;
+            }
+
+            timestamps[ i ] = timestampMs;
+        }
+
+        prvRoundTrip( count );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Encoder_FullBufferKeepsStream( void )
+{
+    GorillaEncoder_t encoder;
+    GorillaDecoder_t decoder;
+    uint32_t timestampMs = 0;
+    float value = 0.0f;
+    uint16_t appended = 0;
+    uint16_t i = 0;
+    size_t length = 0;
+
+    for( i = 0; i < 100U; i++ )
+    {
+        uint32_t bits = prvRandom();
+
+        timestamps[ i ] = prvRandom();
+        memcpy( &values[ i ], &bits, sizeof( float ) );
+    }
+
+    /* Too small for the header. */
+    GorillaEncoder_Init( &encoder, stream, 9 );
+    TEST_ASSERT( GorillaEncoder_Append( &encoder, 1, 1.0f ) == false );
+    TEST_ASSERT_EQUAL_INT( 0, GorillaEncoder_Finish( &encoder ) );
+
+    GorillaEncoder_Init( &encoder, stream, 64 );
+
+    while( ( appended < 100U ) && ( GorillaEncoder_Append( &encoder, timestamps[ appended ], values[ appended ] ) == true ) )
+    {
+        appended++;
+    }
+
+    TEST_ASSERT( ( appended > 1U ) && ( appended < 100U ) );
+    length = GorillaEncoder_Finish( &encoder );
+    TEST_ASSERT( length <= 64U );
+
+    /* What was accepted decodes, the refused sample left no trace. */
+    TEST_ASSERT_EQUAL_INT( appended, GorillaDecoder_Init( &decoder, stream, length ) );
+
+    for( i = 0; i < appended; i++ )
+    {
+        TEST_ASSERT( GorillaDecoder_Next( &decoder, &timestampMs, &value ) == true );
+        TEST_ASSERT_EQUAL_INT( timestamps[ i ], timestampMs );
+        TEST_ASSERT( memcmp( &value, &values[ i ], sizeof( float ) ) == 0 );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Decoder_TruncatedAndGarbage( void )
+{
+    GorillaDecoder_t decoder;
+    uint32_t timestampMs = 0;
+    float value = 0.0f;
+    size_t length = 0;
+    size_t cut = 0;
+    uint16_t decoded = 0;
+    uint16_t i = 0;
+    int round_ = 0;
+
+    for( i = 0; i < 50U; i++ )
+    {
+        timestamps[ i ] = i * 1000U;
+        values[ i ] = ( float ) i * 1.5f;
+    }
+
+    length = prvRoundTrip( 50 );
+
+    /* A cut stream ends early instead of reading past its end. */
+    for( cut = 0; cut < length; cut++ )
+    {
+        decoded = 0;
+        ( void ) GorillaDecoder_Init( &decoder, stream, cut );
+
+        while( GorillaDecoder_Next( &decoder, &timestampMs, &value ) == true )
+        {
+            decoded++;
+        }
+
+        TEST_ASSERT( decoded < 50U );
+    }
+
+    /* Random bytes decode to something or stop, within the length. */
+    for( round_ = 0; round_ < 20000; round_++ )
+    {
+        length = 2U + ( prvRandom() % 64U );
+
+        for( cut = 0; cut < length; cut++ )
+        {
+            stream[ cut ] = ( uint8_t ) prvRandom();
+        }
+
+        decoded = 0;
+        ( void ) GorillaDecoder_Init( &decoder, stream, length );
+
+        while( GorillaDecoder_Next( &decoder, &timestampMs, &value ) == true )
+        {
+            decoded++;
+        }
+
+        TEST_ASSERT( decoded <= ( ( length * 8U ) / 2U ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    RUN_TEST( test_RoundTrip_Empty );
+    RUN_TEST( test_RoundTrip_ConstantSignal );
+    RUN_TEST( test_RoundTrip_DeltaOfDeltaRanges );
+    RUN_TEST( test_RoundTrip_SpecialFloats );
+    RUN_TEST( test_RoundTrip_RandomStreams );
+    RUN_TEST( test_Encoder_FullBufferKeepsStream );
+    RUN_TEST( test_Decoder_TruncatedAndGarbage );
+
+    return TEST_RESULT();
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,270 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file gps_fusion_utest.c
+ * @brief Tests of the GPS and OBD speed fusion on simulated drives.
+ *
+ * A drive steps every 100 ms with the OBD speed every 500 ms and a GPS fix
+ * every second. Fixes are exact, the errors come from the filter alone.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "test_assert.h"
+#include "gps_fusion.h"
+
+#define TEST_STEP_MS            ( 100U )
+#define TEST_SPEED_EVERY_MS     ( 500U )
+#define TEST_FIX_EVERY_MS       ( 1000U )
+
+#define TEST_ORIGIN_LATITUDE    ( 47000000 )
+#define TEST_ORIGIN_LONGITUDE   ( 8000000 )
+#define TEST_METRES_PER_UDEG    ( 0.11131949 )
+#define TEST_PI                 ( 3.14159265358979 )
+
+/* The simulated vehicle in metres from the origin. */
+typedef struct TestVehicle
+{
+    double east;
+    double north;
+    double speed;       /* m/s */
+    double course;      /* Degree, 0 is north. */
+} TestVehicle_t;
+
+static GpsFusion_t fusion;
+static TestVehicle_t vehicle;
+static uint32_t nowMs;
+
+/*-----------------------------------------------------------*/
+
+static double prvMetresPerUdegLongitude( void )
+{
+    return TEST_METRES_PER_UDEG * cos( ( double ) TEST_ORIGIN_LATITUDE / 1e6 * TEST_PI / 180.0 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvToGlobal( double east,
+                         double north,
+                         int32_t * pLatitude,
+                         int32_t * pLongitude )
+{
+    *pLatitude = TEST_ORIGIN_LATITUDE + ( int32_t ) lround( north / TEST_METRES_PER_UDEG );
+    *pLongitude = TEST_ORIGIN_LONGITUDE + ( int32_t ) lround( east / prvMetresPerUdegLongitude() );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Distance of the fused position from the vehicle in metres. */
+static double prvError( void )
+{
+    int32_t latitude = 0;
+    int32_t longitude = 0;
+    float heading = 0.0f;
+    double east = 0.0;
+    double north = 0.0;
+
+    TEST_ASSERT( GPSFusion_GetState( &fusion, &latitude, &longitude, &heading ) == true );
+    east = ( double ) ( longitude - TEST_ORIGIN_LONGITUDE ) * prvMetresPerUdegLongitude();
+    north = ( double ) ( latitude - TEST_ORIGIN_LATITUDE ) * TEST_METRES_PER_UDEG;
+
+    return hypot( east - vehicle.east, north - vehicle.north );
+}
+
+/*-----------------------------------------------------------*/
+
+static double prvHeadingError( double expected )
+{
+    double error = fabs( ( double ) fusion.heading - expected );
+
+    return ( error > 180.0 ) ? ( 360.0 - error ) : error;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvStart( void )
+{
+    int32_t latitude = 0;
+    int32_t longitude = 0;
+
+    memset( &vehicle, 0, sizeof( vehicle ) );
+    nowMs = 1000U;
+    GPSFusion_Init( &fusion );
+    prvToGlobal( 0.0, 0.0, &latitude, &longitude );
+    GPSFusion_UpdateFix( &fusion, latitude, longitude, 10, nowMs );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Drive for a time. The fix reaches the filter lagMs after it was taken, from
+ * where the vehicle was then. Returns the largest error after settleMs. */
+static double prvDrive( uint32_t durationMs,
+                        double turnRateDps,
+                        bool withFixes,
+                        bool withCourse,
+                        uint32_t lagMs,
+                        uint32_t settleMs )
+{
+    double maxError = 0.0;
+    double lagEast = 0.0;
+    double lagNorth = 0.0;
+    double courseRad = 0.0;
+    int32_t latitude = 0;
+    int32_t longitude = 0;
+    uint32_t elapsedMs = 0;
+
+    for( elapsedMs = TEST_STEP_MS; elapsedMs <= durationMs; elapsedMs += TEST_STEP_MS )
+    {
+        nowMs += TEST_STEP_MS;
+        vehicle.course = fmod( vehicle.course + ( turnRateDps * TEST_STEP_MS / 1000.0 ) + 360.0, 360.0 );
+        courseRad = vehicle.course * TEST_PI / 180.0;
+        vehicle.east += vehicle.speed * sin( courseRad ) * TEST_STEP_MS / 1000.0;
+        vehicle.north += vehicle.speed * cos( courseRad ) * TEST_STEP_MS / 1000.0;
+
+        GPSFusion_Predict( &fusion, nowMs );
+
+        if( ( nowMs % TEST_SPEED_EVERY_MS ) == 0U )
+        {
+            GPSFusion_UpdateSpeed( &fusion, ( float ) ( vehicle.speed * 3.6 ) );
+        }
+
+        if( ( withFixes == true ) && ( ( nowMs % TEST_FIX_EVERY_MS ) == 0U ) )
+        {
+            /* On a straight line the vehicle was this far back at the fix. */
+            lagEast = vehicle.east - ( vehicle.speed * sin( courseRad ) * lagMs / 1000.0 );
+            lagNorth = vehicle.north - ( vehicle.speed * cos( courseRad ) * lagMs / 1000.0 );
+            prvToGlobal( lagEast, lagNorth, &latitude, &longitude );
+            GPSFusion_UpdateFix( &fusion, latitude, longitude, 10, nowMs - lagMs );
+
+            if( withCourse == true )
+            {
+                GPSFusion_UpdateCourse( &fusion, ( float ) vehicle.course, ( float ) ( vehicle.speed * 3.6 ) );
+            }
+        }
+
+        if( ( elapsedMs >= settleMs ) && ( prvError() > maxError ) )
+        {
+            maxError = prvError();
+        }
+    }
+
+    return maxError;
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_StraightLine( void )
+{
+    prvStart();
+    vehicle.speed = 20.0;
+    vehicle.course = 90.0;
+
+    TEST_ASSERT_WITHIN( 3.0, 0.0, prvDrive( 60000U, 0.0, true, true, 0U, 10000U ) );
+    TEST_ASSERT_WITHIN( 2.0, 0.0, prvHeadingError( 90.0 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/* The receiver course sets the heading at the start, the speed does not pull
+ * the path north. */
+static void test_StartFromStandstill( void )
+{
+    prvStart();
+    TEST_ASSERT( fusion.headingValid == false );
+
+    /* Before any heading the OBD speed is not applied. */
+    vehicle.speed = 5.0;
+    vehicle.course = 135.0;
+    ( void ) prvDrive( 900U, 0.0, false, false, 0U, 0U );
+    TEST_ASSERT( fusion.north.velocity > -0.1f );
+    TEST_ASSERT( fusion.north.velocity < 0.1f );
+
+    TEST_ASSERT_WITHIN( 3.0, 0.0, prvDrive( 20000U, 0.0, true, true, 0U, 0U ) );
+    TEST_ASSERT( fusion.headingValid == true );
+    TEST_ASSERT_WITHIN( 2.0, 0.0, prvHeadingError( 135.0 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Turn( void )
+{
+    prvStart();
+    vehicle.speed = 15.0;
+    vehicle.course = 90.0;
+
+    ( void ) prvDrive( 20000U, 0.0, true, true, 0U, 0U );
+
+    /* A 90 degree left turn in 10 s, then north. */
+    TEST_ASSERT_WITHIN( 8.0, 0.0, prvDrive( 10000U, -9.0, true, true, 0U, 0U ) );
+    TEST_ASSERT_WITHIN( 3.0, 0.0, prvDrive( 20000U, 0.0, true, true, 0U, 10000U ) );
+    TEST_ASSERT_WITHIN( 2.0, 0.0, prvHeadingError( 0.0 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Dead reckoning on the OBD speed and the last heading. */
+static void test_Dropout( void )
+{
+    uint32_t lastFixMs = 0;
+
+    prvStart();
+    vehicle.speed = 25.0;
+    vehicle.course = 30.0;
+
+    ( void ) prvDrive( 30000U, 0.0, true, true, 0U, 0U );
+    lastFixMs = fusion.lastFixMs;
+
+    /* 750 m without a fix. */
+    TEST_ASSERT_WITHIN( 15.0, 0.0, prvDrive( 30000U, 0.0, false, false, 0U, 0U ) );
+    TEST_ASSERT_EQUAL_INT( lastFixMs, fusion.lastFixMs );
+    TEST_ASSERT_WITHIN( 2.0, 0.0, prvHeadingError( 30.0 ) );
+
+    /* The fixes pull it back. */
+    TEST_ASSERT_WITHIN( 3.0, 0.0, prvDrive( 20000U, 0.0, true, true, 0U, 10000U ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/* A fix a second old at 30 m/s is 30 m behind, applied at its time it is not. */
+static void test_LateFix( void )
+{
+    prvStart();
+    vehicle.speed = 30.0;
+    vehicle.course = 0.0;
+
+    TEST_ASSERT_WITHIN( 3.0, 0.0, prvDrive( 60000U, 0.0, true, true, 1000U, 15000U ) );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    RUN_TEST( test_StraightLine );
+    RUN_TEST( test_StartFromStandstill );
+    RUN_TEST( test_Turn );
+    RUN_TEST( test_Dropout );
+    RUN_TEST( test_LateFix );
+
+    return TEST_RESULT();
+}
+
+/*-----------------------------------------------------------*/
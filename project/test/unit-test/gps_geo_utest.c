@@ -0,0 +1,224 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file gps_geo_utest.c
+ * @brief Accuracy of the fixed-point geodetic helpers against double precision.
+ */
+
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+
+#include "test_assert.h"
+#include "gps_geo.h"
+
+/* The sphere behind the 111319.49 m per degree of gps_geo.c. */
+#define EARTH_RADIUS_M    ( 6378137.0 )
+#define DEG_TO_RAD        ( M_PI / 180.0 )
+
+static uint32_t randomState = 12345U;
+
+/*-----------------------------------------------------------*/
+
+static int32_t prvRandom( int32_t low,
+                          int32_t high )
+{
+    randomState = ( randomState * 1103515245U ) + 12345U;
+
+    return low + ( int32_t ) ( ( ( uint64_t ) ( randomState >> 1 ) * ( uint64_t ) ( high - low ) ) >> 31 );
+}
+
+/*-----------------------------------------------------------*/
+
+static double prvHaversineMm( int32_t lat1E6,
+                              int32_t lng1E6,
+                              int32_t lat2E6,
+                              int32_t lng2E6 )
+{
+    double lat1 = lat1E6 * 1e-6 * DEG_TO_RAD;
+    double lat2 = lat2E6 * 1e-6 * DEG_TO_RAD;
+    double dLat = lat2 - lat1;
+    double dLng = ( lng2E6 - ( double ) lng1E6 ) * 1e-6 * DEG_TO_RAD;
+    double a = sin( dLat / 2 ) * sin( dLat / 2 ) + cos( lat1 ) * cos( lat2 ) * sin( dLng / 2 ) * sin( dLng / 2 );
+
+    return 2.0 * EARTH_RADIUS_M * 1000.0 * atan2( sqrt( a ), sqrt( 1.0 - a ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static double prvEquirectangularMm( int32_t lat1E6,
+                                    int32_t lng1E6,
+                                    int32_t lat2E6,
+                                    int32_t lng2E6 )
+{
+    double meanLat = ( lat1E6 + ( double ) lat2E6 ) / 2.0 * 1e-6 * DEG_TO_RAD;
+    double east = ( lng2E6 - ( double ) lng1E6 ) * 1e-6 * DEG_TO_RAD * cos( meanLat );
+    double north = ( lat2E6 - ( double ) lat1E6 ) * 1e-6 * DEG_TO_RAD;
+
+    return EARTH_RADIUS_M * 1000.0 * sqrt( east * east + north * north );
+}
+
+/*-----------------------------------------------------------*/
+
+static double prvBearingDegrees( int32_t lat1E6,
+                                 int32_t lng1E6,
+                                 int32_t lat2E6,
+                                 int32_t lng2E6 )
+{
+    double lat1 = lat1E6 * 1e-6 * DEG_TO_RAD;
+    double lat2 = lat2E6 * 1e-6 * DEG_TO_RAD;
+    double dLng = ( lng2E6 - ( double ) lng1E6 ) * 1e-6 * DEG_TO_RAD;
+    double bearing = atan2( sin( dLng ) * cos( lat2 ),
+                            cos( lat1 ) * sin( lat2 ) - sin( lat1 ) * cos( lat2 ) * cos( dLng ) ) / DEG_TO_RAD;
+
+    return ( bearing < 0.0 ) ? bearing + 360.0 : bearing;
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Cosine_MatchesLibm( void )
+{
+    int32_t angleE6 = 0;
+
+    for( angleE6 = -89999999; angleE6 < 90000000; angleE6 += 123457 )
+    {
+        TEST_ASSERT_WITHIN( 2.0, 32768.0 * cos( angleE6 * 1e-6 * DEG_TO_RAD ), GPSGeo_CosQ15( angleE6 ) );
+    }
+
+    TEST_ASSERT_EQUAL_INT( 32768, GPSGeo_CosQ15( 0 ) );
+    TEST_ASSERT_EQUAL_INT( 0, GPSGeo_CosQ15( 90000000 ) );
+    TEST_ASSERT_EQUAL_INT( 0, GPSGeo_CosQ15( -120000000 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Distance_ShortSegments( void )
+{
+    int i = 0;
+
+    /* Segments up to about 11 km between 70 degree south and north. */
+    for( i = 0; i < 100000; i++ )
+    {
+        int32_t lat1 = prvRandom( -70000000, 70000000 );
+        int32_t lng1 = prvRandom( -180000000, 180000000 );
+        int32_t lat2 = lat1 + prvRandom( -100000, 100000 );
+        int32_t lng2 = lng1 + prvRandom( -100000, 100000 );
+        double expected = prvHaversineMm( lat1, lng1, lat2, lng2 );
+
+        TEST_ASSERT_WITHIN( expected * 0.0005 + 2.0, expected, GPSGeo_DistanceMm( lat1, lng1, lat2, lng2 ) );
+    }
+
+    TEST_ASSERT_EQUAL_INT( 0, GPSGeo_DistanceMm( 47123456, 8123456, 47123456, 8123456 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Distance_CrossesAntimeridian( void )
+{
+    double expected = prvHaversineMm( 10000000, 179500000, 10000000, 180500000 );
+
+    TEST_ASSERT_WITHIN( expected * 0.0005, expected, GPSGeo_DistanceMm( 10000000, 179500000, 10000000, -179500000 ) );
+    TEST_ASSERT_WITHIN( expected * 0.0005, expected, GPSGeo_DistanceMm( 10000000, -179500000, 10000000, 179500000 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Distance_LongRange( void )
+{
+    double expected = 0.0;
+
+    /* Along the equator and a meridian the approximation is exact on the sphere. */
+    expected = prvHaversineMm( 0, 0, 0, 35000000 );
+    TEST_ASSERT_WITHIN( expected * 0.0001, expected, GPSGeo_DistanceMm( 0, 0, 0, 35000000 ) );
+    expected = prvHaversineMm( -17500000, 12000000, 17500000, 12000000 );
+    TEST_ASSERT_WITHIN( expected * 0.0001, expected, GPSGeo_DistanceMm( -17500000, 12000000, 17500000, 12000000 ) );
+
+    /* Offsets past 2^31 mm on both axes. */
+    expected = prvEquirectangularMm( 0, 0, 25000000, 25000000 );
+    TEST_ASSERT_WITHIN( expected * 0.0005, expected, GPSGeo_DistanceMm( 0, 0, 25000000, 25000000 ) );
+    expected = prvEquirectangularMm( -10000000, -20000000, 15000000, 5000000 );
+    TEST_ASSERT_WITHIN( expected * 0.0005, expected, GPSGeo_DistanceMm( -10000000, -20000000, 15000000, 5000000 ) );
+
+    /* 6679 km saturates instead of wrapping. */
+    TEST_ASSERT_EQUAL_INT( UINT32_MAX, GPSGeo_DistanceMm( 0, 0, 60000000, 0 ) );
+    TEST_ASSERT_EQUAL_INT( UINT32_MAX, GPSGeo_DistanceMm( -90000000, 0, 90000000, 0 ) );
+    TEST_ASSERT_EQUAL_INT( UINT32_MAX, GPSGeo_DistanceMm( 0, 0, 0, 180000000 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Bearing_ShortSegments( void )
+{
+    int i = 0;
+
+    for( i = 0; i < 100000; i++ )
+    {
+        int32_t lat1 = prvRandom( -70000000, 70000000 );
+        int32_t lng1 = prvRandom( -179000000, 179000000 );
+        int32_t lat2 = lat1 + prvRandom( -100000, 100000 );
+        int32_t lng2 = lng1 + prvRandom( -100000, 100000 );
+        double expected = prvBearingDegrees( lat1, lng1, lat2, lng2 );
+        double actual = GPSGeo_BearingCentiDegrees( lat1, lng1, lat2, lng2 ) / 100.0;
+        double error = fabs( expected - actual );
+
+        /* Skip segments too short for a meaningful heading. */
+        if( prvHaversineMm( lat1, lng1, lat2, lng2 ) < 10000.0 )
+        {
+            continue;
+        }
+
+        error = ( error > 180.0 ) ? 360.0 - error : error;
+        TEST_ASSERT_WITHIN( 0.2, 0.0, error );
+    }
+
+    TEST_ASSERT_EQUAL_INT( 0, GPSGeo_BearingCentiDegrees( 0, 0, 1000, 0 ) );
+    TEST_ASSERT_EQUAL_INT( 9000, GPSGeo_BearingCentiDegrees( 0, 0, 0, 1000 ) );
+    TEST_ASSERT_EQUAL_INT( 18000, GPSGeo_BearingCentiDegrees( 0, 0, -1000, 0 ) );
+    TEST_ASSERT_EQUAL_INT( 27000, GPSGeo_BearingCentiDegrees( 0, 0, 0, -1000 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Format_Microdegrees( void )
+{
+    char buffer[ GPS_GEO_STRING_MAX ];
+
+    GPSGeo_FormatMicrodegrees( buffer, sizeof( buffer ), -180000000 );
+    TEST_ASSERT( strcmp( buffer, "-180.000000" ) == 0 );
+    GPSGeo_FormatMicrodegrees( buffer, sizeof( buffer ), 47000012 );
+    TEST_ASSERT( strcmp( buffer, "47.000012" ) == 0 );
+    GPSGeo_FormatMicrodegrees( buffer, sizeof( buffer ), -5 );
+    TEST_ASSERT( strcmp( buffer, "-0.000005" ) == 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    RUN_TEST( test_Cosine_MatchesLibm );
+    RUN_TEST( test_Distance_ShortSegments );
+    RUN_TEST( test_Distance_CrossesAntimeridian );
+    RUN_TEST( test_Distance_LongRange );
+    RUN_TEST( test_Bearing_ShortSegments );
+    RUN_TEST( test_Format_Microdegrees );
+
+    return TEST_RESULT();
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,324 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file gps_nmea_utest.c
+ * @brief Tests of the NMEA sentence parser on recorded and malformed streams.
+ */
+
+#include <stdio.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "test_assert.h"
+#include "FreeRTOS_IO.h"
+#include "gps_library.h"
+#include "gps_nmea.h"
+
+#define TEST_RMC    "GPRMC,123519.00,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W"
+#define TEST_GGA    "GNGGA,123520.00,4807.038,S,01131.000,W,1,08,0.9,545.4,M,46.9,M,,"
+#define TEST_GSA    "GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1"
+#define TEST_VTG    "GPVTG,054.7,T,034.4,M,005.5,N,010.2,K,A"
+
+/* 48 deg 07.038 min and 11 deg 31.000 min in microdegrees. */
+#define TEST_LAT    ( 48117300 )
+#define TEST_LNG    ( 11516667 )
+
+static GpsNmeaParser_t parser;
+static char sentence[ 160 ];
+
+/*-----------------------------------------------------------*/
+
+/* Frame a sentence body with its checksum. */
+static const char * prvFrame( const char * pBody )
+{
+    uint8_t checksum = 0;
+    const char * p = NULL;
+
+    for( p = pBody; *p != '\0'; p++ )
+    {
+        checksum ^= ( uint8_t ) *p;
+    }
+
+    snprintf( sentence, sizeof( sentence ), "$%s*%02X\r\n", pBody, ( unsigned int ) checksum );
+
+    return sentence;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Feed bytes and return the last completed sentence, NONE if there is none. */
+static GpsNmeaSentence_t prvFeed( const char * pBytes )
+{
+    GpsNmeaSentence_t lastSentence = GPS_NMEA_SENTENCE_NONE;
+    GpsNmeaSentence_t parsed = GPS_NMEA_SENTENCE_NONE;
+
+    for( ; *pBytes != '\0'; pBytes++ )
+    {
+        parsed = GPSNmea_ParseByte( &parser, *pBytes );
+
+        if( parsed != GPS_NMEA_SENTENCE_NONE )
+        {
+            lastSentence = parsed;
+        }
+    }
+
+    return lastSentence;
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_RMC_Fields( void )
+{
+    ObdGpsData_t fix = { 0 };
+
+    GPSNmea_Init( &parser );
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_RMC, prvFeed( prvFrame( TEST_RMC ) ) );
+    TEST_ASSERT( GPSNmea_GetFix( &parser, &fix ) == true );
+
+    TEST_ASSERT_EQUAL_INT( 12351900, fix.time );
+    TEST_ASSERT_EQUAL_INT( 230394, fix.date );
+    TEST_ASSERT_EQUAL_INT( TEST_LAT, fix.lat );
+    TEST_ASSERT_EQUAL_INT( TEST_LNG, fix.lng );
+    TEST_ASSERT_WITHIN( 1e-9, 22.4, fix.speed );
+    TEST_ASSERT_EQUAL_INT( 84, fix.heading );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_GGA_FieldsSouthWest( void )
+{
+    ObdGpsData_t fix = { 0 };
+
+    GPSNmea_Init( &parser );
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_GGA, prvFeed( prvFrame( TEST_GGA ) ) );
+    TEST_ASSERT( GPSNmea_GetFix( &parser, &fix ) == true );
+
+    TEST_ASSERT_EQUAL_INT( 12352000, fix.time );
+    TEST_ASSERT_EQUAL_INT( -TEST_LAT, fix.lat );
+    TEST_ASSERT_EQUAL_INT( -TEST_LNG, fix.lng );
+    TEST_ASSERT_EQUAL_INT( 1, fix.fixQuality );
+    TEST_ASSERT_EQUAL_INT( 8, fix.sat );
+    TEST_ASSERT_EQUAL_INT( 9, fix.hdop );
+    TEST_ASSERT_WITHIN( 1e-9, 545.4, fix.alt );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_GSA_VTG_Fields( void )
+{
+    ObdGpsData_t fix = { 0 };
+
+    GPSNmea_Init( &parser );
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_GSA, prvFeed( prvFrame( TEST_GSA ) ) );
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_VTG, prvFeed( prvFrame( TEST_VTG ) ) );
+
+    /* Neither reports a position. */
+    TEST_ASSERT( GPSNmea_GetFix( &parser, &fix ) == false );
+    TEST_ASSERT_EQUAL_INT( 3, fix.fixMode );
+    TEST_ASSERT_EQUAL_INT( 13, fix.hdop );
+    TEST_ASSERT_EQUAL_INT( 54, fix.heading );
+    TEST_ASSERT_WITHIN( 1e-9, 5.5, fix.speed );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Checksum_BadAndMissing( void )
+{
+    ObdGpsData_t fix = { 0 };
+    char body[ 160 ];
+
+    GPSNmea_Init( &parser );
+
+    /* Last checksum digit off by one. */
+    strcpy( body, prvFrame( TEST_RMC ) );
+    body[ strlen( body ) - 3U ] = ( body[ strlen( body ) - 3U ] == '0' ) ? '1' : '0';
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_INVALID, prvFeed( body ) );
+
+    /* No checksum, the line ends in the body. */
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_INVALID, prvFeed( "$" TEST_RMC "\r\n" ) );
+
+    /* Not a hex digit. */
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_INVALID, prvFeed( "$" TEST_RMC "*G1\r\n" ) );
+
+    TEST_ASSERT( GPSNmea_GetFix( &parser, &fix ) == false );
+    TEST_ASSERT_EQUAL_INT( 0, fix.lat );
+    TEST_ASSERT_EQUAL_INT( 3, fix.errors );
+    TEST_ASSERT_EQUAL_INT( 0, fix.sentences );
+
+    /* Lower case hex is accepted. */
+    strcpy( body, prvFrame( TEST_GGA ) );
+    body[ strlen( body ) - 4U ] = ( char ) tolower( ( unsigned char ) body[ strlen( body ) - 4U ] );
+    body[ strlen( body ) - 3U ] = ( char ) tolower( ( unsigned char ) body[ strlen( body ) - 3U ] );
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_GGA, prvFeed( body ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_SplitAcrossReads( void )
+{
+    ObdGpsData_t fix = { 0 };
+    char stream[ 320 ];
+    char secondRead[ 320 ];
+    size_t split = 0;
+
+    strcpy( stream, prvFrame( TEST_GSA ) );
+    strcat( stream, prvFrame( TEST_RMC ) );
+
+    /* Every split point of two sentences gives the same result. */
+    for( split = 1; split < strlen( stream ); split++ )
+    {
+        GPSNmea_Init( &parser );
+
+        strcpy( secondRead, &stream[ split ] );
+        stream[ split ] = '\0';
+        ( void ) prvFeed( stream );
+        ( void ) prvFeed( secondRead );
+        strcat( stream, secondRead );
+
+        TEST_ASSERT( GPSNmea_GetFix( &parser, &fix ) == true );
+        TEST_ASSERT_EQUAL_INT( TEST_LAT, fix.lat );
+        TEST_ASSERT_EQUAL_INT( 3, fix.fixMode );
+        TEST_ASSERT_EQUAL_INT( 2, fix.sentences );
+        TEST_ASSERT_EQUAL_INT( 0, fix.errors );
+    }
+
+    /* A read that starts in the middle of a sentence skips to the next one. */
+    GPSNmea_Init( &parser );
+    strcpy( stream, prvFrame( TEST_GSA ) );
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_NONE, prvFeed( &stream[ 10 ] ) );
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_RMC, prvFeed( prvFrame( TEST_RMC ) ) );
+    TEST_ASSERT_EQUAL_INT( 0, parser.fix.errors );
+
+    /* A sentence cut off by the next start delimiter is an error. */
+    GPSNmea_Init( &parser );
+    strcpy( stream, prvFrame( TEST_GSA ) );
+    stream[ 20 ] = '\0';
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_NONE, prvFeed( stream ) );
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_RMC, prvFeed( prvFrame( TEST_RMC ) ) );
+    TEST_ASSERT_EQUAL_INT( 1, parser.fix.errors );
+    TEST_ASSERT_EQUAL_INT( 1, parser.fix.sentences );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Overlong_Rejected( void )
+{
+    ObdGpsData_t fix = { 0 };
+    char body[ 160 ];
+
+    GPSNmea_Init( &parser );
+
+    memset( body, 0, sizeof( body ) );
+    strcpy( body, "GPTXT," );
+    memset( &body[ 6 ], 'A', GPS_NMEA_SENTENCE_MAX );
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_INVALID, prvFeed( prvFrame( body ) ) );
+    TEST_ASSERT_EQUAL_INT( 1, parser.fix.errors );
+
+    /* The longest sentence that fits is still parsed. */
+    memset( body, 0, sizeof( body ) );
+    strcpy( body, "GPTXT," );
+    memset( &body[ 6 ], 'A', GPS_NMEA_SENTENCE_MAX - 1 - 6 );
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_OTHER, prvFeed( prvFrame( body ) ) );
+
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_RMC, prvFeed( prvFrame( TEST_RMC ) ) );
+    TEST_ASSERT( GPSNmea_GetFix( &parser, &fix ) == true );
+    TEST_ASSERT_EQUAL_INT( 1, fix.errors );
+    TEST_ASSERT_EQUAL_INT( 2, fix.sentences );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_EmptyFields( void )
+{
+    ObdGpsData_t fix = { 0 };
+
+    GPSNmea_Init( &parser );
+
+    /* Before the first fix every field is empty. */
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_RMC, prvFeed( prvFrame( "GPRMC,,V,,,,,,,,,,N" ) ) );
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_GGA, prvFeed( prvFrame( "GPGGA,,,,,,0,00,99.99,,,,,," ) ) );
+    TEST_ASSERT( GPSNmea_GetFix( &parser, &fix ) == false );
+    TEST_ASSERT_EQUAL_INT( 0, fix.lat );
+    TEST_ASSERT_EQUAL_INT( 0, fix.fixQuality );
+
+    /* An empty course keeps the last one, a lost fix drops the position. */
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_RMC, prvFeed( prvFrame( TEST_RMC ) ) );
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_RMC,
+                           prvFeed( prvFrame( "GPRMC,123521.00,A,4807.038,N,01131.000,E,0.0,,230394,," ) ) );
+    TEST_ASSERT( GPSNmea_GetFix( &parser, &fix ) == true );
+    TEST_ASSERT_EQUAL_INT( 84, fix.heading );
+    TEST_ASSERT_WITHIN( 1e-9, 0.0, fix.speed );
+
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_RMC,
+                           prvFeed( prvFrame( "GPRMC,123522.00,V,,,,,,,230394,,,N" ) ) );
+    TEST_ASSERT( GPSNmea_GetFix( &parser, &fix ) == false );
+    TEST_ASSERT_EQUAL_INT( 12352200, fix.time );
+
+    /* Too few fields are counted but not decoded. */
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_RMC, prvFeed( prvFrame( "GPRMC,123523.00,A" ) ) );
+    TEST_ASSERT( GPSNmea_GetFix( &parser, &fix ) == false );
+    TEST_ASSERT_EQUAL_INT( 12352200, fix.time );
+    TEST_ASSERT_EQUAL_INT( 0, fix.errors );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Counters( void )
+{
+    ObdGpsData_t fix = { 0 };
+
+    GPSNmea_Init( &parser );
+
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_OTHER, prvFeed( prvFrame( "GPGSV,1,1,01,04,40,083,46" ) ) );
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_INVALID, prvFeed( prvFrame( "GPRM,1,2" ) ) );
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_NONE, prvFeed( "noise before the first sentence\r\n" ) );
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_VTG, prvFeed( prvFrame( TEST_VTG ) ) );
+
+    ( void ) GPSNmea_GetFix( &parser, &fix );
+    TEST_ASSERT_EQUAL_INT( 2, fix.sentences );
+    TEST_ASSERT_EQUAL_INT( 1, fix.errors );
+
+    /* Init clears them. */
+    GPSNmea_Init( &parser );
+    ( void ) GPSNmea_GetFix( &parser, &fix );
+    TEST_ASSERT_EQUAL_INT( 0, fix.sentences );
+    TEST_ASSERT_EQUAL_INT( 0, fix.errors );
+    TEST_ASSERT_EQUAL_INT( GPS_NMEA_SENTENCE_NONE, GPSNmea_ParseByte( NULL, '$' ) );
+    TEST_ASSERT( GPSNmea_GetFix( NULL, &fix ) == false );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    RUN_TEST( test_RMC_Fields );
+    RUN_TEST( test_GGA_FieldsSouthWest );
+    RUN_TEST( test_GSA_VTG_Fields );
+    RUN_TEST( test_Checksum_BadAndMissing );
+    RUN_TEST( test_SplitAcrossReads );
+    RUN_TEST( test_Overlong_Rejected );
+    RUN_TEST( test_EmptyFields );
+    RUN_TEST( test_Counters );
+
+    return TEST_RESULT();
+}
+
+/*-----------------------------------------------------------*/
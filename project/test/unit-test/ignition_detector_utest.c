@@ -0,0 +1,180 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file ignition_detector_utest.c
+ * @brief Tests of the engine start detection from the battery voltage.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "test_assert.h"
+#include "obd_config.h"
+#include "ignition_detector.h"
+
+#define TEST_REST_VOLTAGE    ( 12.6f )
+
+static IgnitionDetector_t detector;
+
+/*-----------------------------------------------------------*/
+
+/* Park at the rest voltage, one reading per poll interval from time 0. */
+static uint64_t prvPark( uint32_t readings )
+{
+    uint64_t nowMs = 0;
+    uint32_t i = 0;
+
+    IgnitionDetector_Init( &detector );
+
+    for( i = 0; i < readings; i++ )
+    {
+        TEST_ASSERT( IgnitionDetector_Update( &detector, TEST_REST_VOLTAGE, nowMs ) == false );
+        nowMs += IGNITION_POLL_INTERVAL_MS;
+    }
+
+    return nowMs;
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_RestVoltage_Learned( void )
+{
+    uint64_t nowMs = prvPark( 1U );
+    uint32_t i = 0;
+
+    TEST_ASSERT_WITHIN( 1e-6, TEST_REST_VOLTAGE, detector.restVoltage );
+
+    /* Follows a slow drift without asking for a check. */
+    for( i = 0; i < 200U; i++ )
+    {
+        TEST_ASSERT( IgnitionDetector_Update( &detector, TEST_REST_VOLTAGE - 0.4f, nowMs ) == false );
+        nowMs += IGNITION_POLL_INTERVAL_MS;
+    }
+
+    TEST_ASSERT_WITHIN( 0.01, TEST_REST_VOLTAGE - 0.4f, detector.restVoltage );
+
+    /* A single noisy reading moves it by a part only. */
+    TEST_ASSERT( IgnitionDetector_Update( &detector, TEST_REST_VOLTAGE, nowMs ) == false );
+    TEST_ASSERT_WITHIN( 0.01, TEST_REST_VOLTAGE - 0.4f + ( 0.4f / IGNITION_REST_FILTER ), detector.restVoltage );
+
+    /* A charging battery at power up is not taken as the rest voltage. */
+    IgnitionDetector_Init( &detector );
+    TEST_ASSERT( IgnitionDetector_Update( &detector, IGNITION_CHARGING_VOLTAGE + 0.5f, 0U ) == true );
+    TEST_ASSERT_WITHIN( 1e-6, 0.0, detector.restVoltage );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_CrankingDip( void )
+{
+    uint64_t nowMs = prvPark( 10U );
+
+    /* Just above the dip is noise, at the dip it is a start. */
+    TEST_ASSERT( IgnitionDetector_Update( &detector, TEST_REST_VOLTAGE - IGNITION_CRANKING_DIP + 0.05f, nowMs ) == false );
+    ( void ) prvPark( 10U );
+    TEST_ASSERT( IgnitionDetector_Update( &detector, TEST_REST_VOLTAGE - IGNITION_CRANKING_DIP - 0.05f, nowMs ) == true );
+    TEST_ASSERT( detector.candidate == true );
+
+    /* The dip does not become the rest voltage. */
+    TEST_ASSERT_WITHIN( 1e-6, TEST_REST_VOLTAGE, detector.restVoltage );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_ChargingRise( void )
+{
+    uint64_t nowMs = prvPark( 10U );
+
+    /* A rise above the rest voltage on a battery that rests low. */
+    TEST_ASSERT( IgnitionDetector_Update( &detector, TEST_REST_VOLTAGE + IGNITION_CHARGING_RISE - 0.05f, nowMs ) == false );
+    ( void ) prvPark( 10U );
+    TEST_ASSERT( IgnitionDetector_Update( &detector, TEST_REST_VOLTAGE + IGNITION_CHARGING_RISE + 0.05f, nowMs ) == true );
+
+    /* The charging voltage is a start whatever the rest voltage. */
+    IgnitionDetector_Init( &detector );
+    ( void ) IgnitionDetector_Update( &detector, IGNITION_CHARGING_VOLTAGE - 0.1f, 0U );
+    TEST_ASSERT( IgnitionDetector_Update( &detector, IGNITION_CHARGING_VOLTAGE, IGNITION_POLL_INTERVAL_MS ) == true );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_RpmCheck_Interval( void )
+{
+    uint64_t nowMs = prvPark( 10U );
+    uint64_t startMs = nowMs;
+
+    /* Charging with the engine off, the RPM is checked every interval only. */
+    TEST_ASSERT( IgnitionDetector_Update( &detector, 13.8f, nowMs ) == true );
+
+    for( nowMs = startMs + IGNITION_POLL_INTERVAL_MS; nowMs < ( startMs + IGNITION_RPM_CHECK_INTERVAL_MS ); nowMs += IGNITION_POLL_INTERVAL_MS )
+    {
+        TEST_ASSERT( IgnitionDetector_Update( &detector, 13.8f, nowMs ) == false );
+    }
+
+    TEST_ASSERT( IgnitionDetector_Update( &detector, 13.8f, startMs + IGNITION_RPM_CHECK_INTERVAL_MS ) == true );
+    TEST_ASSERT( IgnitionDetector_Update( &detector, 13.8f, startMs + IGNITION_RPM_CHECK_INTERVAL_MS + IGNITION_POLL_INTERVAL_MS ) == false );
+
+    /* Back to rest and a new start is checked at once. */
+    nowMs = startMs + ( 2U * IGNITION_RPM_CHECK_INTERVAL_MS ) - IGNITION_POLL_INTERVAL_MS;
+    TEST_ASSERT( IgnitionDetector_Update( &detector, TEST_REST_VOLTAGE, nowMs ) == false );
+    TEST_ASSERT( detector.candidate == false );
+    TEST_ASSERT( IgnitionDetector_Update( &detector, 13.8f, nowMs + IGNITION_POLL_INTERVAL_MS ) == true );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_FailedRead_Ignored( void )
+{
+    uint64_t nowMs = 0;
+
+    /* Before the rest voltage is known. */
+    IgnitionDetector_Init( &detector );
+    TEST_ASSERT( IgnitionDetector_Update( &detector, 0.0f, nowMs ) == false );
+    TEST_ASSERT( IgnitionDetector_Update( &detector, NAN, nowMs ) == false );
+    TEST_ASSERT_WITHIN( 1e-6, 0.0, detector.restVoltage );
+
+    /* After it, a 0 V read is not a cranking dip. */
+    nowMs = prvPark( 10U );
+    TEST_ASSERT( IgnitionDetector_Update( &detector, 0.0f, nowMs ) == false );
+    TEST_ASSERT( IgnitionDetector_Update( &detector, IGNITION_MIN_VOLTAGE - 0.1f, nowMs ) == false );
+    TEST_ASSERT_WITHIN( 1e-6, TEST_REST_VOLTAGE, detector.restVoltage );
+
+    /* A failed read in a start does not restart the check interval. */
+    TEST_ASSERT( IgnitionDetector_Update( &detector, 13.8f, nowMs ) == true );
+    TEST_ASSERT( IgnitionDetector_Update( &detector, 0.0f, nowMs + IGNITION_POLL_INTERVAL_MS ) == false );
+    TEST_ASSERT( detector.candidate == true );
+    TEST_ASSERT( IgnitionDetector_Update( &detector, 13.8f, nowMs + ( 2U * IGNITION_POLL_INTERVAL_MS ) ) == false );
+    TEST_ASSERT( IgnitionDetector_Update( &detector, 13.8f, nowMs + IGNITION_RPM_CHECK_INTERVAL_MS ) == true );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    RUN_TEST( test_RestVoltage_Learned );
+    RUN_TEST( test_CrankingDip );
+    RUN_TEST( test_ChargingRise );
+    RUN_TEST( test_RpmCheck_Interval );
+    RUN_TEST( test_FailedRead_Ignored );
+
+    return TEST_RESULT();
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,202 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file json_writer_utest.c
+ * @brief Tests of the bounded JSON writer.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "test_assert.h"
+#include "json_writer.h"
+
+#define TEST_ASSERT_JSON( expected, writer )                                    \
+    do {                                                                        \
+        TEST_ASSERT( ( writer ).overflow == false );                            \
+        if( strcmp( ( expected ), ( writer ).pBuffer ) != 0 )                   \
+        {                                                                       \
+            TEST_FAIL_AT( __FILE__, __LINE__, "expected %s, got %s", ( expected ), ( writer ).pBuffer ); \
+        }                                                                       \
+    } while( 0 )
+
+static char buffer[ 512 ];
+
+/*-----------------------------------------------------------*/
+
+static void test_Compact_Object( void )
+{
+    JsonWriter_t writer;
+
+    JsonWriter_Init( &writer, buffer, sizeof( buffer ), 0 );
+    JsonWriter_BeginObject( &writer, NULL );
+    JsonWriter_AddString( &writer, "VIN", "ABC" );
+    JsonWriter_AddInt( &writer, "Count", -42 );
+    JsonWriter_AddBool( &writer, "On", true );
+    JsonWriter_BeginArray( &writer, "Values" );
+    JsonWriter_AddFixed( &writer, NULL, -1234567, 6 );
+    JsonWriter_AddFixed( &writer, NULL, 5, 2 );
+    JsonWriter_EndArray( &writer );
+    JsonWriter_BeginObject( &writer, "Empty" );
+    JsonWriter_EndObject( &writer );
+    JsonWriter_EndObject( &writer );
+
+    TEST_ASSERT_JSON( "{\"VIN\":\"ABC\",\"Count\":-42,\"On\":true,\"Values\":[-1.234567,0.05],\"Empty\":{}}", writer );
+    TEST_ASSERT_EQUAL_INT( strlen( buffer ), writer.length );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Pretty_Indent( void )
+{
+    JsonWriter_t writer;
+
+    JsonWriter_Init( &writer, buffer, sizeof( buffer ), JSON_WRITER_PRETTY );
+    JsonWriter_BeginObject( &writer, NULL );
+    JsonWriter_BeginObject( &writer, "Geo" );
+    JsonWriter_AddInt( &writer, "Lat", 1 );
+    JsonWriter_EndObject( &writer );
+    JsonWriter_EndObject( &writer );
+
+    TEST_ASSERT_JSON( "{\r\n    \"Geo\": {\r\n        \"Lat\": 1\r\n    }\r\n}", writer );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_String_Escapes( void )
+{
+    JsonWriter_t writer;
+
+    JsonWriter_Init( &writer, buffer, sizeof( buffer ), 0 );
+    JsonWriter_AddString( &writer, NULL, "a\"b\\c\r\n\x01" );
+
+    TEST_ASSERT_JSON( "\"a\\\"b\\\\c\\u000d\\u000a\\u0001\"", writer );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Double_Rounding( void )
+{
+    JsonWriter_t writer;
+
+    JsonWriter_Init( &writer, buffer, sizeof( buffer ), 0 );
+    JsonWriter_BeginArray( &writer, NULL );
+    JsonWriter_AddDouble( &writer, NULL, 2.0004999, 3 );
+    JsonWriter_AddDouble( &writer, NULL, -0.0005, 3 );
+    JsonWriter_AddDouble( &writer, NULL, 99.9996, 3 );
+    JsonWriter_AddDouble( &writer, NULL, NAN, 3 );
+    JsonWriter_AddDouble( &writer, NULL, INFINITY, 3 );
+    JsonWriter_AddDouble( &writer, NULL, 1e300, 3 );
+    JsonWriter_EndArray( &writer );
+
+    TEST_ASSERT_JSON( "[2.000,-0.001,100.000,null,null,null]", writer );
+
+    JsonWriter_Init( &writer, buffer, sizeof( buffer ), JSON_WRITER_TRIM_ZEROS );
+    JsonWriter_BeginArray( &writer, NULL );
+    JsonWriter_AddDouble( &writer, NULL, 2.5, 6 );
+    JsonWriter_AddDouble( &writer, NULL, 3.0, 6 );
+    JsonWriter_AddFixed( &writer, NULL, 120, 2 );
+    JsonWriter_EndArray( &writer );
+
+    TEST_ASSERT_JSON( "[2.5,3,1.2]", writer );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_OmitEmpty( void )
+{
+    JsonWriter_t writer;
+
+    JsonWriter_Init( &writer, buffer, sizeof( buffer ), JSON_WRITER_OMIT_EMPTY );
+    JsonWriter_BeginObject( &writer, NULL );
+    JsonWriter_AddString( &writer, "Name", "" );
+    JsonWriter_AddInt( &writer, "A", 1 );
+    JsonWriter_BeginObject( &writer, "Empty" );
+    JsonWriter_BeginArray( &writer, "Nested" );
+    JsonWriter_EndArray( &writer );
+    JsonWriter_EndObject( &writer );
+    JsonWriter_BeginArray( &writer, "Column" );
+    JsonWriter_AddString( &writer, NULL, "" );
+    JsonWriter_EndArray( &writer );
+    JsonWriter_EndObject( &writer );
+
+    TEST_ASSERT_JSON( "{\"A\":1,\"Column\":[\"\"]}", writer );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Overflow_KeepsTerminator( void )
+{
+    JsonWriter_t writer;
+    char small[ 16 ];
+    size_t size = 0;
+
+    for( size = 1; size <= sizeof( small ); size++ )
+    {
+        memset( small, 'x', sizeof( small ) );
+        JsonWriter_Init( &writer, small, size, 0 );
+        JsonWriter_BeginObject( &writer, NULL );
+        JsonWriter_AddString( &writer, "Key", "Value" );
+        JsonWriter_EndObject( &writer );
+
+        /* {"Key":"Value"} is 15 characters. */
+        TEST_ASSERT( writer.overflow == ( size <= 15U ) );
+        TEST_ASSERT( writer.length < size );
+        TEST_ASSERT( small[ writer.length ] == '\0' );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Base64_AndInPlaceString( void )
+{
+    JsonWriter_t writer;
+    const uint8_t data[] = { 'M', 'a', 'n', 'M', 'a' };
+    char * pPosition = NULL;
+    size_t available = 0;
+
+    JsonWriter_Init( &writer, buffer, sizeof( buffer ), 0 );
+    JsonWriter_BeginArray( &writer, NULL );
+    JsonWriter_AddBase64( &writer, NULL, data, sizeof( data ) );
+    pPosition = JsonWriter_BeginString( &writer, NULL, &available );
+    TEST_ASSERT( ( pPosition != NULL ) && ( available > 3U ) );
+    memcpy( pPosition, "abc", 3 );
+    JsonWriter_EndString( &writer, 3 );
+    JsonWriter_EndArray( &writer );
+
+    TEST_ASSERT_JSON( "[\"TWFuTWE=\",\"abc\"]", writer );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    RUN_TEST( test_Compact_Object );
+    RUN_TEST( test_Pretty_Indent );
+    RUN_TEST( test_String_Escapes );
+    RUN_TEST( test_Double_Rounding );
+    RUN_TEST( test_OmitEmpty );
+    RUN_TEST( test_Overflow_KeepsTerminator );
+    RUN_TEST( test_Base64_AndInPlaceString );
+
+    return TEST_RESULT();
+}
+
+/*-----------------------------------------------------------*/
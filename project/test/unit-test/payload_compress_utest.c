@@ -0,0 +1,249 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file payload_compress_utest.c
+ * @brief Round trip and robustness tests of the LZSS payload compression.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "test_assert.h"
+#include "payload_compress.h"
+
+static uint8_t input[ PAYLOAD_COMPRESS_INPUT_MAX + 1U ];
+static uint8_t compressed[ PAYLOAD_COMPRESS_INPUT_MAX + ( PAYLOAD_COMPRESS_INPUT_MAX / 8U ) + 16U ];
+static uint8_t output[ PAYLOAD_COMPRESS_INPUT_MAX + 1U ];
+static uint32_t randomState = 2463534242U;
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRandom( void )
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+
+    return randomState;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Compress and decompress, returns the compressed length. */
+static int32_t prvRoundTrip( const uint8_t * pData,
+                             size_t length )
+{
+    int32_t compressedLength = PayloadCompress_Encode( pData, length, compressed, sizeof( compressed ) );
+    int32_t decodedLength = 0;
+
+    TEST_ASSERT( compressedLength >= ( int32_t ) PAYLOAD_COMPRESS_HEADER_SIZE );
+
+    if( compressedLength < 0 )
+    {
+        return compressedLength;
+    }
+
+    TEST_ASSERT_EQUAL_INT( PAYLOAD_COMPRESS_HEADER_LZSS, compressed[ 0 ] );
+    TEST_ASSERT_EQUAL_INT( length, ( ( size_t ) compressed[ 1 ] << 8 ) | compressed[ 2 ] );
+
+    /* The worst case is one flag byte per 8 literals. */
+    TEST_ASSERT( ( size_t ) compressedLength <= ( PAYLOAD_COMPRESS_HEADER_SIZE + length + ( ( length + 7U ) / 8U ) ) );
+
+    memset( output, 0xA5, sizeof( output ) );
+    decodedLength = PayloadCompress_Decode( compressed, ( size_t ) compressedLength, output, sizeof( output ) );
+    TEST_ASSERT_EQUAL_INT( length, decodedLength );
+    TEST_ASSERT( memcmp( pData, output, length ) == 0 );
+
+    return compressedLength;
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_RoundTrip_Edges( void )
+{
+    const char * pText = "{\"VIN\":\"1HGBH41JXMN109186\",\"Speed\":[88.4,88.4,88.5,88.4],\"Speed\":[88.4,88.4]}";
+
+    TEST_ASSERT_EQUAL_INT( PAYLOAD_COMPRESS_HEADER_SIZE, prvRoundTrip( input, 0 ) );
+    input[ 0 ] = 'x';
+    prvRoundTrip( input, 1 );
+    prvRoundTrip( input, 2 );
+    prvRoundTrip( ( const uint8_t * ) pText, strlen( pText ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_RoundTrip_Runs( void )
+{
+    int32_t length = 0;
+    size_t i = 0;
+
+    /* Overlapping matches at distance 1. */
+    memset( input, 'a', 4000 );
+    length = prvRoundTrip( input, 4000 );
+    TEST_ASSERT( length < 600 );
+
+    /* Random data repeated at a short period. */
+    for( i = 0; i < 12000U; i++ )
+    {
+        input[ i ] = ( uint8_t ) prvRandom();
+    }
+
+    for( i = 200; i < 4000U; i++ )
+    {
+        input[ i ] = input[ i - 200U ];
+    }
+
+    length = prvRoundTrip( input, 4000 );
+    TEST_ASSERT( length < 1200 );
+
+    /* A period just inside and just outside the window. */
+    memcpy( &input[ 4096 ], input, 4096 );
+    prvRoundTrip( input, 8192 );
+    memcpy( &input[ 4097 ], input, 4097 );
+    prvRoundTrip( input, 8194 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_RoundTrip_MaximumInput( void )
+{
+    size_t i = 0;
+
+    for( i = 0; i < PAYLOAD_COMPRESS_INPUT_MAX; i++ )
+    {
+        input[ i ] = ( uint8_t ) ( ( ( prvRandom() & 3U ) == 0U ) ? prvRandom() : ( i / 7U ) );
+    }
+
+    prvRoundTrip( input, PAYLOAD_COMPRESS_INPUT_MAX );
+    TEST_ASSERT_EQUAL_INT( -1, PayloadCompress_Encode( input, PAYLOAD_COMPRESS_INPUT_MAX + 1U, compressed, sizeof( compressed ) ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_RoundTrip_RandomInputs( void )
+{
+    int i = 0;
+    size_t length = 0;
+    size_t j = 0;
+    uint32_t alphabet = 0;
+
+    for( i = 0; i < 20000; i++ )
+    {
+        length = prvRandom() % 3000U;
+        alphabet = 1U + ( prvRandom() % 64U );
+
+        for( j = 0; j < length; j++ )
+        {
+            input[ j ] = ( uint8_t ) ( '0' + ( prvRandom() % alphabet ) );
+        }
+
+        prvRoundTrip( input, length );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Encode_OutputTooSmall( void )
+{
+    size_t size = 0;
+    int32_t full = 0;
+
+    memset( input, 'q', 100 );
+    memcpy( &input[ 40 ], "0123456789", 10 );
+    full = PayloadCompress_Encode( input, 100, compressed, sizeof( compressed ) );
+    TEST_ASSERT( full > 0 );
+
+    for( size = 0; size < ( size_t ) full; size++ )
+    {
+        TEST_ASSERT_EQUAL_INT( -1, PayloadCompress_Encode( input, 100, compressed, size ) );
+    }
+
+    /* The encoder keeps room for a whole match, a little slack may be needed. */
+    TEST_ASSERT_EQUAL_INT( full, PayloadCompress_Encode( input, 100, compressed, ( size_t ) full + 2U ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Decode_RejectsBadInput( void )
+{
+    int32_t length = 0;
+    size_t cut = 0;
+    int i = 0;
+
+    memset( input, 'z', 300 );
+    length = PayloadCompress_Encode( input, 300, compressed, sizeof( compressed ) );
+
+    /* Output buffer too small for the announced length. */
+    TEST_ASSERT_EQUAL_INT( -1, PayloadCompress_Decode( compressed, ( size_t ) length, output, 299 ) );
+
+    /* Truncated streams. */
+    for( cut = 0; cut < ( size_t ) length; cut++ )
+    {
+        TEST_ASSERT_EQUAL_INT( -1, PayloadCompress_Decode( compressed, cut, output, sizeof( output ) ) );
+    }
+
+    /* Not a compressed payload. */
+    TEST_ASSERT_EQUAL_INT( -1, PayloadCompress_Decode( ( const uint8_t * ) "{\"a\":1}", 7, output, sizeof( output ) ) );
+
+    /* A match before the start of the output. */
+    compressed[ 0 ] = PAYLOAD_COMPRESS_HEADER_LZSS;
+    compressed[ 1 ] = 0;
+    compressed[ 2 ] = 4;
+    compressed[ 3 ] = 0x01;
+    compressed[ 4 ] = 'a';
+    compressed[ 5 ] = 0x00;
+    compressed[ 6 ] = 0x10;
+    TEST_ASSERT_EQUAL_INT( -1, PayloadCompress_Decode( compressed, 7, output, sizeof( output ) ) );
+
+    /* Garbage never writes past the output buffer. */
+    for( i = 0; i < 20000; i++ )
+    {
+        size_t garbageLength = 3U + ( prvRandom() % 200U );
+        size_t j = 0;
+
+        for( j = 0; j < garbageLength; j++ )
+        {
+            compressed[ j ] = ( uint8_t ) prvRandom();
+        }
+
+        compressed[ 0 ] = PAYLOAD_COMPRESS_HEADER_LZSS;
+        compressed[ 1 ] = 0;
+        output[ 64 ] = 0x5A;
+        length = PayloadCompress_Decode( compressed, garbageLength, output, 64 );
+        TEST_ASSERT( ( length == -1 ) || ( ( length >= 0 ) && ( length <= 64 ) ) );
+        TEST_ASSERT_EQUAL_INT( 0x5A, output[ 64 ] );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    RUN_TEST( test_RoundTrip_Edges );
+    RUN_TEST( test_RoundTrip_Runs );
+    RUN_TEST( test_RoundTrip_MaximumInput );
+    RUN_TEST( test_RoundTrip_RandomInputs );
+    RUN_TEST( test_Encode_OutputTooSmall );
+    RUN_TEST( test_Decode_RejectsBadInput );
+
+    return TEST_RESULT();
+}
+
+/*-----------------------------------------------------------*/
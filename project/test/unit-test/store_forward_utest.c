@@ -0,0 +1,366 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file store_forward_utest.c
+ * @brief Tests of the SD card message queue on a host directory.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/stat.h>
+
+#include "test_assert.h"
+#include "sdkconfig.h"
+#include "obd_config.h"
+#include "store_forward.h"
+
+#define TEST_DIR             CONFIG_FS_MOUNT_POINT "/sfq"
+#define TEST_CURSOR_PATH     TEST_DIR "/cursor.dat"
+#define TEST_TOPIC           "dt/cvra/thing/telemetry"
+
+/* Records of exactly one alignment unit, so a segment holds a known count. */
+#define TEST_PAYLOAD_SIZE    ( STORE_FORWARD_ALIGN - 16U - ( sizeof( TEST_TOPIC ) - 1U ) )
+#define TEST_PER_SEGMENT     ( STORE_FORWARD_SEGMENT_SIZE / STORE_FORWARD_ALIGN )
+
+static char topic[ 64 ];
+static uint8_t payload[ OBD_MESSAGE_BUF_SIZE ];
+static uint8_t expected[ OBD_MESSAGE_BUF_SIZE ];
+
+/*-----------------------------------------------------------*/
+
+static void prvClear( void )
+{
+    char path[ 128 ];
+    uint32_t segment = 0;
+
+    for( segment = 0; segment < STORE_FORWARD_SEGMENT_COUNT; segment++ )
+    {
+        snprintf( path, sizeof( path ), TEST_DIR "/seg%u.dat", ( unsigned int ) segment );
+        ( void ) remove( path );
+    }
+
+    ( void ) remove( TEST_CURSOR_PATH );
+    TEST_ASSERT( StoreForward_Init() == true );
+}
+
+/*-----------------------------------------------------------*/
+
+/* The payload of message index, its index first then a pattern. */
+static size_t prvMessage( uint32_t index,
+                          size_t length )
+{
+    size_t i = 0;
+
+    for( i = 0; i < length; i++ )
+    {
+        expected[ i ] = ( uint8_t ) ( ( index * 31U ) + i );
+    }
+
+    memcpy( expected, &index, sizeof( index ) );
+
+    return length;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPush( uint32_t index,
+                     size_t length )
+{
+    prvMessage( index, length );
+    TEST_ASSERT( StoreForward_Push( TEST_TOPIC, expected, length ) == true );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Peek and return the index of the oldest message or UINT32_MAX. */
+static uint32_t prvPeekIndex( size_t * pLength )
+{
+    uint32_t index = UINT32_MAX;
+
+    if( StoreForward_Peek( topic, sizeof( topic ), payload, sizeof( payload ), pLength ) == true )
+    {
+        memcpy( &index, payload, sizeof( index ) );
+        TEST_ASSERT( strcmp( topic, TEST_TOPIC ) == 0 );
+    }
+
+    return index;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Pop count messages that must follow first. */
+static void prvPopInOrder( uint32_t first,
+                           uint32_t count,
+                           size_t length )
+{
+    size_t payloadLength = 0;
+    uint32_t i = 0;
+
+    for( i = first; i < ( first + count ); i++ )
+    {
+        if( prvPeekIndex( &payloadLength ) != i )
+        {
+            TEST_FAIL_AT( __FILE__, __LINE__, "message %u expected", ( unsigned int ) i );
+            return;
+        }
+
+        prvMessage( i, length );
+        TEST_ASSERT_EQUAL_INT( length, payloadLength );
+        TEST_ASSERT( memcmp( payload, expected, length ) == 0 );
+        StoreForward_Pop();
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Queue_Empty( void )
+{
+    size_t length = 0;
+
+    prvClear();
+    TEST_ASSERT( StoreForward_IsEmpty() == true );
+    TEST_ASSERT( StoreForward_Peek( topic, sizeof( topic ), payload, sizeof( payload ), &length ) == false );
+    StoreForward_Pop();
+    TEST_ASSERT( StoreForward_IsEmpty() == true );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Queue_InOrder( void )
+{
+    size_t length = 0;
+    uint32_t i = 0;
+
+    prvClear();
+
+    /* Sizes around the alignment and the largest message. */
+    for( i = 0; i < 20U; i++ )
+    {
+        prvPush( i, 4U + ( ( i * 211U ) % ( OBD_MESSAGE_BUF_SIZE - 4U ) ) );
+    }
+
+    TEST_ASSERT( StoreForward_IsEmpty() == false );
+
+    /* A peek without a pop returns the same message. */
+    TEST_ASSERT_EQUAL_INT( 0, prvPeekIndex( &length ) );
+    TEST_ASSERT_EQUAL_INT( 0, prvPeekIndex( &length ) );
+
+    for( i = 0; i < 20U; i++ )
+    {
+        prvPopInOrder( i, 1, 4U + ( ( i * 211U ) % ( OBD_MESSAGE_BUF_SIZE - 4U ) ) );
+    }
+
+    TEST_ASSERT( StoreForward_IsEmpty() == true );
+    TEST_ASSERT_EQUAL_INT( UINT32_MAX, prvPeekIndex( &length ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Restart_ResendsUnsavedOnly( void )
+{
+    size_t length = 0;
+    uint32_t next = 0;
+
+    prvClear();
+
+    for( next = 0; next < 60U; next++ )
+    {
+        prvPush( next, 100 );
+    }
+
+    prvPopInOrder( 0, 40, 100 );
+
+    /* Restart, what was popped after the last save comes again. */
+    TEST_ASSERT( StoreForward_Init() == true );
+    next = prvPeekIndex( &length );
+    TEST_ASSERT( ( next <= 40U ) && ( next > ( 40U - STORE_FORWARD_CURSOR_SAVE_EVERY ) ) );
+    prvPopInOrder( next, 60U - next, 100 );
+
+    /* A drained queue is saved, nothing comes again. */
+    TEST_ASSERT( StoreForward_Init() == true );
+    TEST_ASSERT( StoreForward_IsEmpty() == true );
+
+    /* New messages continue the sequence. */
+    prvPush( 60, 100 );
+    TEST_ASSERT( StoreForward_Init() == true );
+    prvPopInOrder( 60, 1, 100 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Restart_CursorSavedOnSegmentChange( void )
+{
+    /* Three alignment units per record, a segment does not end on a save. */
+    size_t size = TEST_PAYLOAD_SIZE + ( 2U * STORE_FORWARD_ALIGN );
+    uint32_t perSegment = STORE_FORWARD_SEGMENT_SIZE / ( 3U * STORE_FORWARD_ALIGN );
+    size_t length = 0;
+    uint32_t next = 0;
+
+    prvClear();
+    TEST_ASSERT( ( perSegment % STORE_FORWARD_CURSOR_SAVE_EVERY ) != 0U );
+
+    for( next = 0; next < ( perSegment * 2U ); next++ )
+    {
+        prvPush( next, size );
+    }
+
+    /* Two into the second segment. */
+    prvPopInOrder( 0, perSegment + 2U, size );
+
+    /* The cursor is not left in the first segment, it may be dropped. */
+    TEST_ASSERT( StoreForward_Init() == true );
+    next = prvPeekIndex( &length );
+    TEST_ASSERT( ( next >= perSegment ) && ( next <= ( perSegment + 2U ) ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Restart_BadCursorReplaysOldest( void )
+{
+    size_t length = 0;
+    FILE * fp = NULL;
+    uint32_t i = 0;
+
+    prvClear();
+
+    for( i = 0; i < 5U; i++ )
+    {
+        prvPush( i, 100 );
+    }
+
+    prvPopInOrder( 0, 5, 100 );
+
+    /* Missing cursor. */
+    TEST_ASSERT( remove( TEST_CURSOR_PATH ) == 0 );
+    TEST_ASSERT( StoreForward_Init() == true );
+    TEST_ASSERT_EQUAL_INT( 0, prvPeekIndex( &length ) );
+    prvPopInOrder( 0, 5, 100 );
+
+    /* Damaged cursor. */
+    fp = fopen( TEST_CURSOR_PATH, "r+b" );
+    TEST_ASSERT( fp != NULL );
+
+    if( fp != NULL )
+    {
+        fputc( 0xA5, fp );
+        fclose( fp );
+    }
+
+    TEST_ASSERT( StoreForward_Init() == true );
+    prvPopInOrder( 0, 5, 100 );
+    TEST_ASSERT( StoreForward_IsEmpty() == true );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Restart_TornRecordOverwritten( void )
+{
+    FILE * fp = NULL;
+    uint32_t i = 0;
+
+    prvClear();
+
+    for( i = 0; i < 3U; i++ )
+    {
+        prvPush( i, 100 );
+    }
+
+    /* A power loss in the payload of the third record. */
+    fp = fopen( TEST_DIR "/seg0.dat", "r+b" );
+    TEST_ASSERT( fp != NULL );
+
+    if( fp != NULL )
+    {
+        TEST_ASSERT( fseek( fp, ( long ) ( ( 2U * STORE_FORWARD_ALIGN ) + 60U ), SEEK_SET ) == 0 );
+        fputc( 0, fp );
+        fputc( 0, fp );
+        fclose( fp );
+    }
+
+    TEST_ASSERT( StoreForward_Init() == true );
+    prvPush( 3, 100 );
+    prvPopInOrder( 0, 2, 100 );
+    prvPopInOrder( 3, 1, 100 );
+    TEST_ASSERT( StoreForward_IsEmpty() == true );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Full_DropsOldestSegment( void )
+{
+    uint32_t total = TEST_PER_SEGMENT * STORE_FORWARD_SEGMENT_COUNT;
+    uint32_t i = 0;
+
+    prvClear();
+
+    for( i = 0; i < total; i++ )
+    {
+        prvPush( i, TEST_PAYLOAD_SIZE );
+    }
+
+    TEST_ASSERT_EQUAL_INT( 0, StoreForward_GetDroppedSegments() );
+
+    /* The next one goes to the first segment again. */
+    prvPush( total, TEST_PAYLOAD_SIZE );
+    TEST_ASSERT_EQUAL_INT( 1, StoreForward_GetDroppedSegments() );
+    prvPopInOrder( TEST_PER_SEGMENT, total + 1U - TEST_PER_SEGMENT, TEST_PAYLOAD_SIZE );
+    TEST_ASSERT( StoreForward_IsEmpty() == true );
+
+    /* The ring keeps going after a restart. */
+    prvPush( total + 1U, TEST_PAYLOAD_SIZE );
+    TEST_ASSERT( StoreForward_Init() == true );
+    prvPopInOrder( total + 1U, 1, TEST_PAYLOAD_SIZE );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Push_Rejected( void )
+{
+    char longTopic[ 300 ];
+
+    prvClear();
+    memset( longTopic, 'a', sizeof( longTopic ) - 1U );
+    longTopic[ sizeof( longTopic ) - 1U ] = '\0';
+
+    TEST_ASSERT( StoreForward_Push( longTopic, expected, 10 ) == false );
+    TEST_ASSERT( StoreForward_Push( TEST_TOPIC, expected, STORE_FORWARD_SEGMENT_SIZE ) == false );
+    TEST_ASSERT( StoreForward_IsEmpty() == true );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    ( void ) mkdir( CONFIG_FS_MOUNT_POINT, 0775 );
+
+    RUN_TEST( test_Queue_Empty );
+    RUN_TEST( test_Queue_InOrder );
+    RUN_TEST( test_Restart_ResendsUnsavedOnly );
+    RUN_TEST( test_Restart_CursorSavedOnSegmentChange );
+    RUN_TEST( test_Restart_BadCursorReplaysOldest );
+    RUN_TEST( test_Restart_TornRecordOverwritten );
+    RUN_TEST( test_Full_DropsOldestSegment );
+    RUN_TEST( test_Push_Rejected );
+
+    return TEST_RESULT();
+}
+
+/*-----------------------------------------------------------*/
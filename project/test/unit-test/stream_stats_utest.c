@@ -0,0 +1,293 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file stream_stats_utest.c
+ * @brief Tests of the streaming statistics against exact two pass values.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "test_assert.h"
+#include "stream_stats.h"
+
+#define TEST_SAMPLES    ( 20000U )
+
+static double samples[ TEST_SAMPLES ];
+static double sorted[ TEST_SAMPLES ];
+static uint32_t randomState = 2463534242U;
+
+/*-----------------------------------------------------------*/
+
+static double prvUniform( void )
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+
+    /* ( 0, 1 ], never 0 for the logarithms. */
+    return ( ( double ) randomState + 1.0 ) / 4294967296.0;
+}
+
+/*-----------------------------------------------------------*/
+
+static double prvNormal( void )
+{
+    return sqrt( -2.0 * log( prvUniform() ) ) * cos( 6.283185307179586 * prvUniform() );
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvCompare( const void * pLeft,
+                       const void * pRight )
+{
+    double left = *( const double * ) pLeft;
+    double right = *( const double * ) pRight;
+
+    return ( left > right ) - ( left < right );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Fraction of the samples below value, the rank of an estimate. */
+static double prvRank( double value,
+                       uint32_t count )
+{
+    uint32_t below = 0;
+    uint32_t i = 0;
+
+    for( i = 0; i < count; i++ )
+    {
+        below += ( sorted[ i ] < value ) ? 1U : 0U;
+    }
+
+    return ( double ) below / ( double ) count;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Add the samples and compare with exact values, the quantile estimates by
+ * their rank among the samples. */
+static void prvCheck( uint32_t count,
+                      double rankTolerance )
+{
+    StreamStats_t stats;
+    long double sum = 0.0L;
+    long double squares = 0.0L;
+    long double mean = 0.0L;
+    double variance = 0.0;
+    uint32_t i = 0;
+
+    StreamStats_Init( &stats );
+
+    for( i = 0; i < count; i++ )
+    {
+        StreamStats_Add( &stats, samples[ i ], ( uint64_t ) i * 1000U );
+        sorted[ i ] = samples[ i ];
+        sum += samples[ i ];
+    }
+
+    qsort( sorted, count, sizeof( double ), prvCompare );
+    mean = sum / ( long double ) count;
+
+    for( i = 0; i < count; i++ )
+    {
+        squares += ( samples[ i ] - mean ) * ( samples[ i ] - mean );
+    }
+
+    variance = ( double ) ( squares / ( long double ) ( count - 1U ) );
+
+    TEST_ASSERT_EQUAL_INT( count, stats.count );
+    TEST_ASSERT( stats.min == sorted[ 0 ] );
+    TEST_ASSERT( stats.max == sorted[ count - 1U ] );
+    TEST_ASSERT_WITHIN( fabs( ( double ) mean ) * 1e-12 + 1e-12, ( double ) mean, stats.mean );
+    TEST_ASSERT_WITHIN( variance * 1e-5 + 1e-12, variance, StreamStats_GetVariance( &stats ) );
+    TEST_ASSERT_WITHIN( rankTolerance, 0.5, prvRank( StreamQuantile_Get( &stats.p50 ), count ) );
+    TEST_ASSERT_WITHIN( rankTolerance, 0.95, prvRank( StreamQuantile_Get( &stats.p95 ), count ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Welford_LargeOffset( void )
+{
+    uint32_t i = 0;
+
+    /* A naive sum of squares loses all digits of the spread here, the
+     * update keeps five. */
+    for( i = 0; i < TEST_SAMPLES; i++ )
+    {
+        samples[ i ] = 1e9 + prvNormal() * 0.01;
+    }
+
+    prvCheck( TEST_SAMPLES, 0.02 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Distributions( void )
+{
+    uint32_t i = 0;
+
+    for( i = 0; i < TEST_SAMPLES; i++ )
+    {
+        samples[ i ] = prvUniform() * 100.0;
+    }
+
+    prvCheck( TEST_SAMPLES, 0.005 );
+
+    for( i = 0; i < TEST_SAMPLES; i++ )
+    {
+        samples[ i ] = 90.0 + prvNormal() * 5.0;
+    }
+
+    prvCheck( TEST_SAMPLES, 0.005 );
+
+    /* Skewed, the 95th percentile is far in the tail. */
+    for( i = 0; i < TEST_SAMPLES; i++ )
+    {
+        samples[ i ] = -log( prvUniform() ) * 30.0;
+    }
+
+    prvCheck( TEST_SAMPLES, 0.005 );
+
+    /* A speed ramp, sorted input. */
+    for( i = 0; i < TEST_SAMPLES; i++ )
+    {
+        samples[ i ] = ( double ) i * 0.005;
+    }
+
+    prvCheck( TEST_SAMPLES, 0.005 );
+
+    /* Short trip. */
+    for( i = 0; i < 50U; i++ )
+    {
+        samples[ i ] = prvUniform() * 100.0;
+    }
+
+    prvCheck( 50, 0.1 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Quantile_FirstValuesExact( void )
+{
+    StreamQuantile_t quantile;
+    const double values[] = { 40.0, 10.0, 50.0, 20.0, 30.0 };
+    const double median[] = { 40.0, 40.0, 40.0, 40.0, 30.0 };
+    const double high[] = { 40.0, 40.0, 50.0, 50.0, 50.0 };
+    uint32_t i = 0;
+
+    StreamQuantile_Init( &quantile, 0.5 );
+    TEST_ASSERT( StreamQuantile_Get( &quantile ) == 0.0 );
+
+    for( i = 0; i < 5U; i++ )
+    {
+        StreamQuantile_Add( &quantile, values[ i ] );
+        TEST_ASSERT( StreamQuantile_Get( &quantile ) == median[ i ] );
+    }
+
+    StreamQuantile_Init( &quantile, 0.95 );
+
+    for( i = 0; i < 5U; i++ )
+    {
+        StreamQuantile_Add( &quantile, values[ i ] );
+        TEST_ASSERT( StreamQuantile_Get( &quantile ) == high[ i ] );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Quantile_Constant( void )
+{
+    StreamStats_t stats;
+    uint32_t i = 0;
+
+    StreamStats_Init( &stats );
+
+    for( i = 0; i < 1000U; i++ )
+    {
+        StreamStats_Add( &stats, 42.5, i );
+    }
+
+    TEST_ASSERT( StreamQuantile_Get( &stats.p50 ) == 42.5 );
+    TEST_ASSERT( StreamQuantile_Get( &stats.p95 ) == 42.5 );
+    TEST_ASSERT( StreamStats_GetVariance( &stats ) == 0.0 );
+    TEST_ASSERT( stats.mean == 42.5 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Stats_FewSamples( void )
+{
+    StreamStats_t stats;
+
+    StreamStats_Init( &stats );
+    TEST_ASSERT( StreamStats_GetVariance( &stats ) == 0.0 );
+    TEST_ASSERT( StreamStats_GetStdDev( &stats ) == 0.0 );
+
+    StreamStats_Add( &stats, 7.0, 0 );
+    TEST_ASSERT( StreamStats_GetVariance( &stats ) == 0.0 );
+    TEST_ASSERT( stats.min == 7.0 );
+    TEST_ASSERT( stats.max == 7.0 );
+
+    StreamStats_Add( &stats, 9.0, 0 );
+    TEST_ASSERT_WITHIN( 1e-12, 2.0, StreamStats_GetVariance( &stats ) );
+    TEST_ASSERT_WITHIN( 1e-12, sqrt( 2.0 ), StreamStats_GetStdDev( &stats ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_TimeWeightedMean( void )
+{
+    StreamStats_t stats;
+
+    StreamStats_Init( &stats );
+
+    /* No time passed yet, the plain mean. */
+    StreamStats_Add( &stats, 10.0, 5000 );
+    StreamStats_Add( &stats, 30.0, 5000 );
+    TEST_ASSERT_WITHIN( 1e-12, 20.0, StreamStats_GetTimeWeightedMean( &stats ) );
+
+    /* 30 held 1 s, 20 held 3 s, the last value has no duration yet. */
+    StreamStats_Add( &stats, 20.0, 6000 );
+    StreamStats_Add( &stats, 0.0, 9000 );
+    TEST_ASSERT_WITHIN( 1e-12, 22.5, StreamStats_GetTimeWeightedMean( &stats ) );
+
+    /* A sample older than the last one adds no time. */
+    StreamStats_Add( &stats, 100.0, 8000 );
+    TEST_ASSERT_WITHIN( 1e-12, 22.5, StreamStats_GetTimeWeightedMean( &stats ) );
+    TEST_ASSERT_WITHIN( 1e-12, 32.0, stats.mean );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    RUN_TEST( test_Welford_LargeOffset );
+    RUN_TEST( test_Distributions );
+    RUN_TEST( test_Quantile_FirstValuesExact );
+    RUN_TEST( test_Quantile_Constant );
+    RUN_TEST( test_Stats_FewSamples );
+    RUN_TEST( test_TimeWeightedMean );
+
+    return TEST_RESULT();
+}
+
+/*-----------------------------------------------------------*/
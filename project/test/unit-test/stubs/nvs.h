@@ -0,0 +1,61 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file nvs.h
+ * @brief Host stand-in for the ESP-IDF NVS API, the test supplies the store.
+ */
+
+#ifndef NVS_H
+#define NVS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int esp_err_t;
+typedef uint32_t nvs_handle_t;
+
+#define ESP_OK                    ( 0 )
+#define ESP_FAIL                  ( -1 )
+#define ESP_ERR_NVS_NOT_FOUND     ( 0x1102 )
+
+typedef enum
+{
+    NVS_READONLY,
+    NVS_READWRITE
+} nvs_open_mode_t;
+
+esp_err_t nvs_open( const char * name,
+                    nvs_open_mode_t open_mode,
+                    nvs_handle_t * out_handle );
+
+esp_err_t nvs_set_blob( nvs_handle_t handle,
+                        const char * key,
+                        const void * value,
+                        size_t length );
+
+esp_err_t nvs_get_blob( nvs_handle_t handle,
+                        const char * key,
+                        void * out_value,
+                        size_t * length );
+
+esp_err_t nvs_commit( nvs_handle_t handle );
+
+void nvs_close( nvs_handle_t handle );
+
+#endif /* NVS_H */
@@ -0,0 +1,84 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file test_assert.h
+ * @brief Minimal assertions for the host unit tests.
+ *
+ * A failed assertion prints its location and the test carries on, so one run
+ * reports every failure. The test main returns TEST_RESULT() for ctest.
+ */
+
+#ifndef TEST_ASSERT_H
+#define TEST_ASSERT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+
+static unsigned int testFailures = 0;
+static const char * pTestName = "";
+
+#define TEST_FAIL_AT( file, line, ... )                                 \
+    do {                                                                \
+        printf( "%s:%d: %s: ", ( file ), ( line ), pTestName );         \
+        printf( __VA_ARGS__ );                                          \
+        printf( "\n" );                                                 \
+        testFailures++;                                                 \
+    } while( 0 )
+
+#define TEST_ASSERT( condition )                                        \
+    do {                                                                \
+        if( !( condition ) )                                            \
+        {                                                               \
+            TEST_FAIL_AT( __FILE__, __LINE__, "%s", #condition );       \
+        }                                                               \
+    } while( 0 )
+
+#define TEST_ASSERT_EQUAL_INT( expected, actual )                       \
+    do {                                                                \
+        long long e_ = ( long long ) ( expected );                      \
+        long long a_ = ( long long ) ( actual );                        \
+        if( e_ != a_ )                                                  \
+        {                                                               \
+            TEST_FAIL_AT( __FILE__, __LINE__, "%s: expected %lld, got %lld", \
+                          #actual, e_, a_ );                            \
+        }                                                               \
+    } while( 0 )
+
+#define TEST_ASSERT_WITHIN( delta, expected, actual )                   \
+    do {                                                                \
+        double e_ = ( double ) ( expected );                            \
+        double a_ = ( double ) ( actual );                              \
+        if( !( fabs( e_ - a_ ) <= ( double ) ( delta ) ) )              \
+        {                                                               \
+            TEST_FAIL_AT( __FILE__, __LINE__, "%s: expected %.9g +- %.9g, got %.9g", \
+                          #actual, e_, ( double ) ( delta ), a_ );      \
+        }                                                               \
+    } while( 0 )
+
+#define RUN_TEST( function )                                            \
+    do {                                                                \
+        pTestName = #function;                                          \
+        function();                                                     \
+    } while( 0 )
+
+#define TEST_RESULT()                                                   \
+    ( printf( "%s: %u failure(s)\n", __FILE__, testFailures ), ( testFailures == 0U ) ? 0 : 1 )
+
+#endif /* TEST_ASSERT_H */
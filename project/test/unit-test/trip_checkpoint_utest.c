@@ -0,0 +1,223 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file trip_checkpoint_utest.c
+ * @brief Tests of the trip checkpoint store and the trip resume decision.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "test_assert.h"
+#include "nvs.h"
+#include "obd_config.h"
+#include "trip_checkpoint.h"
+
+#define TEST_NOW_MS     ( 1714564800000ULL )
+#define TEST_TRIP_ID    "20240501120000"
+#define TEST_NEXT_ID    "20240501121500"
+
+/* One blob of NVS in memory. */
+static uint8_t nvsBlob[ sizeof( ObdTripCheckpoint_t ) + 64U ];
+static size_t nvsBlobLength;
+static bool nvsFail;
+
+static ObdTripCheckpoint_t checkpoint;
+static ObdTripCheckpoint_t loaded;
+
+/*-----------------------------------------------------------*/
+
+esp_err_t nvs_open( const char * name,
+                    nvs_open_mode_t open_mode,
+                    nvs_handle_t * out_handle )
+{
+    *out_handle = 1U;
+
+    return ( nvsFail == true ) ? ESP_FAIL : ESP_OK;
+}
+
+/*-----------------------------------------------------------*/
+
+esp_err_t nvs_set_blob( nvs_handle_t handle,
+                        const char * key,
+                        const void * value,
+                        size_t length )
+{
+    esp_err_t err = ESP_FAIL;
+
+    if( length <= sizeof( nvsBlob ) )
+    {
+        memcpy( nvsBlob, value, length );
+        nvsBlobLength = length;
+        err = ESP_OK;
+    }
+
+    return err;
+}
+
+/*-----------------------------------------------------------*/
+
+esp_err_t nvs_get_blob( nvs_handle_t handle,
+                        const char * key,
+                        void * out_value,
+                        size_t * length )
+{
+    esp_err_t err = ESP_ERR_NVS_NOT_FOUND;
+
+    if( ( nvsBlobLength > 0U ) && ( nvsBlobLength <= *length ) )
+    {
+        memcpy( out_value, nvsBlob, nvsBlobLength );
+        *length = nvsBlobLength;
+        err = ESP_OK;
+    }
+
+    return err;
+}
+
+/*-----------------------------------------------------------*/
+
+esp_err_t nvs_commit( nvs_handle_t handle )
+{
+    return ESP_OK;
+}
+
+/*-----------------------------------------------------------*/
+
+void nvs_close( nvs_handle_t handle )
+{
+}
+
+/*-----------------------------------------------------------*/
+
+/* A checkpoint of a running trip saved at the given time. */
+static void prvCheckpoint( uint64_t savedEpochMs,
+                           bool ended )
+{
+    memset( &checkpoint, 0, sizeof( checkpoint ) );
+    strcpy( checkpoint.tripId, TEST_TRIP_ID );
+    checkpoint.startEpochMs = savedEpochMs - 600000U;
+    checkpoint.savedEpochMs = savedEpochMs;
+    checkpoint.distanceMm = 12345678U;
+    checkpoint.ended = ended;
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_SaveLoad_RoundTrip( void )
+{
+    nvsBlobLength = 0;
+    nvsFail = false;
+    TEST_ASSERT( TripCheckpoint_Load( &loaded ) == false );
+
+    prvCheckpoint( TEST_NOW_MS, false );
+    checkpoint.highBrakingEvents = 3U;
+    TEST_ASSERT( TripCheckpoint_Save( &checkpoint ) == true );
+    TEST_ASSERT( TripCheckpoint_Load( &loaded ) == true );
+    TEST_ASSERT( memcmp( &checkpoint, &loaded, sizeof( checkpoint ) ) == 0 );
+
+    /* A blob of another layout is not loaded. */
+    nvsBlob[ 0 ] ^= 0xFFU;
+    TEST_ASSERT( TripCheckpoint_Load( &loaded ) == false );
+    nvsBlob[ 0 ] ^= 0xFFU;
+    nvsBlobLength -= 1U;
+    TEST_ASSERT( TripCheckpoint_Load( &loaded ) == false );
+
+    nvsFail = true;
+    TEST_ASSERT( TripCheckpoint_Save( &checkpoint ) == false );
+    nvsFail = false;
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Resume_Fresh( void )
+{
+    prvCheckpoint( TEST_NOW_MS, false );
+
+    TEST_ASSERT_EQUAL_INT( TRIP_RESUME_CHECKPOINT, TripCheckpoint_GetResume( &checkpoint, NULL, true, TEST_NOW_MS ) );
+    TEST_ASSERT_EQUAL_INT( TRIP_RESUME_CHECKPOINT,
+                           TripCheckpoint_GetResume( &checkpoint, TEST_TRIP_ID, true, TEST_NOW_MS + TRIP_CHECKPOINT_MAX_GAP_MS ) );
+
+    /* The checkpoint wins over any trip of the RTC memory. */
+    TEST_ASSERT_EQUAL_INT( TRIP_RESUME_CHECKPOINT, TripCheckpoint_GetResume( &checkpoint, TEST_NEXT_ID, true, TEST_NOW_MS + 1000U ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Resume_Stale( void )
+{
+    uint64_t staleMs = TEST_NOW_MS + TRIP_CHECKPOINT_MAX_GAP_MS + 1U;
+
+    prvCheckpoint( TEST_NOW_MS, false );
+
+    /* Neither the checkpoint nor the RTC memory after a long park. */
+    TEST_ASSERT_EQUAL_INT( TRIP_RESUME_NONE, TripCheckpoint_GetResume( &checkpoint, NULL, true, staleMs ) );
+    TEST_ASSERT_EQUAL_INT( TRIP_RESUME_NONE, TripCheckpoint_GetResume( &checkpoint, TEST_TRIP_ID, true, staleMs ) );
+    TEST_ASSERT_EQUAL_INT( TRIP_RESUME_NONE, TripCheckpoint_GetResume( &checkpoint, TEST_NEXT_ID, true, TEST_NOW_MS + 3600000U ) );
+
+    /* A clock behind the checkpoint cannot measure the gap. */
+    TEST_ASSERT_EQUAL_INT( TRIP_RESUME_NONE, TripCheckpoint_GetResume( &checkpoint, TEST_TRIP_ID, true, TEST_NOW_MS - 1U ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Resume_Ended( void )
+{
+    prvCheckpoint( TEST_NOW_MS, true );
+
+    TEST_ASSERT_EQUAL_INT( TRIP_RESUME_NONE, TripCheckpoint_GetResume( &checkpoint, NULL, true, TEST_NOW_MS + 1000U ) );
+
+    /* Reset between the ended checkpoint and the clear of the RTC memory. */
+    TEST_ASSERT_EQUAL_INT( TRIP_RESUME_NONE, TripCheckpoint_GetResume( &checkpoint, TEST_TRIP_ID, true, TEST_NOW_MS + 1000U ) );
+
+    /* A trip started after it and reset before its first checkpoint. */
+    TEST_ASSERT_EQUAL_INT( TRIP_RESUME_ODOMETER, TripCheckpoint_GetResume( &checkpoint, TEST_NEXT_ID, true, TEST_NOW_MS + 30000U ) );
+    TEST_ASSERT_EQUAL_INT( TRIP_RESUME_NONE,
+                           TripCheckpoint_GetResume( &checkpoint, TEST_NEXT_ID, true, TEST_NOW_MS + TRIP_CHECKPOINT_MAX_GAP_MS + 1U ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Resume_NoClock( void )
+{
+    prvCheckpoint( TEST_NOW_MS, false );
+
+    /* The uptime clock cannot tell the gap, the RTC memory is not used either. */
+    TEST_ASSERT_EQUAL_INT( TRIP_RESUME_NONE, TripCheckpoint_GetResume( &checkpoint, NULL, false, TEST_NOW_MS ) );
+    TEST_ASSERT_EQUAL_INT( TRIP_RESUME_NONE, TripCheckpoint_GetResume( &checkpoint, TEST_TRIP_ID, false, TEST_NOW_MS ) );
+    TEST_ASSERT_EQUAL_INT( TRIP_RESUME_NONE, TripCheckpoint_GetResume( NULL, TEST_TRIP_ID, false, 5000U ) );
+
+    /* No checkpoint to measure the RTC memory by. */
+    TEST_ASSERT_EQUAL_INT( TRIP_RESUME_NONE, TripCheckpoint_GetResume( NULL, TEST_TRIP_ID, true, TEST_NOW_MS ) );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    RUN_TEST( test_SaveLoad_RoundTrip );
+    RUN_TEST( test_Resume_Fresh );
+    RUN_TEST( test_Resume_Stale );
+    RUN_TEST( test_Resume_Ended );
+    RUN_TEST( test_Resume_NoClock );
+
+    return TEST_RESULT();
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,179 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file trip_odometer_utest.c
+ * @brief Tests of the trip odometer and its reset survival store.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "test_assert.h"
+#include "trip_odometer.h"
+#include "obd_config.h"
+
+/* 1000 microdegree of latitude, in millimetre. */
+#define SEGMENT_MM    ( 111319U )
+
+/*-----------------------------------------------------------*/
+
+static void prvDrive( TripOdometer_t * pOdometer,
+                      int32_t fromLatitude,
+                      int segments )
+{
+    int i = 0;
+
+    for( i = 1; i <= segments; i++ )
+    {
+        TripOdometer_AddFix( pOdometer, fromLatitude + ( i * 1000 ), 0, 10 );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Fixes_AddSegments( void )
+{
+    TripOdometer_t odometer;
+
+    TripOdometer_Start( &odometer, "trip-1" );
+    TripOdometer_AddFix( &odometer, 0, 0, 10 );
+    prvDrive( &odometer, 0, 9 );
+
+    TEST_ASSERT_WITHIN( 9 * 5, 9 * SEGMENT_MM, TripOdometer_GetDistanceMm( &odometer ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Fixes_JitterIsHeldBack( void )
+{
+    TripOdometer_t odometer;
+    int i = 0;
+
+    TripOdometer_Start( &odometer, "trip-1" );
+    TripOdometer_AddFix( &odometer, 0, 0, 10 );
+
+    /* 2 m around the anchor, below the 5 m noise of HDOP 1.0. */
+    for( i = 0; i < 100; i++ )
+    {
+        TripOdometer_AddFix( &odometer, ( i % 2 ) * 18, 0, 10 );
+    }
+
+    TEST_ASSERT_EQUAL_INT( 0, TripOdometer_GetDistanceMm( &odometer ) );
+
+    /* Poor fixes are skipped. */
+    TripOdometer_AddFix( &odometer, 5000, 0, TRIP_ODOMETER_MAX_HDOP + 1 );
+    TEST_ASSERT_EQUAL_INT( 0, TripOdometer_GetDistanceMm( &odometer ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Speed_ReplacesGpsJump( void )
+{
+    TripOdometer_t odometer;
+
+    TripOdometer_Start( &odometer, "trip-1" );
+    TripOdometer_AddFix( &odometer, 0, 0, 10 );
+
+    /* 10 s at 36 km/h is 100 m, the fix jumps 1113 m. */
+    TripOdometer_AddSpeed( &odometer, 36.0f, 1000 );
+    TripOdometer_AddSpeed( &odometer, 36.0f, 11000 );
+    TripOdometer_AddFix( &odometer, 10000, 0, 10 );
+
+    TEST_ASSERT_WITHIN( 10, 100000, TripOdometer_GetDistanceMm( &odometer ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Resume_AfterReset( void )
+{
+    TripOdometer_t odometer;
+    char tripId[ 16 ] = { 0 };
+    uint64_t drivenMm = 0;
+
+    TripOdometer_Start( &odometer, "trip-2" );
+    TripOdometer_AddFix( &odometer, 0, 0, 10 );
+    prvDrive( &odometer, 0, 5 );
+    drivenMm = TripOdometer_GetDistanceMm( &odometer );
+
+    /* Reboot: the context is reset and the GPS keeps reporting while parked,
+     * before the trip is resumed. */
+    TripOdometer_Init( &odometer );
+    prvDrive( &odometer, 5000, 3 );
+    TripOdometer_AddSpeed( &odometer, 50.0f, 1000 );
+    TripOdometer_AddSpeed( &odometer, 50.0f, 3000 );
+    TEST_ASSERT_EQUAL_INT( 0, TripOdometer_GetDistanceMm( &odometer ) );
+
+    TEST_ASSERT( TripOdometer_Resume( &odometer, tripId, sizeof( tripId ) ) == true );
+    TEST_ASSERT( strcmp( tripId, "trip-2" ) == 0 );
+    TEST_ASSERT_EQUAL_INT( drivenMm, TripOdometer_GetDistanceMm( &odometer ) );
+
+    /* The resumed trip collects distance again. */
+    TripOdometer_AddFix( &odometer, 5000, 0, 10 );
+    prvDrive( &odometer, 5000, 1 );
+    TEST_ASSERT_WITHIN( 5, drivenMm + SEGMENT_MM, TripOdometer_GetDistanceMm( &odometer ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Stop_EndsTrip( void )
+{
+    TripOdometer_t odometer;
+    char tripId[ 16 ] = { 0 };
+
+    TripOdometer_Start( &odometer, "trip-3" );
+    TripOdometer_AddFix( &odometer, 0, 0, 10 );
+    prvDrive( &odometer, 0, 2 );
+    TripOdometer_Stop( &odometer );
+
+    /* Fixes after the trip do not start a new one. */
+    prvDrive( &odometer, 2000, 2 );
+    TEST_ASSERT( TripOdometer_Resume( &odometer, tripId, sizeof( tripId ) ) == false );
+    TEST_ASSERT_EQUAL_INT( 0, TripOdometer_GetDistanceMm( &odometer ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Continue_FromCheckpoint( void )
+{
+    TripOdometer_t odometer;
+    char tripId[ 16 ] = { 0 };
+
+    TripOdometer_Continue( &odometer, "trip-4", 123456789ULL );
+    TripOdometer_Init( &odometer );
+
+    TEST_ASSERT( TripOdometer_Resume( &odometer, tripId, sizeof( tripId ) ) == true );
+    TEST_ASSERT( strcmp( tripId, "trip-4" ) == 0 );
+    TEST_ASSERT_EQUAL_INT( 123456789ULL, TripOdometer_GetDistanceMm( &odometer ) );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    RUN_TEST( test_Fixes_AddSegments );
+    RUN_TEST( test_Fixes_JitterIsHeldBack );
+    RUN_TEST( test_Speed_ReplacesGpsJump );
+    RUN_TEST( test_Resume_AfterReset );
+    RUN_TEST( test_Stop_EndsTrip );
+    RUN_TEST( test_Continue_FromCheckpoint );
+
+    return TEST_RESULT();
+}
+
+/*-----------------------------------------------------------*/
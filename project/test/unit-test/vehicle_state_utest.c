@@ -0,0 +1,230 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file vehicle_state_utest.c
+ * @brief Tests of the vehicle state dwell time and speed hysteresis.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "test_assert.h"
+#include "obd_config.h"
+#include "vehicle_state.h"
+
+#define TEST_CITY_SPEED       ( 50.0 )
+#define TEST_HIGHWAY_SPEED    ( VEHICLE_STATE_HIGHWAY_SPEED + 10.0 )
+
+static VehicleStateMachine_t machine;
+
+/*-----------------------------------------------------------*/
+
+/* Start a running machine in the given state at time 0. */
+static void prvStartIn( VehicleState_t state )
+{
+    VehicleState_Init( &machine );
+
+    switch( state )
+    {
+        case VEHICLE_STATE_IDLE:
+            ( void ) VehicleState_Update( &machine, true, 0.0, false, 0U );
+            break;
+
+        case VEHICLE_STATE_CITY:
+            ( void ) VehicleState_Update( &machine, true, TEST_CITY_SPEED, false, 0U );
+            break;
+
+        case VEHICLE_STATE_HIGHWAY:
+            ( void ) VehicleState_Update( &machine, true, TEST_HIGHWAY_SPEED, false, 0U );
+            break;
+
+        case VEHICLE_STATE_EVENT:
+            ( void ) VehicleState_Update( &machine, true, TEST_HIGHWAY_SPEED, true, 0U );
+            break;
+
+        default:
+            break;
+    }
+
+    TEST_ASSERT_EQUAL_INT( state, machine.state );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Init_Off( void )
+{
+    VehicleState_Init( &machine );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_OFF, machine.state );
+
+    /* Ignition off stays off without a change. */
+    TEST_ASSERT( VehicleState_Update( &machine, false, 0.0, false, 1000U ) == false );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_OFF, machine.state );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Upgrade_Immediate( void )
+{
+    VehicleState_Init( &machine );
+
+    TEST_ASSERT( VehicleState_Update( &machine, true, 0.0, false, 100U ) == true );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_IDLE, machine.state );
+    TEST_ASSERT( VehicleState_Update( &machine, true, TEST_CITY_SPEED, false, 200U ) == true );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_CITY, machine.state );
+    TEST_ASSERT( VehicleState_Update( &machine, true, TEST_HIGHWAY_SPEED, false, 300U ) == true );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_HIGHWAY, machine.state );
+    TEST_ASSERT( VehicleState_Update( &machine, true, TEST_HIGHWAY_SPEED, true, 400U ) == true );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_EVENT, machine.state );
+
+    /* From a stop straight to an event. */
+    prvStartIn( VEHICLE_STATE_IDLE );
+    TEST_ASSERT( VehicleState_Update( &machine, true, 0.0, true, 100U ) == true );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_EVENT, machine.state );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Downgrade_AfterDwell( void )
+{
+    prvStartIn( VEHICLE_STATE_EVENT );
+
+    /* The event ended at 1000, highway must hold for the dwell time. */
+    TEST_ASSERT( VehicleState_Update( &machine, true, TEST_HIGHWAY_SPEED, false, 1000U ) == false );
+    TEST_ASSERT( VehicleState_Update( &machine, true, TEST_HIGHWAY_SPEED, false, 1000U + VEHICLE_STATE_DWELL_MS - 1U ) == false );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_EVENT, machine.state );
+    TEST_ASSERT( VehicleState_Update( &machine, true, TEST_HIGHWAY_SPEED, false, 1000U + VEHICLE_STATE_DWELL_MS ) == true );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_HIGHWAY, machine.state );
+
+    /* Further updates in the same state report no change. */
+    TEST_ASSERT( VehicleState_Update( &machine, true, TEST_HIGHWAY_SPEED, false, 1000U + ( 2U * VEHICLE_STATE_DWELL_MS ) ) == false );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Downgrade_DwellRestarts( void )
+{
+    prvStartIn( VEHICLE_STATE_CITY );
+
+    /* A short stop does not make it idle. */
+    TEST_ASSERT( VehicleState_Update( &machine, true, 0.0, false, 1000U ) == false );
+    TEST_ASSERT( VehicleState_Update( &machine, true, TEST_CITY_SPEED, false, 4000U ) == false );
+    TEST_ASSERT( VehicleState_Update( &machine, true, 0.0, false, 5000U ) == false );
+    TEST_ASSERT( VehicleState_Update( &machine, true, 0.0, false, 5000U + VEHICLE_STATE_DWELL_MS - 1U ) == false );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_CITY, machine.state );
+    TEST_ASSERT( VehicleState_Update( &machine, true, 0.0, false, 5000U + VEHICLE_STATE_DWELL_MS ) == true );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_IDLE, machine.state );
+
+    /* A different slower state restarts the dwell as well. */
+    prvStartIn( VEHICLE_STATE_HIGHWAY );
+    TEST_ASSERT( VehicleState_Update( &machine, true, TEST_CITY_SPEED, false, 1000U ) == false );
+    TEST_ASSERT( VehicleState_Update( &machine, true, 0.0, false, 3000U ) == false );
+    TEST_ASSERT( VehicleState_Update( &machine, true, 0.0, false, 1000U + VEHICLE_STATE_DWELL_MS ) == false );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_HIGHWAY, machine.state );
+    TEST_ASSERT( VehicleState_Update( &machine, true, 0.0, false, 3000U + VEHICLE_STATE_DWELL_MS ) == true );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_IDLE, machine.state );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Highway_Hysteresis( void )
+{
+    double belowHighway = VEHICLE_STATE_HIGHWAY_SPEED - ( VEHICLE_STATE_SPEED_HYSTERESIS / 2.0 );
+    double belowHysteresis = VEHICLE_STATE_HIGHWAY_SPEED - VEHICLE_STATE_SPEED_HYSTERESIS - 1.0;
+
+    /* In the band the highway state holds without starting a dwell. */
+    prvStartIn( VEHICLE_STATE_HIGHWAY );
+    TEST_ASSERT( VehicleState_Update( &machine, true, belowHighway, false, 1000U ) == false );
+    TEST_ASSERT( VehicleState_Update( &machine, true, belowHighway, false, 1000U + ( 2U * VEHICLE_STATE_DWELL_MS ) ) == false );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_HIGHWAY, machine.state );
+
+    /* Below the band it is city after the dwell. */
+    TEST_ASSERT( VehicleState_Update( &machine, true, belowHysteresis, false, 20000U ) == false );
+    TEST_ASSERT( VehicleState_Update( &machine, true, belowHysteresis, false, 20000U + VEHICLE_STATE_DWELL_MS ) == true );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_CITY, machine.state );
+
+    /* The band does not make city a highway. */
+    TEST_ASSERT( VehicleState_Update( &machine, true, belowHighway, false, 30000U ) == false );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_CITY, machine.state );
+    TEST_ASSERT( VehicleState_Update( &machine, true, VEHICLE_STATE_HIGHWAY_SPEED, false, 31000U ) == true );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_HIGHWAY, machine.state );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_IgnitionOff_BypassesDwell( void )
+{
+    VehicleState_t state = VEHICLE_STATE_IDLE;
+
+    for( state = VEHICLE_STATE_IDLE; state < VEHICLE_STATE_MAX; state++ )
+    {
+        prvStartIn( state );
+        TEST_ASSERT( VehicleState_Update( &machine, false, TEST_HIGHWAY_SPEED, true, 1U ) == true );
+        TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_OFF, machine.state );
+    }
+
+    /* A pending slower state does not carry over to the next start. */
+    prvStartIn( VEHICLE_STATE_CITY );
+    ( void ) VehicleState_Update( &machine, true, 0.0, false, 1000U );
+    TEST_ASSERT( VehicleState_Update( &machine, false, 0.0, false, 2000U ) == true );
+    TEST_ASSERT( VehicleState_Update( &machine, true, TEST_CITY_SPEED, false, 3000U ) == true );
+    TEST_ASSERT( VehicleState_Update( &machine, true, TEST_CITY_SPEED, false, 1000U + VEHICLE_STATE_DWELL_MS ) == false );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_CITY, machine.state );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Profile( void )
+{
+    VehicleStateProfile_t profile = { 0 };
+
+    VehicleState_GetProfile( VEHICLE_STATE_CITY, 1000U, 5000U, &profile );
+    TEST_ASSERT_EQUAL_INT( 1000, profile.collectIntervalMs );
+    TEST_ASSERT_EQUAL_INT( 5000, profile.telemetryIntervalMs );
+    TEST_ASSERT( profile.gpsActive == true );
+
+    VehicleState_GetProfile( VEHICLE_STATE_IDLE, 1000U, 5000U, &profile );
+    TEST_ASSERT_EQUAL_INT( 1000U * VEHICLE_STATE_IDLE_PERCENT / 100U, profile.collectIntervalMs );
+    TEST_ASSERT( profile.gpsActive == false );
+
+    /* Scaled intervals do not go below the minimum. */
+    VehicleState_GetProfile( VEHICLE_STATE_EVENT, 500U, 500U, &profile );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_MIN_INTERVAL_MS, profile.collectIntervalMs );
+    TEST_ASSERT_EQUAL_INT( VEHICLE_STATE_MIN_INTERVAL_MS, profile.telemetryIntervalMs );
+
+    TEST_ASSERT( strcmp( VehicleState_GetName( VEHICLE_STATE_HIGHWAY ), "highway" ) == 0 );
+    TEST_ASSERT( strcmp( VehicleState_GetName( VEHICLE_STATE_MAX ), "unknown" ) == 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    RUN_TEST( test_Init_Off );
+    RUN_TEST( test_Upgrade_Immediate );
+    RUN_TEST( test_Downgrade_AfterDwell );
+    RUN_TEST( test_Downgrade_DwellRestarts );
+    RUN_TEST( test_Highway_Hysteresis );
+    RUN_TEST( test_IgnitionOff_BypassesDwell );
+    RUN_TEST( test_Profile );
+
+    return TEST_RESULT();
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,257 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file window_aggregate_utest.c
+ * @brief Tests of the tumbling and sliding window boundaries and eviction.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "test_assert.h"
+#include "window_aggregate.h"
+
+#define TEST_INTERVAL    ( ( uint64_t ) OBD_AGGREGATED_DATA_INTERVAL_MS )
+#define TEST_ROUNDS      ( 200U )
+
+/* Reference of every closed bucket, kept in full. */
+static WindowSummary_t reference[ TEST_ROUNDS ][ WINDOW_AGGREGATE_MAX_SIGNALS ];
+static uint64_t referenceStart[ TEST_ROUNDS ];
+static uint64_t referenceEnd[ TEST_ROUNDS ];
+static uint32_t randomState = 1234567U;
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRandom( void )
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+
+    return randomState;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvReferenceAdd( WindowSummary_t * pSummary,
+                             double value )
+{
+    if( ( pSummary->count == 0U ) || ( value < pSummary->min ) )
+    {
+        pSummary->min = value;
+    }
+
+    if( ( pSummary->count == 0U ) || ( value > pSummary->max ) )
+    {
+        pSummary->max = value;
+    }
+
+    pSummary->count++;
+    pSummary->sum += value;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvAssertSummary( const WindowSummary_t * pExpected,
+                              const WindowSummary_t * pActual )
+{
+    TEST_ASSERT_EQUAL_INT( pExpected->count, pActual->count );
+
+    if( pExpected->count > 0U )
+    {
+        TEST_ASSERT_WITHIN( 1e-9, pExpected->sum, pActual->sum );
+        TEST_ASSERT( pExpected->min == pActual->min );
+        TEST_ASSERT( pExpected->max == pActual->max );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Empty_BeforeFirstClose( void )
+{
+    WindowAggregate_t window;
+    WindowSummary_t summary;
+
+    WindowAggregate_Init( &window, 1000 );
+    WindowAggregate_Add( &window, 0, 5.0 );
+
+    /* The open bucket is not reported. */
+    TEST_ASSERT_EQUAL_INT( 0, WindowAggregate_GetTumbling( &window, 0, &summary ) );
+    TEST_ASSERT_EQUAL_INT( 0, summary.count );
+    TEST_ASSERT_EQUAL_INT( 0, WindowAggregate_GetSliding( &window, 0, &summary ) );
+    TEST_ASSERT_EQUAL_INT( 0, summary.count );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_IsDue_Boundary( void )
+{
+    WindowAggregate_t window;
+
+    WindowAggregate_Init( &window, 5000 );
+    TEST_ASSERT( WindowAggregate_IsDue( &window, 5000 ) == false );
+    TEST_ASSERT( WindowAggregate_IsDue( &window, 5000 + TEST_INTERVAL - 1U ) == false );
+    TEST_ASSERT( WindowAggregate_IsDue( &window, 5000 + TEST_INTERVAL ) == true );
+
+    /* A late close starts the next bucket where it closed. */
+    WindowAggregate_Close( &window, 5000 + TEST_INTERVAL + 700U );
+    TEST_ASSERT( WindowAggregate_IsDue( &window, 5000 + ( 2U * TEST_INTERVAL ) ) == false );
+    TEST_ASSERT( WindowAggregate_IsDue( &window, 5000 + ( 2U * TEST_INTERVAL ) + 700U ) == true );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Tumbling_OneBucket( void )
+{
+    WindowAggregate_t window;
+    WindowSummary_t summary;
+
+    WindowAggregate_Init( &window, 0 );
+    WindowAggregate_Add( &window, 1, 10.0 );
+    WindowAggregate_Add( &window, 1, -4.0 );
+    WindowAggregate_Add( &window, 1, 7.0 );
+    WindowAggregate_Add( &window, WINDOW_AGGREGATE_MAX_SIGNALS, 99.0 );
+    WindowAggregate_Close( &window, TEST_INTERVAL );
+
+    /* A value after the close belongs to the next bucket. */
+    WindowAggregate_Add( &window, 1, 1000.0 );
+
+    TEST_ASSERT_EQUAL_INT( TEST_INTERVAL, WindowAggregate_GetTumbling( &window, 1, &summary ) );
+    TEST_ASSERT_EQUAL_INT( 3, summary.count );
+    TEST_ASSERT_WITHIN( 1e-12, 13.0, summary.sum );
+    TEST_ASSERT( summary.min == -4.0 );
+    TEST_ASSERT( summary.max == 10.0 );
+
+    /* Other signals are empty, an unknown one is refused. */
+    TEST_ASSERT_EQUAL_INT( TEST_INTERVAL, WindowAggregate_GetTumbling( &window, 0, &summary ) );
+    TEST_ASSERT_EQUAL_INT( 0, summary.count );
+    TEST_ASSERT_EQUAL_INT( 0, WindowAggregate_GetTumbling( &window, WINDOW_AGGREGATE_MAX_SIGNALS, &summary ) );
+    TEST_ASSERT_EQUAL_INT( 0, summary.count );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Sliding_EvictsOldest( void )
+{
+    WindowAggregate_t window;
+    WindowSummary_t summary;
+    uint32_t i = 0;
+
+    /* Bucket i holds the single value i. */
+    WindowAggregate_Init( &window, 0 );
+
+    for( i = 0; i <= OBD_AGGREGATED_SLIDING_WINDOWS; i++ )
+    {
+        WindowAggregate_Add( &window, 0, ( double ) i );
+        WindowAggregate_Close( &window, ( i + 1U ) * TEST_INTERVAL );
+    }
+
+    /* Bucket 0 is out, the window starts at bucket 1. */
+    TEST_ASSERT_EQUAL_INT( OBD_AGGREGATED_SLIDING_WINDOWS * TEST_INTERVAL, WindowAggregate_GetSliding( &window, 0, &summary ) );
+    TEST_ASSERT_EQUAL_INT( OBD_AGGREGATED_SLIDING_WINDOWS, summary.count );
+    TEST_ASSERT( summary.min == 1.0 );
+    TEST_ASSERT( summary.max == ( double ) OBD_AGGREGATED_SLIDING_WINDOWS );
+
+    /* An empty bucket moves the window without values. */
+    WindowAggregate_Close( &window, ( OBD_AGGREGATED_SLIDING_WINDOWS + 2U ) * TEST_INTERVAL );
+    TEST_ASSERT_EQUAL_INT( OBD_AGGREGATED_SLIDING_WINDOWS * TEST_INTERVAL, WindowAggregate_GetSliding( &window, 0, &summary ) );
+    TEST_ASSERT_EQUAL_INT( OBD_AGGREGATED_SLIDING_WINDOWS - 1U, summary.count );
+    TEST_ASSERT( summary.min == 2.0 );
+    TEST_ASSERT_EQUAL_INT( TEST_INTERVAL, WindowAggregate_GetTumbling( &window, 0, &summary ) );
+    TEST_ASSERT_EQUAL_INT( 0, summary.count );
+}
+
+/*-----------------------------------------------------------*/
+
+static void test_Sliding_MatchesReference( void )
+{
+    WindowAggregate_t window;
+    WindowSummary_t expected;
+    WindowSummary_t summary;
+    uint64_t nowMs = 123456;
+    uint32_t round_ = 0;
+    uint32_t signal = 0;
+    uint32_t values = 0;
+    uint32_t oldest = 0;
+    uint32_t i = 0;
+    double value = 0.0;
+
+    memset( reference, 0, sizeof( reference ) );
+    WindowAggregate_Init( &window, nowMs );
+
+    for( round_ = 0; round_ < TEST_ROUNDS; round_++ )
+    {
+        referenceStart[ round_ ] = nowMs;
+
+        /* Some buckets stay empty, signals get different values. */
+        for( values = prvRandom() % 12U; values > 0U; values-- )
+        {
+            signal = prvRandom() % WINDOW_AGGREGATE_MAX_SIGNALS;
+            value = ( ( double ) ( prvRandom() % 20001U ) - 10000.0 ) / 100.0;
+            WindowAggregate_Add( &window, signal, value );
+            prvReferenceAdd( &reference[ round_ ][ signal ], value );
+        }
+
+        /* Closes are late by up to one collect step. */
+        nowMs += TEST_INTERVAL + ( prvRandom() % 2000U );
+        referenceEnd[ round_ ] = nowMs;
+        WindowAggregate_Close( &window, nowMs );
+
+        oldest = ( round_ >= OBD_AGGREGATED_SLIDING_WINDOWS ) ? ( round_ + 1U - OBD_AGGREGATED_SLIDING_WINDOWS ) : 0U;
+
+        for( signal = 0; signal < WINDOW_AGGREGATE_MAX_SIGNALS; signal++ )
+        {
+            TEST_ASSERT_EQUAL_INT( referenceEnd[ round_ ] - referenceStart[ round_ ],
+                                   WindowAggregate_GetTumbling( &window, signal, &summary ) );
+            prvAssertSummary( &reference[ round_ ][ signal ], &summary );
+
+            memset( &expected, 0, sizeof( expected ) );
+
+            for( i = oldest; i <= round_; i++ )
+            {
+                if( reference[ i ][ signal ].count > 0U )
+                {
+                    prvReferenceAdd( &expected, reference[ i ][ signal ].min );
+                    prvReferenceAdd( &expected, reference[ i ][ signal ].max );
+                    expected.count += reference[ i ][ signal ].count - 2U;
+                    expected.sum += reference[ i ][ signal ].sum - reference[ i ][ signal ].min - reference[ i ][ signal ].max;
+                }
+            }
+
+            TEST_ASSERT_EQUAL_INT( referenceEnd[ round_ ] - referenceStart[ oldest ],
+                                   WindowAggregate_GetSliding( &window, signal, &summary ) );
+            prvAssertSummary( &expected, &summary );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    RUN_TEST( test_Empty_BeforeFirstClose );
+    RUN_TEST( test_IsDue_Boundary );
+    RUN_TEST( test_Tumbling_OneBucket );
+    RUN_TEST( test_Sliding_EvictsOldest );
+    RUN_TEST( test_Sliding_MatchesReference );
+
+    return TEST_RESULT();
+}
+
+/*-----------------------------------------------------------*/